@@ -908,6 +908,33 @@ void DatafeedCallbackData::run(const struct sr_dev_inst *sdi,
 	_callback(move(device), move(packet));
 }
 
+DatafeedViewCallbackData::DatafeedViewCallbackData(Session *session,
+		DatafeedViewCallbackFunction callback) :
+	_callback(move(callback)),
+	_session(session),
+	_last_sdi(nullptr),
+	_last_device(nullptr)
+{
+}
+
+void DatafeedViewCallbackData::reset_device_cache()
+{
+	_last_sdi = nullptr;
+	_last_device = nullptr;
+}
+
+void DatafeedViewCallbackData::run(const struct sr_dev_inst *sdi,
+	const struct sr_datafeed_packet *pkt)
+{
+	/* Packets usually arrive in long runs from the same device. */
+	if (sdi != _last_sdi) {
+		_last_device = _session->lookup_device(sdi);
+		_last_sdi = sdi;
+	}
+	const PacketView packet {_session, sdi, pkt};
+	_callback(*_last_device, packet);
+}
+
 SessionDevice::SessionDevice(struct sr_dev_inst *structure) :
 	Device(structure)
 {
@@ -963,6 +990,17 @@ shared_ptr<Device> Session::get_device(const struct sr_dev_inst *sdi)
 		throw Error(SR_ERR_BUG);
 }
 
+Device *Session::lookup_device(const struct sr_dev_inst *sdi)
+{
+	const auto owned = _owned_devices.find(sdi);
+	if (owned != _owned_devices.end())
+		return owned->second.get();
+	const auto other = _other_devices.find(sdi);
+	if (other != _other_devices.end())
+		return other->second.get();
+	throw Error(SR_ERR_BUG);
+}
+
 void Session::add_device(shared_ptr<Device> device)
 {
 	const auto dev_struct = device->_structure;
@@ -985,6 +1023,8 @@ vector<shared_ptr<Device>> Session::devices()
 
 void Session::remove_devices()
 {
+	for (const auto &cb_data : _datafeed_view_callbacks)
+		cb_data->reset_device_cache();
 	_other_devices.clear();
 	check(sr_session_dev_remove_all(_structure));
 }
@@ -1045,10 +1085,27 @@ void Session::add_datafeed_callback(DatafeedCallbackFunction callback)
 	_datafeed_callbacks.push_back(move(cb_data));
 }
 
+static void datafeed_view_callback(const struct sr_dev_inst *sdi,
+	const struct sr_datafeed_packet *pkt, void *cb_data) noexcept
+{
+	auto callback = static_cast<DatafeedViewCallbackData *>(cb_data);
+	callback->run(sdi, pkt);
+}
+
+void Session::add_datafeed_view_callback(DatafeedViewCallbackFunction callback)
+{
+	unique_ptr<DatafeedViewCallbackData> cb_data
+		{new DatafeedViewCallbackData{this, move(callback)}};
+	check(sr_session_datafeed_callback_add(_structure,
+			&datafeed_view_callback, cb_data.get()));
+	_datafeed_view_callbacks.push_back(move(cb_data));
+}
+
 void Session::remove_datafeed_callbacks()
 {
 	check(sr_session_datafeed_callback_remove_all(_structure));
 	_datafeed_callbacks.clear();
+	_datafeed_view_callbacks.clear();
 }
 
 shared_ptr<Trigger> Session::trigger()
@@ -1077,9 +1134,10 @@ shared_ptr<Context> Session::context()
 }
 
 Packet::Packet(shared_ptr<Device> device,
-	const struct sr_datafeed_packet *structure) :
+	const struct sr_datafeed_packet *structure, bool owned) :
 	_structure(structure),
-	_device(move(device))
+	_device(move(device)),
+	_owned(owned)
 {
 	switch (structure->type)
 	{
@@ -1108,6 +1166,8 @@ Packet::Packet(shared_ptr<Device> device,
 
 Packet::~Packet()
 {
+	if (_owned)
+		sr_packet_free(const_cast<struct sr_datafeed_packet *>(_structure));
 }
 
 const PacketType *Packet::type() const
@@ -1123,6 +1183,155 @@ shared_ptr<PacketPayload> Packet::payload()
 		throw Error(SR_ERR_NA);
 }
 
+PacketView::PacketView(Session *session, const struct sr_dev_inst *sdi,
+	const struct sr_datafeed_packet *structure) :
+	_session(session),
+	_sdi(sdi),
+	_structure(structure)
+{
+}
+
+const PacketType *PacketView::type() const
+{
+	return PacketType::get(_structure->type);
+}
+
+LogicView PacketView::logic() const
+{
+	if (_structure->type != SR_DF_LOGIC)
+		throw Error(SR_ERR_NA);
+	return LogicView{static_cast<const struct sr_datafeed_logic *>(
+		_structure->payload)};
+}
+
+AnalogView PacketView::analog() const
+{
+	if (_structure->type != SR_DF_ANALOG)
+		throw Error(SR_ERR_NA);
+	return AnalogView{static_cast<const struct sr_datafeed_analog *>(
+		_structure->payload)};
+}
+
+shared_ptr<Packet> PacketView::retain() const
+{
+	struct sr_datafeed_packet *copy;
+
+	check(sr_packet_copy(_structure, &copy));
+	return shared_ptr<Packet>{new Packet{_session->get_device(_sdi), copy, true},
+		default_delete<Packet>{}};
+}
+
+shared_ptr<Device> PacketView::device() const
+{
+	return _session->get_device(_sdi);
+}
+
+LogicView::LogicView(const struct sr_datafeed_logic *structure) :
+	_structure(structure)
+{
+}
+
+const void *LogicView::data_pointer() const
+{
+	return _structure->data;
+}
+
+size_t LogicView::data_length() const
+{
+	return _structure->length;
+}
+
+unsigned int LogicView::unit_size() const
+{
+	return _structure->unitsize;
+}
+
+size_t LogicView::num_samples() const
+{
+	return _structure->unitsize ? _structure->length / _structure->unitsize : 0;
+}
+
+AnalogView::AnalogView(const struct sr_datafeed_analog *structure) :
+	_structure(structure)
+{
+}
+
+const void *AnalogView::data_pointer() const
+{
+	return _structure->data;
+}
+
+void AnalogView::get_data_as_float(float *dest) const
+{
+	check(sr_analog_to_float(_structure, dest));
+}
+
+unsigned int AnalogView::num_samples() const
+{
+	return _structure->num_samples;
+}
+
+unsigned int AnalogView::unitsize() const
+{
+	return _structure->encoding->unitsize;
+}
+
+bool AnalogView::is_signed() const
+{
+	return _structure->encoding->is_signed;
+}
+
+bool AnalogView::is_float() const
+{
+	return _structure->encoding->is_float;
+}
+
+bool AnalogView::is_bigendian() const
+{
+	return _structure->encoding->is_bigendian;
+}
+
+int AnalogView::digits() const
+{
+	return _structure->encoding->digits;
+}
+
+float AnalogView::scale() const
+{
+	return _structure->encoding->scale.p /
+		(float)_structure->encoding->scale.q;
+}
+
+float AnalogView::offset() const
+{
+	return _structure->encoding->offset.p /
+		(float)_structure->encoding->offset.q;
+}
+
+unsigned int AnalogView::num_channels() const
+{
+	return g_slist_length(_structure->meaning->channels);
+}
+
+int AnalogView::channel_index(unsigned int n) const
+{
+	auto *const ch = static_cast<struct sr_channel *>(
+		g_slist_nth_data(_structure->meaning->channels, n));
+	if (!ch)
+		throw Error(SR_ERR_ARG);
+	return ch->index;
+}
+
+const Quantity *AnalogView::mq() const
+{
+	return Quantity::get(_structure->meaning->mq);
+}
+
+const Unit *AnalogView::unit() const
+{
+	return Unit::get(_structure->meaning->unit);
+}
+
 PacketPayload::PacketPayload()
 {
 }
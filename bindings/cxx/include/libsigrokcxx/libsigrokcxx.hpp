@@ -110,6 +110,9 @@ class SR_API TriggerMatch;
 class SR_API TriggerMatchType;
 class SR_API ChannelType;
 class SR_API Packet;
+class SR_API PacketView;
+class SR_API LogicView;
+class SR_API AnalogView;
 class SR_API PacketPayload;
 class SR_API PacketType;
 class SR_API Quantity;
@@ -593,6 +596,27 @@ private:
 	friend class Session;
 };
 
+/** Type of lightweight datafeed callback */
+typedef function<void(Device &, const PacketView &)>
+	DatafeedViewCallbackFunction;
+
+/* Data required for C callback function to call a C++ view callback */
+class SR_PRIV DatafeedViewCallbackData
+{
+public:
+	void run(const struct sr_dev_inst *sdi,
+		const struct sr_datafeed_packet *pkt);
+private:
+	DatafeedViewCallbackFunction _callback;
+	DatafeedViewCallbackData(Session *session,
+		DatafeedViewCallbackFunction callback);
+	void reset_device_cache();
+	Session *_session;
+	const struct sr_dev_inst *_last_sdi;
+	Device *_last_device;
+	friend class Session;
+};
+
 /** A virtual device associated with a stored session */
 class SR_API SessionDevice :
 	public ParentOwned<SessionDevice, Session>,
@@ -621,6 +645,14 @@ public:
 	/** Add a datafeed callback to this session.
 	 * @param callback Callback of the form callback(Device, Packet). */
 	void add_datafeed_callback(DatafeedCallbackFunction callback);
+	/** Add a lightweight datafeed callback to this session.
+	 *
+	 * The callback receives non-owning views of the device and packet,
+	 * which are only valid for the duration of the call. No objects are
+	 * allocated on this path; use PacketView::retain() to keep a packet.
+	 *
+	 * @param callback Callback of the form callback(Device, PacketView). */
+	void add_datafeed_view_callback(DatafeedViewCallbackFunction callback);
 	/** Remove all datafeed callbacks from this session. */
 	void remove_datafeed_callbacks();
 	/** Start the session. */
@@ -647,17 +679,21 @@ private:
 	Session(shared_ptr<Context> context, string filename);
 	~Session();
 	shared_ptr<Device> get_device(const struct sr_dev_inst *sdi);
+	Device *lookup_device(const struct sr_dev_inst *sdi);
 	struct sr_session *_structure;
 	const shared_ptr<Context> _context;
 	map<const struct sr_dev_inst *, unique_ptr<SessionDevice> > _owned_devices;
 	map<const struct sr_dev_inst *, shared_ptr<Device> > _other_devices;
 	vector<unique_ptr<DatafeedCallbackData> > _datafeed_callbacks;
+	vector<unique_ptr<DatafeedViewCallbackData> > _datafeed_view_callbacks;
 	SessionStoppedCallback _stopped_callback;
 	string _filename;
 	shared_ptr<Trigger> _trigger;
 
 	friend class Context;
 	friend class DatafeedCallbackData;
+	friend class DatafeedViewCallbackData;
+	friend class PacketView;
 	friend class SessionDevice;
 	friend struct std::default_delete<Session>;
 };
@@ -672,15 +708,18 @@ public:
 	shared_ptr<PacketPayload> payload();
 private:
 	Packet(shared_ptr<Device> device,
-		const struct sr_datafeed_packet *structure);
+		const struct sr_datafeed_packet *structure,
+		bool owned = false);
 	~Packet();
 	const struct sr_datafeed_packet *_structure;
 	shared_ptr<Device> _device;
 	unique_ptr<PacketPayload> _payload;
+	bool _owned;
 
 	friend class Session;
 	friend class Output;
 	friend class DatafeedCallbackData;
+	friend class PacketView;
 	friend class Header;
 	friend class Meta;
 	friend class Logic;
@@ -689,6 +728,96 @@ private:
 	friend struct std::default_delete<Packet>;
 };
 
+/** Non-owning view of a packet, valid only during a view callback */
+class SR_API PacketView
+{
+public:
+	/** Type of this packet. */
+	const PacketType *type() const;
+	/** Logic payload of this packet. Throws if the type differs. */
+	LogicView logic() const;
+	/** Analog payload of this packet. Throws if the type differs. */
+	AnalogView analog() const;
+	/** Copy this packet so that it can be kept beyond the callback. */
+	shared_ptr<Packet> retain() const;
+	/** Shared pointer to the device that sent this packet. */
+	shared_ptr<Device> device() const;
+private:
+	PacketView(Session *session, const struct sr_dev_inst *sdi,
+		const struct sr_datafeed_packet *structure);
+	Session *_session;
+	const struct sr_dev_inst *_sdi;
+	const struct sr_datafeed_packet *_structure;
+
+	friend class DatafeedViewCallbackData;
+};
+
+/** Non-owning view of a logic payload */
+class SR_API LogicView
+{
+public:
+	/** Pointer to data. */
+	const void *data_pointer() const;
+	/** Data length in bytes. */
+	size_t data_length() const;
+	/** Size of each sample in bytes. */
+	unsigned int unit_size() const;
+	/** Number of samples in this payload. */
+	size_t num_samples() const;
+private:
+	explicit LogicView(const struct sr_datafeed_logic *structure);
+	const struct sr_datafeed_logic *_structure;
+
+	friend class PacketView;
+};
+
+/** Non-owning view of an analog payload */
+class SR_API AnalogView
+{
+public:
+	/**
+	 * Pointer to data, in the encoding described below. The samples
+	 * of multiple channels are interleaved, in the order of
+	 * channel_index().
+	 */
+	const void *data_pointer() const;
+	/**
+	 * Fills dest pointer with the analog data converted to float.
+	 * The pointer must have space for num_samples() * num_channels()
+	 * floats.
+	 */
+	void get_data_as_float(float *dest) const;
+	/** Number of samples of each channel in this payload. */
+	unsigned int num_samples() const;
+	/** Size of a single sample in bytes. */
+	unsigned int unitsize() const;
+	/** Samples use a signed data type. */
+	bool is_signed() const;
+	/** Samples use float. */
+	bool is_float() const;
+	/** Samples are stored in big-endian order. */
+	bool is_bigendian() const;
+	/** Number of significant digits, see Analog::digits(). */
+	int digits() const;
+	/** Scale factor applied to raw samples, as a (lossy) value. */
+	float scale() const;
+	/** Offset added to scaled samples, as a (lossy) value. */
+	float offset() const;
+	/** Number of channels for which this payload contains data. */
+	unsigned int num_channels() const;
+	/** Index of the n-th channel for which this payload contains data. */
+	int channel_index(unsigned int n) const;
+	/** Measured quantity of the samples in this payload. */
+	const Quantity *mq() const;
+	/** Unit of the samples in this payload. */
+	const Unit *unit() const;
+private:
+	explicit AnalogView(const struct sr_datafeed_analog *structure);
+	const struct sr_datafeed_analog *_structure;
+
+	friend class PacketView;
+};
+
 /** Abstract base class for datafeed packet payloads */
 class SR_API PacketPayload
 {
@@ -296,6 +296,9 @@ typedef guint pyg_flags_type;
 
 #include "libsigrokcxx/libsigrokcxx.hpp"
 
+#include <algorithm>
+#include <cstring>
+
 /* Convert from a Python dict to a std::map<std::string, std::string> */
 std::map<std::string, std::string> dict_to_map_string(PyObject *dict)
 {
@@ -386,6 +389,482 @@ std::map<std::string, Glib::VariantBase> dict_to_map_options(PyObject *dict,
     return output;
 }
 
+/* Growable sample buffer, handed over to NumPy when a batch is flushed. */
+struct BatchBuffer
+{
+    uint8_t *data = nullptr;
+    size_t length = 0;
+    size_t capacity = 0;
+
+    void reserve(size_t size, size_t hint)
+    {
+        if (length + size > capacity) {
+            capacity = std::max(std::max(capacity * 2, hint), length + size);
+            data = static_cast<uint8_t *>(g_realloc(data, capacity));
+        }
+    }
+
+    void append(const void *src, size_t size, size_t hint)
+    {
+        reserve(size, hint);
+        memcpy(data + length, src, size);
+        length += size;
+    }
+
+    /* Append count items of size bytes, which are stride bytes apart. */
+    void append_strided(const uint8_t *src, size_t count, size_t size,
+        size_t stride, size_t hint)
+    {
+        if (stride == size) {
+            append(src, count * size, hint);
+            return;
+        }
+        reserve(count * size, hint);
+        for (size_t i = 0; i < count; i++)
+            memcpy(data + length + i * size, src + i * stride, size);
+        length += count * size;
+    }
+
+    /* Wrap the buffer in a 1-D or 2-D array that takes ownership of it. */
+    PyObject *release(PyArray_Descr *descr, int nd, npy_intp *dims)
+    {
+        auto array = PyArray_NewFromDescr(&PyArray_Type, descr, nd, dims,
+            nullptr, data, NPY_ARRAY_CARRAY, nullptr);
+        auto base = PyCapsule_New(data, nullptr, [](PyObject *capsule) {
+            g_free(PyCapsule_GetPointer(capsule, nullptr));
+        });
+        PyArray_SetBaseObject(reinterpret_cast<PyArrayObject *>(array), base);
+        data = nullptr;
+        length = capacity = 0;
+        return array;
+    }
+
+    ~BatchBuffer()
+    {
+        g_free(data);
+    }
+};
+
+/* Encoding of the samples of an analog stream. */
+struct AnalogEncoding
+{
+    unsigned int unitsize;
+    bool is_signed;
+    bool is_float;
+    bool is_bigendian;
+    float scale;
+    float offset;
+
+    bool operator==(const AnalogEncoding &other) const
+    {
+        return unitsize == other.unitsize &&
+            is_signed == other.is_signed &&
+            is_float == other.is_float &&
+            is_bigendian == other.is_bigendian &&
+            scale == other.scale && offset == other.offset;
+    }
+
+    bool operator!=(const AnalogEncoding &other) const
+    {
+        return !(*this == other);
+    }
+
+    /* NumPy type of the samples, NPY_NOTYPE if there is no such type. */
+    int typenum() const
+    {
+        if (is_float) {
+            if (unitsize == 4)
+                return NPY_FLOAT32;
+            if (unitsize == 8)
+                return NPY_FLOAT64;
+            return NPY_NOTYPE;
+        }
+
+        switch (unitsize) {
+        case 1:
+            return is_signed ? NPY_INT8 : NPY_UINT8;
+        case 2:
+            return is_signed ? NPY_INT16 : NPY_UINT16;
+        case 4:
+            return is_signed ? NPY_INT32 : NPY_UINT32;
+        case 8:
+            return is_signed ? NPY_INT64 : NPY_UINT64;
+        default:
+            return NPY_NOTYPE;
+        }
+    }
+
+    PyArray_Descr *descr() const
+    {
+        auto result = PyArray_DescrFromType(typenum());
+#ifdef WORDS_BIGENDIAN
+        if (!is_bigendian && unitsize > 1) {
+#else
+        if (is_bigendian && unitsize > 1) {
+#endif
+            auto swapped = PyArray_DescrNewByteorder(result, NPY_SWAP);
+            Py_DECREF(result);
+            result = swapped;
+        }
+        return result;
+    }
+};
+
+/*
+ * Accumulates datafeed packets for a batched Python datafeed callback.
+ *
+ * Packets are received through the C++ view callback, so collecting a
+ * batch needs neither the GIL nor any per-packet Python objects. Samples
+ * are copied once into per-stream buffers, which are then passed to
+ * Python as NumPy arrays without further copies.
+ */
+class DatafeedBatcher
+{
+public:
+    DatafeedBatcher(PyObject *callback, size_t max_bytes,
+            unsigned int max_packets) :
+        _callback(callback), _max_bytes(max_bytes),
+        _max_packets(max_packets), _num_packets(0), _num_bytes(0),
+        _unit_size(0), _num_triggers(0), _end(false)
+    {
+        Py_XINCREF(_callback);
+    }
+
+    ~DatafeedBatcher()
+    {
+        auto gstate = PyGILState_Ensure();
+        Py_XDECREF(_callback);
+        PyGILState_Release(gstate);
+    }
+
+    void run(sigrok::Device &device, const sigrok::PacketView &packet)
+    {
+        const auto type = packet.type();
+
+        if (_device && _device.get() != &device)
+            flush();
+
+        if (type == sigrok::PacketType::LOGIC) {
+            const auto logic = packet.logic();
+            if (!_device)
+                _device = packet.device();
+            add_logic(logic.data_pointer(), logic.data_length(),
+                logic.unit_size());
+        } else if (type == sigrok::PacketType::ANALOG) {
+            const auto analog = packet.analog();
+            const AnalogEncoding encoding = {
+                analog.unitsize(), analog.is_signed(), analog.is_float(),
+                analog.is_bigendian(), analog.scale(), analog.offset()
+            };
+            if (!_device)
+                _device = packet.device();
+            add_analog(encoding, analog.num_channels(),
+                [&analog] (unsigned int i) { return analog.channel_index(i); },
+                analog.data_pointer(), analog.num_samples());
+        } else if (type == sigrok::PacketType::TRIGGER) {
+            add_trigger();
+        } else if (type == sigrok::PacketType::END) {
+            if (!_device)
+                _device = packet.device();
+            _end = true;
+            flush();
+        } else if (type == sigrok::PacketType::FRAME_BEGIN ||
+                type == sigrok::PacketType::FRAME_END) {
+            /* Keep batches from spanning frame boundaries. */
+            flush();
+        }
+
+        check_limits();
+    }
+
+    /*
+     * Run packets given as Python tuples through a batcher, so that the
+     * batching can be tested without a device. The packets are
+     * ("logic", data, unit_size), ("analog", channel_indices, data,
+     * num_samples, unitsize, is_signed, is_float, is_bigendian),
+     * ("trigger",), ("frame",) and ("end",).
+     */
+    static void run_script(PyObject *callback, size_t max_bytes,
+        unsigned int max_packets, std::shared_ptr<sigrok::Device> device,
+        PyObject *packets)
+    {
+        auto gstate = PyGILState_Ensure();
+        bool ok;
+
+        {
+            DatafeedBatcher batcher(callback, max_bytes, max_packets);
+            auto iter = PyObject_GetIter(packets);
+            PyObject *item;
+
+            ok = iter != nullptr;
+            while (ok && (item = PyIter_Next(iter))) {
+                ok = batcher.run_script_packet(device, item);
+                Py_DECREF(item);
+            }
+            Py_XDECREF(iter);
+            if (!ok)
+                PyErr_Clear();
+        }
+
+        PyGILState_Release(gstate);
+
+        if (!ok)
+            throw sigrok::Error(SR_ERR_ARG);
+    }
+
+private:
+    struct AnalogStream
+    {
+        BatchBuffer buffer;
+        AnalogEncoding encoding = {};
+        std::vector<size_t> triggers;
+
+        size_t num_samples() const
+        {
+            return encoding.unitsize ? buffer.length / encoding.unitsize : 0;
+        }
+    };
+
+    bool run_script_packet(std::shared_ptr<sigrok::Device> &device,
+        PyObject *item)
+    {
+        const char *type;
+        PyObject *data, *channels;
+        char *bytes;
+        Py_ssize_t length;
+        unsigned int unit_size, num_samples;
+        int is_signed, is_float, is_bigendian;
+
+        if (!PyTuple_Check(item) || !PyTuple_Size(item) ||
+                !string_check(PyTuple_GetItem(item, 0)))
+            return false;
+        type = string_from_python(PyTuple_GetItem(item, 0));
+
+        if (!strcmp(type, "logic")) {
+            if (!PyArg_ParseTuple(item, "sOI", &type, &data, &unit_size) ||
+                    PyBytes_AsStringAndSize(data, &bytes, &length) < 0)
+                return false;
+            if (!_device)
+                _device = device;
+            add_logic(bytes, length, unit_size);
+        } else if (!strcmp(type, "analog")) {
+            if (!PyArg_ParseTuple(item, "sOOIIiii", &type, &channels,
+                    &data, &num_samples, &unit_size, &is_signed,
+                    &is_float, &is_bigendian) ||
+                    !PyList_Check(channels) ||
+                    PyBytes_AsStringAndSize(data, &bytes, &length) < 0 ||
+                    (size_t)length < (size_t)num_samples * unit_size *
+                    PyList_Size(channels))
+                return false;
+            const AnalogEncoding encoding = {
+                unit_size, !!is_signed, !!is_float, !!is_bigendian, 1, 0
+            };
+            if (!_device)
+                _device = device;
+            add_analog(encoding, PyList_Size(channels),
+                [channels] (unsigned int i) {
+                    return (int)PyLong_AsLong(PyList_GetItem(channels, i));
+                }, bytes, num_samples);
+        } else if (!strcmp(type, "trigger")) {
+            add_trigger();
+        } else if (!strcmp(type, "frame")) {
+            flush();
+        } else if (!strcmp(type, "end")) {
+            if (!_device)
+                _device = device;
+            _end = true;
+            flush();
+        } else {
+            return false;
+        }
+
+        check_limits();
+
+        return true;
+    }
+
+    void add_logic(const void *data, size_t length, unsigned int unit_size)
+    {
+        if (_logic.length && unit_size != _unit_size)
+            restart();
+        _unit_size = unit_size;
+        _logic.append(data, length, _max_bytes);
+        _num_bytes += length;
+        _num_packets++;
+    }
+
+    /*
+     * Samples of multi-channel payloads are interleaved, num_samples
+     * is the number of samples of each channel.
+     */
+    template <typename ChannelIndex>
+    void add_analog(const AnalogEncoding &encoding, unsigned int num_channels,
+        ChannelIndex channel_index, const void *data, size_t num_samples)
+    {
+        auto src = static_cast<const uint8_t *>(data);
+        const size_t size = num_samples * encoding.unitsize;
+
+        if (encoding.typenum() == NPY_NOTYPE) {
+            warn_encoding(encoding);
+            return;
+        }
+
+        for (unsigned int i = 0; i < num_channels; i++) {
+            auto it = _analog.find(channel_index(i));
+            if (it != _analog.end() && it->second.encoding != encoding) {
+                restart();
+                break;
+            }
+        }
+
+        for (unsigned int i = 0; i < num_channels; i++) {
+            auto &stream = analog_stream(channel_index(i));
+            stream.encoding = encoding;
+            stream.buffer.append_strided(src + i * encoding.unitsize,
+                num_samples, encoding.unitsize,
+                num_channels * encoding.unitsize, _max_bytes);
+            _num_bytes += size;
+        }
+        _num_packets++;
+    }
+
+    /* Triggers of this batch before the first sample of a stream are at 0. */
+    AnalogStream &analog_stream(int index)
+    {
+        auto it = _analog.find(index);
+        if (it != _analog.end())
+            return it->second;
+
+        auto &stream = _analog[index];
+        stream.triggers.assign(_num_triggers, 0);
+        return stream;
+    }
+
+    void add_trigger()
+    {
+        _logic_triggers.push_back(_unit_size ? _logic.length / _unit_size : 0);
+        for (auto &entry : _analog)
+            entry.second.triggers.push_back(entry.second.num_samples());
+        _num_triggers++;
+    }
+
+    static void warn_encoding(const AnalogEncoding &encoding)
+    {
+        char msg[96];
+
+        snprintf(msg, sizeof(msg), "Dropping analog samples, there is "
+            "no NumPy type for %u byte %s.", encoding.unitsize,
+            encoding.is_float ? "floats" : "integers");
+
+        auto gstate = PyGILState_Ensure();
+        if (PyErr_WarnEx(PyExc_RuntimeWarning, msg, 1) < 0)
+            PyErr_Print();
+        PyGILState_Release(gstate);
+    }
+
+    static PyObject *index_list(const std::vector<size_t> &indices)
+    {
+        auto list = PyList_New(indices.size());
+        for (size_t i = 0; i < indices.size(); i++)
+            PyList_SET_ITEM(list, i, PyLong_FromSize_t(indices[i]));
+        return list;
+    }
+
+    void check_limits()
+    {
+        if (_num_bytes >= _max_bytes || _num_packets >= _max_packets)
+            flush();
+    }
+
+    /* Flush, but keep the device for the packet being added. */
+    void restart()
+    {
+        auto device = _device;
+        flush();
+        _device = device;
+    }
+
+    void flush()
+    {
+        if (!_device)
+            return;
+
+        auto gstate = PyGILState_Ensure();
+
+        auto device_obj = SWIG_NewPointerObj(
+            SWIG_as_voidptr(new std::shared_ptr<sigrok::Device>(_device)),
+            SWIGTYPE_p_std__shared_ptrT_sigrok__Device_t, SWIG_POINTER_OWN);
+
+        PyObject *logic_obj;
+        if (_logic.length) {
+            npy_intp dims[2];
+            dims[0] = _logic.length / _unit_size;
+            dims[1] = _unit_size;
+            logic_obj = _logic.release(PyArray_DescrFromType(NPY_UINT8),
+                2, dims);
+        } else {
+            Py_INCREF(Py_None);
+            logic_obj = Py_None;
+        }
+
+        auto analog_obj = PyDict_New();
+        for (auto &entry : _analog) {
+            auto &stream = entry.second;
+            npy_intp dims[1];
+            dims[0] = stream.num_samples();
+            auto raw = stream.buffer.release(stream.encoding.descr(), 1, dims);
+            auto key = PyLong_FromLong(entry.first);
+            auto value = Py_BuildValue("(NddN)", raw,
+                (double)stream.encoding.scale, (double)stream.encoding.offset,
+                index_list(stream.triggers));
+            PyDict_SetItem(analog_obj, key, value);
+            Py_DECREF(key);
+            Py_DECREF(value);
+        }
+
+        auto arglist = Py_BuildValue("(NNNNO)", device_obj, logic_obj,
+            index_list(_logic_triggers), analog_obj,
+            _end ? Py_True : Py_False);
+
+        auto result = PyEval_CallObject(_callback, arglist);
+
+        Py_XDECREF(arglist);
+
+        if (PyErr_Occurred())
+            PyErr_Print();
+        else if (result != Py_None) {
+            PyErr_SetString(PyExc_TypeError,
+                "Datafeed batch callback did not return None");
+            PyErr_Print();
+        }
+
+        Py_XDECREF(result);
+
+        PyGILState_Release(gstate);
+
+        _device.reset();
+        _analog.clear();
+        _logic_triggers.clear();
+        _num_triggers = 0;
+        _num_packets = 0;
+        _num_bytes = 0;
+        _end = false;
+    }
+
+    PyObject *_callback;
+    size_t _max_bytes;
+    unsigned int _max_packets;
+    unsigned int _num_packets;
+    size_t _num_bytes;
+    std::shared_ptr<sigrok::Device> _device;
+    BatchBuffer _logic;
+    unsigned int _unit_size;
+    std::vector<size_t> _logic_triggers;
+    /* Triggers in this batch, for analog streams which start later. */
+    size_t _num_triggers;
+    std::map<int, AnalogStream> _analog;
+    bool _end;
+};
 %}
 
 /* Ignore these methods, we will override them below. */
@@ -448,6 +927,22 @@ std::map<std::string, Glib::VariantBase> dict_to_map_options(PyObject *dict,
 }
 %enddef
 
+/*
+ * Release the GIL while the session runs. All callbacks re-acquire it,
+ * and batched datafeed callbacks only need it when a batch is handed over.
+ */
+%exception sigrok::Session::run {
+    auto thread_state = PyEval_SaveThread();
+    try {
+        $action
+    } catch (sigrok::Error &e) {
+        PyEval_RestoreThread(thread_state);
+        SWIG_exception(swig_exception_code(e.result),
+            const_cast<char*>(e.what()));
+    }
+    PyEval_RestoreThread(thread_state);
+}
+
 %include "../../../swig/classes.i"
 
 /* Support Driver.scan() with keyword arguments. */
@@ -529,6 +1024,97 @@ std::map<std::string, Glib::VariantBase> dict_to_map_options(PyObject *dict,
     }
 }
 
+/* Drive a datafeed batcher with scripted packets, for the tests. */
+%inline %{
+void _datafeed_batch_script(PyObject *callback, size_t max_bytes,
+    unsigned int max_packets, std::shared_ptr<sigrok::Device> device,
+    PyObject *packets)
+{
+    DatafeedBatcher::run_script(callback, max_bytes, max_packets,
+        device, packets);
+}
+%}
+
+/* Support Session.add_datafeed_batch_callback(). */
+%extend sigrok::Session
+{
+    void _add_datafeed_batch_callback(PyObject *callback,
+        size_t max_bytes, unsigned int max_packets)
+    {
+        if (!PyCallable_Check(callback))
+            throw sigrok::Error(SR_ERR_ARG);
+
+        auto batcher = std::make_shared<DatafeedBatcher>(callback,
+            max_bytes, max_packets);
+
+        $self->add_datafeed_view_callback(
+            [batcher] (sigrok::Device &device,
+                    const sigrok::PacketView &packet) {
+                batcher->run(device, packet);
+            });
+    }
+}
+
+%pythoncode
+{
+    import numpy as _numpy
+
+    class AnalogBatch(object):
+        """Samples of one analog channel from a datafeed batch.
+
+        The raw attribute is a NumPy view of the samples in the encoding
+        they were sent in. Physical values are raw * scale + offset."""
+
+        def __init__(self, channel, raw, scale, offset, triggers):
+            self.channel = channel
+            self.raw = raw
+            self.scale = scale
+            self.offset = offset
+            self.triggers = triggers
+
+        def to_float(self, out=None):
+            """Convert the samples to float32.
+
+            If out is given, it must be a float32 array with room for at
+            least len(raw) items; it is filled and a view of it returned."""
+            if out is None:
+                out = _numpy.empty(len(self.raw), dtype=_numpy.float32)
+            else:
+                out = out[:len(self.raw)]
+            _numpy.multiply(self.raw, self.scale, out=out, casting='unsafe')
+            if self.offset:
+                _numpy.add(out, self.offset, out=out)
+            return out
+
+    class DatafeedBatch(object):
+        """Samples from consecutive datafeed packets of one device.
+
+        logic is a (samples, unit_size) uint8 array or None, analog maps
+        channel names to AnalogBatch objects. Trigger positions are given
+        as sample offsets into the respective stream, a trigger before the
+        first sample of a stream in this batch is at offset 0. end is True
+        if the batch was terminated by the end of the datafeed."""
+
+        def __init__(self, logic, logic_triggers, analog, end):
+            self.logic = logic
+            self.logic_triggers = logic_triggers
+            self.analog = analog
+            self.end = end
+
+    def _Session_add_datafeed_batch_callback(self, callback,
+            max_bytes=1 << 20, max_packets=256):
+        def deliver(device, logic, logic_triggers, analog, end):
+            names = dict((ch.index, ch.name) for ch in device.channels)
+            streams = {}
+            for index, (raw, scale, offset, triggers) in analog.items():
+                name = names.get(index, str(index))
+                streams[name] = AnalogBatch(name, raw, scale, offset, triggers)
+            callback(device, DatafeedBatch(logic, logic_triggers, streams, end))
+        self._add_datafeed_batch_callback(deliver, max_bytes, max_packets)
+
+    Session.add_datafeed_batch_callback = _Session_add_datafeed_batch_callback
+}
+
 /* Return NumPy array from Analog::data(). */
 %extend sigrok::Analog
 {
@@ -0,0 +1,113 @@
+##
+## This file is part of the libsigrok project.
+##
+## Copyright (C) 2026 agent <agent@local>
+##
+## This program is free software: you can redistribute it and/or modify
+## it under the terms of the GNU General Public License as published by
+## the Free Software Foundation, either version 3 of the License, or
+## (at your option) any later version.
+##
+## This program is distributed in the hope that it will be useful,
+## but WITHOUT ANY WARRANTY; without even the implied warranty of
+## MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+## GNU General Public License for more details.
+##
+## You should have received a copy of the GNU General Public License
+## along with this program.  If not, see <http://www.gnu.org/licenses/>.
+##
+
+import unittest
+import warnings
+import numpy
+from sigrok.core.classes import Context, _datafeed_batch_script
+
+def analog(channels, samples, dtype='<i2'):
+    """An analog packet with interleaved samples of the given channels."""
+    data = numpy.array(samples, dtype=numpy.dtype(dtype))
+    return ('analog', channels, data.tobytes(), len(samples) // len(channels),
+        data.itemsize, data.dtype.kind == 'i', data.dtype.kind == 'f',
+        data.dtype.byteorder == '>')
+
+class DatafeedBatchTest(unittest.TestCase):
+
+    def setUp(self):
+        self.context = Context.create()
+        self.device = self.context.create_user_device('Test', 'Batch', '1')
+
+    def run_script(self, packets, max_bytes=1 << 20, max_packets=256):
+        batches = []
+        def callback(device, logic, logic_triggers, analog, end):
+            batches.append((logic, logic_triggers, analog, end))
+        _datafeed_batch_script(callback, max_bytes, max_packets, self.device,
+            packets)
+        return batches
+
+    def test_trigger_after_flush(self):
+        batches = self.run_script([
+            analog([0], [1, 2, 3]),
+            ('trigger',),
+            analog([0], [4, 5]),
+            ('end',),
+        ], max_packets=1)
+        self.assertEqual(len(batches), 3)
+        self.assertEqual(batches[0][2][0][3], [])
+        self.assertEqual(list(batches[1][2][0][0]), [4, 5])
+        self.assertEqual(batches[1][2][0][3], [0])
+        self.assertEqual(batches[1][1], [0])
+        self.assertTrue(batches[2][3])
+
+    def test_trigger_before_first_sample(self):
+        batches = self.run_script([
+            ('logic', b'\x01\x02', 1),
+            analog([0], [1, 2]),
+            ('trigger',),
+            analog([1], [7]),
+            analog([0], [3]),
+            ('end',),
+        ])
+        self.assertEqual(len(batches), 1)
+        logic, logic_triggers, streams, end = batches[0]
+        self.assertEqual(logic_triggers, [2])
+        self.assertEqual(streams[0][3], [2])
+        self.assertEqual(streams[1][3], [0])
+        self.assertTrue(end)
+
+    def test_interleaved_channels(self):
+        batches = self.run_script([
+            analog([2, 0], [10, 0, 11, 1, 12, 2]),
+            analog([2, 0], [13, 3]),
+            ('end',),
+        ])
+        streams = batches[0][2]
+        self.assertEqual(list(streams[0][0]), [0, 1, 2, 3])
+        self.assertEqual(list(streams[2][0]), [10, 11, 12, 13])
+
+    def test_encodings(self):
+        for dtype in ('<i1', '<u2', '>i2', '<i4', '>u4', '<i8', '<f4', '>f8'):
+            batches = self.run_script([
+                analog([0], [1, 2, 3], dtype),
+                ('end',),
+            ])
+            raw = batches[0][2][0][0]
+            self.assertEqual(raw.dtype, numpy.dtype(dtype))
+            self.assertEqual(list(raw), [1, 2, 3])
+
+    def test_unsupported_encoding(self):
+        for unitsize, is_float in ((3, False), (2, True), (16, True)):
+            packet = ('analog', [0], bytes(2 * unitsize), 2, unitsize,
+                True, is_float, False)
+            with warnings.catch_warnings(record=True) as caught:
+                warnings.simplefilter('always')
+                batches = self.run_script([packet, ('end',)])
+            self.assertEqual(len(caught), 1)
+            self.assertTrue(issubclass(caught[0].category, RuntimeWarning))
+            self.assertEqual(batches[0][2], {})
+
+    def test_short_data(self):
+        with self.assertRaises(Exception):
+            self.run_script([('analog', [0, 1], bytes(6), 2, 2,
+                True, False, False)])
+
+if __name__ == '__main__':
+    unittest.main()
@@ -81,6 +81,13 @@ template< class T > class enable_shared_from_this;
 
 %ignore sigrok::DatafeedCallbackData;
 
+/* The view-based datafeed API is for C++ consumers only. */
+%ignore sigrok::DatafeedViewCallbackData;
+%ignore sigrok::Session::add_datafeed_view_callback;
+%ignore sigrok::PacketView;
+%ignore sigrok::LogicView;
+%ignore sigrok::AnalogView;
+
 #ifndef SWIGJAVA
 
 #define SWIG_ATTRIBUTE_TEMPLATE
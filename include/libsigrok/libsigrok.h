@@ -168,6 +168,8 @@ enum sr_packettype {
 	SR_DF_FRAME_END,
 	/** Payload is struct sr_datafeed_analog. */
 	SR_DF_ANALOG,
+	/** Payload is struct sr_datafeed_logic_rle. */
+	SR_DF_LOGIC_RLE,
 
 	/* Update datafeed_dump() (session.c) upon changes! */
 };
@@ -496,6 +498,26 @@ struct sr_datafeed_logic {
 	void *data;
 };
 
+/** Run-length encoded logic datafeed payload for type SR_DF_LOGIC_RLE. */
+struct sr_datafeed_logic_rle {
+	/** Number of runs. */
+	uint64_t num_runs;
+	/** Size of a single sample, in bytes. */
+	uint16_t unitsize;
+	/** One sample value per run, num_runs * unitsize bytes. */
+	void *data;
+	/** Number of samples in each run, num_runs entries. */
+	uint64_t *lengths;
+};
+
+/** Position within a struct sr_datafeed_logic_rle, see sr_logic_rle_expand(). */
+struct sr_logic_rle_pos {
+	/** Index of the current run. */
+	uint64_t run;
+	/** Number of samples of the current run which were already expanded. */
+	uint64_t offset;
+};
+
 /** Analog datafeed payload for type SR_DF_ANALOG. */
 struct sr_datafeed_analog {
 	void *data;
@@ -575,6 +597,8 @@ struct sr_resource {
 enum sr_output_flag {
 	/** If set, this output module writes the output itself. */
 	SR_OUTPUT_INTERNAL_IO_HANDLING = 0x01,
+	/** If set, this output module handles SR_DF_LOGIC_RLE packets. */
+	SR_OUTPUT_LOGIC_RLE = 0x02,
 };
 
 struct sr_input;
@@ -1031,6 +1055,19 @@ enum sr_configkey {
 	/** Number of powerline cycles for ADC integration time. */
 	SR_CONF_ADC_POWERLINE_CYCLES,
 
+	/**
+	 * The host is at risk of not keeping up with the data stream of
+	 * a running acquisition, so samples may be lost.
+	 */
+	SR_CONF_OVERFLOW_RISK,
+
+	/**
+	 * Replay mode of session files: "freewheel" (default), "realtime"
+	 * (paced at the original samplerate) or "max-speed" (read ahead
+	 * in a separate thread).
+	 */
+	SR_CONF_SESSION_REPLAY,
+
 	/* Update sr_key_info_config[] (hwdriver.c) upon changes! */
 
 	/*--- Acquisition modes, sample limiting ----------------------------*/
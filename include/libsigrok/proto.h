@@ -35,6 +35,7 @@ SR_API gboolean sr_analog_si_prefix_friendly(enum sr_unit unit);
 SR_API int sr_analog_unit_to_string(const struct sr_datafeed_analog *analog,
 		char **result);
 SR_API void sr_rational_set(struct sr_rational *r, int64_t p, uint64_t q);
+SR_API int sr_rational_from_double(struct sr_rational *r, double value);
 SR_API int sr_rational_eq(const struct sr_rational *a, const struct sr_rational *b);
 SR_API int sr_rational_mult(struct sr_rational *res, const struct sr_rational *a,
 		const struct sr_rational *b);
@@ -58,6 +59,16 @@ SR_API int sr_a2l_schmitt_trigger(const struct sr_datafeed_analog *analog,
 		float lo_thr, float hi_thr, uint8_t *state, uint8_t *output,
 		uint64_t count);
 
+/*--- logic.c ---------------------------------------------------------------*/
+
+SR_API uint64_t sr_logic_rle_num_samples(const struct sr_datafeed_logic_rle *rle);
+SR_API uint64_t sr_logic_rle_expand(const struct sr_datafeed_logic_rle *rle,
+		struct sr_logic_rle_pos *pos, void *buf, uint64_t max_samples);
+SR_API int sr_logic_transpose16(uint16_t *dst, const uint8_t *src,
+		size_t num_blocks, unsigned int num_planes,
+		unsigned int plane_bytes, const uint16_t *masks,
+		gboolean msb_first);
+
 /*--- log.c -----------------------------------------------------------------*/
 
 typedef int (*sr_log_callback)(void *cb_data, int loglevel,
@@ -68,6 +79,8 @@ SR_API int sr_log_loglevel_get(void);
 SR_API int sr_log_callback_set(sr_log_callback cb, void *cb_data);
 SR_API int sr_log_callback_set_default(void);
 SR_API int sr_log_callback_get(sr_log_callback *cb, void **cb_data);
+SR_API int sr_log_async_start(size_t num_entries);
+SR_API int sr_log_async_stop(void);
 
 /*--- device.c --------------------------------------------------------------*/
 
@@ -145,6 +158,8 @@ SR_API int sr_session_trigger_set(struct sr_session *session, struct sr_trigger
 SR_API int sr_session_datafeed_callback_remove_all(struct sr_session *session);
 SR_API int sr_session_datafeed_callback_add(struct sr_session *session,
 		sr_datafeed_callback cb, void *cb_data);
+SR_API int sr_session_logic_rle_set(struct sr_session *session,
+		gboolean enable);
 
 /* Session control */
 SR_API int sr_session_start(struct sr_session *session);
@@ -176,6 +191,8 @@ SR_API int sr_input_scan_file(const char *filename, const struct sr_input **in);
 SR_API const struct sr_input_module *sr_input_module_get(const struct sr_input *in);
 SR_API struct sr_dev_inst *sr_input_dev_inst_get(const struct sr_input *in);
 SR_API int sr_input_send(const struct sr_input *in, GString *buf);
+SR_API int sr_input_map_file(const struct sr_input *in, const char *filename);
+SR_API int sr_input_send_mapped(const struct sr_input *in, gboolean *done);
 SR_API int sr_input_end(const struct sr_input *in);
 SR_API int sr_input_reset(const struct sr_input *in);
 SR_API void sr_input_free(const struct sr_input *in);
@@ -432,6 +432,48 @@ SR_API void sr_rational_set(struct sr_rational *r, int64_t p, uint64_t q)
 	r->q = q;
 }
 
+/**
+ * Set sr_rational r to (an approximation of) a floating point value.
+ *
+ * The denominator is a power of ten, chosen so that about twelve
+ * significant digits of the value are kept, and trailing zeros get
+ * reduced. This is meant for drivers which derive encoding scale and
+ * offset factors from floating point values reported by the device.
+ *
+ * @param[out] r Rational number struct to set. Must not be NULL.
+ * @param[in] value The value to represent.
+ *
+ * @retval SR_OK Success.
+ * @retval SR_ERR_ARG Invalid argument, non-finite or too large value.
+ *
+ * @since 0.6.0
+ */
+SR_API int sr_rational_from_double(struct sr_rational *r, double value)
+{
+	int64_t p;
+	uint64_t q;
+
+	if (!r || !isfinite(value))
+		return SR_ERR_ARG;
+	if (fabs(value) >= 9e18)
+		return SR_ERR_ARG;
+
+	q = 1;
+	while (value != 0 && q < UINT64_C(1000000000000000) &&
+			fabs(value) * q < 1e11)
+		q *= 10;
+	p = llround(value * q);
+	while (q > 1 && p % 10 == 0) {
+		p /= 10;
+		q /= 10;
+	}
+
+	r->p = p;
+	r->q = q;
+
+	return SR_OK;
+}
+
 #ifndef HAVE___INT128_T
 struct sr_int128_t {
 	int64_t high;
@@ -0,0 +1,206 @@
+/*
+ * This file is part of the libsigrok project.
+ *
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file
+ * Batching of single readings into multi-sample analog packets
+ * @internal
+ */
+
+#include <config.h>
+#include <string.h>
+#include <glib.h>
+#include <libsigrok/libsigrok.h>
+#include "libsigrok-internal.h"
+
+#define LOG_PREFIX "analog_batch"
+
+struct sr_analog_batch {
+	const struct sr_dev_inst *sdi;
+	GSList *channels;
+	size_t capacity;
+	int64_t max_latency_us;
+	float *values;
+	size_t count;
+	int64_t first_at;
+	struct sr_analog_encoding encoding;
+	struct sr_analog_meaning meaning;
+	struct sr_analog_spec spec;
+};
+
+/**
+ * Create a batch which collects the readings of one analog channel.
+ *
+ * Readings get sent as one SR_DF_ANALOG packet once @p capacity of them
+ * were collected, or when the oldest pending reading is older than
+ * @p max_latency_ms. A capacity of 1 sends every reading immediately.
+ *
+ * @param sdi The device instance to send packets for.
+ * @param ch The channel the readings belong to.
+ * @param capacity Maximum number of samples per packet.
+ * @param max_latency_ms Maximum age of a pending reading, 0 for none.
+ *
+ * @return The new batch, NULL on invalid arguments.
+ */
+SR_PRIV struct sr_analog_batch *sr_analog_batch_new(
+	const struct sr_dev_inst *sdi, struct sr_channel *ch,
+	size_t capacity, uint64_t max_latency_ms)
+{
+	struct sr_analog_batch *batch;
+
+	if (!sdi || !ch || !capacity)
+		return NULL;
+
+	batch = g_malloc0(sizeof(*batch));
+	batch->sdi = sdi;
+	batch->channels = g_slist_append(NULL, ch);
+	batch->capacity = capacity;
+	batch->max_latency_us = max_latency_ms * 1000;
+	batch->values = g_malloc(capacity * sizeof(*batch->values));
+
+	return batch;
+}
+
+/**
+ * Free a batch. Pending readings are discarded, see sr_analog_batch_flush().
+ *
+ * @param batch The batch to free, may be NULL.
+ */
+SR_PRIV void sr_analog_batch_free(struct sr_analog_batch *batch)
+{
+	if (!batch)
+		return;
+
+	if (batch->count)
+		sr_dbg("Discarding %zu pending readings.", batch->count);
+	g_slist_free(batch->channels);
+	g_free(batch->values);
+	g_free(batch);
+}
+
+/**
+ * Send all pending readings of a batch as one packet.
+ *
+ * @param batch The batch to flush.
+ *
+ * @return SR_OK upon success, or an error code from sr_session_send().
+ */
+SR_PRIV int sr_analog_batch_flush(struct sr_analog_batch *batch)
+{
+	struct sr_datafeed_packet packet;
+	struct sr_datafeed_analog analog;
+	int ret;
+
+	if (!batch || !batch->count)
+		return SR_OK;
+
+	memset(&analog, 0, sizeof(analog));
+	analog.data = batch->values;
+	analog.num_samples = batch->count;
+	analog.encoding = &batch->encoding;
+	analog.meaning = &batch->meaning;
+	analog.spec = &batch->spec;
+	packet.type = SR_DF_ANALOG;
+	packet.payload = &analog;
+	ret = sr_session_send(batch->sdi, &packet);
+	batch->count = 0;
+
+	return ret;
+}
+
+/**
+ * Flush a batch if its oldest pending reading exceeds the latency bound.
+ *
+ * Call this from the driver's receive callback also when no new data
+ * arrived, so that slow instruments don't hold back readings.
+ *
+ * @param batch The batch to check.
+ *
+ * @return SR_OK upon success, or an error code from sr_session_send().
+ */
+SR_PRIV int sr_analog_batch_poll(struct sr_analog_batch *batch)
+{
+	if (!batch || !batch->count || !batch->max_latency_us)
+		return SR_OK;
+
+	if (g_get_monotonic_time() - batch->first_at < batch->max_latency_us)
+		return SR_OK;
+
+	return sr_analog_batch_flush(batch);
+}
+
+static gboolean same_format(const struct sr_analog_batch *batch,
+	const struct sr_datafeed_analog *analog)
+{
+	const struct sr_analog_meaning *m;
+	const struct sr_analog_encoding *e;
+
+	m = analog->meaning;
+	e = analog->encoding;
+
+	return m->mq == batch->meaning.mq && m->unit == batch->meaning.unit &&
+		m->mqflags == batch->meaning.mqflags &&
+		e->digits == batch->encoding.digits &&
+		e->is_digits_decimal == batch->encoding.is_digits_decimal &&
+		analog->spec->spec_digits == batch->spec.spec_digits;
+}
+
+/**
+ * Add a reading to a batch.
+ *
+ * The meaning and digits of @p analog describe @p value, the data and
+ * channels of @p analog are ignored. A reading with a different meaning
+ * than the pending ones flushes them first, so that every packet keeps
+ * a single quantity, unit and set of flags.
+ *
+ * @param batch The batch to add to.
+ * @param analog The parsed reading, as filled in by a DMM/LCR parser.
+ * @param value The value of the reading.
+ *
+ * @return SR_OK upon success, SR_ERR_ARG for invalid arguments, or an
+ *         error code from sr_session_send().
+ */
+SR_PRIV int sr_analog_batch_add(struct sr_analog_batch *batch,
+	const struct sr_datafeed_analog *analog, float value)
+{
+	int ret;
+
+	if (!batch || !analog || !analog->meaning || !analog->encoding ||
+			!analog->spec)
+		return SR_ERR_ARG;
+
+	if (batch->count && !same_format(batch, analog)) {
+		if ((ret = sr_analog_batch_flush(batch)) != SR_OK)
+			return ret;
+	}
+
+	if (!batch->count) {
+		batch->encoding = *analog->encoding;
+		batch->meaning = *analog->meaning;
+		batch->meaning.channels = batch->channels;
+		batch->spec = *analog->spec;
+		batch->first_at = g_get_monotonic_time();
+	}
+	batch->values[batch->count++] = value;
+
+	if (batch->count == batch->capacity)
+		return sr_analog_batch_flush(batch);
+
+	return sr_analog_batch_poll(batch);
+}
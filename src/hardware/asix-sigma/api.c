@@ -40,6 +40,7 @@ static const uint32_t devopts[] = {
 	SR_CONF_LIMIT_MSEC | SR_CONF_GET | SR_CONF_SET,
 	SR_CONF_LIMIT_SAMPLES | SR_CONF_GET | SR_CONF_SET,
 	SR_CONF_SAMPLERATE | SR_CONF_GET | SR_CONF_SET | SR_CONF_LIST,
+	SR_CONF_CONTINUOUS | SR_CONF_GET | SR_CONF_SET,
 #if ASIX_SIGMA_WITH_TRIGGER
 	SR_CONF_TRIGGER_MATCH | SR_CONF_LIST,
 	SR_CONF_CAPTURE_RATIO | SR_CONF_GET | SR_CONF_SET,
@@ -109,6 +110,7 @@ static GSList *scan(struct sr_dev_driver *di, GSList *options)
 	devc->samples_per_event = 0;
 	devc->capture_ratio = 50;
 	devc->use_triggers = 0;
+	devc->continuous = FALSE;
 
 	sdi = g_malloc0(sizeof(struct sr_dev_inst));
 	sdi->status = SR_ST_INITIALIZING;
@@ -177,6 +179,9 @@ static int config_get(uint32_t key, GVariant **data,
 	case SR_CONF_LIMIT_SAMPLES:
 		*data = g_variant_new_uint64(devc->limit_samples);
 		break;
+	case SR_CONF_CONTINUOUS:
+		*data = g_variant_new_boolean(devc->continuous);
+		break;
 #if ASIX_SIGMA_WITH_TRIGGER
 	case SR_CONF_CAPTURE_RATIO:
 		*data = g_variant_new_uint64(devc->capture_ratio);
@@ -209,6 +214,9 @@ static int config_set(uint32_t key, GVariant *data,
 		devc->limit_msec = sigma_limit_samples_to_msec(devc,
 						devc->limit_samples);
 		break;
+	case SR_CONF_CONTINUOUS:
+		devc->continuous = g_variant_get_boolean(data);
+		break;
 #if ASIX_SIGMA_WITH_TRIGGER
 	case SR_CONF_CAPTURE_RATIO:
 		devc->capture_ratio = g_variant_get_uint64(data);
@@ -245,6 +253,7 @@ static int config_list(uint32_t key, GVariant **data,
 static int dev_acquisition_start(const struct sr_dev_inst *sdi)
 {
 	struct dev_context *devc;
+	struct sr_trigger *trigger;
 	struct clockselect_50 clockselect;
 	int triggerpin, ret;
 	uint8_t triggerselect;
@@ -256,6 +265,16 @@ static int dev_acquisition_start(const struct sr_dev_inst *sdi)
 
 	devc = sdi->priv;
 
+	/*
+	 * Continuous mode downloads DRAM lines while they get written,
+	 * there is no trigger position to report.
+	 */
+	trigger = sr_session_trigger_get(sdi->session);
+	if (devc->continuous && trigger && trigger->stages) {
+		sr_err("Triggers are not supported in continuous mode.");
+		return SR_ERR_NA;
+	}
+
 	if (sigma_convert_trigger(sdi) != SR_OK) {
 		sr_err("Failed to configure triggers.");
 		return SR_ERR;
@@ -342,12 +361,23 @@ static int dev_acquisition_start(const struct sr_dev_inst *sdi)
 
 	/* Start acqusition. */
 	devc->start_time = g_get_monotonic_time();
+	devc->sent_samples = 0;
+	devc->stream.next_line = 0;
+	devc->stream.lines_decoded = 0;
 	regval =  WMR_TRGRES | WMR_SDRAMWRITEEN;
 #if ASIX_SIGMA_WITH_TRIGGER
 	regval |= WMR_TRGEN;
 #endif
+	/* Continuous mode reads DRAM while the capture keeps writing. */
+	if (devc->continuous)
+		regval |= WMR_SDRAMREADEN;
 	sigma_set_register(WRITE_MODE, regval, devc);
 
+	if (devc->continuous && (ret = sigma_stream_start(sdi)) != SR_OK) {
+		sigma_set_register(WRITE_MODE, WMR_FORCESTOP, devc);
+		return ret;
+	}
+
 	std_session_send_df_header(sdi);
 
 	/* Add capture source. */
@@ -675,7 +675,7 @@ SR_PRIV int sigma_convert_trigger(const struct sr_dev_inst *sdi)
 
 /* Software trigger to determine exact trigger position. */
 static int get_trigger_offset(uint8_t *samples, uint16_t last_sample,
-			      struct sigma_trigger *t)
+			      const struct sigma_trigger *t)
 {
 	int i;
 	uint16_t sample = 0;
@@ -709,7 +709,7 @@ static int get_trigger_offset(uint8_t *samples, uint16_t last_sample,
 /*
  * Return the timestamp of "DRAM cluster".
  */
-static uint16_t sigma_dram_cluster_ts(struct sigma_dram_cluster *cluster)
+static uint16_t sigma_dram_cluster_ts(const struct sigma_dram_cluster *cluster)
 {
 	return (cluster->timestamp_hi << 8) | cluster->timestamp_lo;
 }
@@ -717,7 +717,7 @@ static uint16_t sigma_dram_cluster_ts(struct sigma_dram_cluster *cluster)
 /*
  * Return one 16bit data entity of a DRAM cluster at the specified index.
  */
-static uint16_t sigma_dram_cluster_data(struct sigma_dram_cluster *cl, int idx)
+static uint16_t sigma_dram_cluster_data(const struct sigma_dram_cluster *cl, int idx)
 {
 	uint16_t sample;
 
@@ -775,124 +775,126 @@ static void store_sr_sample(uint8_t *samples, int idx, uint16_t data)
 }
 
 /*
- * Local wrapper around sr_session_send() calls. Make sure to not send
+ * Decoding of DRAM lines runs in worker threads. Each job covers a range
+ * of lines and accumulates its samples in run-length buffers, which get
+ * sent to the session in order after all jobs have finished. Clusters
+ * carry their own timestamps, so a job only needs the last timestamp and
+ * sample value before its first line to decode independently.
+ */
+struct sigma_decode_job {
+	const struct sigma_dram_line *lines;
+	uint32_t num_lines;
+	uint32_t events_in_last_line;
+	uint32_t trigger_line;
+	uint32_t trigger_event;
+	uint64_t samplerate;
+	int samples_per_event;
+	const struct sigma_trigger *trigger;
+	uint16_t lastts;
+	uint16_t lastsample;
+	/* Samples before the trigger position, if the trigger is in range. */
+	struct sr_logic_rle_buffer *pre_trigger;
+	struct sr_logic_rle_buffer *rb;
+};
+
+/*
+ * Local wrapper around sending a run-length buffer. Make sure to not send
  * more samples to the session's datafeed than what was requested by a
  * previously configured (optional) sample count.
  */
 static void sigma_session_send(struct sr_dev_inst *sdi,
-				struct sr_datafeed_packet *packet)
+				struct sr_logic_rle_buffer *rb)
 {
 	struct dev_context *devc;
-	struct sr_datafeed_logic *logic;
-	uint64_t send_now;
 
 	devc = sdi->priv;
 	if (devc->limit_samples) {
-		logic = (void *)packet->payload;
-		send_now = logic->length / logic->unitsize;
-		if (devc->sent_samples + send_now > devc->limit_samples) {
-			send_now = devc->limit_samples - devc->sent_samples;
-			logic->length = send_now * logic->unitsize;
-		}
-		if (!send_now)
+		if (devc->sent_samples + rb->num_samples > devc->limit_samples)
+			sr_logic_rle_buffer_truncate(rb,
+				devc->limit_samples - devc->sent_samples);
+		if (!rb->num_samples)
 			return;
-		devc->sent_samples += send_now;
 	}
+	devc->sent_samples += rb->num_samples;
 
-	sr_session_send(sdi, packet);
+	sr_logic_rle_buffer_send(sdi, rb);
 }
 
 /*
- * This size translates to: event count (1K events per cluster), times
- * the sample width (unitsize, 16bits per event), times the maximum
- * number of samples per event.
+ * Expand the events of a DRAM cluster into 16bit samples, in the format
+ * which the session datafeed expects. Cope with memory layouts that vary
+ * with the samplerate. Returns the number of samples.
  */
-#define SAMPLES_BUFFER_SIZE	(1024 * 2 * 4)
+static size_t sigma_cluster_samples(const struct sigma_dram_cluster *cluster,
+				    unsigned int events_in_cluster,
+				    uint64_t samplerate, uint8_t *samples)
+{
+	uint16_t item16;
+	size_t count;
+	unsigned int i;
 
-static void sigma_decode_dram_cluster(struct sigma_dram_cluster *dram_cluster,
+	count = 0;
+	for (i = 0; i < events_in_cluster; i++) {
+		item16 = sigma_dram_cluster_data(cluster, i);
+		if (samplerate == SR_MHZ(200)) {
+			store_sr_sample(samples, count++,
+				sigma_deinterlace_200mhz_data(item16, 0));
+			store_sr_sample(samples, count++,
+				sigma_deinterlace_200mhz_data(item16, 1));
+			store_sr_sample(samples, count++,
+				sigma_deinterlace_200mhz_data(item16, 2));
+			store_sr_sample(samples, count++,
+				sigma_deinterlace_200mhz_data(item16, 3));
+		} else if (samplerate == SR_MHZ(100)) {
+			store_sr_sample(samples, count++,
+				sigma_deinterlace_100mhz_data(item16, 0));
+			store_sr_sample(samples, count++,
+				sigma_deinterlace_100mhz_data(item16, 1));
+		} else {
+			store_sr_sample(samples, count++, item16);
+		}
+	}
+
+	return count;
+}
+
+/* Largest number of samples in a cluster: 7 events of 4 samples each. */
+#define CLUSTER_SAMPLES_MAX	(EVENTS_PER_CLUSTER * 4)
+
+static void sigma_decode_dram_cluster(struct sigma_decode_job *job,
+				      const struct sigma_dram_cluster *dram_cluster,
 				      unsigned int events_in_cluster,
-				      unsigned int triggered,
-				      struct sr_dev_inst *sdi)
+				      unsigned int triggered)
 {
-	struct dev_context *devc = sdi->priv;
-	struct sigma_state *ss = &devc->state;
-	struct sr_datafeed_packet packet;
-	struct sr_datafeed_logic logic;
-	uint16_t tsdiff, ts, sample, item16;
-	uint8_t samples[SAMPLES_BUFFER_SIZE];
-	uint8_t *send_ptr;
-	size_t send_count, trig_count;
-	unsigned int i;
-	int j;
+	uint8_t samples[CLUSTER_SAMPLES_MAX * 2];
+	uint8_t lastsample[2];
+	uint16_t tsdiff, ts;
+	size_t count, i, trig_count;
+	int trigger_offset;
 
 	ts = sigma_dram_cluster_ts(dram_cluster);
-	tsdiff = ts - ss->lastts;
-	ss->lastts = ts + EVENTS_PER_CLUSTER;
-
-	packet.type = SR_DF_LOGIC;
-	packet.payload = &logic;
-	logic.unitsize = 2;
-	logic.data = samples;
+	tsdiff = ts - job->lastts;
+	job->lastts = ts + EVENTS_PER_CLUSTER;
 
 	/*
 	 * If this cluster is not adjacent to the previously received
-	 * cluster, then send the appropriate number of samples with the
-	 * previous values to the sigrok session. This "decodes RLE".
+	 * cluster, then repeat the previous value for the number of
+	 * samples in between. This "decodes RLE". Since constant data
+	 * is sent, duplication of data for rates above 50MHz is simple.
 	 */
-	for (ts = 0; ts < tsdiff; ts++) {
-		i = ts % 1024;
-		store_sr_sample(samples, i, ss->lastsample);
-
-		/*
-		 * If we have 1024 samples ready or we're at the
-		 * end of submitting the padding samples, submit
-		 * the packet to Sigrok. Since constant data is
-		 * sent, duplication of data for rates above 50MHz
-		 * is simple.
-		 */
-		if ((i == 1023) || (ts == tsdiff - 1)) {
-			logic.length = (i + 1) * logic.unitsize;
-			for (j = 0; j < devc->samples_per_event; j++)
-				sigma_session_send(sdi, &packet);
-		}
-	}
+	store_sr_sample(lastsample, 0, job->lastsample);
+	sr_logic_rle_buffer_append(job->rb, lastsample, 2,
+		(uint64_t)tsdiff * job->samples_per_event);
 
-	/*
-	 * Parse the samples in current cluster and prepare them
-	 * to be submitted to Sigrok. Cope with memory layouts that
-	 * vary with the samplerate.
-	 */
-	send_ptr = &samples[0];
-	send_count = 0;
-	sample = 0;
-	for (i = 0; i < events_in_cluster; i++) {
-		item16 = sigma_dram_cluster_data(dram_cluster, i);
-		if (devc->cur_samplerate == SR_MHZ(200)) {
-			sample = sigma_deinterlace_200mhz_data(item16, 0);
-			store_sr_sample(samples, send_count++, sample);
-			sample = sigma_deinterlace_200mhz_data(item16, 1);
-			store_sr_sample(samples, send_count++, sample);
-			sample = sigma_deinterlace_200mhz_data(item16, 2);
-			store_sr_sample(samples, send_count++, sample);
-			sample = sigma_deinterlace_200mhz_data(item16, 3);
-			store_sr_sample(samples, send_count++, sample);
-		} else if (devc->cur_samplerate == SR_MHZ(100)) {
-			sample = sigma_deinterlace_100mhz_data(item16, 0);
-			store_sr_sample(samples, send_count++, sample);
-			sample = sigma_deinterlace_100mhz_data(item16, 1);
-			store_sr_sample(samples, send_count++, sample);
-		} else {
-			sample = item16;
-			store_sr_sample(samples, send_count++, sample);
-		}
-	}
+	count = sigma_cluster_samples(dram_cluster, events_in_cluster,
+				      job->samplerate, samples);
 
 	/*
-	 * If a trigger position applies, then provide the datafeed with
-	 * the first part of data up to that position, then send the
-	 * trigger marker.
+	 * If a trigger position applies, then keep the first part of data
+	 * up to that position apart, so that the trigger marker can be
+	 * sent in between.
 	 */
-	int trigger_offset = 0;
+	i = 0;
 	if (triggered) {
 		/*
 		 * Trigger is not always accurate to sample because of
@@ -901,36 +903,21 @@ static void sigma_decode_dram_cluster(struct sigma_dram_cluster *dram_cluster,
 		 * samples to pinpoint the exact position of the trigger.
 		 */
 		trigger_offset = get_trigger_offset(samples,
-					ss->lastsample, &devc->trigger);
-
-		if (trigger_offset > 0) {
-			trig_count = trigger_offset * devc->samples_per_event;
-			packet.type = SR_DF_LOGIC;
-			logic.length = trig_count * logic.unitsize;
-			sigma_session_send(sdi, &packet);
-			send_ptr += trig_count * logic.unitsize;
-			send_count -= trig_count;
-		}
-
-		/* Only send trigger if explicitly enabled. */
-		if (devc->use_triggers) {
-			packet.type = SR_DF_TRIGGER;
-			sr_session_send(sdi, &packet);
-		}
+					job->lastsample, job->trigger);
+		trig_count = MIN(count, (size_t)trigger_offset *
+				 job->samples_per_event);
+		for (; i < trig_count; i++)
+			sr_logic_rle_buffer_append(job->rb, &samples[2 * i], 2, 1);
+		job->pre_trigger = job->rb;
+		job->rb = sr_logic_rle_buffer_new();
 	}
 
-	/*
-	 * Send the data after the trigger, or all of the received data
-	 * if no trigger position applies.
-	 */
-	if (send_count) {
-		packet.type = SR_DF_LOGIC;
-		logic.length = send_count * logic.unitsize;
-		logic.data = send_ptr;
-		sigma_session_send(sdi, &packet);
-	}
+	for (; i < count; i++)
+		sr_logic_rle_buffer_append(job->rb, &samples[2 * i], 2, 1);
 
-	ss->lastsample = sample;
+	if (count)
+		job->lastsample = samples[2 * count - 2] |
+				  (samples[2 * count - 1] << 8);
 }
 
 /*
@@ -942,19 +929,17 @@ static void sigma_decode_dram_cluster(struct sigma_dram_cluster *dram_cluster,
  * For 50 MHz and below, events contain one sample for each channel,
  * spread 20 ns apart.
  */
-static int decode_chunk_ts(struct sigma_dram_line *dram_line,
+static int decode_chunk_ts(struct sigma_decode_job *job,
+			   const struct sigma_dram_line *dram_line,
 			   uint16_t events_in_line,
-			   uint32_t trigger_event,
-			   struct sr_dev_inst *sdi)
+			   uint32_t trigger_event)
 {
-	struct sigma_dram_cluster *dram_cluster;
-	struct dev_context *devc;
+	const struct sigma_dram_cluster *dram_cluster;
 	unsigned int clusters_in_line;
 	unsigned int events_in_cluster;
 	unsigned int i;
 	uint32_t trigger_cluster, triggered;
 
-	devc = sdi->priv;
 	clusters_in_line = events_in_line;
 	clusters_in_line += EVENTS_PER_CLUSTER - 1;
 	clusters_in_line /= EVENTS_PER_CLUSTER;
@@ -963,7 +948,7 @@ static int decode_chunk_ts(struct sigma_dram_line *dram_line,
 
 	/* Check if trigger is in this chunk. */
 	if (trigger_event < (64 * 7)) {
-		if (devc->cur_samplerate <= SR_MHZ(50)) {
+		if (job->samplerate <= SR_MHZ(50)) {
 			trigger_event -= MIN(EVENTS_PER_CLUSTER - 1,
 					     trigger_event);
 		}
@@ -985,34 +970,339 @@ static int decode_chunk_ts(struct sigma_dram_line *dram_line,
 		}
 
 		triggered = (i == trigger_cluster);
-		sigma_decode_dram_cluster(dram_cluster, events_in_cluster,
-					  triggered, sdi);
+		sigma_decode_dram_cluster(job, dram_cluster, events_in_cluster,
+					  triggered);
 	}
 
 	return SR_OK;
 }
 
-static int download_capture(struct sr_dev_inst *sdi)
+static gpointer sigma_decode_job_run(gpointer data)
+{
+	struct sigma_decode_job *job;
+	uint32_t i, events_in_line, trigger_event;
+
+	job = data;
+	for (i = 0; i < job->num_lines; i++) {
+		events_in_line = 64 * 7;
+		if (i == job->num_lines - 1)
+			events_in_line = job->events_in_last_line;
+		trigger_event = (i == job->trigger_line) ? job->trigger_event : ~0;
+		decode_chunk_ts(job, &job->lines[i], events_in_line,
+				trigger_event);
+	}
+
+	return NULL;
+}
+
+/*
+ * Decode a run of DRAM lines, spread across several threads when there
+ * are enough lines, then send the samples in order. The last line holds
+ * events_in_last_line events, the trigger is at trigger_event within
+ * line trigger_line (~0 if the trigger is not in this run of lines).
+ */
+static void sigma_decode_lines(struct sr_dev_inst *sdi,
+			       const struct sigma_dram_line *lines,
+			       uint32_t num_lines, uint32_t events_in_last_line,
+			       uint32_t trigger_line, uint32_t trigger_event)
+{
+	struct dev_context *devc;
+	struct sigma_decode_job *jobs, *job;
+	GThread **threads;
+	const struct sigma_dram_cluster *prev;
+	struct sr_datafeed_packet packet;
+	uint32_t lines_per_job, first;
+	uint8_t samples[CLUSTER_SAMPLES_MAX * 2];
+	size_t count;
+	int num_jobs, i;
+
+	devc = sdi->priv;
+	if (!num_lines)
+		return;
+
+	num_jobs = MIN(g_get_num_processors(), DECODE_THREADS_MAX);
+	num_jobs = MIN(num_jobs, (int)((num_lines + DECODE_LINES_MIN - 1) /
+				       DECODE_LINES_MIN));
+	num_jobs = MAX(num_jobs, 1);
+	lines_per_job = (num_lines + num_jobs - 1) / num_jobs;
+
+	jobs = g_malloc0(num_jobs * sizeof(*jobs));
+	threads = g_malloc0(num_jobs * sizeof(*threads));
+
+	for (i = 0; i < num_jobs; i++) {
+		job = &jobs[i];
+		first = i * lines_per_job;
+		job->lines = lines + first;
+		job->num_lines = MIN(lines_per_job, num_lines - first);
+		job->events_in_last_line = (first + job->num_lines == num_lines) ?
+			events_in_last_line : 64 * 7;
+		job->trigger_line = ~0;
+		if (trigger_line >= first && trigger_line - first < job->num_lines)
+			job->trigger_line = trigger_line - first;
+		job->trigger_event = trigger_event;
+		job->samplerate = devc->cur_samplerate;
+		job->samples_per_event = devc->samples_per_event;
+		job->trigger = &devc->trigger;
+		job->rb = sr_logic_rle_buffer_new();
+
+		/*
+		 * Start where the previous line left off, its last cluster
+		 * is always full. The first job continues from the state
+		 * of the previous run of lines.
+		 */
+		if (!first) {
+			job->lastts = devc->state.lastts;
+			job->lastsample = devc->state.lastsample;
+		} else {
+			prev = &lines[first - 1].cluster[63];
+			job->lastts = sigma_dram_cluster_ts(prev) + EVENTS_PER_CLUSTER;
+			count = sigma_cluster_samples(prev, EVENTS_PER_CLUSTER,
+						      job->samplerate, samples);
+			job->lastsample = samples[2 * count - 2] |
+					  (samples[2 * count - 1] << 8);
+		}
+	}
+
+	/* The first job runs on this thread, or all of them as a fallback. */
+	for (i = 1; i < num_jobs; i++)
+		threads[i] = g_thread_try_new("asix-sigma-decode",
+				sigma_decode_job_run, &jobs[i], NULL);
+	sigma_decode_job_run(&jobs[0]);
+	for (i = 1; i < num_jobs; i++) {
+		if (threads[i])
+			g_thread_join(threads[i]);
+		else
+			sigma_decode_job_run(&jobs[i]);
+	}
+
+	for (i = 0; i < num_jobs; i++) {
+		job = &jobs[i];
+		if (job->pre_trigger) {
+			sigma_session_send(sdi, job->pre_trigger);
+			sr_logic_rle_buffer_free(job->pre_trigger);
+			/* Only send trigger if explicitly enabled. */
+			if (devc->use_triggers) {
+				packet.type = SR_DF_TRIGGER;
+				packet.payload = NULL;
+				sr_session_send(sdi, &packet);
+			}
+		}
+		sigma_session_send(sdi, job->rb);
+		sr_logic_rle_buffer_free(job->rb);
+	}
+
+	devc->state.lastts = jobs[num_jobs - 1].lastts;
+	devc->state.lastsample = jobs[num_jobs - 1].lastsample;
+
+	g_free(threads);
+	g_free(jobs);
+}
+
+/*
+ * Poll the READ_MODE register at a moderate pace until one of the
+ * given flags is set, instead of hammering the FTDI link.
+ */
+static int sigma_wait_mode(uint8_t flags, uint8_t *modestatus,
+			   struct dev_context *devc)
 {
-	const uint32_t chunks_per_read = 32;
+	int64_t deadline;
+
+	deadline = g_get_monotonic_time() + STATUS_POLL_TIMEOUT_MS * 1000;
+	while (1) {
+		*modestatus = sigma_get_register(READ_MODE, devc);
+		if (*modestatus & flags)
+			return SR_OK;
+		if (g_get_monotonic_time() >= deadline)
+			return SR_ERR_TIMEOUT;
+		g_usleep(STATUS_POLL_US);
+	}
+}
 
+/*
+ * Continuous mode download thread. Follows the hardware's DRAM write
+ * position and fetches every line that was completed since the last
+ * poll. The line which currently gets written to is left alone. Sleeps
+ * between polls once it has caught up with the hardware.
+ */
+static gpointer sigma_stream_thread(gpointer data)
+{
+	struct dev_context *devc;
+	struct sigma_stream *stream;
+	struct sigma_dram_block *block;
+	uint32_t stoppos, triggerpos;
+	uint32_t write_line, avail, num_lines;
+	int ret;
+
+	devc = data;
+	stream = &devc->stream;
+
+	while (!g_atomic_int_get(&stream->stop)) {
+		sigma_read_pos(&stoppos, &triggerpos, devc);
+		write_line = (stoppos >> 9) % DRAM_LINE_COUNT;
+		avail = (write_line - stream->next_line) % DRAM_LINE_COUNT;
+		if (!avail) {
+			g_usleep(STREAM_POLL_US);
+			continue;
+		}
+
+		/* The writer is about to lap us, data is getting lost. */
+		if (avail > DRAM_LINE_COUNT - DRAM_LINES_PER_READ) {
+			sr_err("DRAM ring overrun, host can't keep up.");
+			g_atomic_int_set(&stream->failed, 1);
+			break;
+		}
+
+		/* Let the decoder catch up, the check above catches stalls. */
+		if (g_atomic_int_get(&stream->queued_lines) >=
+		    STREAM_MAX_QUEUED_LINES) {
+			g_usleep(STREAM_POLL_US);
+			continue;
+		}
+
+		num_lines = MIN(avail, DRAM_LINES_PER_READ);
+		num_lines = MIN(num_lines, DRAM_LINE_COUNT - stream->next_line);
+		block = g_malloc(sizeof(*block) +
+				 num_lines * sizeof(block->lines[0]));
+		block->num_lines = num_lines;
+		ret = sigma_read_dram(stream->next_line, num_lines,
+				      (uint8_t *)block->lines, devc);
+		if (ret != (int)(num_lines * CHUNK_SIZE)) {
+			sr_err("Failed to read DRAM lines while streaming.");
+			g_free(block);
+			g_atomic_int_set(&stream->failed, 1);
+			break;
+		}
+		g_atomic_int_add(&stream->queued_lines, num_lines);
+		g_async_queue_push(stream->queue, block);
+		stream->next_line += num_lines;
+		stream->next_line %= DRAM_LINE_COUNT;
+
+		if (avail <= DRAM_LINES_PER_READ)
+			g_usleep(STREAM_POLL_US);
+	}
+
+	return NULL;
+}
+
+SR_PRIV int sigma_stream_start(const struct sr_dev_inst *sdi)
+{
+	struct dev_context *devc;
+	struct sigma_stream *stream;
+	GError *error;
+
+	devc = sdi->priv;
+	stream = &devc->stream;
+
+	stream->next_line = 0;
+	stream->lines_decoded = 0;
+	g_atomic_int_set(&stream->stop, 0);
+	g_atomic_int_set(&stream->failed, 0);
+	g_atomic_int_set(&stream->queued_lines, 0);
+	stream->queue = g_async_queue_new_full(g_free);
+
+	error = NULL;
+	stream->thread = g_thread_try_new("asix-sigma", sigma_stream_thread,
+					  devc, &error);
+	if (!stream->thread) {
+		sr_err("Failed to start download thread: %s.", error->message);
+		g_error_free(error);
+		g_async_queue_unref(stream->queue);
+		stream->queue = NULL;
+		return SR_ERR;
+	}
+
+	return SR_OK;
+}
+
+/* Have the download thread finish, it releases the FTDI context. */
+static void sigma_stream_stop(struct dev_context *devc)
+{
+	if (!devc->stream.thread)
+		return;
+
+	g_atomic_int_set(&devc->stream.stop, 1);
+	g_thread_join(devc->stream.thread);
+	devc->stream.thread = NULL;
+}
+
+/* Decode the DRAM lines which the download thread has queued so far. */
+static void sigma_stream_decode(struct sr_dev_inst *sdi)
+{
+	struct dev_context *devc;
+	struct sigma_dram_block *block;
+
+	devc = sdi->priv;
+	if (!devc->stream.queue)
+		return;
+
+	while ((block = g_async_queue_try_pop(devc->stream.queue))) {
+		/* The very first line provides the initial timestamp. */
+		if (!devc->stream.lines_decoded) {
+			devc->state.lastts = sigma_dram_cluster_ts(
+				&block->lines[0].cluster[0]);
+			devc->state.lastsample = 0;
+		}
+		sigma_decode_lines(sdi, block->lines, block->num_lines,
+				   64 * 7, ~0, ~0);
+		devc->stream.lines_decoded += block->num_lines;
+		g_atomic_int_add(&devc->stream.queued_lines,
+				 -(gint)block->num_lines);
+		g_free(block);
+	}
+}
+
+static void sigma_stream_free(struct dev_context *devc)
+{
+	sigma_stream_stop(devc);
+	if (devc->stream.queue) {
+		g_async_queue_unref(devc->stream.queue);
+		devc->stream.queue = NULL;
+	}
+}
+
+/* Terminate a continuous capture which can't be downloaded completely. */
+static int sigma_stream_abort(struct sr_dev_inst *sdi)
+{
+	struct dev_context *devc;
+
+	devc = sdi->priv;
+	sigma_stream_free(devc);
+
+	std_session_send_df_end(sdi);
+
+	devc->state.state = SIGMA_IDLE;
+	sr_dev_acquisition_stop(sdi);
+
+	return TRUE;
+}
+
+static int download_capture(struct sr_dev_inst *sdi)
+{
 	struct dev_context *devc;
 	struct sigma_dram_line *dram_line;
 	int bufsz;
 	uint32_t stoppos, triggerpos;
 	uint8_t modestatus;
 	uint32_t i;
-	uint32_t dl_lines_total, dl_lines_curr, dl_lines_done;
+	uint32_t dl_lines_total, dl_lines_curr, dl_lines_done, dl_lines_batch;
 	uint32_t dl_first_line, dl_line;
 	uint32_t dl_events_in_line;
-	uint32_t trg_line, trg_event;
+	uint32_t trg_line, trg_event, trigger_line;
 
 	devc = sdi->priv;
-	dl_events_in_line = 64 * 7;
+
+	/* Take back the FTDI context from the download thread. */
+	if (devc->stream.thread) {
+		sigma_stream_stop(devc);
+		if (g_atomic_int_get(&devc->stream.failed))
+			return sigma_stream_abort(sdi);
+		sigma_stream_decode(sdi);
+	}
+
 	trg_line = ~0;
 	trg_event = ~0;
 
-	dram_line = g_try_malloc0(chunks_per_read * sizeof(*dram_line));
+	dram_line = g_try_malloc0(DECODE_BATCH_LINES * sizeof(*dram_line));
 	if (!dram_line)
 		return FALSE;
 
@@ -1026,9 +1316,8 @@ static int download_capture(struct sr_dev_inst *sdi)
 	 * raise the POSTTRIGGERED flag.
 	 */
 	sigma_set_register(WRITE_MODE, WMR_FORCESTOP | WMR_SDRAMWRITEEN, devc);
-	do {
-		modestatus = sigma_get_register(READ_MODE, devc);
-	} while (!(modestatus & RMR_POSTTRIGGERED));
+	if (sigma_wait_mode(RMR_POSTTRIGGERED, &modestatus, devc) != SR_OK)
+		sr_warn("Timeout waiting for the capture to stop.");
 
 	/* Set SDRAM Read Enable. */
 	sigma_set_register(WRITE_MODE, WMR_SDRAMREADEN, devc);
@@ -1043,8 +1332,6 @@ static int download_capture(struct sr_dev_inst *sdi)
 		trg_event = triggerpos & 0x1ff;
 	}
 
-	devc->sent_samples = 0;
-
 	/*
 	 * Determine how many "DRAM lines" of 1024 bytes each we need to
 	 * retrieve from the Sigma hardware, so that we have a complete
@@ -1055,50 +1342,65 @@ static int download_capture(struct sr_dev_inst *sdi)
 	 * around. Since the status of the very next line is uncertain in
 	 * that case, we skip it and start reading from the next line. The
 	 * circular buffer has 32K lines (0x8000).
+	 *
+	 * In continuous mode, the download thread already fetched all
+	 * lines up to where the hardware was writing to recently, only
+	 * the remainder up to the stop position is left to retrieve.
 	 */
 	dl_lines_total = (stoppos >> 9) + 1;
-	if (modestatus & RMR_ROUND) {
+	if (devc->continuous) {
+		dl_first_line = devc->stream.next_line;
+		dl_lines_total = ((stoppos >> 9) - dl_first_line) %
+				 DRAM_LINE_COUNT + 1;
+	} else if (modestatus & RMR_ROUND) {
 		dl_first_line = dl_lines_total + 1;
-		dl_lines_total = 0x8000 - 2;
+		dl_lines_total = DRAM_LINE_COUNT - 2;
 	} else {
 		dl_first_line = 0;
 	}
 	dl_lines_done = 0;
 	while (dl_lines_total > dl_lines_done) {
-		/* We can download only up-to 32 DRAM lines in one go! */
-		dl_lines_curr = MIN(chunks_per_read, dl_lines_total - dl_lines_done);
-
-		dl_line = dl_first_line + dl_lines_done;
-		dl_line %= 0x8000;
-		bufsz = sigma_read_dram(dl_line, dl_lines_curr,
-					(uint8_t *)dram_line, devc);
-		/* TODO: Check bufsz. For now, just avoid compiler warnings. */
-		(void)bufsz;
+		/*
+		 * Collect a batch of lines for the decoder threads. We can
+		 * download only up-to 32 DRAM lines in one go!
+		 */
+		dl_lines_batch = MIN(DECODE_BATCH_LINES, dl_lines_total - dl_lines_done);
+		for (i = 0; i < dl_lines_batch; i += dl_lines_curr) {
+			dl_lines_curr = MIN(DRAM_LINES_PER_READ, dl_lines_batch - i);
+
+			dl_line = dl_first_line + dl_lines_done + i;
+			dl_line %= DRAM_LINE_COUNT;
+			bufsz = sigma_read_dram(dl_line, dl_lines_curr,
+						(uint8_t *)(dram_line + i), devc);
+			/* TODO: Check bufsz. For now, just avoid compiler warnings. */
+			(void)bufsz;
+		}
 
 		/* This is the first DRAM line, so find the initial timestamp. */
-		if (dl_lines_done == 0) {
+		if (dl_lines_done == 0 && !devc->stream.lines_decoded) {
 			devc->state.lastts =
 				sigma_dram_cluster_ts(&dram_line[0].cluster[0]);
 			devc->state.lastsample = 0;
 		}
 
-		for (i = 0; i < dl_lines_curr; i++) {
-			uint32_t trigger_event = ~0;
-			/* The last "DRAM line" can be only partially full. */
-			if (dl_lines_done + i == dl_lines_total - 1)
-				dl_events_in_line = stoppos & 0x1ff;
+		/* The last "DRAM line" can be only partially full. */
+		dl_events_in_line = 64 * 7;
+		if (dl_lines_done + dl_lines_batch == dl_lines_total)
+			dl_events_in_line = stoppos & 0x1ff;
 
-			/* Test if the trigger happened on this line. */
-			if (dl_lines_done + i == trg_line)
-				trigger_event = trg_event;
+		/* Test if the trigger happened in this batch. */
+		trigger_line = ~0;
+		if (trg_line >= dl_lines_done &&
+		    trg_line < dl_lines_done + dl_lines_batch)
+			trigger_line = trg_line - dl_lines_done;
 
-			decode_chunk_ts(dram_line + i, dl_events_in_line,
-					trigger_event, sdi);
-		}
+		sigma_decode_lines(sdi, dram_line, dl_lines_batch,
+				   dl_events_in_line, trigger_line, trg_event);
 
-		dl_lines_done += dl_lines_curr;
+		dl_lines_done += dl_lines_batch;
 	}
 	g_free(dram_line);
+	sigma_stream_free(devc);
 
 	std_session_send_df_end(sdi);
 
@@ -1121,6 +1423,22 @@ static int sigma_capture_mode(struct sr_dev_inst *sdi)
 
 	devc = sdi->priv;
 
+	/*
+	 * In continuous mode, decode what the download thread fetched
+	 * meanwhile. Without a limit, run until the application stops
+	 * the acquisition.
+	 */
+	if (devc->continuous) {
+		if (g_atomic_int_get(&devc->stream.failed))
+			return download_capture(sdi);
+		sigma_stream_decode(sdi);
+		if (devc->limit_samples &&
+		    devc->sent_samples >= devc->limit_samples)
+			return download_capture(sdi);
+		if (!devc->limit_msec)
+			return TRUE;
+	}
+
 	/*
 	 * Check if the selected sampling duration passed. Sample count
 	 * limits are covered by this enforced timeout as well.
@@ -96,6 +96,29 @@ enum sigma_read_register {
 
 #define CHUNK_SIZE		1024
 
+/* The DRAM ring holds this many lines, read up to 32 lines at a time. */
+#define DRAM_LINE_COUNT		0x8000
+#define DRAM_LINES_PER_READ	32
+
+/*
+ * Downloaded lines are decoded in batches, split across up to this many
+ * threads with at least DECODE_LINES_MIN lines each.
+ */
+#define DECODE_BATCH_LINES	1024
+#define DECODE_THREADS_MAX	8
+#define DECODE_LINES_MIN	64
+
+/* Pacing of status polls while waiting for the hardware. */
+#define STATUS_POLL_US		1000
+#define STATUS_POLL_TIMEOUT_MS	1000
+#define STREAM_POLL_US		(10 * 1000)
+/*
+ * Continuous mode stops fetching DRAM lines while this many are queued
+ * for decoding. If decoding doesn't catch up, the hardware overruns the
+ * DRAM ring and the capture fails, instead of host memory growing.
+ */
+#define STREAM_MAX_QUEUED_LINES	DRAM_LINE_COUNT
+
 /* WRITE_MODE register fields. */
 #define WMR_SDRAMWRITEEN	(1 << 0)
 #define WMR_SDRAMREADEN		(1 << 1)
@@ -253,6 +276,27 @@ struct sigma_state {
 	uint16_t lastsample;
 };
 
+/* A run of DRAM lines fetched while a continuous capture is running. */
+struct sigma_dram_block {
+	size_t num_lines;
+	struct sigma_dram_line lines[];
+};
+
+/*
+ * Continuous mode: a thread follows the hardware write pointer and
+ * fetches completed DRAM lines, which get queued for the main thread
+ * to decode. The thread owns the FTDI context until it is joined.
+ */
+struct sigma_stream {
+	GThread *thread;
+	GAsyncQueue *queue;
+	gint stop;
+	gint failed;
+	gint queued_lines;
+	uint32_t next_line;
+	uint64_t lines_decoded;
+};
+
 struct dev_context {
 	struct ftdi_context ftdic;
 	uint64_t cur_samplerate;
@@ -267,7 +311,9 @@ struct dev_context {
 	uint64_t capture_ratio;
 	struct sigma_trigger trigger;
 	int use_triggers;
+	gboolean continuous;
 	struct sigma_state state;
+	struct sigma_stream stream;
 };
 
 extern SR_PRIV const uint64_t samplerates[];
@@ -282,6 +328,7 @@ SR_PRIV uint64_t sigma_limit_samples_to_msec(const struct dev_context *devc,
 SR_PRIV int sigma_set_samplerate(const struct sr_dev_inst *sdi, uint64_t samplerate);
 SR_PRIV int sigma_convert_trigger(const struct sr_dev_inst *sdi);
 SR_PRIV int sigma_receive_data(int fd, int revents, void *cb_data);
+SR_PRIV int sigma_stream_start(const struct sr_dev_inst *sdi);
 SR_PRIV int sigma_build_basic_trigger(struct triggerlut *lut, struct dev_context *devc);
 
 #endif
@@ -118,10 +118,12 @@ static GSList *scan(struct sr_dev_driver *di, GSList *options)
 	} else {
 		devc->read_timeout = 1000 * 1000;
 		devc->beaglelogic = &beaglelogic_tcp_ops;
-		devc->address = g_strdup(params[1]);
-		devc->port = g_strdup(params[2]);
+		devc->tcp = sr_tcp_dev_inst_new(params[1], params[2],
+			TCP_RCVBUF_SIZE);
 		g_strfreev(params);
 
+		if (!devc->tcp)
+			goto err_free;
 		if (devc->beaglelogic->open(devc) != SR_OK)
 			goto err_free;
 		if (beaglelogic_tcp_detect(devc) != SR_OK)
@@ -129,7 +131,7 @@ static GSList *scan(struct sr_dev_driver *di, GSList *options)
 		if (devc->beaglelogic->close(devc) != SR_OK)
 			goto err_free;
 		sr_info("BeagleLogic device found at %s : %s",
-			devc->address, devc->port);
+			devc->tcp->host_addr, devc->tcp->tcp_port);
 	}
 
 	/* Fill the channels */
@@ -144,8 +146,7 @@ static GSList *scan(struct sr_dev_driver *di, GSList *options)
 err_free:
 	g_free(sdi->model);
 	g_free(sdi->version);
-	g_free(devc->address);
-	g_free(devc->port);
+	sr_tcp_dev_inst_free(devc->tcp);
 	g_free(devc);
 	g_free(sdi);
 
@@ -162,7 +163,7 @@ static int dev_open(struct sr_dev_inst *sdi)
 
 	/* Set fd and local attributes */
 	if (devc->beaglelogic == &beaglelogic_tcp_ops)
-		devc->pollfd.fd = devc->socket;
+		devc->pollfd.fd = devc->tcp->sock_fd;
 	else
 		devc->pollfd.fd = devc->fd;
 	devc->pollfd.events = G_IO_IN;
@@ -208,8 +209,7 @@ static int dev_close(struct sr_dev_inst *sdi)
 static void clear_helper(struct dev_context *devc)
 {
 	g_free(devc->tcp_buffer);
-	g_free(devc->address);
-	g_free(devc->port);
+	sr_tcp_dev_inst_free(devc->tcp);
 }
 
 static int dev_clear(const struct sr_dev_driver *di)
@@ -42,48 +42,6 @@
 #include "protocol.h"
 #include "beaglelogic.h"
 
-static int beaglelogic_tcp_open(struct dev_context *devc)
-{
-	struct addrinfo hints;
-	struct addrinfo *results, *res;
-	int err;
-
-	memset(&hints, 0, sizeof(hints));
-	hints.ai_family = AF_UNSPEC;
-	hints.ai_socktype = SOCK_STREAM;
-	hints.ai_protocol = IPPROTO_TCP;
-
-	err = getaddrinfo(devc->address, devc->port, &hints, &results);
-
-	if (err) {
-		sr_err("Address lookup failed: %s:%s: %s", devc->address,
-			devc->port, gai_strerror(err));
-		return SR_ERR;
-	}
-
-	for (res = results; res; res = res->ai_next) {
-		if ((devc->socket = socket(res->ai_family, res->ai_socktype,
-						res->ai_protocol)) < 0)
-			continue;
-		if (connect(devc->socket, res->ai_addr, res->ai_addrlen) != 0) {
-			close(devc->socket);
-			devc->socket = -1;
-			continue;
-		}
-		break;
-	}
-
-	freeaddrinfo(results);
-
-	if (devc->socket < 0) {
-		sr_err("Failed to connect to %s:%s: %s", devc->address,
-			devc->port, g_strerror(errno));
-		return SR_ERR;
-	}
-
-	return SR_OK;
-}
-
 static int beaglelogic_tcp_send_cmd(struct dev_context *devc,
 				    const char *format, ...)
 {
@@ -103,19 +61,13 @@ static int beaglelogic_tcp_send_cmd(struct dev_context *devc,
 	if (buf[len - 1] != '\n')
 		buf[len] = '\n';
 
-	out = send(devc->socket, buf, strlen(buf), 0);
+	out = sr_tcp_write_bytes(devc->tcp, (const uint8_t *)buf, strlen(buf));
 
 	if (out < 0) {
-		sr_err("Send error: %s", g_strerror(errno));
 		g_free(buf);
 		return SR_ERR;
 	}
 
-	if (out < (int)strlen(buf)) {
-		sr_dbg("Only sent %d/%zu bytes of command: '%s'.", out,
-		       strlen(buf), buf);
-	}
-
 	sr_spew("Sent command: '%s'.", buf);
 
 	g_free(buf);
@@ -126,16 +78,7 @@ static int beaglelogic_tcp_send_cmd(struct dev_context *devc,
 static int beaglelogic_tcp_read_data(struct dev_context *devc, char *buf,
 				     int maxlen)
 {
-	int len;
-
-	len = recv(devc->socket, buf, maxlen, 0);
-
-	if (len < 0) {
-		sr_err("Receive error: %s", g_strerror(errno));
-		return SR_ERR;
-	}
-
-	return len;
+	return sr_tcp_read_bytes(devc->tcp, (uint8_t *)buf, maxlen);
 }
 
 SR_PRIV int beaglelogic_tcp_drain(struct dev_context *devc)
@@ -146,14 +89,14 @@ SR_PRIV int beaglelogic_tcp_drain(struct dev_context *devc)
 	struct timeval tv;
 
 	FD_ZERO(&rset);
-	FD_SET(devc->socket, &rset);
+	FD_SET(devc->tcp->sock_fd, &rset);
 
 	/* 25ms timeout */
 	tv.tv_sec = 0;
 	tv.tv_usec = 25 * 1000;
 
 	do {
-		ret = select(devc->socket + 1, &rset, NULL, NULL, &tv);
+		ret = select(devc->tcp->sock_fd + 1, &rset, NULL, NULL, &tv);
 		if (ret > 0)
 			len += beaglelogic_tcp_read_data(devc, buf, 1024);
 	} while (ret > 0);
@@ -250,15 +193,12 @@ SR_PRIV int beaglelogic_tcp_detect(struct dev_context *devc)
 
 static int beaglelogic_open(struct dev_context *devc)
 {
-	return beaglelogic_tcp_open(devc);
+	return sr_tcp_connect(devc->tcp);
 }
 
 static int beaglelogic_close(struct dev_context *devc)
 {
-	if (close(devc->socket) < 0)
-		return SR_ERR;
-
-	return SR_OK;
+	return sr_tcp_disconnect(devc->tcp);
 }
 
 static int beaglelogic_get_buffersize(struct dev_context *devc)
@@ -21,94 +21,135 @@
 #include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
-#ifdef _WIN32
-#define _WIN32_WINNT 0x0501
-#include <winsock2.h>
-#include <ws2tcpip.h>
-#else
-#include <sys/socket.h>
-#endif
 #include <errno.h>
 #include "protocol.h"
 #include "beaglelogic.h"
 
-/* Define data packet size independent of packet (bufunitsize bytes) size
- * from the BeagleLogic kernel module */
+/* Data packet size if the kernel module doesn't report its bufunitsize */
 #define PACKET_SIZE	(512 * 1024)
 
-/* This implementation is zero copy from the libsigrok side.
- * It does not copy any data, just passes a pointer from the mmap'ed
- * kernel buffers appropriately. It is up to the application which is
- * using libsigrok to decide how to deal with the data.
+/* Ring units handled per wakeup at most, leaves room for the main loop */
+#define MAX_UNITS_PER_WAKEUP	8
+
+/* Check without blocking whether the kernel has filled the next unit. */
+static gboolean ring_unit_ready(struct dev_context *devc)
+{
+	GPollFD pfd;
+
+	pfd.fd = devc->fd;
+	pfd.events = G_IO_IN;
+	pfd.revents = 0;
+
+	return g_poll(&pfd, 1, 0) > 0 && pfd.revents == G_IO_IN;
+}
+
+/*
+ * Send one unit of the capture ring, and hand it back to the kernel.
+ *
+ * The packet points straight into the mmap'ed ring. Session datafeed
+ * callbacks are synchronous, so the unit is released right after
+ * sr_session_send() returns, and the kernel never refills a unit
+ * that consumers still look at.
+ *
+ * Returns FALSE when the acquisition is complete.
  */
-SR_PRIV int beaglelogic_native_receive_data(int fd, int revents, void *cb_data)
+static gboolean ring_unit_send(const struct sr_dev_inst *sdi,
+		struct dev_context *devc, uint32_t packetsize)
 {
-	const struct sr_dev_inst *sdi;
-	struct dev_context *devc;
 	struct sr_datafeed_packet packet;
 	struct sr_datafeed_logic logic;
-
 	int trigger_offset;
 	int pre_trigger_samples;
-	uint32_t packetsize;
 	uint64_t bytes_remaining;
 
-	if (!(sdi = cb_data) || !(devc = sdi->priv))
-		return TRUE;
-
-	packetsize = PACKET_SIZE;
 	logic.unitsize = SAMPLEUNIT_TO_BYTES(devc->sampleunit);
+	bytes_remaining = (devc->limit_samples * logic.unitsize) -
+			devc->bytes_read;
+
+	/* Configure data packet */
+	packet.type = SR_DF_LOGIC;
+	packet.payload = &logic;
+	logic.data = devc->sample_buf + devc->offset;
+	logic.length = MIN(packetsize, bytes_remaining);
+
+	if (devc->trigger_fired) {
+		/* Send the incoming transfer to the session bus. */
+		sr_session_send(sdi, &packet);
+		devc->bytes_read += logic.length;
+	} else {
+		/* Check for trigger, directly on the ring memory */
+		trigger_offset = soft_trigger_logic_check(devc->stl,
+				logic.data, packetsize, &pre_trigger_samples);
+		if (trigger_offset > -1) {
+			devc->bytes_read += pre_trigger_samples * logic.unitsize;
+			trigger_offset *= logic.unitsize;
+			logic.length = MIN(packetsize - trigger_offset,
+					bytes_remaining);
+			logic.data += trigger_offset;
 
-	if (revents == G_IO_IN) {
-		sr_info("In callback G_IO_IN, offset=%d", devc->offset);
+			sr_session_send(sdi, &packet);
+			devc->bytes_read += logic.length;
 
-		bytes_remaining = (devc->limit_samples * logic.unitsize) -
-				devc->bytes_read;
+			devc->trigger_fired = TRUE;
+		}
+	}
 
-		/* Configure data packet */
-		packet.type = SR_DF_LOGIC;
-		packet.payload = &logic;
-		logic.data = devc->sample_buf + devc->offset;
-		logic.length = MIN(packetsize, bytes_remaining);
+	/* Release the unit: move the read pointer forward */
+	lseek(devc->fd, packetsize, SEEK_CUR);
+
+	/* Update offset (roll over if needed) */
+	if ((devc->offset += packetsize) >= devc->buffersize) {
+		/* One shot capture, we abort and settle with less than
+		 * the required number of samples */
+		if (devc->triggerflags == BL_TRIGGERFLAGS_CONTINUOUS)
+			devc->offset = 0;
+		else
+			return FALSE;
+	}
 
-		if (devc->trigger_fired) {
-			/* Send the incoming transfer to the session bus. */
-			sr_session_send(sdi, &packet);
-		} else {
-			/* Check for trigger */
-			trigger_offset = soft_trigger_logic_check(devc->stl,
-					logic.data, packetsize, &pre_trigger_samples);
-			if (trigger_offset > -1) {
-				devc->bytes_read += pre_trigger_samples * logic.unitsize;
-				trigger_offset *= logic.unitsize;
-				logic.length = MIN(packetsize - trigger_offset,
-						bytes_remaining);
-				logic.data += trigger_offset;
+	return devc->bytes_read < devc->limit_samples * logic.unitsize;
+}
 
-				sr_session_send(sdi, &packet);
+/* This implementation is zero copy from the libsigrok side.
+ * It does not copy any data, just passes a pointer from the mmap'ed
+ * kernel buffers appropriately. It is up to the application which is
+ * using libsigrok to decide how to deal with the data.
+ *
+ * All units the kernel has filled get sent per wakeup (up to a limit),
+ * one packet per unit, instead of one fixed size packet per wakeup.
+ */
+SR_PRIV int beaglelogic_native_receive_data(int fd, int revents, void *cb_data)
+{
+	const struct sr_dev_inst *sdi;
+	struct dev_context *devc;
+	uint32_t packetsize;
+	gboolean running;
+	int units;
 
-				devc->trigger_fired = TRUE;
-			}
-		}
+	(void)fd;
 
-		/* Move the read pointer forward */
-		lseek(fd, packetsize, SEEK_CUR);
+	if (!(sdi = cb_data) || !(devc = sdi->priv))
+		return TRUE;
 
-		/* Update byte count and offset (roll over if needed) */
-		devc->bytes_read += logic.length;
-		if ((devc->offset += packetsize) >= devc->buffersize) {
-			/* One shot capture, we abort and settle with less than
-			 * the required number of samples */
-			if (devc->triggerflags == BL_TRIGGERFLAGS_CONTINUOUS)
-				devc->offset = 0;
-			else
-				packetsize = 0;
-		}
+	running = TRUE;
+	if (revents & G_IO_ERR) {
+		devc->beaglelogic->get_lasterror(devc);
+		sr_err("Capture error %d, the ring buffer overran?",
+			devc->last_error);
+		running = FALSE;
+	} else if (revents == G_IO_IN) {
+		packetsize = devc->bufunitsize ? devc->bufunitsize : PACKET_SIZE;
+		sr_spew("In callback G_IO_IN, offset=%d", devc->offset);
+
+		units = 0;
+		do {
+			running = ring_unit_send(sdi, devc, packetsize);
+		} while (running && ++units < MAX_UNITS_PER_WAKEUP &&
+				ring_unit_ready(devc));
 	}
 
 	/* EOF Received or we have reached the limit */
-	if (devc->bytes_read >= devc->limit_samples * logic.unitsize ||
-			packetsize == 0) {
+	if (!running) {
 		/* Send EOA Packet, stop polling */
 		std_session_send_df_end(sdi);
 		sr_session_source_remove_pollfd(sdi->session, &devc->pollfd);
@@ -130,6 +171,8 @@ SR_PRIV int beaglelogic_tcp_receive_data(int fd, int revents, void *cb_data)
 	uint32_t packetsize;
 	uint64_t bytes_remaining;
 
+	(void)fd;
+
 	if (!(sdi = cb_data) || !(devc = sdi->priv))
 		return TRUE;
 
@@ -139,11 +182,11 @@ SR_PRIV int beaglelogic_tcp_receive_data(int fd, int revents, void *cb_data)
 	if (revents == G_IO_IN) {
 		sr_info("In callback G_IO_IN");
 
-		len = recv(fd, devc->tcp_buffer, TCP_BUFFER_SIZE, 0);
-		if (len < 0) {
-			sr_err("Receive error: %s", g_strerror(errno));
+		/* Take everything queued on the socket, not single segments. */
+		len = sr_tcp_read_bulk(devc->tcp, devc->tcp_buffer,
+			TCP_BUFFER_SIZE);
+		if (len < 0)
 			return SR_ERR;
-		}
 
 		packetsize = len;
 
@@ -32,7 +32,9 @@
 
 #define SAMPLEUNIT_TO_BYTES(x)	((x) == 1 ? 1 : 2)
 
-#define TCP_BUFFER_SIZE         (128 * 1024)
+/* Stream chunk size per poll event, and the requested socket buffer. */
+#define TCP_BUFFER_SIZE         (1024 * 1024)
+#define TCP_RCVBUF_SIZE         (4 * 1024 * 1024)
 
 /** Private, per-device-instance driver context. */
 struct dev_context {
@@ -43,9 +45,7 @@ struct dev_context {
 	const struct beaglelogic_ops *beaglelogic;
 
 	/* TCP Settings */
-	char *address;
-	char *port;
-	int socket;
+	struct sr_tcp_dev_inst *tcp;
 	unsigned int read_timeout;
 	unsigned char *tcp_buffer;
 
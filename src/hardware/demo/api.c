@@ -47,6 +47,13 @@ static const char *logic_pattern_str[] = {
 	"graycode",
 };
 
+/* Note: No spaces allowed because of sigrok-cli. */
+static const char *mode_str[] = {
+	[DEMO_MODE_NORMAL] = "normal",
+	[DEMO_MODE_BENCHMARK] = "benchmark",
+	[DEMO_MODE_BENCHMARK_MAX] = "benchmark-max",
+};
+
 static const uint32_t scanopts[] = {
 	SR_CONF_NUM_LOGIC_CHANNELS,
 	SR_CONF_NUM_ANALOG_CHANNELS,
@@ -69,6 +76,8 @@ static const uint32_t devopts[] = {
 	SR_CONF_AVG_SAMPLES | SR_CONF_GET | SR_CONF_SET,
 	SR_CONF_TRIGGER_MATCH | SR_CONF_LIST,
 	SR_CONF_CAPTURE_RATIO | SR_CONF_GET | SR_CONF_SET,
+	SR_CONF_DEVICE_MODE | SR_CONF_GET | SR_CONF_SET | SR_CONF_LIST,
+	SR_CONF_BUFFERSIZE | SR_CONF_GET | SR_CONF_SET,
 };
 
 static const uint32_t devopts_cg_logic[] = {
@@ -145,6 +154,8 @@ static GSList *scan(struct sr_dev_driver *di, GSList *options)
 	devc->limit_frames = limit_frames;
 	devc->capture_ratio = 20;
 	devc->stl = NULL;
+	devc->mode = DEMO_MODE_NORMAL;
+	devc->bench_packet_samples = DEFAULT_BENCH_PACKET_SAMPLES;
 
 	if (num_logic_channels > 0) {
 		/* Logic channels, all in one channel group. */
@@ -192,6 +203,7 @@ static GSList *scan(struct sr_dev_driver *di, GSList *options)
 			ag->pattern = pattern;
 			ag->avg_val = 0.0f;
 			ag->num_avgs = 0;
+			ag->bench_data = NULL;
 			g_hash_table_insert(devc->ch_ag, ch, ag);
 
 			if (++pattern == ARRAY_SIZE(analog_pattern_str))
@@ -209,6 +221,8 @@ static void clear_helper(struct dev_context *devc)
 	GHashTableIter iter;
 	void *value;
 
+	demo_bench_free(devc);
+
 	/* Analog generators. */
 	g_hash_table_iter_init(&iter, devc->ch_ag);
 	while (g_hash_table_iter_next(&iter, NULL, &value))
@@ -280,6 +294,12 @@ static int config_get(uint32_t key, GVariant **data,
 	case SR_CONF_CAPTURE_RATIO:
 		*data = g_variant_new_uint64(devc->capture_ratio);
 		break;
+	case SR_CONF_DEVICE_MODE:
+		*data = g_variant_new_string(mode_str[devc->mode]);
+		break;
+	case SR_CONF_BUFFERSIZE:
+		*data = g_variant_new_uint64(devc->bench_packet_samples);
+		break;
 	default:
 		return SR_ERR_NA;
 	}
@@ -294,7 +314,8 @@ static int config_set(uint32_t key, GVariant *data,
 	struct analog_gen *ag;
 	struct sr_channel *ch;
 	GSList *l;
-	int logic_pattern, analog_pattern;
+	int logic_pattern, analog_pattern, idx;
+	uint64_t packet_samples;
 
 	devc = sdi->priv;
 
@@ -336,11 +357,6 @@ static int config_set(uint32_t key, GVariant *data,
 				sr_dbg("Setting logic pattern to %s",
 						logic_pattern_str[logic_pattern]);
 				devc->logic_pattern = logic_pattern;
-				/* Might as well do this now, these are static. */
-				if (logic_pattern == PATTERN_ALL_LOW)
-					memset(devc->logic_data, 0x00, LOGIC_BUFSIZE);
-				else if (logic_pattern == PATTERN_ALL_HIGH)
-					memset(devc->logic_data, 0xff, LOGIC_BUFSIZE);
 			} else if (ch->type == SR_CHANNEL_ANALOG) {
 				if (analog_pattern == -1)
 					return SR_ERR_ARG;
@@ -366,6 +382,17 @@ static int config_set(uint32_t key, GVariant *data,
 	case SR_CONF_CAPTURE_RATIO:
 		devc->capture_ratio = g_variant_get_uint64(data);
 		break;
+	case SR_CONF_DEVICE_MODE:
+		if ((idx = std_str_idx(data, ARRAY_AND_SIZE(mode_str))) < 0)
+			return SR_ERR_ARG;
+		devc->mode = idx;
+		break;
+	case SR_CONF_BUFFERSIZE:
+		packet_samples = g_variant_get_uint64(data);
+		if (!packet_samples || packet_samples > BENCH_PACKET_SAMPLES_MAX)
+			return SR_ERR_ARG;
+		devc->bench_packet_samples = packet_samples;
+		break;
 	default:
 		return SR_ERR_NA;
 	}
@@ -389,6 +416,9 @@ static int config_list(uint32_t key, GVariant **data,
 		case SR_CONF_TRIGGER_MATCH:
 			*data = std_gvar_array_i32(ARRAY_AND_SIZE(trigger_matches));
 			break;
+		case SR_CONF_DEVICE_MODE:
+			*data = g_variant_new_strv(ARRAY_AND_SIZE(mode_str));
+			break;
 		default:
 			return SR_ERR_NA;
 		}
@@ -437,13 +467,22 @@ static int dev_acquisition_start(const struct sr_dev_inst *sdi)
 	GHashTableIter iter;
 	void *value;
 	struct sr_trigger *trigger;
+	int ret;
 
 	devc = sdi->priv;
 	devc->sent_samples = 0;
 	devc->sent_frame_samples = 0;
 
+	trigger = sr_session_trigger_get(sdi->session);
+	if (devc->mode != DEMO_MODE_NORMAL && (trigger || devc->avg ||
+			devc->limit_frames)) {
+		sr_warn("Triggers, averaging and frames are not supported "
+			"in benchmark modes, ignoring.");
+		trigger = NULL;
+	}
+
 	/* Setup triggers */
-	if ((trigger = sr_session_trigger_get(sdi->session))) {
+	if (trigger) {
 		int pre_trigger_samples = 0;
 		if (devc->limit_samples > 0)
 			pre_trigger_samples = (devc->capture_ratio * devc->limit_samples) / 100;
@@ -510,12 +549,20 @@ static int dev_acquisition_start(const struct sr_dev_inst *sdi)
 	while (g_hash_table_iter_next(&iter, NULL, &value))
 		demo_generate_analog_pattern(value, devc->cur_samplerate);
 
-	sr_session_source_add(sdi->session, -1, 0, 100,
+	if (devc->mode != DEMO_MODE_NORMAL) {
+		if ((ret = demo_bench_prepare((struct sr_dev_inst *)sdi)) != SR_OK)
+			return ret;
+		sr_session_source_add(sdi->session, -1, 0,
+			devc->mode == DEMO_MODE_BENCHMARK ? BENCH_PACE_MS : 0,
+			demo_bench_data, (struct sr_dev_inst *)sdi);
+	} else {
+		sr_session_source_add(sdi->session, -1, 0, 100,
 			demo_prepare_data, (struct sr_dev_inst *)sdi);
+	}
 
 	std_session_send_df_header(sdi);
 
-	if (devc->limit_frames > 0)
+	if (devc->mode == DEMO_MODE_NORMAL && devc->limit_frames > 0)
 		std_session_send_frame_begin(sdi);
 
 	/* We use this timestamp to decide how many more samples to send. */
@@ -529,12 +576,24 @@ static int dev_acquisition_start(const struct sr_dev_inst *sdi)
 static int dev_acquisition_stop(struct sr_dev_inst *sdi)
 {
 	struct dev_context *devc;
+	double secs;
 
 	sr_session_source_remove(sdi->session, -1);
 
 	devc = sdi->priv;
-	if (devc->limit_frames > 0)
+	if (devc->mode != DEMO_MODE_NORMAL) {
+		secs = (g_get_monotonic_time() - devc->start_us) /
+			(double)G_USEC_PER_SEC;
+		if (secs > 0)
+			sr_info("Sent %" PRIu64 " samples (%" PRIu64 " bytes) "
+				"in %.3f s: %.1f Msamples/s, %.1f MB/s.",
+				devc->sent_samples, devc->bench_bytes, secs,
+				devc->sent_samples / secs / 1e6,
+				devc->bench_bytes / secs / 1e6);
+	} else if (devc->limit_frames > 0) {
 		std_session_send_frame_end(sdi);
+	}
+	demo_bench_free(devc);
 
 	std_session_send_df_end(sdi);
 
@@ -258,7 +258,8 @@ static void set_logic_data(uint64_t bits, uint8_t *data, size_t len)
 	}
 }
 
-static void logic_generator(struct sr_dev_inst *sdi, uint64_t size)
+static void logic_generator(struct sr_dev_inst *sdi, uint8_t *data,
+		uint64_t size)
 {
 	struct dev_context *devc;
 	uint64_t i, j;
@@ -272,23 +273,22 @@ static void logic_generator(struct sr_dev_inst *sdi, uint64_t size)
 
 	switch (devc->logic_pattern) {
 	case PATTERN_SIGROK:
-		memset(devc->logic_data, 0x00, size);
+		memset(data, 0x00, size);
 		for (i = 0; i < size; i += devc->logic_unitsize) {
 			for (j = 0; j < devc->logic_unitsize; j++) {
 				pat = pattern_sigrok[(devc->step + j) % sizeof(pattern_sigrok)] >> 1;
-				devc->logic_data[i + j] = ~pat;
+				data[i + j] = ~pat;
 			}
 			devc->step++;
 		}
 		break;
 	case PATTERN_RANDOM:
 		for (i = 0; i < size; i++)
-			devc->logic_data[i] = (uint8_t)(rand() & 0xff);
+			data[i] = (uint8_t)(rand() & 0xff);
 		break;
 	case PATTERN_INC:
-		for (i = 0; i < size; i++) {
-			for (j = 0; j < devc->logic_unitsize; j++)
-				devc->logic_data[i + j] = devc->step;
+		for (i = 0; i < size; i += devc->logic_unitsize) {
+			memset(&data[i], devc->step, devc->logic_unitsize);
 			devc->step++;
 		}
 		break;
@@ -296,7 +296,7 @@ static void logic_generator(struct sr_dev_inst *sdi, uint64_t size)
 		/* j contains the value of the highest bit */
 		j = 1 << (devc->num_logic_channels - 1);
 		for (i = 0; i < size; i++) {
-			devc->logic_data[i] = devc->step;
+			data[i] = devc->step;
 			if (devc->step == 0)
 				devc->step = 1;
 			else
@@ -311,7 +311,7 @@ static void logic_generator(struct sr_dev_inst *sdi, uint64_t size)
 		/* j contains the value of the highest bit */
 		j = 1 << (devc->num_logic_channels - 1);
 		for (i = 0; i < size; i++) {
-			devc->logic_data[i] = ~devc->step;
+			data[i] = ~devc->step;
 			if (devc->step == 0)
 				devc->step = 1;
 			else
@@ -322,15 +322,17 @@ static void logic_generator(struct sr_dev_inst *sdi, uint64_t size)
 		}
 		break;
 	case PATTERN_ALL_LOW:
+		memset(data, 0x00, size);
+		break;
 	case PATTERN_ALL_HIGH:
-		/* These were set when the pattern mode was selected. */
+		memset(data, 0xff, size);
 		break;
 	case PATTERN_SQUID:
-		memset(devc->logic_data, 0x00, size);
+		memset(data, 0x00, size);
 		col_count = ARRAY_SIZE(pattern_squid);
 		col_height = ARRAY_SIZE(pattern_squid[0]);
 		for (i = 0; i < size; i += devc->logic_unitsize) {
-			sample = &devc->logic_data[i];
+			sample = &data[i];
 			image_col = pattern_squid[devc->step];
 			for (j = 0; j < devc->logic_unitsize; j++) {
 				pat = image_col[j % col_height];
@@ -346,7 +348,7 @@ static void logic_generator(struct sr_dev_inst *sdi, uint64_t size)
 			devc->step &= devc->all_logic_channels_mask;
 			gray = encode_number_to_gray(devc->step);
 			gray &= devc->all_logic_channels_mask;
-			set_logic_data(gray, &devc->logic_data[i], devc->logic_unitsize);
+			set_logic_data(gray, &data[i], devc->logic_unitsize);
 		}
 		break;
 	default:
@@ -521,7 +523,8 @@ SR_PRIV int demo_prepare_data(int fd, int revents, void *cb_data)
 		if (logic_done < samples_todo) {
 			sending_now = MIN(samples_todo - logic_done,
 					LOGIC_BUFSIZE / devc->logic_unitsize);
-			logic_generator(sdi, sending_now * devc->logic_unitsize);
+			logic_generator(sdi, devc->logic_data,
+				sending_now * devc->logic_unitsize);
 			/* Check for trigger and send pre-trigger data if needed */
 			if (devc->stl && (!devc->trigger_fired)) {
 				trigger_offset = soft_trigger_logic_check(devc->stl,
@@ -618,3 +621,161 @@ SR_PRIV int demo_prepare_data(int fd, int revents, void *cb_data)
 
 	return G_SOURCE_CONTINUE;
 }
+
+/*
+ * Pre-generate the buffers of the benchmark modes. The configured
+ * logic pattern and the analog waveforms get rendered once, the
+ * datafeed then just points into these buffers.
+ */
+SR_PRIV int demo_bench_prepare(struct sr_dev_inst *sdi)
+{
+	struct dev_context *devc;
+	struct sr_datafeed_logic logic;
+	struct analog_gen *ag;
+	GHashTableIter iter;
+	void *value;
+	uint64_t count, i;
+
+	devc = sdi->priv;
+	count = devc->bench_packet_samples;
+
+	if (devc->enabled_logic_channels) {
+		logic.length = count * devc->logic_unitsize;
+		logic.unitsize = devc->logic_unitsize;
+		logic.data = devc->bench_logic = g_try_malloc(logic.length);
+		if (!devc->bench_logic)
+			return SR_ERR_MALLOC;
+		logic_generator(sdi, devc->bench_logic, logic.length);
+		logic_fixup_feed(devc, &logic);
+	}
+
+	g_hash_table_iter_init(&iter, devc->ch_ag);
+	while (g_hash_table_iter_next(&iter, NULL, &value)) {
+		ag = value;
+		if (!ag->ch || !ag->ch->enabled)
+			continue;
+		ag->bench_data = g_try_malloc((count + ag->num_samples) *
+			sizeof(float));
+		if (!ag->bench_data) {
+			demo_bench_free(devc);
+			return SR_ERR_MALLOC;
+		}
+		for (i = 0; i < count + ag->num_samples; i++)
+			ag->bench_data[i] = ag->pattern_data[i % ag->num_samples];
+	}
+
+	devc->bench_bytes = 0;
+
+	return SR_OK;
+}
+
+SR_PRIV void demo_bench_free(struct dev_context *devc)
+{
+	struct analog_gen *ag;
+	GHashTableIter iter;
+	void *value;
+
+	g_free(devc->bench_logic);
+	devc->bench_logic = NULL;
+
+	g_hash_table_iter_init(&iter, devc->ch_ag);
+	while (g_hash_table_iter_next(&iter, NULL, &value)) {
+		ag = value;
+		g_free(ag->bench_data);
+		ag->bench_data = NULL;
+	}
+}
+
+static void bench_send_packet(struct sr_dev_inst *sdi, uint64_t num_samples)
+{
+	struct dev_context *devc;
+	struct sr_datafeed_packet packet;
+	struct sr_datafeed_logic logic;
+	struct analog_gen *ag;
+	GHashTableIter iter;
+	void *value;
+
+	devc = sdi->priv;
+
+	if (devc->bench_logic) {
+		logic.length = num_samples * devc->logic_unitsize;
+		logic.unitsize = devc->logic_unitsize;
+		logic.data = devc->bench_logic;
+		packet.type = SR_DF_LOGIC;
+		packet.payload = &logic;
+		sr_session_send(sdi, &packet);
+		devc->bench_bytes += logic.length;
+	}
+
+	g_hash_table_iter_init(&iter, devc->ch_ag);
+	while (g_hash_table_iter_next(&iter, NULL, &value)) {
+		ag = value;
+		if (!ag->bench_data)
+			continue;
+		/* Continue the waveform where the previous packet ended. */
+		ag->packet.data = ag->bench_data +
+			devc->sent_samples % ag->num_samples;
+		ag->packet.num_samples = num_samples;
+		packet.type = SR_DF_ANALOG;
+		packet.payload = &ag->packet;
+		sr_session_send(sdi, &packet);
+		devc->bench_bytes += num_samples * sizeof(float);
+	}
+
+	devc->sent_samples += num_samples;
+}
+
+/* Callback of the benchmark modes. */
+SR_PRIV int demo_bench_data(int fd, int revents, void *cb_data)
+{
+	struct sr_dev_inst *sdi;
+	struct dev_context *devc;
+	uint64_t due, samples_todo, sending_now;
+	int64_t elapsed_us, limit_us, deadline;
+
+	(void)fd;
+	(void)revents;
+
+	sdi = cb_data;
+	devc = sdi->priv;
+
+	elapsed_us = g_get_monotonic_time() - devc->start_us;
+	limit_us = 1000 * devc->limit_msec;
+	if (limit_us > 0 && elapsed_us >= limit_us) {
+		sr_dbg("Requested time limit reached.");
+		sr_dev_acquisition_stop(sdi);
+		return G_SOURCE_CONTINUE;
+	}
+
+	if (devc->mode == DEMO_MODE_BENCHMARK) {
+		/* Whatever is due at the samplerate by now. */
+		due = elapsed_us / G_USEC_PER_SEC * devc->cur_samplerate +
+			elapsed_us % G_USEC_PER_SEC * devc->cur_samplerate /
+			G_USEC_PER_SEC;
+		samples_todo = due > devc->sent_samples ?
+			due - devc->sent_samples : 0;
+		deadline = G_MAXINT64;
+	} else {
+		/* As much as fits into a time slice. */
+		samples_todo = G_MAXUINT64;
+		deadline = g_get_monotonic_time() + BENCH_SLICE_MS * 1000;
+	}
+	if (devc->limit_samples > 0)
+		samples_todo = MIN(samples_todo,
+			devc->limit_samples - devc->sent_samples);
+
+	while (samples_todo > 0) {
+		sending_now = MIN(samples_todo, devc->bench_packet_samples);
+		bench_send_packet(sdi, sending_now);
+		samples_todo -= sending_now;
+		if (g_get_monotonic_time() >= deadline)
+			break;
+	}
+
+	if (devc->limit_samples > 0 && devc->sent_samples >= devc->limit_samples) {
+		sr_dbg("Requested number of samples reached.");
+		sr_dev_acquisition_stop(sdi);
+	}
+
+	return G_SOURCE_CONTINUE;
+}
@@ -36,6 +36,13 @@
 /* This is a development feature: it starts a new frame every n samples. */
 #define SAMPLES_PER_FRAME		1000UL
 #define DEFAULT_LIMIT_FRAMES		0
+/* Samples per datafeed packet in the benchmark modes. */
+#define DEFAULT_BENCH_PACKET_SAMPLES	(64 * 1024)
+#define BENCH_PACKET_SAMPLES_MAX	(16 * 1024 * 1024)
+/* Timer period of the paced benchmark mode. */
+#define BENCH_PACE_MS			10
+/* Return to the main loop after this long in the unthrottled mode. */
+#define BENCH_SLICE_MS			50
 
 /* Logic patterns we can generate. */
 enum logic_pattern_type {
@@ -83,6 +90,19 @@ enum logic_pattern_type {
 	PATTERN_GRAYCODE,
 };
 
+/* Modes of operation. */
+enum demo_mode {
+	/* Generate patterns on the fly, paced at the samplerate. */
+	DEMO_MODE_NORMAL,
+	/*
+	 * Send pre-generated buffers of a configurable packet size,
+	 * paced at the samplerate (BENCHMARK) or as fast as the
+	 * session accepts them (BENCHMARK_MAX).
+	 */
+	DEMO_MODE_BENCHMARK,
+	DEMO_MODE_BENCHMARK_MAX,
+};
+
 /* Analog patterns we can generate. */
 enum analog_pattern_type {
 	PATTERN_SQUARE,
@@ -121,6 +141,11 @@ struct dev_context {
 	uint64_t capture_ratio;
 	gboolean trigger_fired;
 	struct soft_trigger_logic *stl;
+	/* Benchmark modes */
+	enum demo_mode mode;
+	uint64_t bench_packet_samples;
+	uint8_t *bench_logic;
+	uint64_t bench_bytes;
 };
 
 static const char *analog_pattern_str[] = {
@@ -142,9 +167,14 @@ struct analog_gen {
 	struct sr_analog_spec spec;
 	float avg_val; /* Average value */
 	unsigned int num_avgs; /* Number of samples averaged */
+	/* The pattern repeated to cover a benchmark packet at any offset. */
+	float *bench_data;
 };
 
 SR_PRIV void demo_generate_analog_pattern(struct analog_gen *ag, uint64_t sample_rate);
 SR_PRIV int demo_prepare_data(int fd, int revents, void *cb_data);
+SR_PRIV int demo_bench_prepare(struct sr_dev_inst *sdi);
+SR_PRIV void demo_bench_free(struct dev_context *devc);
+SR_PRIV int demo_bench_data(int fd, int revents, void *cb_data);
 
 #endif
@@ -65,6 +65,7 @@ static const uint32_t devopts[] = {
 	SR_CONF_CAPTURE_RATIO | SR_CONF_GET | SR_CONF_SET,
 	SR_CONF_EXTERNAL_CLOCK | SR_CONF_GET | SR_CONF_SET,
 	SR_CONF_CLOCK_EDGE | SR_CONF_GET | SR_CONF_SET | SR_CONF_LIST,
+	SR_CONF_OVERFLOW_RISK | SR_CONF_GET,
 };
 
 static const int32_t trigger_matches[] = {
@@ -445,6 +446,9 @@ static int config_get(uint32_t key, GVariant **data,
 			return SR_ERR_BUG;
 		*data = g_variant_new_string(signal_edges[0]);
 		break;
+	case SR_CONF_OVERFLOW_RISK:
+		*data = g_variant_new_boolean(devc->sched.overflow_risk);
+		break;
 	default:
 		return SR_ERR_NA;
 	}
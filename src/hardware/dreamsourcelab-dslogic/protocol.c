@@ -712,40 +712,118 @@ static void free_transfer(struct libusb_transfer *transfer)
 		finish_acquisition(sdi);
 }
 
+static void LIBUSB_CALL receive_transfer(struct libusb_transfer *transfer);
+
+static int submit_new_transfer(const struct sr_dev_inst *sdi)
+{
+	struct dev_context *const devc = sdi->priv;
+	struct sr_usb_dev_inst *const usb = sdi->conn;
+	struct libusb_transfer *transfer;
+	unsigned char *buf;
+	unsigned int i;
+	int ret;
+
+	for (i = 0; i < devc->num_transfers; i++)
+		if (!devc->transfers[i])
+			break;
+	if (i == devc->num_transfers)
+		return SR_ERR_BUG;
+
+	if (!(buf = g_try_malloc(devc->sched.buffer_size))) {
+		sr_err("USB transfer buffer malloc failed.");
+		return SR_ERR_MALLOC;
+	}
+	transfer = libusb_alloc_transfer(0);
+	libusb_fill_bulk_transfer(transfer, usb->devhdl,
+			6 | LIBUSB_ENDPOINT_IN, buf, devc->sched.buffer_size,
+			receive_transfer, (void *)sdi,
+			sr_usb_xfer_sched_timeout(&devc->sched));
+	sr_info("submitting transfer: %d", i);
+	if ((ret = libusb_submit_transfer(transfer)) != 0) {
+		sr_err("Failed to submit transfer: %s.",
+		       libusb_error_name(ret));
+		libusb_free_transfer(transfer);
+		g_free(buf);
+		return SR_ERR;
+	}
+	devc->transfers[i] = transfer;
+	devc->submitted_transfers++;
+
+	return SR_OK;
+}
+
 static void resubmit_transfer(struct libusb_transfer *transfer)
 {
+	struct sr_dev_inst *const sdi = transfer->user_data;
+	struct dev_context *const devc = sdi->priv;
+	unsigned char *buf;
 	int ret;
 
-	if ((ret = libusb_submit_transfer(transfer)) == LIBUSB_SUCCESS)
+	/* The scheduler shrunk the queue, retire this transfer. */
+	if ((unsigned int)devc->submitted_transfers > devc->sched.num_transfers) {
+		free_transfer(transfer);
+		return;
+	}
+
+	/* The scheduler changed the transfer size. */
+	if ((size_t)transfer->length != devc->sched.buffer_size &&
+			(buf = g_try_malloc(devc->sched.buffer_size))) {
+		g_free(transfer->buffer);
+		transfer->buffer = buf;
+		transfer->length = devc->sched.buffer_size;
+		transfer->timeout = sr_usb_xfer_sched_timeout(&devc->sched);
+	}
+
+	if ((ret = libusb_submit_transfer(transfer)) != LIBUSB_SUCCESS) {
+		sr_err("%s: %s", __func__, libusb_error_name(ret));
+		free_transfer(transfer);
 		return;
+	}
+
+	/* The scheduler grew the queue. */
+	while ((unsigned int)devc->submitted_transfers < devc->sched.num_transfers)
+		if (submit_new_transfer(sdi) != SR_OK)
+			break;
+}
+
+/* Make sure the deinterleave buffer can hold a transfer of this size. */
+static int reserve_deinterleave_buffer(const struct sr_dev_inst *sdi,
+	size_t size)
+{
+	struct dev_context *const devc = sdi->priv;
+	const size_t channel_count = enabled_channel_count(sdi);
+	uint16_t *buf;
 
-	sr_err("%s: %s", __func__, libusb_error_name(ret));
-	free_transfer(transfer);
+	if (size <= devc->deinterleave_size)
+		return SR_OK;
 
+	buf = g_try_malloc(DSLOGIC_ATOMIC_SAMPLES *
+		(size / (channel_count * DSLOGIC_ATOMIC_BYTES)) * sizeof(uint16_t));
+	if (!buf) {
+		sr_err("Deinterleave buffer malloc failed.");
+		return SR_ERR_MALLOC;
+	}
+	g_free(devc->deinterleave_buffer);
+	devc->deinterleave_buffer = buf;
+	devc->deinterleave_size = size;
+
+	return SR_OK;
 }
 
 static void deinterleave_buffer(const uint8_t *src, size_t length,
 	uint16_t *dst_ptr, size_t channel_count, uint16_t channel_mask)
 {
-	uint16_t sample;
-
-	for (const uint64_t *src_ptr = (uint64_t*)src;
-		src_ptr < (uint64_t*)(src + length);
-		src_ptr += channel_count) {
-		for (int bit = 0; bit != 64; bit++) {
-			const uint64_t *word_ptr = src_ptr;
-			sample = 0;
-			for (unsigned int channel = 0; channel != 16;
-				channel++) {
-				const uint16_t m = channel_mask >> channel;
-				if (!m)
-					break;
-				if ((m & 1) && ((*word_ptr++ >> bit) & UINT64_C(1)))
-					sample |= 1 << channel;
-			}
-			*dst_ptr++ = sample;
-		}
-	}
+	uint16_t masks[16];
+	unsigned int channel, plane;
+
+	/* Each block holds a 64-bit plane per enabled channel. */
+	plane = 0;
+	for (channel = 0; channel != 16; channel++)
+		if (channel_mask & (1 << channel))
+			masks[plane++] = 1 << channel;
+
+	sr_logic_transpose16(dst_ptr, src, length / (channel_count * 8),
+		channel_count, sizeof(uint64_t), masks, FALSE);
 }
 
 static void send_data(struct sr_dev_inst *sdi,
@@ -779,6 +857,7 @@ static void LIBUSB_CALL receive_transfer(struct libusb_transfer *transfer)
 	struct sr_datafeed_packet packet;
 	unsigned int num_samples;
 	int trigger_offset;
+	gint64 start;
 
 	/*
 	 * If acquisition has already ended, just free any queued up
@@ -789,6 +868,8 @@ static void LIBUSB_CALL receive_transfer(struct libusb_transfer *transfer)
 		return;
 	}
 
+	start = sr_usb_xfer_sched_begin(&devc->sched);
+
 	sr_dbg("receive_transfer(): status %s received %d bytes.",
 		libusb_error_name(transfer->status), transfer->actual_length);
 
@@ -843,6 +924,11 @@ static void LIBUSB_CALL receive_transfer(struct libusb_transfer *transfer)
 		 */
 		if (transfer->actual_length % (DSLOGIC_ATOMIC_BYTES * channel_count) != 0)
 			sr_err("Invalid transfer length!");
+		if (reserve_deinterleave_buffer(sdi, transfer->actual_length) != SR_OK) {
+			abort_acquisition(devc);
+			free_transfer(transfer);
+			return;
+		}
 		deinterleave_buffer(transfer->buffer, transfer->actual_length,
 			devc->deinterleave_buffer, channel_count, channel_mask);
 
@@ -873,8 +959,10 @@ static void LIBUSB_CALL receive_transfer(struct libusb_transfer *transfer)
 	if (devc->limit_samples && devc->sent_samples >= devc->limit_samples) {
 		abort_acquisition(devc);
 		free_transfer(transfer);
-	} else
+	} else {
+		sr_usb_xfer_sched_end(&devc->sched, start);
 		resubmit_transfer(transfer);
+	}
 }
 
 static int receive_data(int fd, int revents, void *cb_data)
@@ -908,93 +996,53 @@ static size_t to_bytes_per_ms(const struct sr_dev_inst *sdi)
 	return 35000000 / (1000 * 10);
 }
 
-static size_t get_buffer_size(const struct sr_dev_inst *sdi)
+static void init_transfer_sched(const struct sr_dev_inst *sdi)
 {
+	struct dev_context *const devc = sdi->priv;
+
 	/*
-	 * The buffer should be large enough to hold 10ms of data and
-	 * a multiple of the size of a data atom.
+	 * Start with buffers holding 10ms of data each, and about 100ms
+	 * of data in total. Buffer sizes must be a multiple of the size
+	 * of a data atom.
 	 */
-	const size_t block_size = enabled_channel_count(sdi) * 512;
-	const size_t s = 10 * to_bytes_per_ms(sdi);
-	if (!block_size)
-		return s;
-	return ((s + block_size - 1) / block_size) * block_size;
-}
-
-static unsigned int get_number_of_transfers(const struct sr_dev_inst *sdi)
-{
-	/* Total buffer size should be able to hold about 100ms of data. */
-	const unsigned int s = get_buffer_size(sdi);
-	const unsigned int n = (100 * to_bytes_per_ms(sdi) + s - 1) / s;
-	return (n > NUM_SIMUL_TRANSFERS) ? NUM_SIMUL_TRANSFERS : n;
-}
-
-static unsigned int get_timeout(const struct sr_dev_inst *sdi)
-{
-	const size_t total_size = get_buffer_size(sdi) *
-		get_number_of_transfers(sdi);
-	const unsigned int timeout = total_size / to_bytes_per_ms(sdi);
-	return timeout + timeout / 4; /* Leave a headroom of 25% percent. */
+	sr_usb_xfer_sched_init(&devc->sched,
+		MAX(enabled_channel_count(sdi), 1) * 512, to_bytes_per_ms(sdi),
+		10, 100, MAX_TRANSFER_MEMORY, NUM_SIMUL_TRANSFERS,
+		MAX_TRANSFER_MEMORY);
 }
 
 static int start_transfers(const struct sr_dev_inst *sdi)
 {
-	const size_t channel_count = enabled_channel_count(sdi);
-	const size_t size = get_buffer_size(sdi);
-	const unsigned int num_transfers = get_number_of_transfers(sdi);
-	const unsigned int timeout = get_timeout(sdi);
-
 	struct dev_context *devc;
-	struct sr_usb_dev_inst *usb;
-	struct libusb_transfer *transfer;
 	unsigned int i;
-	int ret;
-	unsigned char *buf;
 
 	devc = sdi->priv;
-	usb = sdi->conn;
 
 	devc->sent_samples = 0;
 	devc->acq_aborted = FALSE;
 	devc->empty_transfer_count = 0;
 	devc->submitted_transfers = 0;
 
+	/* Leave room for the scheduler to add transfers later on. */
 	g_free(devc->transfers);
-	devc->transfers = g_try_malloc0(sizeof(*devc->transfers) * num_transfers);
+	devc->transfers = g_try_malloc0(sizeof(*devc->transfers) *
+		devc->sched.max_transfers);
 	if (!devc->transfers) {
 		sr_err("USB transfers malloc failed.");
 		return SR_ERR_MALLOC;
 	}
 
-	devc->deinterleave_buffer = g_try_malloc(DSLOGIC_ATOMIC_SAMPLES *
-		(size / (channel_count * DSLOGIC_ATOMIC_BYTES)) * sizeof(uint16_t));
-	if (!devc->deinterleave_buffer) {
-		sr_err("Deinterleave buffer malloc failed.");
-		g_free(devc->deinterleave_buffer);
+	devc->deinterleave_buffer = NULL;
+	devc->deinterleave_size = 0;
+	if (reserve_deinterleave_buffer(sdi, devc->sched.buffer_size) != SR_OK)
 		return SR_ERR_MALLOC;
-	}
 
-	devc->num_transfers = num_transfers;
-	for (i = 0; i < num_transfers; i++) {
-		if (!(buf = g_try_malloc(size))) {
-			sr_err("USB transfer buffer malloc failed.");
-			return SR_ERR_MALLOC;
-		}
-		transfer = libusb_alloc_transfer(0);
-		libusb_fill_bulk_transfer(transfer, usb->devhdl,
-				6 | LIBUSB_ENDPOINT_IN, buf, size,
-				receive_transfer, (void *)sdi, timeout);
-		sr_info("submitting transfer: %d", i);
-		if ((ret = libusb_submit_transfer(transfer)) != 0) {
-			sr_err("Failed to submit transfer: %s.",
-			       libusb_error_name(ret));
-			libusb_free_transfer(transfer);
-			g_free(buf);
+	devc->num_transfers = devc->sched.max_transfers;
+	for (i = 0; i < devc->sched.num_transfers; i++) {
+		if (submit_new_transfer(sdi) != SR_OK) {
 			abort_acquisition(devc);
 			return SR_ERR;
 		}
-		devc->transfers[i] = transfer;
-		devc->submitted_transfers++;
 	}
 
 	std_session_send_df_header(sdi);
@@ -1031,8 +1079,6 @@ static void LIBUSB_CALL trigger_receive(struct libusb_transfer *transfer)
 
 SR_PRIV int dslogic_acquisition_start(const struct sr_dev_inst *sdi)
 {
-	const unsigned int timeout = get_timeout(sdi);
-
 	struct sr_dev_driver *di;
 	struct drv_context *drvc;
 	struct dev_context *devc;
@@ -1051,7 +1097,9 @@ SR_PRIV int dslogic_acquisition_start(const struct sr_dev_inst *sdi)
 	devc->empty_transfer_count = 0;
 	devc->acq_aborted = FALSE;
 
-	usb_source_add(sdi->session, devc->ctx, timeout, receive_data, drvc);
+	init_transfer_sched(sdi);
+	usb_source_add(sdi->session, devc->ctx,
+		sr_usb_xfer_sched_timeout(&devc->sched), receive_data, drvc);
 
 	if ((ret = command_stop_acquisition(sdi)) != SR_OK)
 		return ret;
@@ -37,6 +37,8 @@
 #define MAX_RENUM_DELAY_MS	3000
 #define NUM_SIMUL_TRANSFERS	32
 #define MAX_EMPTY_TRANSFERS	(NUM_SIMUL_TRANSFERS * 2)
+/* Memory budget for all transfer buffers together. */
+#define MAX_TRANSFER_MEMORY	(32 * 1024 * 1024)
 
 #define NUM_CHANNELS		16
 #define NUM_TRIGGER_STAGES	16
@@ -130,9 +132,12 @@ struct dev_context {
 
 	unsigned int num_transfers;
 	struct libusb_transfer **transfers;
+	struct sr_usb_xfer_sched sched;
 	struct sr_context *ctx;
 
 	uint16_t *deinterleave_buffer;
+	/* Largest transfer the deinterleave buffer can hold. */
+	size_t deinterleave_size;
 
 	uint16_t mode;
 	uint32_t trigger_pos;
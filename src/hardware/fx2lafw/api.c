@@ -130,6 +130,7 @@ static const uint32_t devopts[] = {
 	SR_CONF_SAMPLERATE | SR_CONF_GET | SR_CONF_SET | SR_CONF_LIST,
 	SR_CONF_TRIGGER_MATCH | SR_CONF_LIST,
 	SR_CONF_CAPTURE_RATIO | SR_CONF_GET | SR_CONF_SET,
+	SR_CONF_OVERFLOW_RISK | SR_CONF_GET,
 };
 
 static const int32_t trigger_matches[] = {
@@ -499,6 +500,9 @@ static int config_get(uint32_t key, GVariant **data,
 	case SR_CONF_CAPTURE_RATIO:
 		*data = g_variant_new_uint64(devc->capture_ratio);
 		break;
+	case SR_CONF_OVERFLOW_RISK:
+		*data = g_variant_new_boolean(devc->sched.overflow_risk);
+		break;
 	default:
 		return SR_ERR_NA;
 	}
@@ -302,6 +302,8 @@ static void finish_acquisition(struct sr_dev_inst *sdi)
 	}
 }
 
+static void LIBUSB_CALL receive_transfer(struct libusb_transfer *transfer);
+
 static void free_transfer(struct libusb_transfer *transfer)
 {
 	struct sr_dev_inst *sdi;
@@ -327,16 +329,82 @@ static void free_transfer(struct libusb_transfer *transfer)
 		finish_acquisition(sdi);
 }
 
+static int submit_new_transfer(const struct sr_dev_inst *sdi)
+{
+	struct dev_context *devc;
+	struct sr_usb_dev_inst *usb;
+	struct libusb_transfer *transfer;
+	unsigned char *buf;
+	unsigned int i;
+	int ret;
+
+	devc = sdi->priv;
+	usb = sdi->conn;
+
+	for (i = 0; i < devc->num_transfers; i++)
+		if (!devc->transfers[i])
+			break;
+	if (i == devc->num_transfers)
+		return SR_ERR_BUG;
+
+	if (!(buf = g_try_malloc(devc->sched.buffer_size))) {
+		sr_err("USB transfer buffer malloc failed.");
+		return SR_ERR_MALLOC;
+	}
+	transfer = libusb_alloc_transfer(0);
+	libusb_fill_bulk_transfer(transfer, usb->devhdl,
+			2 | LIBUSB_ENDPOINT_IN, buf, devc->sched.buffer_size,
+			receive_transfer, (void *)sdi,
+			sr_usb_xfer_sched_timeout(&devc->sched));
+	sr_info("submitting transfer: %d", i);
+	if ((ret = libusb_submit_transfer(transfer)) != 0) {
+		sr_err("Failed to submit transfer: %s.",
+		       libusb_error_name(ret));
+		libusb_free_transfer(transfer);
+		g_free(buf);
+		return SR_ERR;
+	}
+	devc->transfers[i] = transfer;
+	devc->submitted_transfers++;
+
+	return SR_OK;
+}
+
 static void resubmit_transfer(struct libusb_transfer *transfer)
 {
+	struct sr_dev_inst *sdi;
+	struct dev_context *devc;
+	unsigned char *buf;
 	int ret;
 
-	if ((ret = libusb_submit_transfer(transfer)) == LIBUSB_SUCCESS)
+	sdi = transfer->user_data;
+	devc = sdi->priv;
+
+	/* The scheduler shrunk the queue, retire this transfer. */
+	if ((unsigned int)devc->submitted_transfers > devc->sched.num_transfers) {
+		free_transfer(transfer);
 		return;
+	}
+
+	/* The scheduler changed the transfer size. */
+	if ((size_t)transfer->length != devc->sched.buffer_size &&
+			(buf = g_try_malloc(devc->sched.buffer_size))) {
+		g_free(transfer->buffer);
+		transfer->buffer = buf;
+		transfer->length = devc->sched.buffer_size;
+		transfer->timeout = sr_usb_xfer_sched_timeout(&devc->sched);
+	}
 
-	sr_err("%s: %s", __func__, libusb_error_name(ret));
-	free_transfer(transfer);
+	if ((ret = libusb_submit_transfer(transfer)) != LIBUSB_SUCCESS) {
+		sr_err("%s: %s", __func__, libusb_error_name(ret));
+		free_transfer(transfer);
+		return;
+	}
 
+	/* The scheduler grew the queue. */
+	while ((unsigned int)devc->submitted_transfers < devc->sched.num_transfers)
+		if (submit_new_transfer(sdi) != SR_OK)
+			break;
 }
 
 static void mso_send_data_proc(struct sr_dev_inst *sdi,
@@ -416,6 +484,7 @@ static void LIBUSB_CALL receive_transfer(struct libusb_transfer *transfer)
 	unsigned int num_samples;
 	int trigger_offset, cur_sample_count, unitsize;
 	int pre_trigger_samples;
+	gint64 start;
 
 	sdi = transfer->user_data;
 	devc = sdi->priv;
@@ -429,6 +498,8 @@ static void LIBUSB_CALL receive_transfer(struct libusb_transfer *transfer)
 		return;
 	}
 
+	start = sr_usb_xfer_sched_begin(&devc->sched);
+
 	sr_dbg("receive_transfer(): status %s received %d bytes.",
 		libusb_error_name(transfer->status), transfer->actual_length);
 
@@ -499,8 +570,10 @@ static void LIBUSB_CALL receive_transfer(struct libusb_transfer *transfer)
 	if (devc->limit_samples && devc->sent_samples >= devc->limit_samples) {
 		fx2lafw_abort_acquisition(devc);
 		free_transfer(transfer);
-	} else
+	} else {
+		sr_usb_xfer_sched_end(&devc->sched, start);
 		resubmit_transfer(transfer);
+	}
 }
 
 static int configure_channels(const struct sr_dev_inst *sdi)
@@ -542,41 +615,24 @@ static unsigned int to_bytes_per_ms(unsigned int samplerate)
 	return samplerate / 1000;
 }
 
-static size_t get_buffer_size(struct dev_context *devc)
+static void init_transfer_sched(struct dev_context *devc)
 {
-	size_t s;
+	size_t bytes_per_ms, max_buffer_size;
+
+	bytes_per_ms = to_bytes_per_ms(devc->cur_samplerate);
+	if (devc->sample_wide)
+		bytes_per_ms *= 2;
 
 	/*
-	 * The buffer should be large enough to hold 10ms of data and
-	 * a multiple of 512.
+	 * Start with buffers holding 10ms of data each, and about 500ms
+	 * of data in total. The analog buffers are sized after the
+	 * initial transfer size, so transfers mustn't grow in that case.
 	 */
-	s = 10 * to_bytes_per_ms(devc->cur_samplerate);
-	return (s + 511) & ~511;
-}
-
-static unsigned int get_number_of_transfers(struct dev_context *devc)
-{
-	unsigned int n;
-
-	/* Total buffer size should be able to hold about 500ms of data. */
-	n = (500 * to_bytes_per_ms(devc->cur_samplerate) /
-		get_buffer_size(devc));
-
-	if (n > NUM_SIMUL_TRANSFERS)
-		return NUM_SIMUL_TRANSFERS;
-
-	return n;
-}
-
-static unsigned int get_timeout(struct dev_context *devc)
-{
-	size_t total_size;
-	unsigned int timeout;
-
-	total_size = get_buffer_size(devc) *
-			get_number_of_transfers(devc);
-	timeout = total_size / to_bytes_per_ms(devc->cur_samplerate);
-	return timeout + timeout / 4; /* Leave a headroom of 25% percent. */
+	max_buffer_size = MAX_TRANSFER_MEMORY;
+	if (g_slist_length(devc->enabled_analog_channels) > 0)
+		max_buffer_size = 10 * bytes_per_ms;
+	sr_usb_xfer_sched_init(&devc->sched, 512, bytes_per_ms, 10, 500,
+		max_buffer_size, NUM_SIMUL_TRANSFERS, MAX_TRANSFER_MEMORY);
 }
 
 static int receive_data(int fd, int revents, void *cb_data)
@@ -598,16 +654,10 @@ static int receive_data(int fd, int revents, void *cb_data)
 static int start_transfers(const struct sr_dev_inst *sdi)
 {
 	struct dev_context *devc;
-	struct sr_usb_dev_inst *usb;
 	struct sr_trigger *trigger;
-	struct libusb_transfer *transfer;
-	unsigned int i, num_transfers;
-	int timeout, ret;
-	unsigned char *buf;
-	size_t size;
+	unsigned int i;
 
 	devc = sdi->priv;
-	usb = sdi->conn;
 
 	devc->sent_samples = 0;
 	devc->acq_aborted = FALSE;
@@ -624,39 +674,22 @@ static int start_transfers(const struct sr_dev_inst *sdi)
 	} else
 		devc->trigger_fired = TRUE;
 
-	num_transfers = get_number_of_transfers(devc);
-
-	size = get_buffer_size(devc);
 	devc->submitted_transfers = 0;
 
-	devc->transfers = g_try_malloc0(sizeof(*devc->transfers) * num_transfers);
+	/* Leave room for the scheduler to add transfers later on. */
+	devc->transfers = g_try_malloc0(sizeof(*devc->transfers) *
+			devc->sched.max_transfers);
 	if (!devc->transfers) {
 		sr_err("USB transfers malloc failed.");
 		return SR_ERR_MALLOC;
 	}
 
-	timeout = get_timeout(devc);
-	devc->num_transfers = num_transfers;
-	for (i = 0; i < num_transfers; i++) {
-		if (!(buf = g_try_malloc(size))) {
-			sr_err("USB transfer buffer malloc failed.");
-			return SR_ERR_MALLOC;
-		}
-		transfer = libusb_alloc_transfer(0);
-		libusb_fill_bulk_transfer(transfer, usb->devhdl,
-				2 | LIBUSB_ENDPOINT_IN, buf, size,
-				receive_transfer, (void *)sdi, timeout);
-		sr_info("submitting transfer: %d", i);
-		if ((ret = libusb_submit_transfer(transfer)) != 0) {
-			sr_err("Failed to submit transfer: %s.",
-			       libusb_error_name(ret));
-			libusb_free_transfer(transfer);
-			g_free(buf);
+	devc->num_transfers = devc->sched.max_transfers;
+	for (i = 0; i < devc->sched.num_transfers; i++) {
+		if (submit_new_transfer(sdi) != SR_OK) {
 			fx2lafw_abort_acquisition(devc);
 			return SR_ERR;
 		}
-		devc->transfers[i] = transfer;
-		devc->submitted_transfers++;
 	}
 
 	/*
@@ -696,10 +729,11 @@ SR_PRIV int fx2lafw_start_acquisition(const struct sr_dev_inst *sdi)
 		return SR_ERR;
 	}
 
-	timeout = get_timeout(devc);
+	init_transfer_sched(devc);
+	timeout = sr_usb_xfer_sched_timeout(&devc->sched);
 	usb_source_add(sdi->session, devc->ctx, timeout, receive_data, drvc);
 
-	size = get_buffer_size(devc);
+	size = devc->sched.buffer_size;
 	/* Prepare for analog sampling. */
 	if (g_slist_length(devc->enabled_analog_channels) > 0) {
 		/* We need a buffer half the size of a transfer. */
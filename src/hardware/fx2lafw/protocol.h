@@ -38,6 +38,8 @@
 #define MAX_RENUM_DELAY_MS	3000
 #define NUM_SIMUL_TRANSFERS	32
 #define MAX_EMPTY_TRANSFERS	(NUM_SIMUL_TRANSFERS * 2)
+/* Memory budget for all transfer buffers together. */
+#define MAX_TRANSFER_MEMORY	(32 * 1024 * 1024)
 
 #define NUM_CHANNELS		16
 
@@ -116,6 +118,7 @@ struct dev_context {
 
 	unsigned int num_transfers;
 	struct libusb_transfer **transfers;
+	struct sr_usb_xfer_sched sched;
 	struct sr_context *ctx;
 	void (*send_data_proc)(struct sr_dev_inst *sdi,
 		uint8_t *data, size_t length, size_t sample_width);
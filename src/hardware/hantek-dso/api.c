@@ -257,6 +257,7 @@ static void clear_helper(struct dev_context *devc)
 {
 	g_free(devc->triggersource);
 	g_slist_free(devc->enabled_channels);
+	dso_free_channeldata(devc);
 }
 
 static int dev_clear(const struct sr_dev_driver *di)
@@ -639,8 +640,25 @@ static int config_list(uint32_t key, GVariant **data,
 	return SR_OK;
 }
 
-static void send_chunk(struct sr_dev_inst *sdi, unsigned char *buf,
-		int num_samples)
+/*
+ * Voltage values are encoded as a value 0-255 (0-512 on the DSO-5200*),
+ * where the value is a point in the range represented by the vdiv setting.
+ * There are 8 vertical divs, so e.g. 500mV/div represents 4V peak-to-peak
+ * where 0 = -2V and 255 = +2V.
+ *
+ * The device always sends data for both channels, interleaved. If a channel
+ * is disabled, it contains a copy of the enabled channel's data.
+ */
+static void convert_samples(float *dst, const unsigned char *src,
+		unsigned int num_samples, float scale, float offset)
+{
+	unsigned int i;
+
+	for (i = 0; i < num_samples; i++)
+		dst[i] = src[i * 2] * scale + offset;
+}
+
+static void send_frame(struct sr_dev_inst *sdi)
 {
 	struct sr_datafeed_packet packet;
 	struct sr_datafeed_analog analog;
@@ -649,17 +667,27 @@ static void send_chunk(struct sr_dev_inst *sdi, unsigned char *buf,
 	struct sr_analog_spec spec;
 	struct dev_context *devc = sdi->priv;
 	GSList *channels = devc->enabled_channels;
+	unsigned int pre, post;
+
+	/*
+	 * The device always sends a full frame, but the beginning of the frame
+	 * doesn't represent the trigger point. The offset at which the trigger
+	 * happened came in with the capture state. The samples before that
+	 * point came after the end of the device's frame buffer was reached,
+	 * and it wrapped around to overwrite up until the trigger point.
+	 */
+	pre = devc->trigger_offset < devc->framesize ? devc->trigger_offset : 0;
+	post = devc->framesize - pre;
 
 	packet.type = SR_DF_ANALOG;
 	packet.payload = &analog;
 	/* TODO: support for 5xxx series 9-bit samples */
 	sr_analog_init(&analog, &encoding, &meaning, &spec, 0);
-	analog.num_samples = num_samples;
+	analog.num_samples = devc->framesize;
 	analog.meaning->mq = SR_MQ_VOLTAGE;
 	analog.meaning->unit = SR_UNIT_VOLT;
 	analog.meaning->mqflags = 0;
-	/* TODO: Check malloc return value. */
-	analog.data = g_try_malloc(num_samples * sizeof(float));
+	analog.data = devc->samples;
 
 	for (int ch = 0; ch < NUM_CHANNELS; ch++) {
 		if (!devc->ch_enabled[ch])
@@ -672,125 +700,68 @@ static void send_chunk(struct sr_dev_inst *sdi, unsigned char *buf,
 		analog.spec->spec_digits = digits;
 		analog.meaning->channels = g_slist_append(NULL, channels->data);
 
-		for (int i = 0; i < num_samples; i++) {
-			/*
-			 * The device always sends data for both channels. If a channel
-			 * is disabled, it contains a copy of the enabled channel's
-			 * data. However, we only send the requested channels to
-			 * the bus.
-			 *
-			 * Voltage values are encoded as a value 0-255 (0-512 on the
-			 * DSO-5200*), where the value is a point in the range
-			 * represented by the vdiv setting. There are 8 vertical divs,
-			 * so e.g. 500mV/div represents 4V peak-to-peak where 0 = -2V
-			 * and 255 = +2V.
-			 */
-			/* TODO: Support for DSO-5xxx series 9-bit samples. */
-			((float *)analog.data)[i] = range / 255 * *(buf + i * 2 + 1 - ch) - range / 2;
-		}
+		/* Trigger point first, then the wrapped-around part. */
+		convert_samples(devc->samples, devc->framebuf + pre * 2 + 1 - ch,
+				post, range / 255, -range / 2);
+		convert_samples(devc->samples + post, devc->framebuf + 1 - ch,
+				pre, range / 255, -range / 2);
+
 		sr_session_send(sdi, &packet);
 		g_slist_free(analog.meaning->channels);
 
 		channels = channels->next;
 	}
-	g_free(analog.data);
 }
 
 /*
  * Called by libusb (as triggered by handle_event()) when a transfer comes in.
- * Only channel data comes in asynchronously, and all transfers for this are
- * queued up beforehand, so this just needs to chuck the incoming data onto
- * the libsigrok session bus.
+ * Only channel data comes in asynchronously. All transfers for a frame are
+ * queued up beforehand and read straight into the frame buffer, which is
+ * sent up the session bus once the last of them has come back.
  */
 static void LIBUSB_CALL receive_transfer(struct libusb_transfer *transfer)
 {
 	struct sr_datafeed_packet packet;
 	struct sr_dev_inst *sdi;
 	struct dev_context *devc;
-	int num_samples, pre;
 
 	sdi = transfer->user_data;
 	devc = sdi->priv;
 	sr_spew("receive_transfer(): status %s received %d bytes.",
 		libusb_error_name(transfer->status), transfer->actual_length);
 
-	if (transfer->actual_length == 0)
-		/* Nothing to send to the bus. */
-		return;
-
-	num_samples = transfer->actual_length / 2;
+	devc->submitted_transfers--;
 
-	sr_spew("Got %d-%d/%d samples in frame.", devc->samp_received + 1,
-		devc->samp_received + num_samples, devc->framesize);
+	if (transfer->status == LIBUSB_TRANSFER_CANCELLED ||
+			devc->dev_state != FETCH_DATA)
+		return;
 
-	/*
-	 * The device always sends a full frame, but the beginning of the frame
-	 * doesn't represent the trigger point. The offset at which the trigger
-	 * happened came in with the capture state, so we need to start sending
-	 * from there up the session bus. The samples in the frame buffer
-	 * before that trigger point came after the end of the device's frame
-	 * buffer was reached, and it wrapped around to overwrite up until the
-	 * trigger point.
-	 */
-	if (devc->samp_received < devc->trigger_offset) {
-		/* Trigger point not yet reached. */
-		if (devc->samp_received + num_samples < devc->trigger_offset) {
-			/* The entire chunk is before the trigger point. */
-			memcpy(devc->framebuf + devc->samp_buffered * 2,
-					transfer->buffer, num_samples * 2);
-			devc->samp_buffered += num_samples;
-		} else {
-			/*
-			 * This chunk hits or overruns the trigger point.
-			 * Store the part before the trigger fired, and
-			 * send the rest up to the session bus.
-			 */
-			pre = devc->trigger_offset - devc->samp_received;
-			memcpy(devc->framebuf + devc->samp_buffered * 2,
-					transfer->buffer, pre * 2);
-			devc->samp_buffered += pre;
-
-			/* The rest of this chunk starts with the trigger point. */
-			sr_dbg("Reached trigger point, %d samples buffered.",
-				devc->samp_buffered);
-
-			/* Avoid the corner case where the chunk ended at
-			 * exactly the trigger point. */
-			if (num_samples > pre)
-				send_chunk(sdi, transfer->buffer + pre * 2,
-						num_samples - pre);
-		}
-	} else {
-		/* Already past the trigger point, just send it all out. */
-		send_chunk(sdi, transfer->buffer, num_samples);
-	}
+	if (transfer->actual_length != transfer->length)
+		devc->frame_short = TRUE;
+	devc->samp_received += transfer->actual_length / 2;
 
-	devc->samp_received += num_samples;
+	sr_spew("Got %d/%d samples in frame.", devc->samp_received,
+		devc->framesize);
 
-	/* Everything in this transfer was either copied to the buffer or
-	 * sent to the session bus. */
-	g_free(transfer->buffer);
-	libusb_free_transfer(transfer);
+	if (devc->submitted_transfers)
+		return;
 
-	if (devc->samp_received >= devc->framesize) {
-		/* That was the last chunk in this frame. Send the buffered
-		 * pre-trigger samples out now, in one big chunk. */
-		sr_dbg("End of frame, sending %d pre-trigger buffered samples.",
-			devc->samp_buffered);
-		send_chunk(sdi, devc->framebuf, devc->samp_buffered);
-		g_free(devc->framebuf);
-		devc->framebuf = NULL;
+	/* That was the last chunk in this frame. */
+	if (devc->frame_short)
+		sr_warn("Dropping incomplete frame (%d/%d samples).",
+			devc->samp_received, devc->framesize);
+	else
+		send_frame(sdi);
 
-		/* Mark the end of this frame. */
-		packet.type = SR_DF_FRAME_END;
-		sr_session_send(sdi, &packet);
+	/* Mark the end of this frame. */
+	packet.type = SR_DF_FRAME_END;
+	sr_session_send(sdi, &packet);
 
-		if (devc->limit_frames && ++devc->num_frames >= devc->limit_frames) {
-			/* Terminate session */
-			devc->dev_state = STOPPING;
-		} else {
-			devc->dev_state = NEW_CAPTURE;
-		}
+	if (devc->limit_frames && ++devc->num_frames >= devc->limit_frames) {
+		/* Terminate session */
+		devc->dev_state = STOPPING;
+	} else {
+		devc->dev_state = NEW_CAPTURE;
 	}
 }
 
@@ -802,7 +773,6 @@ static int handle_event(int fd, int revents, void *cb_data)
 	struct sr_dev_driver *di;
 	struct dev_context *devc;
 	struct drv_context *drvc;
-	int num_channels;
 	uint32_t trigger_offset;
 	uint8_t capturestate;
 
@@ -816,11 +786,16 @@ static int handle_event(int fd, int revents, void *cb_data)
 	if (devc->dev_state == STOPPING) {
 		/* We've been told to wind up the acquisition. */
 		sr_dbg("Stopping acquisition.");
-		/*
-		 * TODO: Doesn't really cancel pending transfers so they might
-		 * come in after SR_DF_END is sent.
-		 */
+		/* Let any frame transfers still in flight retire first. */
+		if (devc->submitted_transfers) {
+			dso_cancel_channeldata(sdi);
+			tv.tv_sec = tv.tv_usec = 0;
+			libusb_handle_events_timeout(drvc->sr_ctx->libusb_ctx, &tv);
+			if (devc->submitted_transfers)
+				return TRUE;
+		}
 		usb_source_remove(sdi->session, drvc->sr_ctx);
+		dso_free_channeldata(devc);
 
 		std_session_send_df_end(sdi);
 
@@ -874,10 +849,6 @@ static int handle_event(int fd, int revents, void *cb_data)
 		/* Remember where in the captured frame the trigger is. */
 		devc->trigger_offset = trigger_offset;
 
-		num_channels = (devc->ch_enabled[0] && devc->ch_enabled[1]) ? 2 : 1;
-		devc->framebuf = g_malloc(devc->framesize * num_channels * 2);
-		devc->samp_buffered = devc->samp_received = 0;
-
 		/* Tell the scope to send us the first frame. */
 		if (dso_get_channeldata(sdi, receive_transfer) != SR_OK)
 			break;
@@ -884,21 +884,88 @@ SR_PRIV int dso_capture_start(const struct sr_dev_inst *sdi)
 	return SR_OK;
 }
 
+static int alloc_channeldata(struct dev_context *devc)
+{
+	int i;
+
+	if (devc->framebuf && devc->framebuf_size == devc->framesize)
+		return SR_OK;
+
+	dso_free_channeldata(devc);
+
+	/* The device always sends both channels, one byte each. */
+	if (!(devc->framebuf = g_try_malloc(devc->framesize * 2)) ||
+			!(devc->samples = g_try_malloc(devc->framesize * sizeof(float)))) {
+		sr_err("Failed to allocate frame buffer.");
+		dso_free_channeldata(devc);
+		return SR_ERR_MALLOC;
+	}
+	devc->framebuf_size = devc->framesize;
+
+	for (i = 0; i < NUM_TRANSFERS; i++) {
+		if (!(devc->transfers[i] = libusb_alloc_transfer(0))) {
+			sr_err("Failed to allocate USB transfer.");
+			dso_free_channeldata(devc);
+			return SR_ERR_MALLOC;
+		}
+	}
+
+	return SR_OK;
+}
+
+SR_PRIV void dso_free_channeldata(struct dev_context *devc)
+{
+	int i;
+
+	for (i = 0; i < NUM_TRANSFERS; i++) {
+		libusb_free_transfer(devc->transfers[i]);
+		devc->transfers[i] = NULL;
+	}
+	g_free(devc->samples);
+	devc->samples = NULL;
+	g_free(devc->framebuf);
+	devc->framebuf = NULL;
+	devc->framebuf_size = 0;
+}
+
+SR_PRIV void dso_cancel_channeldata(const struct sr_dev_inst *sdi)
+{
+	struct dev_context *devc;
+	int i;
+
+	devc = sdi->priv;
+
+	if (!devc->submitted_transfers)
+		return;
+
+	for (i = 0; i < NUM_TRANSFERS; i++) {
+		if (devc->transfers[i])
+			libusb_cancel_transfer(devc->transfers[i]);
+	}
+}
+
 SR_PRIV int dso_get_channeldata(const struct sr_dev_inst *sdi,
 		libusb_transfer_cb_fn cb)
 {
 	struct dev_context *devc;
 	struct sr_usb_dev_inst *usb;
-	struct libusb_transfer *transfer;
-	int num_transfers, ret, i;
+	int num_transfers, ret;
+	unsigned int frame_bytes, chunk_size, offset, length;
 	uint8_t cmdstring[2];
-	unsigned char *buf;
-
-	sr_dbg("Sending CMD_GET_CHANNELDATA.");
 
 	devc = sdi->priv;
 	usb = sdi->conn;
 
+	if (devc->submitted_transfers) {
+		sr_dbg("Previous frame still in flight.");
+		return SR_ERR;
+	}
+
+	if ((ret = alloc_channeldata(devc)) != SR_OK)
+		return ret;
+
+	sr_dbg("Sending CMD_GET_CHANNELDATA.");
+
 	cmdstring[0] = CMD_GET_CHANNELDATA;
 	cmdstring[1] = 0;
 
@@ -908,27 +975,36 @@ SR_PRIV int dso_get_channeldata(const struct sr_dev_inst *sdi,
 		return SR_ERR;
 	}
 
-	/* TODO: DSO-2xxx only. */
-	num_transfers = devc->framesize *
-			sizeof(unsigned short) / devc->epin_maxpacketsize;
-	sr_dbg("Queueing up %d transfers.", num_transfers);
-	for (i = 0; i < num_transfers; i++) {
-		if (!(buf = g_try_malloc(devc->epin_maxpacketsize))) {
-			sr_err("Failed to malloc USB endpoint buffer.");
-			return SR_ERR_MALLOC;
-		}
-		transfer = libusb_alloc_transfer(0);
-		libusb_fill_bulk_transfer(transfer, usb->devhdl, DSO_EP_IN, buf,
-				devc->epin_maxpacketsize, cb, (void *)sdi, 40);
-		if ((ret = libusb_submit_transfer(transfer)) != 0) {
+	/*
+	 * Split the frame across the transfers, each a whole number of
+	 * packets so that only the last one can end short.
+	 * TODO: DSO-2xxx only.
+	 */
+	frame_bytes = devc->framesize * 2;
+	chunk_size = (frame_bytes + NUM_TRANSFERS - 1) / NUM_TRANSFERS;
+	chunk_size += devc->epin_maxpacketsize - 1;
+	chunk_size -= chunk_size % devc->epin_maxpacketsize;
+
+	devc->samp_received = 0;
+	devc->frame_short = FALSE;
+
+	num_transfers = 0;
+	for (offset = 0; offset < frame_bytes; offset += length) {
+		length = MIN(chunk_size, frame_bytes - offset);
+		libusb_fill_bulk_transfer(devc->transfers[num_transfers],
+				usb->devhdl, DSO_EP_IN, devc->framebuf + offset,
+				length, cb, (void *)sdi, TRANSFER_TIMEOUT_MS);
+		if ((ret = libusb_submit_transfer(devc->transfers[num_transfers])) != 0) {
 			sr_err("Failed to submit transfer: %s.",
 			       libusb_error_name(ret));
-			/* TODO: Free them all. */
-			libusb_free_transfer(transfer);
-			g_free(buf);
+			dso_cancel_channeldata(sdi);
 			return SR_ERR;
 		}
+		devc->submitted_transfers++;
+		num_transfers++;
 	}
+	sr_dbg("Queued up %d transfers of up to %u bytes.",
+		num_transfers, chunk_size);
 
 	return SR_OK;
 }
@@ -34,6 +34,13 @@
 
 #define MAX_CAPTURE_EMPTY       3
 
+/*
+ * A frame is fetched with a handful of large bulk transfers which read
+ * straight into the frame buffer, instead of one per USB packet.
+ */
+#define NUM_TRANSFERS           4
+#define TRANSFER_TIMEOUT_MS     500
+
 #define DEFAULT_VOLTAGE         VDIV_500MV
 #define DEFAULT_FRAMESIZE       FRAMESIZE_SMALL
 #define DEFAULT_TIMEBASE        TIME_100us
@@ -209,9 +216,13 @@ struct dev_context {
 
 	/* Frame transfer */
 	unsigned int samp_received;
-	unsigned int samp_buffered;
 	unsigned int trigger_offset;
+	gboolean frame_short;
 	unsigned char *framebuf;
+	unsigned int framebuf_size;
+	float *samples;
+	struct libusb_transfer *transfers[NUM_TRANSFERS];
+	int submitted_transfers;
 };
 
 SR_PRIV int dso_open(struct sr_dev_inst *sdi);
@@ -224,6 +235,8 @@ SR_PRIV int dso_get_capturestate(const struct sr_dev_inst *sdi,
 SR_PRIV int dso_capture_start(const struct sr_dev_inst *sdi);
 SR_PRIV int dso_get_channeldata(const struct sr_dev_inst *sdi,
 		libusb_transfer_cb_fn cb);
+SR_PRIV void dso_cancel_channeldata(const struct sr_dev_inst *sdi);
+SR_PRIV void dso_free_channeldata(struct dev_context *devc);
 SR_PRIV int dso_set_trigger_samplerate(const struct sr_dev_inst *sdi);
 SR_PRIV int dso_set_voffsets(const struct sr_dev_inst *sdi);
 
@@ -150,7 +150,7 @@ static GSList *scan(struct sr_dev_driver *di, GSList *options)
 	sr_sw_limits_init(&devc->limits);
 	g_mutex_init(&devc->rw_mutex);
 	devc->model = &models[model_id];
-	devc->req_sent_at = 0;
+	korad_kaxxxxp_txn_init(serial, devc);
 	sdi->priv = devc;
 
 	/* Get current status of device. */
@@ -331,8 +331,8 @@ static int dev_acquisition_start(const struct sr_dev_inst *sdi)
 	sr_sw_limits_acquisition_start(&devc->limits);
 	std_session_send_df_header(sdi);
 
-	devc->req_sent_at = 0;
 	serial = sdi->conn;
+	korad_kaxxxxp_txn_init(serial, devc);
 	serial_source_add(sdi->session, serial, G_IO_IN,
 			KAXXXXP_POLL_INTERVAL_MS,
 			korad_kaxxxxp_receive_data, (void *)sdi);
@@ -22,6 +22,7 @@
 #include "protocol.h"
 
 #define REQ_TIMEOUT_MS 500
+#define REQ_RETRIES 1
 #define DEVICE_PROCESSING_TIME_MS 80
 
 SR_PRIV int korad_kaxxxxp_send_cmd(struct sr_serial_dev_inst *serial,
@@ -65,19 +66,138 @@ SR_PRIV int korad_kaxxxxp_read_chars(struct sr_serial_dev_inst *serial,
 	return ret;
 }
 
-static void give_device_time_to_process(struct dev_context *devc)
+SR_PRIV void korad_kaxxxxp_txn_init(struct sr_serial_dev_inst *serial,
+				struct dev_context *devc)
+{
+	/* The device needs some time to process one command. */
+	serial_txn_init(&devc->txn, serial, REQ_TIMEOUT_MS, REQ_RETRIES,
+		DEVICE_PROCESSING_TIME_MS);
+	devc->acq_pending = FALSE;
+	devc->acq_done = FALSE;
+}
+
+static const char *query_cmd(int target, int *count)
 {
-	int64_t sleeping_time;
+	*count = 5;
 
-	sleeping_time = devc->req_sent_at + (DEVICE_PROCESSING_TIME_MS * 1000);
-	sleeping_time -= g_get_monotonic_time();
+	switch (target) {
+	case KAXXXXP_CURRENT:
+		/* Read current from device. */
+		return "IOUT1?";
+	case KAXXXXP_CURRENT_MAX:
+		/* Read set current from device. */
+		return "ISET1?";
+	case KAXXXXP_VOLTAGE:
+		/* Read voltage from device. */
+		return "VOUT1?";
+	case KAXXXXP_VOLTAGE_MAX:
+		/* Read set voltage from device. */
+		return "VSET1?";
+	case KAXXXXP_STATUS:
+	case KAXXXXP_OUTPUT:
+	case KAXXXXP_OCP:
+	case KAXXXXP_OVP:
+		/* Read status from device. */
+		*count = 1;
+		return "STATUS?";
+	default:
+		return NULL;
+	}
+}
+
+static void handle_reply(struct dev_context *devc, int target)
+{
+	char reply[6];
+	float *value;
+	char status_byte;
+
+	memcpy(reply, devc->txn.reply, devc->txn.reply_len);
+	reply[devc->txn.reply_len] = 0;
+	sr_spew("Received: '%s'.", reply);
+
+	switch (target) {
+	case KAXXXXP_CURRENT:
+		value = &(devc->current);
+		break;
+	case KAXXXXP_CURRENT_MAX:
+		value = &(devc->current_max);
+		break;
+	case KAXXXXP_VOLTAGE:
+		value = &(devc->voltage);
+		break;
+	case KAXXXXP_VOLTAGE_MAX:
+		value = &(devc->voltage_max);
+		break;
+	default:
+		value = NULL;
+		break;
+	}
 
-	if (sleeping_time > 0) {
-		g_usleep(sleeping_time);
-		sr_spew("Sleeping for processing %" PRIi64 " usec", sleeping_time);
+	if (value) {
+		sr_atof_ascii((const char *)&reply, value);
+		sr_dbg("value: %f", *value);
+	} else {
+		/* We have status reply. */
+		status_byte = reply[0];
+		/* Constant current */
+		devc->cc_mode[0] = !(status_byte & (1 << 0)); /* Channel one */
+		devc->cc_mode[1] = !(status_byte & (1 << 1)); /* Channel two */
+		/*
+		 * Tracking
+		 * status_byte & ((1 << 2) | (1 << 3))
+		 * 00 independent 01 series 11 parallel
+		 */
+		devc->beep_enabled = (1 << 4);
+		devc->ocp_enabled = (status_byte & (1 << 5));
+		devc->output_enabled = (status_byte & (1 << 6));
+		/* Velleman LABPS3005 quirk */
+		if (devc->output_enabled)
+			devc->ovp_enabled = (status_byte & (1 << 7));
+		sr_dbg("Status: 0x%02x", status_byte);
+		sr_spew("Status: CH1: constant %s CH2: constant %s. "
+			"Tracking would be %s. Device is "
+			"%s and %s. Buttons are %s. Output is %s "
+			"and extra byte is %s.",
+			(status_byte & (1 << 0)) ? "voltage" : "current",
+			(status_byte & (1 << 1)) ? "voltage" : "current",
+			(status_byte & (1 << 2)) ? "parallel" : "series",
+			(status_byte & (1 << 3)) ? "tracking" : "independent",
+			(status_byte & (1 << 4)) ? "beeping" : "silent",
+			(status_byte & (1 << 5)) ? "locked" : "unlocked",
+			(status_byte & (1 << 6)) ? "enabled" : "disabled",
+			(status_byte & (1 << 7)) ? "true" : "false");
 	}
 }
 
+/* Store the result of the acquisition query, must hold rw_mutex. */
+static void acq_finish(struct dev_context *devc, int status)
+{
+	if (status == SR_OK)
+		handle_reply(devc, devc->acquisition_target);
+	devc->acq_status = status;
+	devc->acq_pending = FALSE;
+	devc->acq_done = TRUE;
+}
+
+/* Run one command to completion, must hold rw_mutex. */
+static int run_cmd(struct dev_context *devc, const char *cmd, int count)
+{
+	int ret;
+
+	/* Let a pending acquisition query finish first. */
+	if (devc->acq_pending)
+		acq_finish(devc, serial_txn_wait(&devc->txn));
+
+	sr_dbg("Sending '%s'.", cmd);
+	ret = serial_txn_start(&devc->txn, cmd, strlen(cmd), count, NULL, NULL);
+	if (ret != SR_OK)
+		return ret;
+	if ((ret = serial_txn_wait(&devc->txn)) != SR_OK)
+		sr_err("Error %d running command '%s'.", ret, cmd);
+
+	return ret;
+}
+
 SR_PRIV int korad_kaxxxxp_set_value(struct sr_serial_dev_inst *serial,
 				int target, struct dev_context *devc)
 {
@@ -86,8 +206,9 @@ SR_PRIV int korad_kaxxxxp_set_value(struct sr_serial_dev_inst *serial,
 	float value;
 	int ret;
 
+	(void)serial;
+
 	g_mutex_lock(&devc->rw_mutex);
-	give_device_time_to_process(devc);
 
 	switch (target) {
 	case KAXXXXP_CURRENT:
@@ -150,8 +271,7 @@ SR_PRIV int korad_kaxxxxp_set_value(struct sr_serial_dev_inst *serial,
 	if (cmd)
 		sr_snprintf_ascii(msg, 20, cmd, value);
 
-	ret = korad_kaxxxxp_send_cmd(serial, msg);
-	devc->req_sent_at = g_get_monotonic_time();
+	ret = run_cmd(devc, msg, 0);
 	g_free(msg);
 
 	g_mutex_unlock(&devc->rw_mutex);
@@ -162,95 +282,23 @@ SR_PRIV int korad_kaxxxxp_set_value(struct sr_serial_dev_inst *serial,
 SR_PRIV int korad_kaxxxxp_get_value(struct sr_serial_dev_inst *serial,
 				int target, struct dev_context *devc)
 {
+	const char *cmd;
 	int ret, count;
-	char reply[6];
-	float *value;
 	char status_byte;
 
 	g_mutex_lock(&devc->rw_mutex);
-	give_device_time_to_process(devc);
-
-	value = NULL;
-	count = 5;
 
-	switch (target) {
-	case KAXXXXP_CURRENT:
-		/* Read current from device. */
-		ret = korad_kaxxxxp_send_cmd(serial, "IOUT1?");
-		value = &(devc->current);
-		break;
-	case KAXXXXP_CURRENT_MAX:
-		/* Read set current from device. */
-		ret = korad_kaxxxxp_send_cmd(serial, "ISET1?");
-		value = &(devc->current_max);
-		break;
-	case KAXXXXP_VOLTAGE:
-		/* Read voltage from device. */
-		ret = korad_kaxxxxp_send_cmd(serial, "VOUT1?");
-		value = &(devc->voltage);
-		break;
-	case KAXXXXP_VOLTAGE_MAX:
-		/* Read set voltage from device. */
-		ret = korad_kaxxxxp_send_cmd(serial, "VSET1?");
-		value = &(devc->voltage_max);
-		break;
-	case KAXXXXP_STATUS:
-	case KAXXXXP_OUTPUT:
-	case KAXXXXP_OCP:
-	case KAXXXXP_OVP:
-		/* Read status from device. */
-		ret = korad_kaxxxxp_send_cmd(serial, "STATUS?");
-		count = 1;
-		break;
-	default:
+	if (!(cmd = query_cmd(target, &count))) {
 		sr_err("Don't know how to query %d.", target);
 		g_mutex_unlock(&devc->rw_mutex);
 		return SR_ERR;
 	}
 
-	devc->req_sent_at = g_get_monotonic_time();
-
-	if ((ret = korad_kaxxxxp_read_chars(serial, count, reply)) < 0) {
+	if ((ret = run_cmd(devc, cmd, count)) < 0) {
 		g_mutex_unlock(&devc->rw_mutex);
 		return ret;
 	}
-
-	reply[count] = 0;
-
-	if (value) {
-		sr_atof_ascii((const char *)&reply, value);
-		sr_dbg("value: %f", *value);
-	} else {
-		/* We have status reply. */
-		status_byte = reply[0];
-		/* Constant current */
-		devc->cc_mode[0] = !(status_byte & (1 << 0)); /* Channel one */
-		devc->cc_mode[1] = !(status_byte & (1 << 1)); /* Channel two */
-		/*
-		 * Tracking
-		 * status_byte & ((1 << 2) | (1 << 3))
-		 * 00 independent 01 series 11 parallel
-		 */
-		devc->beep_enabled = (1 << 4);
-		devc->ocp_enabled = (status_byte & (1 << 5));
-		devc->output_enabled = (status_byte & (1 << 6));
-		/* Velleman LABPS3005 quirk */
-		if (devc->output_enabled)
-			devc->ovp_enabled = (status_byte & (1 << 7));
-		sr_dbg("Status: 0x%02x", status_byte);
-		sr_spew("Status: CH1: constant %s CH2: constant %s. "
-			"Tracking would be %s. Device is "
-			"%s and %s. Buttons are %s. Output is %s "
-			"and extra byte is %s.",
-			(status_byte & (1 << 0)) ? "voltage" : "current",
-			(status_byte & (1 << 1)) ? "voltage" : "current",
-			(status_byte & (1 << 2)) ? "parallel" : "series",
-			(status_byte & (1 << 3)) ? "tracking" : "independent",
-			(status_byte & (1 << 4)) ? "beeping" : "silent",
-			(status_byte & (1 << 5)) ? "locked" : "unlocked",
-			(status_byte & (1 << 6)) ? "enabled" : "disabled",
-			(status_byte & (1 << 7)) ? "true" : "false");
-	}
+	handle_reply(devc, target);
 
 	/* Read the sixth byte from ISET? BUG workaround. */
 	if (target == KAXXXXP_CURRENT_MAX)
@@ -297,13 +345,15 @@ SR_PRIV int korad_kaxxxxp_receive_data(int fd, int revents, void *cb_data)
 {
 	struct sr_dev_inst *sdi;
 	struct dev_context *devc;
-	struct sr_serial_dev_inst *serial;
 	struct sr_datafeed_packet packet;
 	struct sr_datafeed_analog analog;
 	struct sr_analog_encoding encoding;
 	struct sr_analog_meaning meaning;
 	struct sr_analog_spec spec;
 	GSList *l;
+	const char *cmd;
+	gboolean done;
+	int count, status, target;
 
 	(void)fd;
 	(void)revents;
@@ -314,10 +364,37 @@ SR_PRIV int korad_kaxxxxp_receive_data(int fd, int revents, void *cb_data)
 	if (!(devc = sdi->priv))
 		return TRUE;
 
-	serial = sdi->conn;
+	/*
+	 * Advance the query without blocking, other devices share this
+	 * thread. Its reply may also have been collected by get_value().
+	 */
+	g_mutex_lock(&devc->rw_mutex);
+	if (devc->acq_pending && serial_txn_poll(&devc->txn, &status))
+		acq_finish(devc, status);
+	done = devc->acq_done;
+	status = devc->acq_status;
+	target = devc->acquisition_target;
+	if (done) {
+		devc->acq_done = FALSE;
+		next_measurement(devc);
+	}
+	if (!devc->acq_pending) {
+		cmd = query_cmd(devc->acquisition_target, &count);
+		if (serial_txn_start(&devc->txn, cmd, strlen(cmd), count,
+				NULL, NULL) == SR_OK) {
+			devc->acq_pending = TRUE;
+			if (serial_txn_poll(&devc->txn, &status))
+				acq_finish(devc, status);
+		}
+	}
+	g_mutex_unlock(&devc->rw_mutex);
 
-	/* Get the value. */
-	korad_kaxxxxp_get_value(serial, devc->acquisition_target, devc);
+	if (!done)
+		return TRUE;
+	if (status != SR_OK) {
+		sr_warn("Failed to query target %d: %d.", target, status);
+		goto check_limits;
+	}
 
 	/* Note: digits/spec_digits will be overridden later. */
 	sr_analog_init(&analog, &encoding, &meaning, &spec, 0);
@@ -327,7 +404,7 @@ SR_PRIV int korad_kaxxxxp_receive_data(int fd, int revents, void *cb_data)
 	packet.payload = &analog;
 	analog.num_samples = 1;
 	l = g_slist_copy(sdi->channels);
-	if (devc->acquisition_target == KAXXXXP_CURRENT) {
+	if (target == KAXXXXP_CURRENT) {
 		l = g_slist_remove_link(l, g_slist_nth(l, 0));
 		analog.meaning->channels = l;
 		analog.meaning->mq = SR_MQ_CURRENT;
@@ -337,7 +414,7 @@ SR_PRIV int korad_kaxxxxp_receive_data(int fd, int revents, void *cb_data)
 		analog.spec->spec_digits = 3;
 		analog.data = &devc->current;
 		sr_session_send(sdi, &packet);
-	} else if (devc->acquisition_target == KAXXXXP_VOLTAGE) {
+	} else if (target == KAXXXXP_VOLTAGE) {
 		l = g_slist_remove_link(l, g_slist_nth(l, 1));
 		analog.meaning->channels = l;
 		analog.meaning->mq = SR_MQ_VOLTAGE;
@@ -349,8 +426,9 @@ SR_PRIV int korad_kaxxxxp_receive_data(int fd, int revents, void *cb_data)
 		sr_session_send(sdi, &packet);
 		sr_sw_limits_update_samples_read(&devc->limits, 1);
 	}
-	next_measurement(devc);
+	g_slist_free(l);
 
+check_limits:
 	if (sr_sw_limits_check(&devc->limits))
 		sr_dev_acquisition_stop(sdi);
 
@@ -29,7 +29,7 @@
 
 #define LOG_PREFIX "korad-kaxxxxp"
 
-#define KAXXXXP_POLL_INTERVAL_MS 80
+#define KAXXXXP_POLL_INTERVAL_MS 10
 
 enum {
 	VELLEMAN_PS3005D,
@@ -74,8 +74,11 @@ struct dev_context {
 	const struct korad_kaxxxxp_model *model; /**< Model information. */
 
 	struct sr_sw_limits limits;
-	int64_t req_sent_at;
+	struct serial_txn txn;  /**< Request/response state of the port. */
 	GMutex rw_mutex;
+	gboolean acq_pending;   /**< Acquisition query awaits its reply. */
+	gboolean acq_done;      /**< Acquisition reply wasn't sent yet. */
+	int acq_status;         /**< Result of the last acquisition query. */
 
 	float current;          /**< Last current value [A] read from device. */
 	float current_max;      /**< Output current set. */
@@ -96,6 +99,8 @@ SR_PRIV int korad_kaxxxxp_send_cmd(struct sr_serial_dev_inst *serial,
 					const char *cmd);
 SR_PRIV int korad_kaxxxxp_read_chars(struct sr_serial_dev_inst *serial,
 					int count, char *buf);
+SR_PRIV void korad_kaxxxxp_txn_init(struct sr_serial_dev_inst *serial,
+					struct dev_context *devc);
 SR_PRIV int korad_kaxxxxp_set_value(struct sr_serial_dev_inst *serial,
 					int target, struct dev_context *devc);
 SR_PRIV int korad_kaxxxxp_get_value(struct sr_serial_dev_inst *serial,
@@ -61,7 +61,6 @@ static int pickit2_usb_send(const struct sr_dev_inst *sdi, struct pickit2_cmd *c
 {
 	struct sr_usb_dev_inst *usb;
 	int ret, sent;
-	GString *text;
 
 	if (!cmd)
 		return SR_OK;
@@ -69,9 +68,7 @@ static int pickit2_usb_send(const struct sr_dev_inst *sdi, struct pickit2_cmd *c
 	if (!usb)
 		return SR_ERR_ARG;
 
-	text = sr_hexdump_new(&cmd->raw[0], cmd->length);
-	sr_dbg("USB sent: %s", text->str);
-	sr_hexdump_free(text);
+	sr_dbg_hexdump("USB sent:", &cmd->raw[0], cmd->length);
 
 	ret = libusb_interrupt_transfer(usb->devhdl,
 		LIBUSB_ENDPOINT_OUT | PICKIT2_USB_ENDPOINT,
@@ -94,7 +91,6 @@ static int pickit2_usb_recv(const struct sr_dev_inst *sdi, struct pickit2_cmd *c
 {
 	struct sr_usb_dev_inst *usb;
 	int ret, rcvd;
-	GString *text;
 
 	if (!cmd)
 		return SR_ERR_ARG;
@@ -114,9 +110,7 @@ static int pickit2_usb_recv(const struct sr_dev_inst *sdi, struct pickit2_cmd *c
 		return SR_ERR_IO;
 	}
 
-	text = sr_hexdump_new(&cmd->raw[0], rcvd);
-	sr_dbg("USB recv: %s", text->str);
-	sr_hexdump_free(text);
+	sr_dbg_hexdump("USB recv:", &cmd->raw[0], rcvd);
 
 	cmd->length = rcvd;
 	if (rcvd != PICKIT2_PACKET_LENGTH) {
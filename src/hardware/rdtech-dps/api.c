@@ -95,7 +95,6 @@ static struct sr_dev_inst *probe_device(struct sr_modbus_dev_inst *modbus)
 	devc = g_malloc0(sizeof(struct dev_context));
 	sr_sw_limits_init(&devc->limits);
 	devc->model = model;
-	devc->expecting_registers = 0;
 
 	sdi->priv = devc;
 
@@ -149,7 +148,6 @@ static int dev_open(struct sr_dev_inst *sdi)
 
 static int dev_close(struct sr_dev_inst *sdi)
 {
-	struct dev_context *devc;
 	struct sr_modbus_dev_inst *modbus;
 
 	modbus = sdi->conn;
@@ -157,15 +155,7 @@ static int dev_close(struct sr_dev_inst *sdi)
 	if (!modbus)
 		return SR_ERR_BUG;
 
-	devc = sdi->priv;
-
-	if (devc->expecting_registers) {
-		/* Wait for the last data that was requested from the device. */
-		uint16_t registers[devc->expecting_registers];
-		sr_modbus_read_holding_registers(modbus, -1,
-			devc->expecting_registers, registers);
-	}
-
+	/* A pending asynchronous reply is drained by the next request. */
 	rdtech_dps_set_reg(modbus, REG_LOCK, 0);
 
 	return sr_modbus_close(modbus);
@@ -191,16 +181,16 @@ static int config_get(uint32_t key, GVariant **data,
 		ret = sr_sw_limits_config_get(&devc->limits, key, data);
 		break;
 	case SR_CONF_ENABLED:
-		if ((ret = rdtech_dps_get_reg(modbus, REG_ENABLE, &ivalue)) == SR_OK)
+		if ((ret = rdtech_dps_get_reg_cached(sdi, REG_ENABLE, &ivalue)) == SR_OK)
 			*data = g_variant_new_boolean(ivalue);
 		break;
 	case SR_CONF_REGULATION:
-		if ((ret = rdtech_dps_get_reg(modbus, REG_CV_CC, &ivalue)) != SR_OK)
+		if ((ret = rdtech_dps_get_reg_cached(sdi, REG_CV_CC, &ivalue)) != SR_OK)
 			break;
 		*data = g_variant_new_string((ivalue == MODE_CC) ? "CC" : "CV");
 		break;
 	case SR_CONF_VOLTAGE:
-		if ((ret = rdtech_dps_get_reg(modbus, REG_UOUT, &ivalue)) == SR_OK)
+		if ((ret = rdtech_dps_get_reg_cached(sdi, REG_UOUT, &ivalue)) == SR_OK)
 			*data = g_variant_new_double((float)ivalue / 100.0f);
 		break;
 	case SR_CONF_VOLTAGE_TARGET:
@@ -208,7 +198,7 @@ static int config_get(uint32_t key, GVariant **data,
 			*data = g_variant_new_double((float)ivalue / 100.0f);
 		break;
 	case SR_CONF_CURRENT:
-		if ((ret = rdtech_dps_get_reg(modbus, REG_IOUT, &ivalue)) == SR_OK)
+		if ((ret = rdtech_dps_get_reg_cached(sdi, REG_IOUT, &ivalue)) == SR_OK)
 			*data = g_variant_new_double((float)ivalue / 100.0f);
 		break;
 	case SR_CONF_CURRENT_LIMIT:
@@ -219,7 +209,7 @@ static int config_get(uint32_t key, GVariant **data,
 		*data = g_variant_new_boolean(TRUE);
 		break;
 	case SR_CONF_OVER_VOLTAGE_PROTECTION_ACTIVE:
-		if ((ret = rdtech_dps_get_reg(modbus, REG_PROTECT, &ivalue)) == SR_OK)
+		if ((ret = rdtech_dps_get_reg_cached(sdi, REG_PROTECT, &ivalue)) == SR_OK)
 			*data = g_variant_new_boolean(ivalue == STATE_OVP);
 		break;
 	case SR_CONF_OVER_VOLTAGE_PROTECTION_THRESHOLD:
@@ -230,7 +220,7 @@ static int config_get(uint32_t key, GVariant **data,
 		*data = g_variant_new_boolean(TRUE);
 		break;
 	case SR_CONF_OVER_CURRENT_PROTECTION_ACTIVE:
-		if ((ret = rdtech_dps_get_reg(modbus, REG_PROTECT, &ivalue)) == SR_OK)
+		if ((ret = rdtech_dps_get_reg_cached(sdi, REG_PROTECT, &ivalue)) == SR_OK)
 			*data = g_variant_new_boolean(ivalue == STATE_OCP);
 		break;
 	case SR_CONF_OVER_CURRENT_PROTECTION_THRESHOLD:
@@ -255,6 +245,9 @@ static int config_set(uint32_t key, GVariant *data,
 	modbus = sdi->conn;
 	devc = sdi->priv;
 
+	/* Don't serve stale values until the next cycle completed. */
+	sr_modbus_regcache_invalidate(devc->regs);
+
 	switch (key) {
 	case SR_CONF_LIMIT_SAMPLES:
 	case SR_CONF_LIMIT_MSEC:
@@ -327,6 +320,7 @@ static int dev_acquisition_stop(struct sr_dev_inst *sdi)
 
 	modbus = sdi->conn;
 	sr_modbus_source_remove(sdi->session, modbus);
+	rdtech_dps_capture_stop(sdi);
 
 	return SR_OK;
 }
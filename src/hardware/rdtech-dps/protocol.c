@@ -37,6 +37,30 @@ SR_PRIV int rdtech_dps_set_reg(struct sr_modbus_dev_inst *modbus,
 	return sr_modbus_write_multiple_registers(modbus, address, 1, registers);
 }
 
+/*
+ * Registers read every acquisition cycle: the measurements, and the
+ * state which frontends display alongside them. They coalesce into a
+ * single request.
+ */
+static const struct sr_modbus_reg_range acq_registers[] = {
+	{ REG_UOUT, 3 },
+	{ REG_PROTECT, 3 },
+};
+
+/* Serve a register from the acquisition snapshot if possible. */
+SR_PRIV int rdtech_dps_get_reg_cached(const struct sr_dev_inst *sdi,
+		uint16_t address, uint16_t *value)
+{
+	struct dev_context *devc;
+
+	devc = sdi->priv;
+
+	if (sr_modbus_regcache_get(devc->regs, address, value) == SR_OK)
+		return SR_OK;
+
+	return rdtech_dps_get_reg(sdi->conn, address, value);
+}
+
 SR_PRIV int rdtech_dps_get_model_version(struct sr_modbus_dev_inst *modbus,
 		uint16_t *model, uint16_t *version)
 {
@@ -77,15 +101,30 @@ static void send_value(const struct sr_dev_inst *sdi, struct sr_channel *ch,
 SR_PRIV int rdtech_dps_capture_start(const struct sr_dev_inst *sdi)
 {
 	struct dev_context *devc;
-	struct sr_modbus_dev_inst *modbus;
 	int ret;
 
-	modbus = sdi->conn;
 	devc = sdi->priv;
 
-	if ((ret = sr_modbus_read_holding_registers(modbus, REG_UOUT, 3, NULL)) == SR_OK)
-		devc->expecting_registers = 2;
-	return ret;
+	devc->regs = sr_modbus_regcache_new(acq_registers,
+		ARRAY_SIZE(acq_registers), 2);
+	if (!devc->regs)
+		return SR_ERR_BUG;
+
+	/* Send the first request of the first cycle. */
+	if (sr_modbus_regcache_poll(sdi->conn, devc->regs, &ret))
+		return ret;
+
+	return SR_OK;
+}
+
+SR_PRIV void rdtech_dps_capture_stop(const struct sr_dev_inst *sdi)
+{
+	struct dev_context *devc;
+
+	devc = sdi->priv;
+
+	sr_modbus_regcache_free(devc->regs);
+	devc->regs = NULL;
 }
 
 SR_PRIV int rdtech_dps_receive_data(int fd, int revents, void *cb_data)
@@ -94,7 +133,8 @@ SR_PRIV int rdtech_dps_receive_data(int fd, int revents, void *cb_data)
 	struct dev_context *devc;
 	struct sr_modbus_dev_inst *modbus;
 	struct sr_datafeed_packet packet;
-	uint16_t registers[3];
+	uint16_t uout, iout, power;
+	int ret;
 
 	(void)fd;
 	(void)revents;
@@ -105,19 +145,27 @@ SR_PRIV int rdtech_dps_receive_data(int fd, int revents, void *cb_data)
 	modbus = sdi->conn;
 	devc = sdi->priv;
 
-	devc->expecting_registers = 0;
-	if (sr_modbus_read_holding_registers(modbus, -1, 3, registers) == SR_OK) {
+	/* Never wait for the reply, other devices share this thread. */
+	if (!sr_modbus_regcache_poll(modbus, devc->regs, &ret))
+		return TRUE;
+
+	if (ret != SR_OK) {
+		sr_warn("Failed to read measurements: %d.", ret);
+	} else {
 		packet.type = SR_DF_FRAME_BEGIN;
 		sr_session_send(sdi, &packet);
 
+		sr_modbus_regcache_get(devc->regs, REG_UOUT, &uout);
+		sr_modbus_regcache_get(devc->regs, REG_IOUT, &iout);
+		sr_modbus_regcache_get(devc->regs, REG_POWER, &power);
 		send_value(sdi, sdi->channels->data,
-			RB16(registers + 0) / 100.0f,
+			uout / 100.0f,
 			SR_MQ_VOLTAGE, SR_UNIT_VOLT, 3);
 		send_value(sdi, sdi->channels->next->data,
-			RB16(registers + 1) / 1000.0f,
+			iout / 1000.0f,
 			SR_MQ_CURRENT, SR_UNIT_AMPERE, 4);
 		send_value(sdi, sdi->channels->next->next->data,
-			RB16(registers + 2) / 100.0f,
+			power / 100.0f,
 			SR_MQ_POWER, SR_UNIT_WATT, 3);
 
 		packet.type = SR_DF_FRAME_END;
@@ -130,6 +178,8 @@ SR_PRIV int rdtech_dps_receive_data(int fd, int revents, void *cb_data)
 		return TRUE;
 	}
 
-	rdtech_dps_capture_start(sdi);
+	/* Start the next cycle right away. */
+	sr_modbus_regcache_poll(modbus, devc->regs, &ret);
+
 	return TRUE;
 }
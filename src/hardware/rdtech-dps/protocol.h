@@ -38,7 +38,8 @@ struct rdtech_dps_model {
 struct dev_context {
 	const struct rdtech_dps_model *model;
 	struct sr_sw_limits limits;
-	int expecting_registers;
+	/** Registers read every acquisition cycle, NULL when not running. */
+	struct sr_modbus_regcache *regs;
 };
 
 enum rdtech_dps_register {
@@ -86,11 +87,14 @@ enum rdtech_dps_mode {
 
 SR_PRIV int rdtech_dps_get_reg(struct sr_modbus_dev_inst *modbus, uint16_t address, uint16_t *value);
 SR_PRIV int rdtech_dps_set_reg(struct sr_modbus_dev_inst *modbus, uint16_t address, uint16_t value);
+SR_PRIV int rdtech_dps_get_reg_cached(const struct sr_dev_inst *sdi,
+		uint16_t address, uint16_t *value);
 
 SR_PRIV int rdtech_dps_get_model_version(struct sr_modbus_dev_inst *modbus,
 		uint16_t *model, uint16_t *version);
 
 SR_PRIV int rdtech_dps_capture_start(const struct sr_dev_inst *sdi);
+SR_PRIV void rdtech_dps_capture_stop(const struct sr_dev_inst *sdi);
 SR_PRIV int rdtech_dps_receive_data(int fd, int revents, void *cb_data);
 
 #endif
@@ -434,6 +434,36 @@ SR_PRIV int rigol_ds_capture_start(const struct sr_dev_inst *sdi)
 	return SR_OK;
 }
 
+/*
+ * Get the vertical scaling of the current waveform source from the
+ * preamble, one query instead of three. The preamble reads
+ * "format,type,points,count,xinc,xorigin,xref,yinc,yorigin,yref".
+ */
+static int rigol_ds_get_preamble(const struct sr_dev_inst *sdi, int index)
+{
+	struct dev_context *devc;
+	char *response;
+	gchar **fields;
+	int ret;
+
+	devc = sdi->priv;
+
+	if (sr_scpi_get_string(sdi->conn, ":WAV:PRE?", &response) != SR_OK)
+		return SR_ERR;
+	fields = g_strsplit(response, ",", 0);
+	g_free(response);
+
+	ret = SR_ERR;
+	if (g_strv_length(fields) >= 10 &&
+			sr_atof_ascii(fields[7], &devc->vert_inc[index]) == SR_OK &&
+			sr_atof_ascii(fields[8], &devc->vert_origin[index]) == SR_OK &&
+			sr_atoi(fields[9], &devc->vert_reference[index]) == SR_OK)
+		ret = SR_OK;
+	g_strfreev(fields);
+
+	return ret;
+}
+
 /* Start reading data from the current channel */
 SR_PRIV int rigol_ds_channel_start(const struct sr_dev_inst *sdi)
 {
@@ -495,6 +525,10 @@ SR_PRIV int rigol_ds_channel_start(const struct sr_dev_inst *sdi)
 	}
 
 	if (devc->model->series->protocol >= PROTOCOL_V3 &&
+			ch->type == SR_CHANNEL_ANALOG &&
+			rigol_ds_get_preamble(sdi, ch->index) == SR_OK) {
+		sr_spew("Vertical scaling from preamble.");
+	} else if (devc->model->series->protocol >= PROTOCOL_V3 &&
 			ch->type == SR_CHANNEL_ANALOG) {
 		/* Vertical increment. */
 		if (sr_scpi_get_float(sdi->conn, ":WAV:YINC?",
@@ -517,6 +551,42 @@ SR_PRIV int rigol_ds_channel_start(const struct sr_dev_inst *sdi)
 	devc->num_channel_bytes = 0;
 	devc->num_header_bytes = 0;
 	devc->num_block_bytes = 0;
+	devc->block_requested = FALSE;
+
+	return SR_OK;
+}
+
+/*
+ * Ask for the next data block of the current channel. The setup commands
+ * don't wait for completion, the scope executes them in order before it
+ * answers the query.
+ */
+static int rigol_ds_request_block(const struct sr_dev_inst *sdi)
+{
+	struct dev_context *devc;
+	struct sr_channel *ch;
+	uint64_t frame_size;
+
+	devc = sdi->priv;
+	ch = devc->channel_entry->data;
+	frame_size = ch->type == SR_CHANNEL_ANALOG ?
+			devc->analog_frame_size : devc->digital_frame_size;
+
+	if (devc->model->series->protocol >= PROTOCOL_V4) {
+		if (sr_scpi_send(sdi->conn, ":WAV:START %" PRIu64,
+				devc->num_channel_bytes + 1) != SR_OK)
+			return SR_ERR;
+		if (sr_scpi_send(sdi->conn, ":WAV:STOP %" PRIu64,
+				MIN(devc->num_channel_bytes + ACQ_BLOCK_SIZE,
+					frame_size)) != SR_OK)
+			return SR_ERR;
+	}
+
+	if (devc->model->series->protocol >= PROTOCOL_V3)
+		if (sr_scpi_send(sdi->conn, ":WAV:DATA?") != SR_OK)
+			return SR_ERR;
+
+	devc->block_requested = TRUE;
 
 	return SR_OK;
 }
@@ -590,9 +660,12 @@ SR_PRIV int rigol_ds_receive(int fd, int revents, void *cb_data)
 	struct sr_analog_spec spec;
 	struct sr_datafeed_logic logic;
 	double vdiv, offset, origin;
-	int len, i, vref;
+	float vdivlog;
+	int len, vref, digits;
+	char lf;
 	struct sr_channel *ch;
 	gsize expected_data_bytes;
+	gboolean block_done, channel_done;
 
 	(void)fd;
 
@@ -639,19 +712,10 @@ SR_PRIV int rigol_ds_receive(int fd, int revents, void *cb_data)
 			devc->analog_frame_size : devc->digital_frame_size;
 
 	if (devc->num_block_bytes == 0) {
-		if (devc->model->series->protocol >= PROTOCOL_V4) {
-			if (rigol_ds_config_set(sdi, ":WAV:START %d",
-					devc->num_channel_bytes + 1) != SR_OK)
-				return TRUE;
-			if (rigol_ds_config_set(sdi, ":WAV:STOP %d",
-					MIN(devc->num_channel_bytes + ACQ_BLOCK_SIZE,
-						devc->analog_frame_size)) != SR_OK)
-				return TRUE;
-		}
-
-		if (devc->model->series->protocol >= PROTOCOL_V3)
-			if (sr_scpi_send(sdi->conn, ":WAV:DATA?") != SR_OK)
-				return TRUE;
+		/* The block may have been requested ahead of time. */
+		if (!devc->block_requested &&
+				rigol_ds_request_block(sdi) != SR_OK)
+			return TRUE;
 
 		if (sr_scpi_read_begin(scpi) != SR_OK)
 			return TRUE;
@@ -669,6 +733,7 @@ SR_PRIV int rigol_ds_receive(int fd, int revents, void *cb_data)
 				sr_dev_acquisition_stop(sdi);
 				return TRUE;
 			}
+			devc->block_requested = FALSE;
 			/* At slow timebases in live capture the DS2072
 			 * sometimes returns "short" data blocks, with
 			 * apparently no way to get the rest of the data.
@@ -684,6 +749,7 @@ SR_PRIV int rigol_ds_receive(int fd, int revents, void *cb_data)
 			devc->num_block_bytes = len;
 		} else {
 			devc->num_block_bytes = expected_data_bytes;
+			devc->block_requested = FALSE;
 		}
 		devc->num_block_read = 0;
 	}
@@ -707,47 +773,11 @@ SR_PRIV int rigol_ds_receive(int fd, int revents, void *cb_data)
 
 	devc->num_block_read += len;
 
-	if (ch->type == SR_CHANNEL_ANALOG) {
-		vref = devc->vert_reference[ch->index];
-		vdiv = devc->vert_inc[ch->index];
-		origin = devc->vert_origin[ch->index];
-		offset = devc->vert_offset[ch->index];
-		if (devc->model->series->protocol >= PROTOCOL_V3)
-			for (i = 0; i < len; i++)
-				devc->data[i] = ((int)devc->buffer[i] - vref - origin) * vdiv;
-		else
-			for (i = 0; i < len; i++)
-				devc->data[i] = (128 - devc->buffer[i]) * vdiv - offset;
-		float vdivlog = log10f(vdiv);
-		int digits = -(int)vdivlog + (vdivlog < 0.0);
-		sr_analog_init(&analog, &encoding, &meaning, &spec, digits);
-		analog.meaning->channels = g_slist_append(NULL, ch);
-		analog.num_samples = len;
-		analog.data = devc->data;
-		analog.meaning->mq = SR_MQ_VOLTAGE;
-		analog.meaning->unit = SR_UNIT_VOLT;
-		analog.meaning->mqflags = 0;
-		packet.type = SR_DF_ANALOG;
-		packet.payload = &analog;
-		sr_session_send(sdi, &packet);
-		g_slist_free(analog.meaning->channels);
-	} else {
-		logic.length = len;
-		// TODO: For the MSO1000Z series, we need a way to express that
-		// this data is in fact just for a single channel, with the valid
-		// data for that channel in the LSB of each byte.
-		logic.unitsize = devc->model->series->protocol == PROTOCOL_V4 ? 1 : 2;
-		logic.data = devc->buffer;
-		packet.type = SR_DF_LOGIC;
-		packet.payload = &logic;
-		sr_session_send(sdi, &packet);
-	}
-
 	if (devc->num_block_read == devc->num_block_bytes) {
 		sr_dbg("Block has been completed");
 		if (devc->model->series->protocol >= PROTOCOL_V3) {
 			/* Discard the terminating linefeed */
-			sr_scpi_read_data(scpi, (char *)devc->buffer, 1);
+			sr_scpi_read_data(scpi, &lf, 1);
 		}
 		if (devc->format == FORMAT_IEEE488_2) {
 			/* Prepare for possible next block */
@@ -765,34 +795,100 @@ SR_PRIV int rigol_ds_receive(int fd, int revents, void *cb_data)
 			return TRUE;
 		}
 		devc->num_block_read = 0;
+		block_done = TRUE;
 	} else {
 		sr_dbg("%" PRIu64 " of %" PRIu64 " block bytes read",
 			devc->num_block_read, devc->num_block_bytes);
+		block_done = FALSE;
 	}
 
 	devc->num_channel_bytes += len;
+	channel_done = devc->num_channel_bytes >= expected_data_bytes;
 
-	if (devc->num_channel_bytes < expected_data_bytes)
-		/* Don't have the full data for this channel yet, re-run. */
-		return TRUE;
+	/*
+	 * The response has been read completely. Have the scope prepare
+	 * the next block, or the next channel, while the data we have is
+	 * converted and sent.
+	 */
+	if (channel_done) {
+		/* End of data for this channel. */
+		if (devc->model->series->protocol == PROTOCOL_V3) {
+			/* Signal end of data download to scope */
+			if (devc->data_source != DATA_SOURCE_LIVE)
+				/*
+				 * This causes a query error, without it switching
+				 * to the next channel causes an error. Fun with
+				 * firmware...
+				 */
+				rigol_ds_config_set(sdi, ":WAV:END");
+		}
 
-	/* End of data for this channel. */
-	if (devc->model->series->protocol == PROTOCOL_V3) {
-		/* Signal end of data download to scope */
-		if (devc->data_source != DATA_SOURCE_LIVE)
-			/*
-			 * This causes a query error, without it switching
-			 * to the next channel causes an error. Fun with
-			 * firmware...
-			 */
-			rigol_ds_config_set(sdi, ":WAV:END");
+		if (devc->channel_entry->next) {
+			/* We got the frame for this channel, now get the next channel. */
+			devc->channel_entry = devc->channel_entry->next;
+			if (rigol_ds_channel_start(sdi) == SR_OK &&
+					devc->model->series->protocol >= PROTOCOL_V4)
+				rigol_ds_request_block(sdi);
+		}
+	} else if (block_done && devc->model->series->protocol >= PROTOCOL_V4) {
+		rigol_ds_request_block(sdi);
 	}
 
-	if (devc->channel_entry->next) {
-		/* We got the frame for this channel, now get the next channel. */
-		devc->channel_entry = devc->channel_entry->next;
-		rigol_ds_channel_start(sdi);
+	if (ch->type == SR_CHANNEL_ANALOG) {
+		vref = devc->vert_reference[ch->index];
+		vdiv = devc->vert_inc[ch->index];
+		origin = devc->vert_origin[ch->index];
+		offset = devc->vert_offset[ch->index];
+		vdivlog = log10f(vdiv);
+		digits = -(int)vdivlog + (vdivlog < 0.0);
+		sr_analog_init(&analog, &encoding, &meaning, &spec, digits);
+		/*
+		 * Pass the raw ADC bytes on and let the receiver apply
+		 * the scale and offset, instead of converting each
+		 * sample to float here.
+		 */
+		encoding.unitsize = 1;
+		encoding.is_signed = FALSE;
+		encoding.is_float = FALSE;
+		encoding.is_bigendian = FALSE;
+		if (devc->model->series->protocol >= PROTOCOL_V3) {
+			/* (raw - vref - origin) * vdiv */
+			sr_rational_from_double(&encoding.scale, vdiv);
+			sr_rational_from_double(&encoding.offset,
+				-(vref + origin) * vdiv);
+		} else {
+			/* (128 - raw) * vdiv - offset */
+			sr_rational_from_double(&encoding.scale, -vdiv);
+			sr_rational_from_double(&encoding.offset,
+				128 * vdiv - offset);
+		}
+		analog.meaning->channels = g_slist_append(NULL, ch);
+		analog.num_samples = len;
+		analog.data = devc->buffer;
+		analog.meaning->mq = SR_MQ_VOLTAGE;
+		analog.meaning->unit = SR_UNIT_VOLT;
+		analog.meaning->mqflags = 0;
+		packet.type = SR_DF_ANALOG;
+		packet.payload = &analog;
+		sr_session_send(sdi, &packet);
+		g_slist_free(analog.meaning->channels);
 	} else {
+		logic.length = len;
+		// TODO: For the MSO1000Z series, we need a way to express that
+		// this data is in fact just for a single channel, with the valid
+		// data for that channel in the LSB of each byte.
+		logic.unitsize = devc->model->series->protocol == PROTOCOL_V4 ? 1 : 2;
+		logic.data = devc->buffer;
+		packet.type = SR_DF_LOGIC;
+		packet.payload = &logic;
+		sr_session_send(sdi, &packet);
+	}
+
+	if (!channel_done)
+		/* Don't have the full data for this channel yet, re-run. */
+		return TRUE;
+
+	if (devc->channel_entry->data == ch) {
 		/* Done with this frame. */
 		packet.type = SR_DF_FRAME_END;
 		sr_session_send(sdi, &packet);
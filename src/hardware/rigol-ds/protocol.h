@@ -28,11 +28,14 @@
 
 #define LOG_PREFIX "rigol-ds"
 
-/* Size of acquisition buffers */
-#define ACQ_BUFFER_SIZE (32 * 1024)
+/* Size of acquisition buffers, large enough to read a block in one go. */
+#define ACQ_BUFFER_SIZE (256 * 1024)
 
-/* Maximum number of samples to retrieve at once. */
-#define ACQ_BLOCK_SIZE (30 * 1000)
+/*
+ * Maximum number of samples to retrieve at once. This is the limit for
+ * :WAV:DATA? in BYTE format on protocol V4 devices.
+ */
+#define ACQ_BLOCK_SIZE (250 * 1000)
 
 #define MAX_ANALOG_CHANNELS 4
 #define MAX_DIGITAL_CHANNELS 16
@@ -152,13 +155,14 @@ struct dev_context {
 	uint64_t num_block_bytes;
 	/* Number of data block bytes already read */
 	uint64_t num_block_read;
+	/* The next data block was already requested from the scope */
+	gboolean block_requested;
 	/* What to wait for in *_receive */
 	enum wait_events wait_event;
 	/* Trigger/block copying/stop waiting status */
 	int wait_status;
-	/* Acq buffers used for reading from the scope and sending data to app */
+	/* Acq buffer used for reading from the scope and sending data to app */
 	unsigned char *buffer;
-	float *data;
 };
 
 SR_PRIV int rigol_ds_config_set(const struct sr_dev_inst *sdi, const char *format, ...);
@@ -849,40 +849,40 @@ static void saleae_logic_pro_convert_data(const struct sr_dev_inst *sdi,
 					 const uint32_t *src, size_t srccnt)
 {
 	struct dev_context *devc = sdi->priv;
-	uint8_t *dst = devc->conv_buffer;
-	uint32_t samples;
-	uint16_t channel_mask;
-	unsigned int sample_index, batch_index;
-	uint16_t *dst_batch;
-
-	/* Copy partial batch to the beginning. */
-	memcpy(dst, dst + devc->conv_size, CONV_BATCH_SIZE);
+	uint16_t *dst = (uint16_t *)devc->conv_buffer;
+	const uint8_t *words = (const uint8_t *)src;
+	size_t num_batches, n;
+
 	/* Reset converted size. */
 	devc->conv_size = 0;
 
-	batch_index = devc->batch_index;
-	while (srccnt--) {
-		samples = *src++;
-		dst_batch = (uint16_t*)dst;
-
-		/* First index of the batch. */
-		if (batch_index == 0)
-			memset(dst, 0, CONV_BATCH_SIZE);
-
-		/* Convert one channel. */
-		channel_mask = devc->dig_channel_masks[batch_index];
-		for (sample_index = 0; sample_index <= 31; sample_index++)
-			if ((samples >> (31 - sample_index)) & 1)
-				dst_batch[sample_index] |= channel_mask;
-
-		/* Last index of the batch. */
-		if (++batch_index == devc->dig_channel_cnt) {
-			devc->conv_size += CONV_BATCH_SIZE;
-			batch_index = 0;
-			dst += CONV_BATCH_SIZE;
-		}
+	/* Complete the batch left over from the previous packet. */
+	if (devc->batch_index) {
+		n = MIN(devc->dig_channel_cnt - devc->batch_index, srccnt);
+		memcpy(devc->batch_data + devc->batch_index * 4, words, n * 4);
+		devc->batch_index += n;
+		words += n * 4;
+		srccnt -= n;
+		if (devc->batch_index < devc->dig_channel_cnt)
+			return;
+		sr_logic_transpose16(dst, devc->batch_data, 1,
+			devc->dig_channel_cnt, 4, devc->dig_channel_masks, TRUE);
+		devc->batch_index = 0;
+		devc->conv_size += CONV_BATCH_SIZE;
+		dst += 32;
 	}
-	devc->batch_index = batch_index;
+
+	/* Each word holds 32 samples of a channel, first one in the MSB. */
+	num_batches = srccnt / devc->dig_channel_cnt;
+	sr_logic_transpose16(dst, words, num_batches, devc->dig_channel_cnt,
+		4, devc->dig_channel_masks, TRUE);
+	devc->conv_size += num_batches * CONV_BATCH_SIZE;
+	words += num_batches * devc->dig_channel_cnt * 4;
+	srccnt -= num_batches * devc->dig_channel_cnt;
+
+	/* Keep the words of an incomplete batch for the next packet. */
+	memcpy(devc->batch_data, words, srccnt * 4);
+	devc->batch_index = srccnt;
 }
 
 SR_PRIV void LIBUSB_CALL saleae_logic_pro_receive_data(struct libusb_transfer *transfer)
@@ -31,7 +31,7 @@
 #define CONV_BATCH_SIZE (2 * 32)
 
 /*
- * One packet + one partial conversion: Worst case is only one active
+ * One packet + one completed partial batch: Worst case is only one active
  * channel converted to 2 bytes per sample, with 8 * 16384 samples per packet.
  */
 #define CONV_BUFFER_SIZE (2 * 8 * 16384 + CONV_BATCH_SIZE)
@@ -51,6 +51,8 @@ struct dev_context {
 	uint8_t *conv_buffer;
 	unsigned int conv_size;
 	unsigned int batch_index;
+	/* Channel words of an incomplete batch, batch_index of them. */
+	uint8_t batch_data[16 * 4];
 };
 
 SR_PRIV int saleae_logic_pro_init(const struct sr_dev_inst *sdi);
@@ -804,44 +804,54 @@ static void resubmit_transfer(struct libusb_transfer *transfer)
 	sr_err("%s: %s", __func__, libusb_error_name(ret));
 }
 
+/*
+ * The device sends blocks of a 16-bit word per enabled channel, holding
+ * 16 samples of that channel, most recent sample in the lowest bit.
+ */
 static size_t convert_sample_data(struct dev_context *devc,
 		uint8_t *dest, size_t destcnt, const uint8_t *src, size_t srccnt)
 {
-	uint16_t *channel_data;
-	int i, cur_channel;
-	size_t ret = 0;
-	uint16_t sample, channel_mask;
-
-	srccnt /= 2;
-
-	channel_data = devc->channel_data;
-	cur_channel = devc->cur_channel;
-
-	while (srccnt--) {
-		sample = src[0] | (src[1] << 8);
-		src += 2;
-
-		channel_mask = devc->channel_masks[cur_channel];
-
-		for (i = 15; i >= 0; --i, sample >>= 1)
-			if (sample & 1)
-				channel_data[i] |= channel_mask;
-
-		if (++cur_channel == devc->num_channels) {
-			cur_channel = 0;
-			if (destcnt < 16 * 2) {
-				sr_err("Conversion buffer too small!");
-				break;
-			}
-			memcpy(dest, channel_data, 16 * 2);
-			memset(channel_data, 0, 16 * 2);
-			dest += 16 * 2;
-			ret += 16;
-			destcnt -= 16 * 2;
+	size_t block_size, num_blocks, ret, n;
+
+	block_size = devc->num_channels * 2;
+	ret = 0;
+
+	/* Complete the block left over from the previous transfer. */
+	if (devc->cur_channel) {
+		n = MIN(block_size - devc->cur_channel * 2, srccnt & ~1);
+		memcpy(devc->channel_data + devc->cur_channel * 2, src, n);
+		devc->cur_channel += n / 2;
+		src += n;
+		srccnt -= n;
+		if (devc->cur_channel < devc->num_channels)
+			return 0;
+		if (destcnt < 16 * 2) {
+			sr_err("Conversion buffer too small!");
+			return 0;
 		}
-	}
-
-	devc->cur_channel = cur_channel;
+		sr_logic_transpose16((uint16_t *)dest, devc->channel_data, 1,
+			devc->num_channels, 2, devc->channel_masks, TRUE);
+		devc->cur_channel = 0;
+		dest += 16 * 2;
+		destcnt -= 16 * 2;
+		ret += 16;
+	}
+
+	num_blocks = srccnt / block_size;
+	if (num_blocks > destcnt / (16 * 2)) {
+		sr_err("Conversion buffer too small!");
+		num_blocks = destcnt / (16 * 2);
+	}
+	sr_logic_transpose16((uint16_t *)dest, src, num_blocks,
+		devc->num_channels, 2, devc->channel_masks, TRUE);
+	ret += num_blocks * 16;
+	src += num_blocks * block_size;
+	srccnt -= num_blocks * block_size;
+
+	/* Keep the words of an incomplete block for the next transfer. */
+	n = MIN(srccnt & ~1, block_size);
+	memcpy(devc->channel_data, src, n);
+	devc->cur_channel = n / 2;
 
 	return ret;
 }
@@ -80,7 +80,8 @@ struct dev_context {
 	int num_channels;
 	int cur_channel;
 	uint16_t channel_masks[16];
-	uint16_t channel_data[16];
+	/* Channel words of an incomplete block, cur_channel of them. */
+	uint8_t channel_data[16 * 2];
 	uint8_t *convbuffer;
 	size_t convbuffer_size;
 	struct soft_trigger_logic *stl;
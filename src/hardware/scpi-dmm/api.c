@@ -146,7 +146,7 @@ static struct sr_dev_inst *probe_device(struct sr_scpi_dev_inst *scpi)
 
 static GSList *scan(struct sr_dev_driver *di, GSList *options)
 {
-	return sr_scpi_scan(di->context, options, probe_device);
+	return sr_scpi_scan_concurrent(di->context, options, probe_device);
 }
 
 static int dev_open(struct sr_dev_inst *sdi)
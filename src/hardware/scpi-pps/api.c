@@ -239,7 +239,8 @@ static struct sr_dev_inst *probe_hpib_pps_device(struct sr_scpi_dev_inst *scpi)
 
 static GSList *scan_scpi_pps(struct sr_dev_driver *di, GSList *options)
 {
-	return sr_scpi_scan(di->context, options, probe_scpi_pps_device);
+	return sr_scpi_scan_concurrent(di->context, options,
+		probe_scpi_pps_device);
 }
 
 static GSList *scan_hpib_pps(struct sr_dev_driver *di, GSList *options)
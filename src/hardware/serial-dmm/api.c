@@ -42,6 +42,7 @@ static const uint32_t devopts[] = {
 	SR_CONF_CONTINUOUS,
 	SR_CONF_LIMIT_SAMPLES | SR_CONF_SET,
 	SR_CONF_LIMIT_MSEC | SR_CONF_SET,
+	SR_CONF_BUFFERSIZE | SR_CONF_GET | SR_CONF_SET,
 };
 
 static GSList *scan(struct sr_dev_driver *di, GSList *options)
@@ -130,6 +131,7 @@ static GSList *scan(struct sr_dev_driver *di, GSList *options)
 	sdi->model = g_strdup(dmm->device);
 	devc = g_malloc0(sizeof(struct dev_context));
 	sr_sw_limits_init(&devc->limits);
+	devc->batch_size = 1;
 	sdi->inst_type = SR_INST_SERIAL;
 	sdi->conn = serial;
 	sdi->priv = devc;
@@ -158,16 +160,52 @@ scan_cleanup:
 	return std_scan_complete(di, devices);
 }
 
+static int config_get(uint32_t key, GVariant **data,
+	const struct sr_dev_inst *sdi, const struct sr_channel_group *cg)
+{
+	struct dev_context *devc;
+
+	(void)cg;
+
+	if (!sdi)
+		return SR_ERR_ARG;
+
+	devc = sdi->priv;
+
+	switch (key) {
+	case SR_CONF_BUFFERSIZE:
+		*data = g_variant_new_uint64(devc->batch_size);
+		break;
+	default:
+		return sr_sw_limits_config_get(&devc->limits, key, data);
+	}
+
+	return SR_OK;
+}
+
 static int config_set(uint32_t key, GVariant *data,
 	const struct sr_dev_inst *sdi, const struct sr_channel_group *cg)
 {
 	struct dev_context *devc;
+	uint64_t size;
 
 	(void)cg;
 
 	devc = sdi->priv;
 
-	return sr_sw_limits_config_set(&devc->limits, key, data);
+	switch (key) {
+	case SR_CONF_BUFFERSIZE:
+		/* Readings per analog packet, opt-in batching. */
+		size = g_variant_get_uint64(data);
+		if (!size || size > DMM_BATCH_SIZE_MAX)
+			return SR_ERR_ARG;
+		devc->batch_size = size;
+		break;
+	default:
+		return sr_sw_limits_config_set(&devc->limits, key, data);
+	}
+
+	return SR_OK;
 }
 
 static int config_list(uint32_t key, GVariant **data,
@@ -184,6 +222,7 @@ static int dev_acquisition_start(const struct sr_dev_inst *sdi)
 	devc = sdi->priv;
 
 	sr_sw_limits_acquisition_start(&devc->limits);
+	dmm_batches_create(sdi);
 	std_session_send_df_header(sdi);
 
 	serial = sdi->conn;
@@ -193,6 +232,14 @@ static int dev_acquisition_start(const struct sr_dev_inst *sdi)
 	return SR_OK;
 }
 
+static int dev_acquisition_stop(struct sr_dev_inst *sdi)
+{
+	/* Send the readings which still wait for their packet to fill. */
+	dmm_batches_free(sdi, TRUE);
+
+	return std_serial_dev_acquisition_stop(sdi);
+}
+
 #define DMM(ID, CHIPSET, VENDOR, MODEL, CONN, BAUDRATE, PACKETSIZE, TIMEOUT, \
 			DELAY, REQUEST, VALID, PARSE, DETAILS) \
 	&((struct dmm_info) { \
@@ -205,13 +252,13 @@ static int dev_acquisition_start(const struct sr_dev_inst *sdi)
 			.scan = scan, \
 			.dev_list = std_dev_list, \
 			.dev_clear = std_dev_clear, \
-			.config_get = NULL, \
+			.config_get = config_get, \
 			.config_set = config_set, \
 			.config_list = config_list, \
 			.dev_open = std_serial_dev_open, \
 			.dev_close = std_serial_dev_close, \
 			.dev_acquisition_start = dev_acquisition_start, \
-			.dev_acquisition_stop = std_serial_dev_acquisition_stop, \
+			.dev_acquisition_stop = dev_acquisition_stop, \
 			.context = NULL, \
 		}, \
 		VENDOR, MODEL, CONN, BAUDRATE, PACKETSIZE, TIMEOUT, DELAY, \
@@ -29,11 +29,56 @@
 
 static void log_dmm_packet(const uint8_t *buf, size_t len)
 {
-	GString *text;
+	sr_dbg_hexdump("DMM packet:", buf, len);
+}
+
+/** Create the per-channel batches and the chipset info struct. */
+SR_PRIV int dmm_batches_create(const struct sr_dev_inst *sdi)
+{
+	struct dmm_info *dmm;
+	struct dev_context *devc;
+	struct sr_channel *ch;
+	GSList *l;
+	size_t ch_idx;
+
+	dmm = (struct dmm_info *)sdi->driver;
+	devc = sdi->priv;
+
+	devc->info = g_malloc(dmm->info_size);
+	devc->batches = g_malloc0(dmm->channel_count * sizeof(*devc->batches));
+	for (l = sdi->channels, ch_idx = 0; l && ch_idx < dmm->channel_count;
+			l = l->next, ch_idx++) {
+		ch = l->data;
+		if (!ch->enabled)
+			continue;
+		devc->batches[ch_idx] = sr_analog_batch_new(sdi, ch,
+			devc->batch_size, DMM_BATCH_LATENCY_MS);
+	}
 
-	text = sr_hexdump_new(buf, len);
-	sr_dbg("DMM packet: %s", text->str);
-	sr_hexdump_free(text);
+	return SR_OK;
+}
+
+/** Free the per-channel batches, optionally sending pending readings. */
+SR_PRIV void dmm_batches_free(const struct sr_dev_inst *sdi, gboolean flush)
+{
+	struct dmm_info *dmm;
+	struct dev_context *devc;
+	size_t ch_idx;
+
+	dmm = (struct dmm_info *)sdi->driver;
+	devc = sdi->priv;
+
+	if (devc->batches) {
+		for (ch_idx = 0; ch_idx < dmm->channel_count; ch_idx++) {
+			if (flush)
+				sr_analog_batch_flush(devc->batches[ch_idx]);
+			sr_analog_batch_free(devc->batches[ch_idx]);
+		}
+	}
+	g_free(devc->batches);
+	devc->batches = NULL;
+	g_free(devc->info);
+	devc->info = NULL;
 }
 
 static void handle_packet(const uint8_t *buf, struct sr_dev_inst *sdi,
@@ -41,14 +86,12 @@ static void handle_packet(const uint8_t *buf, struct sr_dev_inst *sdi,
 {
 	struct dmm_info *dmm;
 	float floatval;
-	struct sr_datafeed_packet packet;
 	struct sr_datafeed_analog analog;
 	struct sr_analog_encoding encoding;
 	struct sr_analog_meaning meaning;
 	struct sr_analog_spec spec;
 	struct dev_context *devc;
 	gboolean sent_sample;
-	struct sr_channel *channel;
 	size_t ch_idx;
 
 	dmm = (struct dmm_info *)sdi->driver;
@@ -61,9 +104,6 @@ static void handle_packet(const uint8_t *buf, struct sr_dev_inst *sdi,
 	for (ch_idx = 0; ch_idx < dmm->channel_count; ch_idx++) {
 		/* Note: digits/spec_digits will be overridden by the DMM parsers. */
 		sr_analog_init(&analog, &encoding, &meaning, &spec, 0);
-
-		channel = g_slist_nth_data(sdi->channels, ch_idx);
-		analog.meaning->channels = g_slist_append(NULL, channel);
 		analog.num_samples = 1;
 		analog.meaning->mq = 0;
 
@@ -74,11 +114,10 @@ static void handle_packet(const uint8_t *buf, struct sr_dev_inst *sdi,
 		if (dmm->dmm_details)
 			dmm->dmm_details(&analog, info);
 
-		if (analog.meaning->mq != 0 && channel->enabled) {
-			/* Got a measurement. */
-			packet.type = SR_DF_ANALOG;
-			packet.payload = &analog;
-			sr_session_send(sdi, &packet);
+		if (analog.meaning->mq != 0 && devc->batches[ch_idx]) {
+			/* Got a measurement, send it once the batch is full. */
+			sr_analog_batch_add(devc->batches[ch_idx], &analog,
+				floatval);
 			sent_sample = TRUE;
 		}
 	}
@@ -122,7 +161,7 @@ SR_PRIV int req_packet(struct sr_dev_inst *sdi)
 	return SR_OK;
 }
 
-static void handle_new_data(struct sr_dev_inst *sdi, void *info)
+static void handle_new_data(struct sr_dev_inst *sdi)
 {
 	struct dmm_info *dmm;
 	struct dev_context *devc;
@@ -149,7 +188,7 @@ static void handle_new_data(struct sr_dev_inst *sdi, void *info)
 	offset = 0;
 	while ((devc->buflen - offset) >= dmm->packet_size) {
 		if (dmm->packet_valid(devc->buf + offset)) {
-			handle_packet(devc->buf + offset, sdi, info);
+			handle_packet(devc->buf + offset, sdi, devc->info);
 			offset += dmm->packet_size;
 
 			/* Request next packet, if required. */
@@ -175,7 +214,7 @@ int receive_data(int fd, int revents, void *cb_data)
 	struct sr_dev_inst *sdi;
 	struct dev_context *devc;
 	struct dmm_info *dmm;
-	void *info;
+	size_t ch_idx;
 
 	(void)fd;
 
@@ -189,15 +228,17 @@ int receive_data(int fd, int revents, void *cb_data)
 
 	if (revents == G_IO_IN) {
 		/* Serial data arrived. */
-		info = g_malloc(dmm->info_size);
-		handle_new_data(sdi, info);
-		g_free(info);
+		handle_new_data(sdi);
 	} else {
 		/* Timeout; send another packet request if DMM needs it. */
 		if (dmm->packet_request && (req_packet(sdi) < 0))
 			return FALSE;
 	}
 
+	/* Don't hold back readings of slow meters for too long. */
+	for (ch_idx = 0; devc->batches && ch_idx < dmm->channel_count; ch_idx++)
+		sr_analog_batch_poll(devc->batches[ch_idx]);
+
 	if (sr_sw_limits_check(&devc->limits))
 		sr_dev_acquisition_stop(sdi);
 
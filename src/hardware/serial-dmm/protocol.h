@@ -64,6 +64,11 @@ struct dmm_info {
 
 #define DMM_BUFSIZE 256
 
+/** Upper bound for the number of readings per analog packet. */
+#define DMM_BATCH_SIZE_MAX 4096
+/** Maximum age [ms] of a reading which waits for its packet to fill. */
+#define DMM_BATCH_LATENCY_MS 250
+
 struct dev_context {
 	struct sr_sw_limits limits;
 
@@ -76,9 +81,18 @@ struct dev_context {
 	 * Used only if device needs polling.
 	 */
 	int64_t req_next_at;
+
+	/** Readings per analog packet, 1 sends every reading immediately. */
+	uint64_t batch_size;
+	/** Per-channel batches, NULL for disabled channels. */
+	struct sr_analog_batch **batches;
+	/** Chipset info struct, reused for every packet. */
+	void *info;
 };
 
 SR_PRIV int req_packet(struct sr_dev_inst *sdi);
 SR_PRIV int receive_data(int fd, int revents, void *cb_data);
+SR_PRIV int dmm_batches_create(const struct sr_dev_inst *sdi);
+SR_PRIV void dmm_batches_free(const struct sr_dev_inst *sdi, gboolean flush);
 
 #endif
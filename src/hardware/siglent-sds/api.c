@@ -348,7 +348,6 @@ static struct sr_dev_inst *probe_device(struct sr_scpi_dev_inst *scpi)
 
 	devc->buffer = g_malloc(devc->model->series->buffer_samples);
 	sr_dbg("Setting device context buffer size: %i.", devc->model->series->buffer_samples);
-	devc->data = g_malloc(devc->model->series->buffer_samples * sizeof(float));
 
 	devc->data_source = DATA_SOURCE_SCREEN;
 
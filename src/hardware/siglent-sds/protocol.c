@@ -465,8 +465,8 @@ SR_PRIV int siglent_sds_receive(int fd, int revents, void *cb_data)
 	struct sr_analog_spec spec;
 	struct sr_datafeed_logic logic;
 	struct sr_channel *ch;
-	int len, i;
-	float wait;
+	int len, digits;
+	float wait, vdiv, offset, vdivlog;
 	gboolean read_complete = FALSE;
 
 	(void)fd;
@@ -577,27 +577,21 @@ SR_PRIV int siglent_sds_receive(int fd, int revents, void *cb_data)
 				}
 				sr_dbg("Received block: %i, %d bytes.", devc->num_block_read, len);
 				if (ch->type == SR_CHANNEL_ANALOG) {
-					float vdiv = devc->vdiv[ch->index];
-					float offset = devc->vert_offset[ch->index];
-					GArray *float_data;
-					static GArray *data;
-					float voltage, vdivlog;
-					int digits;
-
-					data = g_array_sized_new(FALSE, FALSE, sizeof(uint8_t), len);
-					g_array_append_vals(data, devc->buffer, len);
-					float_data = g_array_new(FALSE, FALSE, sizeof(float));
-					for (i = 0; i < len; i++) {
-						voltage = (float)g_array_index(data, int8_t, i) / 25;
-						voltage = ((vdiv * voltage) - offset);
-						g_array_append_val(float_data, voltage);
-					}
+					vdiv = devc->vdiv[ch->index];
+					offset = devc->vert_offset[ch->index];
 					vdivlog = log10f(vdiv);
 					digits = -(int) vdivlog + (vdivlog < 0.0);
 					sr_analog_init(&analog, &encoding, &meaning, &spec, digits);
+					/* Signed ADC bytes, voltage = raw / 25 * vdiv - offset. */
+					encoding.unitsize = 1;
+					encoding.is_signed = TRUE;
+					encoding.is_float = FALSE;
+					encoding.is_bigendian = FALSE;
+					sr_rational_from_double(&encoding.scale, vdiv / 25);
+					sr_rational_from_double(&encoding.offset, -offset);
 					analog.meaning->channels = g_slist_append(NULL, ch);
-					analog.num_samples = float_data->len;
-					analog.data = (float *)float_data->data;
+					analog.num_samples = len;
+					analog.data = devc->buffer;
 					analog.meaning->mq = SR_MQ_VOLTAGE;
 					analog.meaning->unit = SR_UNIT_VOLT;
 					analog.meaning->mqflags = 0;
@@ -605,7 +599,6 @@ SR_PRIV int siglent_sds_receive(int fd, int revents, void *cb_data)
 					packet.payload = &analog;
 					sr_session_send(sdi, &packet);
 					g_slist_free(analog.meaning->channels);
-					g_array_free(data, TRUE);
 				}
 				len = 0;
 				if (devc->num_samples == (devc->num_block_bytes - SIGLENT_HEADER_SIZE)) {
@@ -151,7 +151,6 @@ struct dev_context {
 	int wait_status;
 	/* Acq buffers used for reading from the scope and sending data to app. */
 	unsigned char *buffer;
-	float *data;
 	GArray *dig_buffer;
 };
 
@@ -39,6 +39,7 @@ static const int32_t trigger_matches[] = {
 	SR_TRIGGER_ONE,
 	SR_TRIGGER_RISING,
 	SR_TRIGGER_FALLING,
+	SR_TRIGGER_EDGE,
 };
 
 static const char *trigger_sources[] = {
@@ -482,55 +483,40 @@ static int config_channel_set(const struct sr_dev_inst *sdi,
 	return SR_OK;
 }
 
-/* Derive trigger masks from the session's trigger configuration. */
+/*
+ * Derive trigger masks from the session's trigger configuration. Parts
+ * which the hardware can't evaluate get checked by the host while the
+ * capture memory is read out.
+ */
 static int prepare_trigger_masks(const struct sr_dev_inst *sdi)
 {
 	uint64_t trigger_mask, trigger_values, trigger_edge_mask;
 	uint64_t level_bit, type_bit;
 	struct dev_context *devc;
-	struct sr_trigger *trigger;
+	struct sr_trigger_plan plan;
 	struct sr_trigger_stage *stage;
 	struct sr_trigger_match *match;
 	const GSList *node;
-	int idx;
+	int idx, ret;
 	enum sr_trigger_matches trg;
 
 	devc = sdi->priv;
 
-	trigger = sr_session_trigger_get(sdi->session);
-	if (!trigger || !trigger->stages)
-		return SR_OK;
-
-	if (trigger->stages->next) {
-		sr_err("This device only supports 1 trigger stage.");
-		return SR_ERR_ARG;
-	}
-	stage = trigger->stages->data;
+	ret = sr_trigger_plan_init(sr_session_trigger_get(sdi->session),
+		&devc->model->trigger_caps, &plan);
+	if (ret != SR_OK)
+		return ret;
 
 	trigger_mask = 0;
 	trigger_values = 0;
 	trigger_edge_mask = 0;
 
-	for (node = stage->matches; node; node = node->next) {
+	stage = plan.hw ? plan.hw->stages->data : NULL;
+	for (node = stage ? stage->matches : NULL; node; node = node->next) {
 		match = node->data;
-
-		if (!match->channel->enabled)
-			continue; /* Ignore disabled channel. */
-
 		idx = match->channel->index;
 		trg = match->match;
 
-		if (idx < 0 || idx >= devc->model->num_channels) {
-			sr_err("Channel index %d out of range.", idx);
-			return SR_ERR_BUG; /* Should not happen. */
-		}
-		if (trg != SR_TRIGGER_ZERO
-				&& trg != SR_TRIGGER_ONE
-				&& trg != SR_TRIGGER_RISING
-				&& trg != SR_TRIGGER_FALLING) {
-			sr_err("Unsupported trigger match for CH%d.", idx + 1);
-			return SR_ERR_ARG;
-		}
 		level_bit = (trg == SR_TRIGGER_ONE
 			|| trg == SR_TRIGGER_RISING) ? 1 : 0;
 		type_bit = (trg == SR_TRIGGER_RISING
@@ -543,6 +529,10 @@ static int prepare_trigger_masks(const struct sr_dev_inst *sdi)
 	devc->trigger_mask = trigger_mask;
 	devc->trigger_values = trigger_values;
 	devc->trigger_edge_mask = trigger_edge_mask;
+	devc->trigger_on_host = plan.soft != NULL;
+	devc->trigger_on_device = plan.hw != NULL;
+
+	sr_trigger_plan_clear(&plan);
 
 	return SR_OK;
 }
@@ -110,16 +110,25 @@ struct acquisition_state {
 	uint64_t sample;	/* last sample read from capture memory */
 	uint64_t run_len;	/* remaining run length of current sample */
 
-	struct libusb_transfer *xfer_in;	/* USB in transfer record */
+	struct libusb_transfer *xfer_in;	/* USB in transfer being handled */
 	struct libusb_transfer *xfer_out;	/* USB out transfer record */
+	struct libusb_transfer *xfer_in_pool[2]; /* alternating in transfers */
+	unsigned int xfer_in_slot;	/* pool index of next in transfer */
+	unsigned int xfers_pending;	/* number of submitted transfers */
+	gboolean out_pending;		/* out transfer not completed yet */
+	gboolean in_deferred;		/* in transfer completed before out */
+	gboolean read_stopping;		/* discard the read still in flight */
 
 	unsigned int mem_addr_fill;	/* capture memory fill level */
 	unsigned int mem_addr_done;	/* next address to be processed */
-	unsigned int mem_addr_next;	/* start address for next async read */
+	unsigned int mem_addr_next;	/* end address of the handled read */
+	unsigned int mem_addr_req;	/* start address for next async read */
 	unsigned int mem_addr_stop;	/* end of memory range to be read */
+	unsigned int read_end[2];	/* end address of read per in transfer */
 	unsigned int in_index;		/* position in read transfer buffer */
 	unsigned int out_index;		/* position in logic packet buffer */
 	enum rle_state rle;		/* RLE decoding state */
+	struct soft_trigger_logic *stl;	/* host trigger check, or NULL */
 
 	gboolean rle_enabled;	/* capturing in timing-state mode */
 	gboolean clock_boost;	/* switch to faster clock during capture */
@@ -129,7 +138,8 @@ struct acquisition_state {
 	unsigned int reg_seq_len;	/* length of register/value sequence */
 
 	struct regval reg_sequence[MAX_REG_SEQ_LEN];	/* register buffer */
-	uint32_t xfer_buf_in[MAX_ACQ_RECV_LEN32];	/* USB in buffer */
+	uint32_t *xfer_buf_in;				/* buffer of xfer_in */
+	uint32_t xfer_bufs_in[2][MAX_ACQ_RECV_LEN32];	/* USB in buffers */
 	uint16_t xfer_buf_out[MAX_ACQ_SEND_LEN16];	/* USB out buffer */
 	uint8_t out_packet[PACKET_SIZE];		/* logic payload */
 };
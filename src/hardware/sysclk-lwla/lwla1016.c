@@ -369,16 +369,16 @@ static int prepare_request(const struct sr_dev_inst *sdi)
 		/* Limit reads to 16 device words (64 bytes) at a time if the
 		 * device firmware has the short transfer quirk. */
 		chunk_len = (devc->short_transfer_quirk) ? 16 : READ_CHUNK_LEN;
-		count = MIN(chunk_len, acq->mem_addr_stop - acq->mem_addr_next);
+		count = MIN(chunk_len, acq->mem_addr_stop - acq->mem_addr_req);
 
 		acq->xfer_buf_out[0] = LWLA_WORD(CMD_READ_MEM32);
-		acq->xfer_buf_out[1] = LWLA_WORD_0(acq->mem_addr_next);
-		acq->xfer_buf_out[2] = LWLA_WORD_1(acq->mem_addr_next);
+		acq->xfer_buf_out[1] = LWLA_WORD_0(acq->mem_addr_req);
+		acq->xfer_buf_out[2] = LWLA_WORD_1(acq->mem_addr_req);
 		acq->xfer_buf_out[3] = LWLA_WORD_0(count);
 		acq->xfer_buf_out[4] = LWLA_WORD_1(count);
 		acq->xfer_out->length = 5 * sizeof(acq->xfer_buf_out[0]);
 
-		acq->mem_addr_next += count;
+		acq->mem_addr_req += count;
 		break;
 	default:
 		sr_err("BUG: unhandled request state %d.", devc->state);
@@ -405,6 +405,7 @@ static int handle_response(const struct sr_dev_inst *sdi)
 		break;
 	case STATE_LENGTH_REQUEST:
 		acq->mem_addr_next = READ_START_ADDR;
+		acq->mem_addr_req = READ_START_ADDR;
 		acq->mem_addr_stop = acq->reg_sequence[0].val + READ_START_ADDR - 1;
 		break;
 	case STATE_READ_REQUEST:
@@ -453,6 +454,17 @@ SR_PRIV const struct model_info lwla1016_info = {
 		SR_HZ(500),  SR_HZ(200),  SR_HZ(100),
 	},
 
+	.trigger_caps = {
+		.num_stages = 1,
+		.channels = UINT64_C(0xFFFF),
+		.matches = SR_TRIGGER_MATCH_BIT(SR_TRIGGER_ZERO)
+			| SR_TRIGGER_MATCH_BIT(SR_TRIGGER_ONE)
+			| SR_TRIGGER_MATCH_BIT(SR_TRIGGER_RISING)
+			| SR_TRIGGER_MATCH_BIT(SR_TRIGGER_FALLING),
+		.max_edges = -1,
+		.max_rewind = 0,
+	},
+
 	.apply_fpga_config = &apply_fpga_config,
 	.device_init_check = &device_init_check,
 	.setup_acquisition = &setup_acquisition,
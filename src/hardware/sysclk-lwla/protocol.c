@@ -26,8 +26,11 @@
 static int submit_transfer(struct dev_context *devc,
 			   struct libusb_transfer *xfer)
 {
+	struct acquisition_state *acq;
 	int ret;
 
+	acq = devc->acquisition;
+
 	ret = libusb_submit_transfer(xfer);
 
 	if (ret != 0) {
@@ -35,10 +38,47 @@ static int submit_transfer(struct dev_context *devc,
 		devc->transfer_error = TRUE;
 		return SR_ERR;
 	}
+	acq->xfers_pending++;
+	if (xfer == acq->xfer_out)
+		acq->out_pending = TRUE;
 
 	return SR_OK;
 }
 
+/* Submit the in transfer for the next response. The two in transfers
+ * are used alternately, so that the response to a memory read request
+ * can be received while the previous one is still being decoded.
+ */
+static int submit_in_transfer(struct dev_context *devc)
+{
+	struct acquisition_state *acq;
+	unsigned int slot;
+	int ret;
+
+	acq = devc->acquisition;
+	slot = acq->xfer_in_slot;
+
+	acq->read_end[slot] = acq->mem_addr_req;
+	ret = submit_transfer(devc, acq->xfer_in_pool[slot]);
+	if (ret == SR_OK)
+		acq->xfer_in_slot = slot ^ 1;
+
+	return ret;
+}
+
+/* Cancel the transfers still in flight. Returns FALSE once none are. */
+static gboolean cancel_pending_transfers(struct acquisition_state *acq)
+{
+	if (!acq || acq->xfers_pending == 0)
+		return FALSE;
+
+	libusb_cancel_transfer(acq->xfer_out);
+	libusb_cancel_transfer(acq->xfer_in_pool[0]);
+	libusb_cancel_transfer(acq->xfer_in_pool[1]);
+
+	return TRUE;
+}
+
 /* Set up transfer for the next register in a write sequence. */
 static void next_reg_write(struct acquisition_state *acq)
 {
@@ -115,7 +155,13 @@ static int submit_request(const struct sr_dev_inst *sdi,
 			next_reg_write(acq);
 	}
 
-	return submit_transfer(devc, acq->xfer_out);
+	ret = submit_transfer(devc, acq->xfer_out);
+
+	/* Queue the response to a memory read along with the request. */
+	if (ret == SR_OK && state == STATE_READ_REQUEST)
+		ret = submit_in_transfer(devc);
+
+	return ret;
 }
 
 /* Evaluate and act on the response to a capture status request. */
@@ -154,6 +200,47 @@ static void handle_status_response(const struct sr_dev_inst *sdi)
 	}
 }
 
+/*
+ * Send the decoded samples to the session bus. If the hardware trigger
+ * is not exact, check the samples for the full trigger first: samples
+ * before the trigger point get dropped and don't count towards the
+ * sample limit.
+ */
+static void send_logic_packet(const struct sr_dev_inst *sdi)
+{
+	struct dev_context *devc;
+	struct acquisition_state *acq;
+	struct sr_datafeed_packet packet;
+	struct sr_datafeed_logic logic;
+	int unitsize, offset;
+
+	devc = sdi->priv;
+	acq = devc->acquisition;
+
+	unitsize = (devc->model->num_channels + 7) / 8;
+	packet.type = SR_DF_LOGIC;
+	packet.payload = &logic;
+	logic.unitsize = unitsize;
+	logic.data = acq->out_packet;
+	logic.length = acq->out_index * unitsize;
+	acq->out_index = 0;
+
+	if (acq->stl) {
+		offset = soft_trigger_logic_check(acq->stl, acq->out_packet,
+						  logic.length, NULL);
+		if (offset < 0) {
+			acq->samples_done -= logic.length / unitsize;
+			return;
+		}
+		acq->samples_done -= offset;
+		logic.data = acq->out_packet + offset * unitsize;
+		logic.length -= offset * unitsize;
+		soft_trigger_logic_free(acq->stl);
+		acq->stl = NULL;
+	}
+	sr_session_send(sdi, &packet);
+}
+
 /* Evaluate and act on the response to a capture length request. */
 static void handle_length_response(const struct sr_dev_inst *sdi)
 {
@@ -189,56 +276,64 @@ static void handle_read_response(const struct sr_dev_inst *sdi)
 {
 	struct dev_context *devc;
 	struct acquisition_state *acq;
-	struct sr_datafeed_packet packet;
-	struct sr_datafeed_logic logic;
-	unsigned int end_addr;
+	unsigned int end_addr, unitsize;
+	gboolean requested;
 
 	devc = sdi->priv;
 	acq = devc->acquisition;
 
-	/* Prepare session packet. */
-	packet.type = SR_DF_LOGIC;
-	packet.payload = &logic;
-	logic.unitsize = (devc->model->num_channels + 7) / 8;
-	logic.data = acq->out_packet;
-
+	unitsize = (devc->model->num_channels + 7) / 8;
 	end_addr = MIN(acq->mem_addr_next, acq->mem_addr_stop);
 	acq->in_index = 0;
 
 	/*
-	 * Repeatedly call the model-specific read response handler until
-	 * all data received in the transfer has been accounted for.
+	 * Request the next block before decoding this one, so that the
+	 * device reads out its memory while the host decodes. A block
+	 * requested just before reaching the end is discarded.
 	 */
-	while (!devc->cancel_requested
-			&& (acq->run_len > 0 || acq->mem_addr_done < end_addr)
-			&& acq->samples_done < acq->samples_max) {
-
-		if ((*devc->model->handle_response)(sdi) != SR_OK) {
-			devc->transfer_error = TRUE;
-			return;
+	requested = FALSE;
+	if (acq->read_stopping) {
+		acq->read_stopping = FALSE;
+	} else {
+		if (!devc->cancel_requested
+				&& acq->samples_done < acq->samples_max
+				&& acq->mem_addr_req < acq->mem_addr_stop) {
+			if (submit_request(sdi, STATE_READ_REQUEST) != SR_OK)
+				return;
+			requested = TRUE;
 		}
-		if (acq->out_index * logic.unitsize >= PACKET_SIZE) {
-			/* Send off full logic packet. */
-			logic.length = acq->out_index * logic.unitsize;
-			sr_session_send(sdi, &packet);
-			acq->out_index = 0;
+
+		/*
+		 * Repeatedly call the model-specific read response handler
+		 * until all data received in the transfer has been
+		 * accounted for.
+		 */
+		while (!devc->cancel_requested
+				&& (acq->run_len > 0 || acq->mem_addr_done < end_addr)
+				&& acq->samples_done < acq->samples_max) {
+
+			if ((*devc->model->handle_response)(sdi) != SR_OK) {
+				devc->transfer_error = TRUE;
+				return;
+			}
+			if (acq->out_index * unitsize >= PACKET_SIZE) {
+				/* Send off full logic packet. */
+				send_logic_packet(sdi);
+			}
 		}
 	}
 
-	if (!devc->cancel_requested
-			&& acq->samples_done < acq->samples_max
-			&& acq->mem_addr_next < acq->mem_addr_stop) {
-		/* Request the next block. */
-		submit_request(sdi, STATE_READ_REQUEST);
+	if (requested) {
+		/* Finish once the block in flight has arrived. */
+		if (devc->cancel_requested
+				|| acq->samples_done >= acq->samples_max)
+			acq->read_stopping = TRUE;
 		return;
 	}
 
 	/* Send partially filled packet as it is the last one. */
-	if (!devc->cancel_requested && acq->out_index > 0) {
- 		logic.length = acq->out_index * logic.unitsize;
-		sr_session_send(sdi, &packet);
-		acq->out_index = 0;
-	}
+	if (!devc->cancel_requested && acq->out_index > 0)
+		send_logic_packet(sdi);
 	submit_request(sdi, STATE_READ_FINISH);
 }
 
@@ -255,7 +350,10 @@ static void clear_acquisition_state(const struct sr_dev_inst *sdi)
 
 	if (acq) {
 		libusb_free_transfer(acq->xfer_out);
-		libusb_free_transfer(acq->xfer_in);
+		libusb_free_transfer(acq->xfer_in_pool[0]);
+		libusb_free_transfer(acq->xfer_in_pool[1]);
+		if (acq->stl)
+			soft_trigger_logic_free(acq->stl);
 		g_free(acq);
 	}
 }
@@ -296,8 +394,12 @@ static int transfer_event(int fd, int revents, void *cb_data)
 	}
 
 	/* Stop processing events if an error occurred on a transfer. */
-	if (devc->transfer_error)
+	if (devc->transfer_error) {
 		devc->state = STATE_IDLE;
+		/* Wait for the transfers in flight before freeing them. */
+		if (cancel_pending_transfers(devc->acquisition))
+			return G_SOURCE_CONTINUE;
+	}
 
 	if (devc->state != STATE_IDLE)
 		return G_SOURCE_CONTINUE;
@@ -322,6 +424,11 @@ static void LIBUSB_CALL transfer_out_completed(struct libusb_transfer *transfer)
 	devc = sdi->priv;
 	acq = devc->acquisition;
 
+	acq->xfers_pending--;
+	acq->out_pending = FALSE;
+	if (devc->transfer_error)
+		return; /* Draining transfers after an error. */
+
 	if (transfer->status != LIBUSB_TRANSFER_COMPLETED) {
 		sr_err("Transfer to device failed (state %d): %s.",
 		       devc->state, libusb_error_name(transfer->status));
@@ -331,7 +438,13 @@ static void LIBUSB_CALL transfer_out_completed(struct libusb_transfer *transfer)
 
 	/* If this was a read request, wait for the response. */
 	if ((devc->state & STATE_EXPECT_RESPONSE) != 0) {
-		submit_transfer(devc, acq->xfer_in);
+		if (devc->state != STATE_READ_REQUEST) {
+			submit_in_transfer(devc);
+		} else if (acq->in_deferred) {
+			/* The response was reaped before the request. */
+			acq->in_deferred = FALSE;
+			handle_read_response(sdi);
+		}
 		return;
 	}
 	if (acq->reg_seq_pos < acq->reg_seq_len)
@@ -366,6 +479,15 @@ static void LIBUSB_CALL transfer_out_completed(struct libusb_transfer *transfer)
 			submit_request(sdi, STATE_READ_FINISH);
 		break;
 	case STATE_READ_FINISH:
+		/* All samples were dropped if the host check never matched. */
+		if (acq->stl && !devc->cancel_requested) {
+			if (devc->trigger_on_device)
+				sr_warn("Hardware trigger fired, but the captured "
+					"data doesn't match the complete trigger.");
+			else
+				sr_warn("No sample in the captured data matches "
+					"the trigger.");
+		}
 		devc->state = STATE_IDLE;
 		break;
 	default:
@@ -386,6 +508,10 @@ static void LIBUSB_CALL transfer_in_completed(struct libusb_transfer *transfer)
 	devc = sdi->priv;
 	acq = devc->acquisition;
 
+	acq->xfers_pending--;
+	if (devc->transfer_error)
+		return; /* Draining transfers after an error. */
+
 	if (transfer->status != LIBUSB_TRANSFER_COMPLETED) {
 		sr_err("Transfer from device failed (state %d): %s.",
 		       devc->state, libusb_error_name(transfer->status));
@@ -398,6 +524,8 @@ static void LIBUSB_CALL transfer_in_completed(struct libusb_transfer *transfer)
 		devc->transfer_error = TRUE;
 		return;
 	}
+	acq->xfer_in = transfer;
+	acq->xfer_buf_in = (uint32_t *)transfer->buffer;
 
 	if (acq->reg_seq_pos < acq->reg_seq_len && !devc->cancel_requested) {
 		/* Complete register read sequence. */
@@ -427,7 +555,12 @@ static void LIBUSB_CALL transfer_in_completed(struct libusb_transfer *transfer)
 			handle_length_response(sdi);
 		break;
 	case STATE_READ_REQUEST:
-		handle_read_response(sdi);
+		acq->mem_addr_next =
+			acq->read_end[transfer == acq->xfer_in_pool[1]];
+		if (acq->out_pending)
+			acq->in_deferred = TRUE;
+		else
+			handle_read_response(sdi);
 		break;
 	default:
 		sr_err("Unexpected device state %d.", devc->state);
@@ -442,6 +575,8 @@ static int init_acquisition_state(const struct sr_dev_inst *sdi)
 	struct dev_context *devc;
 	struct sr_usb_dev_inst *usb;
 	struct acquisition_state *acq;
+	struct sr_trigger *trigger;
+	unsigned int i;
 
 	devc = sdi->priv;
 	usb = sdi->conn;
@@ -459,14 +594,13 @@ static int init_acquisition_state(const struct sr_dev_inst *sdi)
 	if (!acq)
 		return SR_ERR_MALLOC;
 
-	acq->xfer_in = libusb_alloc_transfer(0);
-	if (!acq->xfer_in) {
-		g_free(acq);
-		return SR_ERR_MALLOC;
-	}
 	acq->xfer_out = libusb_alloc_transfer(0);
-	if (!acq->xfer_out) {
-		libusb_free_transfer(acq->xfer_in);
+	acq->xfer_in_pool[0] = libusb_alloc_transfer(0);
+	acq->xfer_in_pool[1] = libusb_alloc_transfer(0);
+	if (!acq->xfer_out || !acq->xfer_in_pool[0] || !acq->xfer_in_pool[1]) {
+		libusb_free_transfer(acq->xfer_out);
+		libusb_free_transfer(acq->xfer_in_pool[0]);
+		libusb_free_transfer(acq->xfer_in_pool[1]);
 		g_free(acq);
 		return SR_ERR_MALLOC;
 	}
@@ -476,11 +610,16 @@ static int init_acquisition_state(const struct sr_dev_inst *sdi)
 				  &transfer_out_completed,
 				  (struct sr_dev_inst *)sdi, USB_TIMEOUT_MS);
 
-	libusb_fill_bulk_transfer(acq->xfer_in, usb->devhdl, EP_REPLY,
-				  (unsigned char *)acq->xfer_buf_in,
-				  sizeof(acq->xfer_buf_in),
-				  &transfer_in_completed,
-				  (struct sr_dev_inst *)sdi, USB_TIMEOUT_MS);
+	for (i = 0; i < G_N_ELEMENTS(acq->xfer_in_pool); i++)
+		libusb_fill_bulk_transfer(acq->xfer_in_pool[i], usb->devhdl,
+					  EP_REPLY,
+					  (unsigned char *)acq->xfer_bufs_in[i],
+					  sizeof(acq->xfer_bufs_in[i]),
+					  &transfer_in_completed,
+					  (struct sr_dev_inst *)sdi,
+					  USB_TIMEOUT_MS);
+	acq->xfer_in = acq->xfer_in_pool[0];
+	acq->xfer_buf_in = acq->xfer_bufs_in[0];
 
 	if (devc->limit_msec > 0) {
 		acq->duration_max = devc->limit_msec;
@@ -502,8 +641,13 @@ static int init_acquisition_state(const struct sr_dev_inst *sdi)
 		/* Ramp up clock speed to enable samplerates above 100 MS/s. */
 		acq->clock_boost = (devc->samplerate > SR_MHZ(100));
 
-		/* If only one of the limits is set, derive the other one. */
-		if (devc->limit_msec == 0 && devc->limit_samples > 0)
+		/*
+		 * If only one of the limits is set, derive the other one.
+		 * With the trigger checked on the host, the samples before
+		 * the trigger point don't count, so keep capturing.
+		 */
+		if (devc->limit_msec == 0 && devc->limit_samples > 0
+				&& !devc->trigger_on_host)
 			acq->duration_max = devc->limit_samples
 					* 1000 / devc->samplerate + 1;
 		else if (devc->limit_samples == 0 && devc->limit_msec > 0)
@@ -521,6 +665,16 @@ static int init_acquisition_state(const struct sr_dev_inst *sdi)
 	acq->rle_enabled = devc->cfg_rle;
 	devc->acquisition = acq;
 
+	trigger = sr_session_trigger_get(sdi->session);
+	if (devc->trigger_on_host && trigger) {
+		sr_info("Checking trigger on the host.");
+		acq->stl = soft_trigger_logic_new(sdi, trigger, 0);
+		if (!acq->stl) {
+			clear_acquisition_state(sdi);
+			return SR_ERR_MALLOC;
+		}
+	}
+
 	return SR_OK;
 }
 
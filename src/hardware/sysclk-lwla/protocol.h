@@ -114,6 +114,8 @@ struct dev_context {
 	uint64_t trigger_mask;		/* trigger enable mask */
 	uint64_t trigger_edge_mask;	/* trigger type mask */
 	uint64_t trigger_values;	/* trigger level/slope bits */
+	gboolean trigger_on_host;	/* host checks the full trigger */
+	gboolean trigger_on_device;	/* hardware trigger stage programmed */
 
 	const struct model_info *model;		/* device model descriptor */
 	struct acquisition_state *acquisition;	/* running capture state */
@@ -142,6 +144,8 @@ struct model_info {
 	unsigned int num_samplerates;
 	uint64_t samplerates[20];
 
+	struct sr_trigger_hw_caps trigger_caps;
+
 	int (*apply_fpga_config)(const struct sr_dev_inst *sdi);
 	int (*device_init_check)(const struct sr_dev_inst *sdi);
 	int (*setup_acquisition)(const struct sr_dev_inst *sdi);
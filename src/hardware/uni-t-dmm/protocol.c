@@ -164,11 +164,7 @@ static void log_8byte_chunk(const uint8_t *buf)
 
 static void log_dmm_packet(const uint8_t *buf)
 {
-	GString *text;
-
-	text = sr_hexdump_new(buf, 14);
-	sr_dbg("DMM packet:   %s", text->str);
-	sr_hexdump_free(text);
+	sr_dbg_hexdump("DMM packet:  ", buf, 14);
 }
 
 static int get_and_handle_data(struct sr_dev_inst *sdi)
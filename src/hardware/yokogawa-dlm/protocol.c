@@ -906,9 +906,7 @@ static int dlm_analog_samples_send(GArray *data,
 		struct analog_channel_state *ch_state,
 		struct sr_dev_inst *sdi)
 {
-	uint32_t i, samples;
-	float voltage, range, offset;
-	GArray *float_data;
+	uint32_t samples;
 	struct dev_context *devc;
 	struct scope_state *model_state;
 	struct sr_channel *ch;
@@ -928,26 +926,25 @@ static int dlm_analog_samples_send(GArray *data,
 		return SR_ERR;
 	}
 
-	range = ch_state->waveform_range;
-	offset = ch_state->waveform_offset;
+	/* TODO: Use proper 'digits' value for this device (and its modes). */
+	sr_analog_init(&analog, &encoding, &meaning, &spec, 2);
 
 	/*
-	 * Convert byte sample to voltage according to
-	 * page 269 of the Communication Interface User's Manual.
+	 * Send the signed bytes as they are, the conversion to voltage
+	 * according to page 269 of the Communication Interface User's
+	 * Manual is expressed in the encoding's scale and offset.
 	 */
-	float_data = g_array_new(FALSE, FALSE, sizeof(float));
-	for (i = 0; i < samples; i++) {
-		voltage = (float)g_array_index(data, int8_t, i);
-		voltage = (range * voltage /
-				DLM_DIVISION_FOR_BYTE_FORMAT) + offset;
-		g_array_append_val(float_data, voltage);
-	}
+	encoding.unitsize = sizeof(int8_t);
+	encoding.is_signed = TRUE;
+	encoding.is_float = FALSE;
+	encoding.is_bigendian = FALSE;
+	sr_rational_from_double(&encoding.scale,
+		(double)ch_state->waveform_range / DLM_DIVISION_FOR_BYTE_FORMAT);
+	sr_rational_from_double(&encoding.offset, ch_state->waveform_offset);
 
-	/* TODO: Use proper 'digits' value for this device (and its modes). */
-	sr_analog_init(&analog, &encoding, &meaning, &spec, 2);
 	analog.meaning->channels = g_slist_append(NULL, ch);
-	analog.num_samples = float_data->len;
-	analog.data = (float*)float_data->data;
+	analog.num_samples = samples;
+	analog.data = data->data;
 	analog.meaning->mq = SR_MQ_VOLTAGE;
 	analog.meaning->unit = SR_UNIT_VOLT;
 	analog.meaning->mqflags = 0;
@@ -956,7 +953,6 @@ static int dlm_analog_samples_send(GArray *data,
 	sr_session_send(sdi, &packet);
 	g_slist_free(analog.meaning->channels);
 
-	g_array_free(float_data, TRUE);
 	g_array_remove_range(data, 0, samples * sizeof(uint8_t));
 
 	return SR_OK;
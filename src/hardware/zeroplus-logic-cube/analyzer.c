@@ -425,6 +425,19 @@ SR_PRIV int analyzer_read_data(libusb_device_handle *devh, void *buffer,
 	return gl_read_bulk(devh, buffer, size);
 }
 
+SR_PRIV int analyzer_read_request(libusb_device_handle *devh,
+		unsigned int size)
+{
+	return gl_read_bulk_request(devh, size);
+}
+
+SR_PRIV void analyzer_fill_read_transfer(struct libusb_transfer *transfer,
+		libusb_device_handle *devh, void *buffer, unsigned int size,
+		libusb_transfer_cb_fn cb, void *user_data)
+{
+	gl_fill_read_bulk(transfer, devh, buffer, size, cb, user_data);
+}
+
 SR_PRIV void analyzer_read_stop(libusb_device_handle *devh)
 {
 	analyzer_write_status(devh, 3, STATUS_FLAG_20);
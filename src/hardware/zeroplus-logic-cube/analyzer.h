@@ -100,6 +100,11 @@ SR_PRIV void analyzer_wait(libusb_device_handle *devh, int set, int unset);
 SR_PRIV void analyzer_read_start(libusb_device_handle *devh);
 SR_PRIV int analyzer_read_data(libusb_device_handle *devh, void *buffer,
 		unsigned int size);
+SR_PRIV int analyzer_read_request(libusb_device_handle *devh,
+		unsigned int size);
+SR_PRIV void analyzer_fill_read_transfer(struct libusb_transfer *transfer,
+		libusb_device_handle *devh, void *buffer, unsigned int size,
+		libusb_transfer_cb_fn cb, void *user_data);
 SR_PRIV void analyzer_read_stop(libusb_device_handle *devh);
 SR_PRIV void analyzer_start(libusb_device_handle *devh);
 SR_PRIV void analyzer_configure(libusb_device_handle *devh);
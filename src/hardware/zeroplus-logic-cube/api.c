@@ -23,7 +23,6 @@
 #define USB_INTERFACE			0
 #define USB_CONFIGURATION		1
 #define NUM_TRIGGER_STAGES		4
-#define PACKET_SIZE			2048	/* ?? */
 
 //#define ZP_EXPERIMENTAL
 
@@ -427,29 +426,261 @@ static int config_list(uint32_t key, GVariant **data,
 	return SR_OK;
 }
 
-static int dev_acquisition_start(const struct sr_dev_inst *sdi)
+/* Send out a chunk of sample memory, skipping what lies outside the capture. */
+static void send_samples(const struct sr_dev_inst *sdi, unsigned char *buf,
+		unsigned int len)
 {
 	struct dev_context *devc;
-	struct sr_usb_dev_inst *usb;
 	struct sr_datafeed_packet packet;
 	struct sr_datafeed_logic logic;
-	unsigned int samples_read;
-	int res;
-	unsigned int packet_num, n;
-	unsigned char *buf;
+	unsigned int skip;
+
+	devc = sdi->priv;
+
+	if (devc->discard) {
+		skip = MIN(devc->discard, len / 4);
+		devc->discard -= skip;
+		buf += skip * 4;
+		len -= skip * 4;
+	}
+
+	/* Check if we've read all the samples */
+	if (devc->samples_read + len / 4 >= devc->valid_samples)
+		len = (devc->valid_samples - devc->samples_read) * 4;
+	if (!len)
+		return;
+
+	if (devc->samples_read < devc->trigger_offset &&
+	    devc->samples_read + len / 4 > devc->trigger_offset) {
+		/* Send out samples remaining before trigger */
+		packet.type = SR_DF_LOGIC;
+		packet.payload = &logic;
+		logic.length = (devc->trigger_offset - devc->samples_read) * 4;
+		logic.unitsize = 4;
+		logic.data = buf;
+		sr_session_send(sdi, &packet);
+		len -= logic.length;
+		devc->samples_read += logic.length / 4;
+		buf += logic.length;
+	}
+
+	if (devc->samples_read == devc->trigger_offset) {
+		/* Send out trigger */
+		packet.type = SR_DF_TRIGGER;
+		packet.payload = NULL;
+		sr_session_send(sdi, &packet);
+	}
+
+	/* Send out data (or data after trigger) */
+	packet.type = SR_DF_LOGIC;
+	packet.payload = &logic;
+	logic.length = len;
+	logic.unitsize = 4;
+	logic.data = buf;
+	sr_session_send(sdi, &packet);
+	devc->samples_read += len / 4;
+}
+
+static void cancel_transfers(struct dev_context *devc)
+{
+	int i;
+
+	for (i = 0; i < NUM_TRANSFERS; i++) {
+		if (devc->transfers[i])
+			libusb_cancel_transfer(devc->transfers[i]);
+	}
+}
+
+static void abort_readout(struct dev_context *devc)
+{
+	devc->read_aborted = TRUE;
+	cancel_transfers(devc);
+}
+
+static void LIBUSB_CALL receive_transfer(struct libusb_transfer *transfer);
+
+static int submit_transfer(const struct sr_dev_inst *sdi,
+		struct libusb_transfer *transfer)
+{
+	struct dev_context *devc;
+	struct sr_usb_dev_inst *usb;
+	unsigned int len;
+	int ret;
+
+	devc = sdi->priv;
+	usb = sdi->conn;
+
+	if (devc->read_chunked) {
+		len = MIN(CHUNK_SIZE, devc->read_size - devc->read_offset);
+		if (analyzer_read_request(usb->devhdl, len) != 8) {
+			abort_readout(devc);
+			return SR_ERR;
+		}
+	} else {
+		len = MIN(TRANSFER_SIZE, devc->read_size - devc->read_offset);
+	}
+	analyzer_fill_read_transfer(transfer, usb->devhdl, transfer->buffer,
+			len, receive_transfer, (void *)sdi);
+	if ((ret = libusb_submit_transfer(transfer)) != 0) {
+		sr_err("Failed to submit transfer: %s.",
+		       libusb_error_name(ret));
+		abort_readout(devc);
+		return SR_ERR;
+	}
+	devc->submitted_transfers++;
+	devc->read_offset += len;
+
+	return SR_OK;
+}
+
+/*
+ * Called by libusb (as triggered by receive_data()) when a read of sample
+ * memory comes in. Transfers on the bulk endpoint complete in the order
+ * they were submitted, so each is sent out and then resubmitted for the
+ * next part of the memory.
+ *
+ * If a read of the whole-memory request times out, the remaining
+ * transfers get cancelled (data which made it is still sent out), and
+ * receive_data() continues from there with one request per chunk and a
+ * single read in flight, the way the driver used to read.
+ */
+static void LIBUSB_CALL receive_transfer(struct libusb_transfer *transfer)
+{
+	const struct sr_dev_inst *sdi;
+	struct dev_context *devc;
+	unsigned int len;
+
+	sdi = transfer->user_data;
+	devc = sdi->priv;
+
+	devc->submitted_transfers--;
+
+	if (devc->read_aborted)
+		return;
+
+	if (transfer->status == LIBUSB_TRANSFER_TIMED_OUT
+			&& !devc->read_chunked && !devc->read_fallback) {
+		sr_warn("Sample memory read timed out, falling back to "
+			"%d byte reads.", CHUNK_SIZE);
+		devc->read_fallback = TRUE;
+		cancel_transfers(devc);
+	} else if (transfer->status != LIBUSB_TRANSFER_COMPLETED
+			&& !devc->read_fallback) {
+		sr_err("Sample memory read failed (status %d).",
+		       transfer->status);
+		abort_readout(devc);
+		return;
+	} else if (transfer->actual_length != transfer->length
+			&& !devc->read_fallback) {
+		sr_warn("Tried to read %d bytes, actually read %d.",
+			transfer->length, transfer->actual_length);
+	}
+
+	len = transfer->actual_length & ~3;
+	send_samples(sdi, transfer->buffer, len);
+	devc->read_done += len;
+
+	if (!devc->read_fallback && !devc->read_chunked
+			&& devc->read_offset < devc->read_size)
+		submit_transfer(sdi, transfer);
+}
+
+static void free_transfers(struct dev_context *devc)
+{
+	int i;
+
+	for (i = 0; i < NUM_TRANSFERS; i++) {
+		if (!devc->transfers[i])
+			continue;
+		g_free(devc->transfers[i]->buffer);
+		libusb_free_transfer(devc->transfers[i]);
+		devc->transfers[i] = NULL;
+	}
+}
+
+static int alloc_transfers(struct dev_context *devc)
+{
+	int i;
+
+	for (i = 0; i < NUM_TRANSFERS; i++) {
+		if (!(devc->transfers[i] = libusb_alloc_transfer(0)) ||
+				!(devc->transfers[i]->buffer = g_try_malloc(TRANSFER_SIZE))) {
+			sr_err("Failed to allocate USB transfer.");
+			free_transfers(devc);
+			return SR_ERR_MALLOC;
+		}
+	}
+
+	return SR_OK;
+}
+
+static int receive_data(int fd, int revents, void *cb_data)
+{
+	const struct sr_dev_inst *sdi;
+	struct dev_context *devc;
+	struct drv_context *drvc;
+	struct sr_usb_dev_inst *usb;
+	struct timeval tv;
+
+	(void)fd;
+	(void)revents;
+
+	sdi = cb_data;
+	devc = sdi->priv;
+	drvc = sdi->driver->context;
+	usb = sdi->conn;
+
+	tv.tv_sec = tv.tv_usec = 0;
+	libusb_handle_events_timeout(drvc->sr_ctx->libusb_ctx, &tv);
+
+	if (devc->submitted_transfers)
+		return TRUE;
+
+	if (devc->read_fallback && !devc->read_aborted) {
+		devc->read_fallback = FALSE;
+		devc->read_chunked = TRUE;
+		devc->read_offset = devc->read_done;
+	}
+	/*
+	 * Chunked reads need a (synchronous) control request before each
+	 * read, which can't be issued from the transfer callback.
+	 */
+	if (devc->read_chunked && !devc->read_aborted
+			&& devc->read_offset < devc->read_size
+			&& submit_transfer(sdi, devc->transfers[0]) == SR_OK)
+		return TRUE;
+
+	/* All transfers have retired, the readout is complete. */
+	usb_source_remove(sdi->session, drvc->sr_ctx);
+	free_transfers(devc);
+	analyzer_read_stop(usb->devhdl);
+	if (devc->read_aborted)
+		analyzer_reset(usb->devhdl);
+
+	std_session_send_df_end(sdi);
+
+	return TRUE;
+}
+
+static int dev_acquisition_start(const struct sr_dev_inst *sdi)
+{
+	struct dev_context *devc;
+	struct drv_context *drvc;
+	struct sr_usb_dev_inst *usb;
+	unsigned int n;
 	unsigned int status;
 	unsigned int stop_address;
 	unsigned int now_address;
 	unsigned int trigger_address;
-	unsigned int trigger_offset;
 	unsigned int triggerbar;
 	unsigned int ramsize_trigger;
 	unsigned int memory_size;
 	unsigned int valid_samples;
 	unsigned int discard;
-	int trigger_now;
+	int trigger_now, i;
 
 	devc = sdi->priv;
+	drvc = sdi->driver->context;
 
 	if (analyzer_add_triggers(sdi) != SR_OK) {
 		sr_err("Failed to configure triggers.");
@@ -494,8 +725,6 @@ static int dev_acquisition_start(const struct sr_dev_inst *sdi)
 		return SR_OK;
 	}
 
-	buf = g_malloc(PACKET_SIZE);
-
 	/* Check if the trigger is in the samples we are throwing away */
 	trigger_now = now_address == trigger_address ||
 		((now_address + 1) % memory_size) == trigger_address;
@@ -533,86 +762,66 @@ static int dev_acquisition_start(const struct sr_dev_inst *sdi)
 
 	/* Calculate how far in the trigger is */
 	if (trigger_now)
-		trigger_offset = 0;
+		devc->trigger_offset = 0;
 	else
-		trigger_offset = (trigger_address - now_address) % memory_size;
+		devc->trigger_offset = (trigger_address - now_address) % memory_size;
 
 	/* Recalculate the number of samples available */
-	valid_samples = (stop_address - now_address) % memory_size;
-
-	/* Send the incoming transfer to the session bus. */
-	samples_read = 0;
-	for (packet_num = 0; packet_num < n / PACKET_SIZE; packet_num++) {
-		unsigned int len;
-		unsigned int buf_offset;
-
-		res = analyzer_read_data(usb->devhdl, buf, PACKET_SIZE);
-		if (res != PACKET_SIZE)
-			sr_warn("Tried to read %d bytes, actually read %d.",
-				PACKET_SIZE, res);
-
-		if (discard >= PACKET_SIZE / 4) {
-			discard -= PACKET_SIZE / 4;
-			continue;
-		}
+	devc->valid_samples = (stop_address - now_address) % memory_size;
+	devc->discard = discard;
+	devc->samples_read = 0;
 
-		len = PACKET_SIZE - discard * 4;
-		buf_offset = discard * 4;
-		discard = 0;
+	if (alloc_transfers(devc) != SR_OK) {
+		analyzer_read_stop(usb->devhdl);
+		std_session_send_df_end(sdi);
+		return SR_ERR_MALLOC;
+	}
 
-		/* Check if we've read all the samples */
-		if (samples_read + len / 4 >= valid_samples)
-			len = (valid_samples - samples_read) * 4;
-		if (!len)
+	/*
+	 * Ask for all of sample memory at once and keep several large
+	 * reads in flight, so the download runs at bus speed instead of
+	 * paying a round trip per packet.
+	 */
+	devc->read_size = n;
+	devc->read_offset = 0;
+	devc->read_done = 0;
+	devc->read_aborted = FALSE;
+	devc->read_chunked = FALSE;
+	devc->read_fallback = FALSE;
+	devc->submitted_transfers = 0;
+	if (analyzer_read_request(usb->devhdl, n) != 8) {
+		sr_err("Failed to request sample memory.");
+		free_transfers(devc);
+		analyzer_read_stop(usb->devhdl);
+		std_session_send_df_end(sdi);
+		return SR_ERR;
+	}
+	for (i = 0; i < NUM_TRANSFERS && devc->read_offset < n; i++) {
+		if (submit_transfer(sdi, devc->transfers[i]) != SR_OK)
 			break;
-
-		if (samples_read < trigger_offset &&
-		    samples_read + len / 4 > trigger_offset) {
-			/* Send out samples remaining before trigger */
-			packet.type = SR_DF_LOGIC;
-			packet.payload = &logic;
-			logic.length = (trigger_offset - samples_read) * 4;
-			logic.unitsize = 4;
-			logic.data = buf + buf_offset;
-			sr_session_send(sdi, &packet);
-			len -= logic.length;
-			samples_read += logic.length / 4;
-			buf_offset += logic.length;
-		}
-
-		if (samples_read == trigger_offset) {
-			/* Send out trigger */
-			packet.type = SR_DF_TRIGGER;
-			packet.payload = NULL;
-			sr_session_send(sdi, &packet);
-		}
-
-		/* Send out data (or data after trigger) */
-		packet.type = SR_DF_LOGIC;
-		packet.payload = &logic;
-		logic.length = len;
-		logic.unitsize = 4;
-		logic.data = buf + buf_offset;
-		sr_session_send(sdi, &packet);
-		samples_read += len / 4;
 	}
-	analyzer_read_stop(usb->devhdl);
-	g_free(buf);
 
-	std_session_send_df_end(sdi);
+	usb_source_add(sdi->session, drvc->sr_ctx, 100, receive_data,
+			(void *)sdi);
 
 	return SR_OK;
 }
 
 static int dev_acquisition_stop(struct sr_dev_inst *sdi)
 {
+	struct dev_context *devc;
 	struct sr_usb_dev_inst *usb;
 
-	std_session_send_df_end(sdi);
+	devc = sdi->priv;
+
+	/* A readout in progress winds up in receive_data(). */
+	if (devc->transfers[0]) {
+		abort_readout(devc);
+		return SR_OK;
+	}
 
 	usb = sdi->conn;
 	analyzer_reset(usb->devhdl);
-	/* TODO: Need to cancel and free any queued up transfers. */
 
 	return SR_OK;
 }
@@ -35,6 +35,12 @@
 #include <libusb.h>
 #include <libsigrok/libsigrok.h>
 
+SR_PRIV int gl_read_bulk_request(libusb_device_handle *devh,
+			 unsigned int size);
+SR_PRIV void gl_fill_read_bulk(struct libusb_transfer *transfer,
+			 libusb_device_handle *devh, void *buffer,
+			 unsigned int size, libusb_transfer_cb_fn cb,
+			 void *user_data);
 SR_PRIV int gl_read_bulk(libusb_device_handle *devh, void *buffer,
 			 unsigned int size);
 SR_PRIV int gl_reg_write(libusb_device_handle *devh, unsigned int reg,
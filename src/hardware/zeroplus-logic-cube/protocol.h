@@ -30,6 +30,12 @@
 
 #define LOG_PREFIX "zeroplus-logic-cube"
 
+/* Sample memory is downloaded with this many reads in flight. */
+#define NUM_TRANSFERS		4
+#define TRANSFER_SIZE		(64 * 1024)
+/* Fallback: one read request per chunk, with a single read in flight. */
+#define CHUNK_SIZE		2048
+
 struct dev_context {
 	uint64_t cur_samplerate;
 	uint64_t max_samplerate;
@@ -45,6 +51,20 @@ struct dev_context {
 	uint64_t capture_ratio;
 	double cur_threshold;
 	const struct zp_model *prof;
+
+	/* Sample memory readout */
+	struct libusb_transfer *transfers[NUM_TRANSFERS];
+	int submitted_transfers;
+	gboolean read_aborted;
+	gboolean read_chunked;
+	gboolean read_fallback;
+	unsigned int read_size;
+	unsigned int read_offset;
+	unsigned int read_done;
+	unsigned int discard;
+	unsigned int valid_samples;
+	unsigned int samples_read;
+	unsigned int trigger_offset;
 };
 
 SR_PRIV unsigned int get_memory_size(int type);
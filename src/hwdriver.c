@@ -199,6 +199,10 @@ static struct sr_key_info sr_key_info_config[] = {
 		"Probe factor", NULL},
 	{SR_CONF_ADC_POWERLINE_CYCLES, SR_T_FLOAT, "nplc",
 		"Number of ADC powerline cycles", NULL},
+	{SR_CONF_OVERFLOW_RISK, SR_T_BOOL, "overflow_risk",
+		"Overflow risk", NULL},
+	{SR_CONF_SESSION_REPLAY, SR_T_STRING, "session_replay",
+		"Session replay mode", NULL},
 
 	/* Acquisition modes, sample limiting */
 	{SR_CONF_LIMIT_MSEC, SR_T_UINT64, "limit_time",
@@ -66,15 +66,41 @@ static int init(struct sr_input *in, GHashTable *options)
 	return SR_OK;
 }
 
-static int process_buffer(struct sr_input *in)
+static void send_chunks(struct sr_input *in, const char *data, gsize len)
 {
 	struct sr_datafeed_packet packet;
-	struct sr_datafeed_meta meta;
 	struct sr_datafeed_logic logic;
+	struct context *inc;
+	gsize i, chunk;
+
+	inc = in->priv;
+
+	packet.type = SR_DF_LOGIC;
+	packet.payload = &logic;
+	logic.unitsize = inc->unitsize;
+
+	for (i = 0; i < len; i += chunk) {
+		chunk = MIN(CHUNK_SIZE, len - i);
+		logic.data = sr_input_packet_data(in, data + i, chunk);
+		logic.length = chunk;
+		sr_session_send(in->sdi, &packet);
+	}
+}
+
+/*
+ * Send the data stashed in in->buf and the data in buf (if given).
+ *
+ * Data from buf is sent straight from the caller's memory (which may
+ * be a mapped file) unless session transforms need a copy, only a
+ * trailing partial sample gets copied into in->buf for the next call.
+ */
+static int process_buffer(struct sr_input *in, GString *buf)
+{
+	struct sr_datafeed_packet packet;
+	struct sr_datafeed_meta meta;
 	struct sr_config *src;
 	struct context *inc;
-	gsize chunk_size, i;
-	int chunk;
+	gsize chunk_size, offset, partial;
 
 	inc = in->priv;
 	if (!inc->started) {
@@ -93,39 +119,41 @@ static int process_buffer(struct sr_input *in)
 		inc->started = TRUE;
 	}
 
-	packet.type = SR_DF_LOGIC;
-	packet.payload = &logic;
-	logic.unitsize = inc->unitsize;
+	offset = 0;
+	if (in->buf->len) {
+		/* Complete a partial sample from the previous call. */
+		partial = in->buf->len % inc->unitsize;
+		if (buf && partial) {
+			offset = MIN(inc->unitsize - partial, buf->len);
+			g_string_append_len(in->buf, buf->str, offset);
+		}
+		/* Cut off at multiple of unitsize. */
+		chunk_size = in->buf->len / inc->unitsize * inc->unitsize;
+		send_chunks(in, in->buf->str, chunk_size);
+		g_string_erase(in->buf, 0, chunk_size);
+	}
 
-	/* Cut off at multiple of unitsize. */
-	chunk_size = in->buf->len / logic.unitsize * logic.unitsize;
+	if (!buf)
+		return SR_OK;
 
-	for (i = 0; i < chunk_size; i += chunk) {
-		logic.data = in->buf->str + i;
-		chunk = MIN(CHUNK_SIZE, chunk_size - i);
-		logic.length = chunk;
-		sr_session_send(in->sdi, &packet);
-	}
-	g_string_erase(in->buf, 0, chunk_size);
+	chunk_size = (buf->len - offset) / inc->unitsize * inc->unitsize;
+	send_chunks(in, buf->str + offset, chunk_size);
+	offset += chunk_size;
+	g_string_append_len(in->buf, buf->str + offset, buf->len - offset);
 
 	return SR_OK;
 }
 
 static int receive(struct sr_input *in, GString *buf)
 {
-	int ret;
-
-	g_string_append_len(in->buf, buf->str, buf->len);
-
 	if (!in->sdi_ready) {
+		g_string_append_len(in->buf, buf->str, buf->len);
 		/* sdi is ready, notify frontend. */
 		in->sdi_ready = TRUE;
 		return SR_OK;
 	}
 
-	ret = process_buffer(in);
-
-	return ret;
+	return process_buffer(in, buf);
 }
 
 static int end(struct sr_input *in)
@@ -134,7 +162,7 @@ static int end(struct sr_input *in)
 	int ret;
 
 	if (in->sdi_ready)
-		ret = process_buffer(in);
+		ret = process_buffer(in, NULL);
 	else
 		ret = SR_OK;
 
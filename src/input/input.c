@@ -22,6 +22,9 @@
 #include <errno.h>
 #include <glib.h>
 #include <glib/gstdio.h>
+#ifdef HAVE_SYS_MMAN_H
+#include <sys/mman.h>
+#endif
 #include <libsigrok/libsigrok.h>
 #include "libsigrok-internal.h"
 
@@ -31,6 +34,15 @@
 
 #define CHUNK_SIZE	(4 * 1024 * 1024)
 
+/*
+ * Mapped files are passed to input modules in windows of this size
+ * (a multiple of any page size). Until the module has seen enough
+ * to set up its device instance, smaller probe slices are used so
+ * that the module doesn't have to stash a whole window.
+ */
+#define MAP_WINDOW_SIZE	(64 * 1024 * 1024)
+#define MAP_PROBE_SIZE	(64 * 1024)
+
 /**
  * @file
  *
@@ -589,6 +601,180 @@ SR_API int sr_input_send(const struct sr_input *in, GString *buf)
 	return in->module->receive((struct sr_input *)in, buf);
 }
 
+enum map_advice {
+	MAP_SEQUENTIAL,
+	MAP_WILLNEED,
+	MAP_DONTNEED,
+};
+
+/** Give the kernel a hint about upcoming access to a mapped region. */
+static void map_advise(const struct sr_input *in, gsize offset, gsize len,
+		enum map_advice advice)
+{
+#ifdef HAVE_SYS_MMAN_H
+	static const int posix_advice[] = {
+		[MAP_SEQUENTIAL] = POSIX_MADV_SEQUENTIAL,
+		[MAP_WILLNEED] = POSIX_MADV_WILLNEED,
+		[MAP_DONTNEED] = POSIX_MADV_DONTNEED,
+	};
+	char *base;
+	gsize size;
+
+	size = g_mapped_file_get_length(in->mapped);
+	if (offset >= size)
+		return;
+	base = g_mapped_file_get_contents(in->mapped);
+	posix_madvise(base + offset, MIN(len, size - offset),
+		posix_advice[advice]);
+#else
+	(void)in;
+	(void)offset;
+	(void)len;
+	(void)advice;
+#endif
+}
+
+/**
+ * Map a file into memory, to be sent to the specified input instance.
+ *
+ * This is an alternative to reading the file and passing it to
+ * sr_input_send() chunk by chunk. The mapped data gets passed to the
+ * input module by calling sr_input_send_mapped() repeatedly. Modules
+ * which don't need to parse their input (like binary and raw_analog)
+ * then send datafeed packets which point directly into the mapping,
+ * without copying the data, unless session transforms are active.
+ *
+ * @param in The input instance. Must not be NULL.
+ * @param filename The name of the file to map. Must not be NULL.
+ *
+ * @retval SR_OK Success.
+ * @retval SR_ERR_ARG Invalid argument.
+ * @retval SR_ERR The file could not be mapped.
+ *
+ * @since 0.6.0
+ */
+SR_API int sr_input_map_file(const struct sr_input *in_ro, const char *filename)
+{
+	struct sr_input *in;
+	GMappedFile *mapped;
+	GError *error;
+
+	in = (struct sr_input *)in_ro;	/* "un-const" */
+	if (!in || !filename || !filename[0])
+		return SR_ERR_ARG;
+
+	error = NULL;
+	mapped = g_mapped_file_new(filename, FALSE, &error);
+	if (!mapped) {
+		sr_err("Failed to map %s: %s", filename, error->message);
+		g_error_free(error);
+		return SR_ERR;
+	}
+
+	if (in->mapped)
+		g_mapped_file_unref(in->mapped);
+	in->mapped = mapped;
+	in->map_offset = 0;
+
+	map_advise(in, 0, g_mapped_file_get_length(mapped), MAP_SEQUENTIAL);
+	map_advise(in, 0, MAP_WINDOW_SIZE, MAP_WILLNEED);
+
+	return SR_OK;
+}
+
+/**
+ * Send the next part of a mapped file to the specified input instance.
+ *
+ * This must be called repeatedly after sr_input_map_file(), until
+ * @a done is set. Like sr_input_send(), this returns the moment the
+ * input's device instance becomes ready, so the caller can examine it
+ * and set up the session before any sample data is sent. Afterwards,
+ * sr_input_end() must be called as usual.
+ *
+ * While a window of the file is being processed, the kernel is asked to
+ * read ahead the next one, and pages of the previous one are released.
+ *
+ * @param in The input instance. Must not be NULL.
+ * @param done Set to TRUE when the whole file has been sent.
+ *
+ * @retval SR_OK Success.
+ * @retval SR_ERR_ARG Invalid argument, or no file mapped.
+ * @retval other The input module's receive() result.
+ *
+ * @since 0.6.0
+ */
+SR_API int sr_input_send_mapped(const struct sr_input *in_ro, gboolean *done)
+{
+	struct sr_input *in;
+	GString view;
+	gsize size, len;
+	int ret;
+
+	in = (struct sr_input *)in_ro;	/* "un-const" */
+	if (!in || !in->mapped || !done)
+		return SR_ERR_ARG;
+
+	size = g_mapped_file_get_length(in->mapped);
+	len = in->sdi_ready ? MAP_WINDOW_SIZE : MAP_PROBE_SIZE;
+	len = MIN(len, size - in->map_offset);
+
+	/*
+	 * Modules treat the received buffer as read-only, so a GString
+	 * which wraps the mapped memory can be passed in directly.
+	 */
+	view.str = g_mapped_file_get_contents(in->mapped) + in->map_offset;
+	view.len = len;
+	view.allocated_len = 0;
+
+	if (len > 0) {
+		map_advise(in, in->map_offset + len, MAP_WINDOW_SIZE,
+			MAP_WILLNEED);
+		sr_spew("Sending %zu mapped bytes to %s module.", len,
+			in->module->id);
+		ret = in->module->receive(in, &view);
+		/* Window offsets are multiples of the page size. */
+		map_advise(in, in->map_offset, len, MAP_DONTNEED);
+	} else {
+		ret = SR_OK;
+	}
+
+	in->map_offset += len;
+	*done = (in->map_offset >= size);
+
+	return ret;
+}
+
+/**
+ * Get the data pointer for a packet which an input module sends.
+ *
+ * Modules may send packets which point into the buffer passed to their
+ * receive() callback, i.e. into the caller's memory or a read-only file
+ * mapping. Session transforms modify packet data in place though, so
+ * when any are active, the data gets copied into a scratch buffer which
+ * stays valid until the next call.
+ *
+ * @param in The input instance.
+ * @param data The data to send.
+ * @param len The length of the data in bytes.
+ *
+ * @return A pointer to the data which may be modified by transforms.
+ *
+ * @private
+ */
+SR_PRIV void *sr_input_packet_data(struct sr_input *in, const char *data,
+		gsize len)
+{
+	if (!in->sdi->session || !in->sdi->session->transforms)
+		return (void *)data;
+
+	if (!in->scratch)
+		in->scratch = g_string_sized_new(len);
+	g_string_truncate(in->scratch, 0);
+	g_string_append_len(in->scratch, data, len);
+
+	return in->scratch->str;
+}
+
 /**
  * Signal the input module no more data will come.
  *
@@ -653,6 +839,7 @@ SR_API int sr_input_reset(const struct sr_input *in_ro)
 	if (in->buf)
 		g_string_truncate(in->buf, 0);
 	in->sdi_ready = FALSE;
+	in->map_offset = 0;
 
 	return rc;
 }
@@ -687,6 +874,10 @@ SR_API void sr_input_free(const struct sr_input *in)
 			" unprocessed bytes at free time.", in->buf->len);
 	}
 	g_string_free(in->buf, TRUE);
+	if (in->mapped)
+		g_mapped_file_unref(in->mapped);
+	if (in->scratch)
+		g_string_free(in->scratch, TRUE);
 	g_free(in->priv);
 	g_free((gpointer)in);
 }
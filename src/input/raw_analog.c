@@ -142,13 +142,39 @@ static int init(struct sr_input *in, GHashTable *options)
 	return SR_OK;
 }
 
-static int process_buffer(struct sr_input *in)
+static void send_chunks(struct sr_input *in, const char *data, gsize len)
+{
+	struct context *inc;
+	gsize offset, chunk_size;
+
+	inc = in->priv;
+
+	/* Round down to the last channels * unitsize boundary. */
+	chunk_size = CHUNK_SIZE / inc->samplesize * inc->samplesize;
+
+	for (offset = 0; offset < len; offset += chunk_size) {
+		chunk_size = MIN(chunk_size, len - offset);
+		inc->analog.data = sr_input_packet_data(in, data + offset,
+			chunk_size);
+		inc->analog.num_samples = chunk_size / inc->samplesize;
+		sr_session_send(in->sdi, &inc->packet);
+	}
+}
+
+/*
+ * Send the data stashed in in->buf and the data in buf (if given).
+ *
+ * Data from buf is sent straight from the caller's memory (which may
+ * be a mapped file) unless session transforms need a copy, only a
+ * trailing partial sample gets copied into in->buf for the next call.
+ */
+static int process_buffer(struct sr_input *in, GString *buf)
 {
 	struct context *inc;
 	struct sr_datafeed_meta meta;
 	struct sr_datafeed_packet packet;
 	struct sr_config *src;
-	unsigned int offset, chunk_size;
+	gsize chunk_size, offset, partial;
 
 	inc = in->priv;
 	if (!inc->started) {
@@ -167,53 +193,45 @@ static int process_buffer(struct sr_input *in)
 		inc->started = TRUE;
 	}
 
-	/* Round down to the last channels * unitsize boundary. */
-	inc->analog.num_samples = CHUNK_SIZE / inc->samplesize;
-	chunk_size = inc->analog.num_samples * inc->samplesize;
 	offset = 0;
-
-	while ((offset + chunk_size) < in->buf->len) {
-		inc->analog.data = in->buf->str + offset;
-		sr_session_send(in->sdi, &inc->packet);
-		offset += chunk_size;
+	if (in->buf->len) {
+		/* Complete a partial sample from the previous call. */
+		partial = in->buf->len % inc->samplesize;
+		if (buf && partial) {
+			offset = MIN(inc->samplesize - partial, buf->len);
+			g_string_append_len(in->buf, buf->str, offset);
+		}
+		chunk_size = in->buf->len / inc->samplesize * inc->samplesize;
+		send_chunks(in, in->buf->str, chunk_size);
+		g_string_erase(in->buf, 0, chunk_size);
 	}
 
-	inc->analog.num_samples = (in->buf->len - offset) / inc->samplesize;
-	chunk_size = inc->analog.num_samples * inc->samplesize;
-	if (chunk_size > 0) {
-		inc->analog.data = in->buf->str + offset;
-		sr_session_send(in->sdi, &inc->packet);
-		offset += chunk_size;
-	}
+	if (!buf)
+		return SR_OK;
 
-	if ((unsigned int)offset < in->buf->len) {
-		/*
-		 * The incoming buffer wasn't processed completely. Stash
-		 * the leftover data for next time.
-		 */
-		g_string_erase(in->buf, 0, offset);
-	} else {
-		g_string_truncate(in->buf, 0);
-	}
+	chunk_size = (buf->len - offset) / inc->samplesize * inc->samplesize;
+	send_chunks(in, buf->str + offset, chunk_size);
+	offset += chunk_size;
+
+	/*
+	 * The incoming buffer wasn't processed completely. Stash
+	 * the leftover data for next time.
+	 */
+	g_string_append_len(in->buf, buf->str + offset, buf->len - offset);
 
 	return SR_OK;
 }
 
 static int receive(struct sr_input *in, GString *buf)
 {
-	int ret;
-
-	g_string_append_len(in->buf, buf->str, buf->len);
-
 	if (!in->sdi_ready) {
+		g_string_append_len(in->buf, buf->str, buf->len);
 		/* sdi is ready, notify frontend. */
 		in->sdi_ready = TRUE;
 		return SR_OK;
 	}
 
-	ret = process_buffer(in);
-
-	return ret;
+	return process_buffer(in, buf);
 }
 
 static int end(struct sr_input *in)
@@ -222,7 +240,7 @@ static int end(struct sr_input *in)
 	int ret;
 
 	if (in->sdi_ready)
-		ret = process_buffer(in);
+		ret = process_buffer(in, NULL);
 	else
 		ret = SR_OK;
 
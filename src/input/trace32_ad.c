@@ -100,7 +100,7 @@ struct context {
 	int32_t last_record;
 	uint64_t samplerate;
 	double timestamp_scale;
-	GString *out_buf;
+	struct sr_logic_rle_buffer *out_rle;
 };
 
 static int process_header(GString *buf, struct context *inc);
@@ -182,7 +182,7 @@ static int init(struct sr_input *in, GHashTable *options)
 		return SR_ERR;
 	}
 
-	inc->out_buf = g_string_sized_new(CHUNK_SIZE);
+	inc->out_rle = sr_logic_rle_buffer_new();
 
 	return SR_OK;
 }
@@ -385,21 +385,11 @@ static void send_metadata(struct sr_input *in)
 static void flush_output_buffer(struct sr_input *in)
 {
 	struct context *inc;
-	struct sr_datafeed_packet packet;
-	struct sr_datafeed_logic logic;
 
 	inc = in->priv;
 
-	if (inc->out_buf->len) {
-		packet.type = SR_DF_LOGIC;
-		packet.payload = &logic;
-		logic.unitsize = (g_slist_length(in->sdi->channels) + 7) / 8;
-		logic.data = inc->out_buf->str;
-		logic.length = inc->out_buf->len;
-		sr_session_send(in->sdi, &packet);
-
-		g_string_truncate(inc->out_buf, 0);
-	}
+	/* Records hold one sample for a time span, send them as runs. */
+	sr_logic_rle_buffer_send(in->sdi, inc->out_rle);
 }
 
 static void process_record_pi(struct sr_input *in, gsize start)
@@ -546,21 +536,20 @@ static void process_record_pi(struct sr_input *in, gsize start)
 	/* Is this the last record in the file? */
 	if (inc->cur_record == inc->record_count - 1) {
 		/* It is, so send the last sample data only once. */
-		g_string_append_len(inc->out_buf, single_payload, payload_len);
+		packet_count = 1;
 	} else {
-		/* It's not, so fill the time gap by sending lots of data. */
+		/* It's not, so fill the time gap by repeating the sample. */
 		next_timestamp = RL64(buf->str + start + inc->record_size);
 		packet_count = (int)(next_timestamp - timestamp) / inc->timestamp_scale;
 
 		/* Make sure we send at least one data set. */
 		if (packet_count == 0)
 			packet_count = 1;
-
-		for (i = 0; i < packet_count; i++)
-			g_string_append_len(inc->out_buf, single_payload, payload_len);
 	}
+	sr_logic_rle_buffer_append(inc->out_rle, single_payload,
+		payload_len, packet_count);
 
-	if (inc->out_buf->len >= CHUNK_SIZE)
+	if (inc->out_rle->data->len >= CHUNK_SIZE)
 		flush_output_buffer(in);
 }
 
@@ -570,7 +559,7 @@ static void process_record_iprobe(struct sr_input *in, gsize start)
 	struct context *inc;
 	uint64_t timestamp, next_timestamp;
 	char single_payload[3];
-	int i, payload_len, packet_count;
+	int payload_len, packet_count;
 
 	inc = in->priv;
 
@@ -599,21 +588,20 @@ static void process_record_iprobe(struct sr_input *in, gsize start)
 	/* Is this the last record in the file? */
 	if (inc->cur_record == inc->record_count - 1) {
 		/* It is, so send the last sample data only once. */
-		g_string_append_len(inc->out_buf, single_payload, payload_len);
+		packet_count = 1;
 	} else {
-		/* It's not, so fill the time gap by sending lots of data. */
+		/* It's not, so fill the time gap by repeating the sample. */
 		next_timestamp = RL64(in->buf->str + start + inc->record_size);
 		packet_count = (int)(next_timestamp - timestamp) / inc->timestamp_scale;
 
 		/* Make sure we send at least one data set. */
 		if (packet_count == 0)
 			packet_count = 1;
-
-		for (i = 0; i < packet_count; i++)
-			g_string_append_len(inc->out_buf, single_payload, payload_len);
 	}
+	sr_logic_rle_buffer_append(inc->out_rle, single_payload,
+		payload_len, packet_count);
 
-	if (inc->out_buf->len >= CHUNK_SIZE)
+	if (inc->out_rle->data->len >= CHUNK_SIZE)
 		flush_output_buffer(in);
 }
 
@@ -829,6 +817,15 @@ static int reset(struct sr_input *in)
 	return SR_OK;
 }
 
+static void cleanup(struct sr_input *in)
+{
+	struct context *inc;
+
+	inc = in->priv;
+	sr_logic_rle_buffer_free(inc->out_rle);
+	inc->out_rle = NULL;
+}
+
 static struct sr_option options[] = {
 	{ "podA", "Import pod A / iprobe",
 		"Create channels and data for pod A / iprobe", NULL, NULL },
@@ -882,5 +879,6 @@ SR_PRIV struct sr_input_module input_trace32_ad = {
 	.init = init,
 	.receive = receive,
 	.end = end,
+	.cleanup = cleanup,
 	.reset = reset,
 };
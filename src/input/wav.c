@@ -52,6 +52,10 @@ struct context {
 	int unitsize;
 	gboolean found_data;
 	gboolean create_channels;
+	gboolean native;
+	/* Conversion buffer, reused for every chunk. */
+	float *fdata;
+	int fdata_samples;
 };
 
 static int parse_wav_header(GString *buf, struct context *inc)
@@ -70,8 +74,8 @@ static int parse_wav_header(GString *buf, struct context *inc)
 	if (num_channels == 0)
 		return SR_ERR;
 	unitsize = samplesize / num_channels;
-	if (unitsize != 1 && unitsize != 2 && unitsize != 4) {
-		sr_err("Only 8, 16 or 32 bits per sample supported.");
+	if (unitsize != 1 && unitsize != 2 && unitsize != 3 && unitsize != 4) {
+		sr_err("Only 8, 16, 24 or 32 bits per sample supported.");
 		return SR_ERR_DATA;
 	}
 
@@ -153,23 +157,26 @@ static int init(struct sr_input *in, GHashTable *options)
 {
 	struct context *inc;
 
-	(void)options;
-
 	in->sdi = g_malloc0(sizeof(struct sr_dev_inst));
 	in->priv = g_malloc0(sizeof(struct context));
 	inc = in->priv;
 
 	inc->create_channels = TRUE;
+	inc->native = g_variant_get_boolean(g_hash_table_lookup(options, "native"));
 
 	return SR_OK;
 }
 
+/*
+ * Returns the offset of the first sample, 0 if the "data" chunk was
+ * not seen yet, or -1 if the file doesn't look like it has one.
+ */
 static int find_data_chunk(GString *buf, int initial_offset)
 {
 	unsigned int offset, i;
 
 	offset = initial_offset;
-	while (offset < MIN(MAX_DATA_CHUNK_OFFSET, buf->len)) {
+	while (offset < MAX_DATA_CHUNK_OFFSET && offset + 8 <= buf->len) {
 		if (!memcmp(buf->str + offset, "data", 4))
 			/* Skip into the samples. */
 			return offset + 8;
@@ -183,13 +190,114 @@ static int find_data_chunk(GString *buf, int initial_offset)
 		offset += 8 + RL32(buf->str + offset + 4);
 	}
 
-	if (offset > MAX_DATA_CHUNK_OFFSET)
+	if (offset >= MAX_DATA_CHUNK_OFFSET)
 		return -1;
 
-	return offset;
+	return 0;
 }
 
-static void send_chunk(const struct sr_input *in, int offset, int num_samples)
+/*
+ * Sample conversion routines. Each handles one format with a fixed
+ * stride and no per-sample branches, so the compiler can vectorize them.
+ */
+
+static void convert_pcm8(float *dst, const uint8_t *src, size_t count)
+{
+	size_t i;
+
+	/* 8-bit PCM samples are unsigned. */
+	for (i = 0; i < count; i++)
+		dst[i] = src[i] / (float)255;
+}
+
+static void convert_pcm16(float *dst, const uint8_t *src, size_t count)
+{
+	size_t i;
+	int16_t v;
+
+	for (i = 0; i < count; i++) {
+#ifdef WORDS_BIGENDIAN
+		v = RL16S(src + i * sizeof(v));
+#else
+		memcpy(&v, src + i * sizeof(v), sizeof(v));
+#endif
+		dst[i] = v / (float)INT16_MAX;
+	}
+}
+
+static void convert_pcm24(float *dst, const uint8_t *src, size_t count)
+{
+	size_t i;
+	int32_t v;
+
+	for (i = 0; i < count; i++) {
+		/* Assemble in the upper bits, then sign-extend. */
+		v = (int32_t)((uint32_t)src[3 * i] << 8 |
+			(uint32_t)src[3 * i + 1] << 16 |
+			(uint32_t)src[3 * i + 2] << 24) >> 8;
+		dst[i] = v / (float)0x7fffff;
+	}
+}
+
+static void convert_pcm32(float *dst, const uint8_t *src, size_t count)
+{
+	size_t i;
+	int32_t v;
+
+	for (i = 0; i < count; i++) {
+#ifdef WORDS_BIGENDIAN
+		v = RL32S(src + i * sizeof(v));
+#else
+		memcpy(&v, src + i * sizeof(v), sizeof(v));
+#endif
+		dst[i] = v / (float)INT32_MAX;
+	}
+}
+
+static void convert_float(float *dst, const uint8_t *src, size_t count)
+{
+#ifdef WORDS_BIGENDIAN
+	size_t i;
+
+	/* BINARY32 float */
+	for (i = 0; i < count; i++)
+		dst[i] = RLFL(src + i * sizeof(float));
+#else
+	memcpy(dst, src, count * sizeof(float));
+#endif
+}
+
+/* Describe the file's own sample encoding, for native packets. */
+static gboolean native_encoding(const struct context *inc,
+		struct sr_analog_encoding *encoding)
+{
+	if (inc->fmt_code == WAVE_FORMAT_IEEE_FLOAT_) {
+		/* Already matches sr_analog_init()'s defaults but endianness. */
+		encoding->is_bigendian = FALSE;
+		return TRUE;
+	}
+
+	/* There is no native 24-bit analog encoding. */
+	if (inc->unitsize == 3)
+		return FALSE;
+
+	encoding->unitsize = inc->unitsize;
+	encoding->is_float = FALSE;
+	encoding->is_signed = (inc->unitsize != 1);
+	encoding->is_bigendian = FALSE;
+	encoding->scale.p = 1;
+	if (inc->unitsize == 1)
+		encoding->scale.q = 255;
+	else if (inc->unitsize == 2)
+		encoding->scale.q = INT16_MAX;
+	else
+		encoding->scale.q = INT32_MAX;
+
+	return TRUE;
+}
+
+static int send_chunk(const struct sr_input *in, const char *data,
+		int num_samples)
 {
 	struct sr_datafeed_packet packet;
 	struct sr_datafeed_analog analog;
@@ -197,67 +305,99 @@ static void send_chunk(const struct sr_input *in, int offset, int num_samples)
 	struct sr_analog_meaning meaning;
 	struct sr_analog_spec spec;
 	struct context *inc;
-	float *fdata;
-	int total_samples, samplenum;
-	char *s, *d;
+	int total_samples;
+	const uint8_t *s;
 
 	inc = in->priv;
 
 	total_samples = num_samples * inc->num_channels;
-	fdata = g_malloc0(total_samples * sizeof(float));
-	s = in->buf->str + offset;
-	d = (char *)fdata;
-
-	for (samplenum = 0; samplenum < total_samples; samplenum++) {
-		if (inc->fmt_code == WAVE_FORMAT_PCM_) {
-			switch (inc->unitsize) {
-			case 1:
-				/* 8-bit PCM samples are unsigned. */
-				fdata[samplenum] = *(uint8_t*)(s) / (float)255;
-				break;
-			case 2:
-				fdata[samplenum] = RL16S(s) / (float)INT16_MAX;
-				break;
-			case 4:
-				fdata[samplenum] = RL32S(s) / (float)INT32_MAX;
-				break;
-			}
-		} else {
-			/* BINARY32 float */
-#ifdef WORDS_BIGENDIAN
-			int i;
-			for (i = 0; i < inc->unitsize; i++)
-				d[i] = s[inc->unitsize - 1 - i];
-#else
-			memcpy(d, s, inc->unitsize);
-#endif
-		}
-		s += inc->unitsize;
-		d += inc->unitsize;
-	}
+	s = (const uint8_t *)data;
 
 	/* TODO: Use proper 'digits' value for this device (and its modes). */
 	sr_analog_init(&analog, &encoding, &meaning, &spec, 2);
 	packet.type = SR_DF_ANALOG;
 	packet.payload = &analog;
 	analog.num_samples = num_samples;
-	analog.data = fdata;
 	analog.meaning->channels = in->sdi->channels;
 	analog.meaning->mq = 0;
 	analog.meaning->mqflags = 0;
 	analog.meaning->unit = 0;
+
+	if (inc->native && native_encoding(inc, &encoding)) {
+		/* Consumers convert (or not) as they see fit. */
+		analog.data = (void *)data;
+		sr_session_send(in->sdi, &packet);
+		return SR_OK;
+	}
+
+	if (total_samples > inc->fdata_samples) {
+		g_free(inc->fdata);
+		inc->fdata = g_try_malloc(total_samples * sizeof(float));
+		if (!inc->fdata) {
+			inc->fdata_samples = 0;
+			sr_err("Failed to allocate conversion buffer.");
+			return SR_ERR_MALLOC;
+		}
+		inc->fdata_samples = total_samples;
+	}
+
+	if (inc->fmt_code == WAVE_FORMAT_IEEE_FLOAT_)
+		convert_float(inc->fdata, s, total_samples);
+	else if (inc->unitsize == 1)
+		convert_pcm8(inc->fdata, s, total_samples);
+	else if (inc->unitsize == 2)
+		convert_pcm16(inc->fdata, s, total_samples);
+	else if (inc->unitsize == 3)
+		convert_pcm24(inc->fdata, s, total_samples);
+	else
+		convert_pcm32(inc->fdata, s, total_samples);
+
+	analog.data = inc->fdata;
 	sr_session_send(in->sdi, &packet);
-	g_free(fdata);
+
+	return SR_OK;
+}
+
+/* Send the whole samples in data, in chunks. The byte count is stored in used. */
+static int send_samples(const struct sr_input *in, const char *data,
+		gsize len, gsize *used)
+{
+	struct context *inc;
+	int max_chunk_samples, num_samples, ret;
+	gsize total_samples, processed;
+
+	inc = in->priv;
+
+	/* Round off up to the last channels * unitsize boundary. */
+	total_samples = len / inc->samplesize;
+	max_chunk_samples = CHUNK_SIZE / inc->samplesize;
+	processed = 0;
+	ret = SR_OK;
+	while (processed < total_samples && ret == SR_OK) {
+		num_samples = MIN(total_samples - processed, (gsize)max_chunk_samples);
+		ret = send_chunk(in, data + processed * inc->samplesize,
+			num_samples);
+		processed += num_samples;
+	}
+	*used = processed * inc->samplesize;
+
+	return ret;
 }
 
-static int process_buffer(struct sr_input *in)
+/*
+ * Send the samples stashed in in->buf and those in buf (if given).
+ *
+ * Once the data chunk was found, samples in buf are converted straight
+ * from the caller's memory, only a trailing partial sample is stashed.
+ */
+static int process_buffer(struct sr_input *in, GString *buf)
 {
 	struct context *inc;
 	struct sr_datafeed_packet packet;
 	struct sr_datafeed_meta meta;
 	struct sr_config *src;
-	int offset, chunk_samples, total_samples, processed, max_chunk_samples;
-	int num_samples, i;
+	gsize offset, used, partial;
+	int data_offset, ret;
 
 	inc = in->priv;
 	if (!inc->started) {
@@ -275,45 +415,50 @@ static int process_buffer(struct sr_input *in)
 	}
 
 	if (!inc->found_data) {
+		if (buf) {
+			g_string_append_len(in->buf, buf->str, buf->len);
+			buf = NULL;
+		}
 		/* Skip past size of 'fmt ' chunk. */
-		i = 20 + RL32(in->buf->str + 16);
-		offset = find_data_chunk(in->buf, i);
-		if (offset < 0) {
-			if (in->buf->len > MAX_DATA_CHUNK_OFFSET) {
-				sr_err("Couldn't find data chunk.");
-				return SR_ERR;
-			}
+		data_offset = find_data_chunk(in->buf, 20 + RL32(in->buf->str + 16));
+		if (data_offset == 0 && in->buf->len <= MAX_DATA_CHUNK_OFFSET)
+			/* Not enough data yet. */
+			return SR_OK;
+		if (data_offset <= 0) {
+			sr_err("Couldn't find data chunk.");
+			return SR_ERR;
 		}
+		g_string_erase(in->buf, 0, data_offset);
 		inc->found_data = TRUE;
-	} else
-		offset = 0;
+	}
 
-	/* Round off up to the last channels * unitsize boundary. */
-	chunk_samples = (in->buf->len - offset) / inc->samplesize;
-	max_chunk_samples = CHUNK_SIZE / inc->samplesize;
-	processed = 0;
-	total_samples = chunk_samples;
-	while (processed < total_samples) {
-		if (chunk_samples > max_chunk_samples)
-			num_samples = max_chunk_samples;
-		else
-			num_samples = chunk_samples;
-		send_chunk(in, offset, num_samples);
-		offset += num_samples * inc->samplesize;
-		chunk_samples -= num_samples;
-		processed += num_samples;
+	offset = 0;
+	if (in->buf->len) {
+		/* Complete a partial sample from the previous call. */
+		partial = in->buf->len % inc->samplesize;
+		if (buf && partial) {
+			offset = MIN(inc->samplesize - partial, buf->len);
+			g_string_append_len(in->buf, buf->str, offset);
+		}
+		ret = send_samples(in, in->buf->str, in->buf->len, &used);
+		g_string_erase(in->buf, 0, used);
+		if (ret != SR_OK)
+			return ret;
 	}
 
-	if ((unsigned int)offset < in->buf->len) {
-		/*
-		 * The incoming buffer wasn't processed completely. Stash
-		 * the leftover data for next time.
-		 */
-		g_string_erase(in->buf, 0, offset);
-	} else
-		g_string_truncate(in->buf, 0);
+	if (!buf)
+		return SR_OK;
 
-	return SR_OK;
+	ret = send_samples(in, buf->str + offset, buf->len - offset, &used);
+	offset += used;
+
+	/*
+	 * The incoming buffer wasn't processed completely. Stash
+	 * the leftover data for next time.
+	 */
+	g_string_append_len(in->buf, buf->str + offset, buf->len - offset);
+
+	return ret;
 }
 
 static int receive(struct sr_input *in, GString *buf)
@@ -322,6 +467,10 @@ static int receive(struct sr_input *in, GString *buf)
 	int ret;
 	char channelname[16];
 
+	inc = in->priv;
+	if (in->sdi_ready)
+		return process_buffer(in, buf);
+
 	g_string_append_len(in->buf, buf->str, buf->len);
 
 	if (in->buf->len < MIN_DATA_CHUNK_OFFSET) {
@@ -332,31 +481,25 @@ static int receive(struct sr_input *in, GString *buf)
 		return SR_OK;
 	}
 
-	inc = in->priv;
-	if (!in->sdi_ready) {
-		if ((ret = parse_wav_header(in->buf, inc)) == SR_ERR_NA)
-			/* Not enough data yet. */
-			return SR_OK;
-		else if (ret != SR_OK)
-			return ret;
+	if ((ret = parse_wav_header(in->buf, inc)) == SR_ERR_NA)
+		/* Not enough data yet. */
+		return SR_OK;
+	else if (ret != SR_OK)
+		return ret;
 
-		if (inc->create_channels) {
-			for (int i = 0; i < inc->num_channels; i++) {
-				snprintf(channelname, sizeof(channelname), "CH%d", i + 1);
-				sr_channel_new(in->sdi, i, SR_CHANNEL_ANALOG, TRUE, channelname);
-			}
+	if (inc->create_channels) {
+		for (int i = 0; i < inc->num_channels; i++) {
+			snprintf(channelname, sizeof(channelname), "CH%d", i + 1);
+			sr_channel_new(in->sdi, i, SR_CHANNEL_ANALOG, TRUE, channelname);
 		}
-
-		inc->create_channels = FALSE;
-
-		/* sdi is ready, notify frontend. */
-		in->sdi_ready = TRUE;
-		return SR_OK;
 	}
 
-	ret = process_buffer(in);
+	inc->create_channels = FALSE;
 
-	return ret;
+	/* sdi is ready, notify frontend. */
+	in->sdi_ready = TRUE;
+
+	return SR_OK;
 }
 
 static int end(struct sr_input *in)
@@ -365,7 +508,7 @@ static int end(struct sr_input *in)
 	int ret;
 
 	if (in->sdi_ready)
-		ret = process_buffer(in);
+		ret = process_buffer(in, NULL);
 	else
 		ret = SR_OK;
 
@@ -378,18 +521,48 @@ static int end(struct sr_input *in)
 
 static int reset(struct sr_input *in)
 {
+	struct context *inc;
+	gboolean native;
+
+	inc = in->priv;
+	native = inc->native;
+	g_free(inc->fdata);
 	memset(in->priv, 0, sizeof(struct context));
 
 	/*
 	 * We only want to create the sigrok channels once, so
 	 * inc->create_channels won't be set to TRUE this time around.
 	 */
+	inc->native = native;
 
 	g_string_truncate(in->buf, 0);
 
 	return SR_OK;
 }
 
+static void cleanup(struct sr_input *in)
+{
+	struct context *inc;
+
+	inc = in->priv;
+	g_free(inc->fdata);
+	inc->fdata = NULL;
+}
+
+static struct sr_option options[] = {
+	{ "native", "Native encoding", "Send PCM and float samples in the "
+		"file's encoding, instead of converting them to float", NULL, NULL },
+	ALL_ZERO
+};
+
+static const struct sr_option *get_options(void)
+{
+	if (!options[0].def)
+		options[0].def = g_variant_ref_sink(g_variant_new_boolean(FALSE));
+
+	return options;
+}
+
 SR_PRIV struct sr_input_module input_wav = {
 	.id = "wav",
 	.name = "WAV",
@@ -397,8 +570,10 @@ SR_PRIV struct sr_input_module input_wav = {
 	.exts = (const char*[]){"wav", NULL},
 	.metadata = { SR_INPUT_META_HEADER | SR_INPUT_META_REQUIRED },
 	.format_match = format_match,
+	.options = get_options,
 	.init = init,
 	.receive = receive,
 	.end = end,
+	.cleanup = cleanup,
 	.reset = reset,
 };
@@ -370,6 +370,12 @@ struct sr_input {
 	struct sr_dev_inst *sdi;
 	gboolean sdi_ready;
 	void *priv;
+	/** File mapped by sr_input_map_file(), or NULL. */
+	GMappedFile *mapped;
+	/** Offset of the next mapped byte to send. */
+	gsize map_offset;
+	/** Copy of packet data for session transforms, or NULL. */
+	GString *scratch;
 };
 
 /** Input (file) module driver. */
@@ -756,12 +762,32 @@ SR_PRIV int sr_log(int loglevel, const char *format, ...)
 SR_PRIV int sr_log(int loglevel, const char *format, ...) G_GNUC_PRINTF(2, 3);
 #endif
 
+SR_PRIV int sr_log_hexdump(int loglevel, const char *text,
+		const uint8_t *data, size_t len);
+
+/* Currently selected loglevel, see sr_log_loglevel_set(). */
+SR_PRIV extern int sr_cur_loglevel;
+
+/*
+ * Check the loglevel before the call, so that the arguments of disabled
+ * messages don't get evaluated.
+ */
+#define sr_log_enabled(loglevel) ((loglevel) <= sr_cur_loglevel)
+#define sr_log_lazy(loglevel, ...) (sr_log_enabled(loglevel) ? \
+	sr_log(loglevel, LOG_PREFIX ": " __VA_ARGS__) : SR_OK)
+
 /* Message logging helpers with subsystem-specific prefix string. */
-#define sr_spew(...)	sr_log(SR_LOG_SPEW, LOG_PREFIX ": " __VA_ARGS__)
-#define sr_dbg(...)	sr_log(SR_LOG_DBG,  LOG_PREFIX ": " __VA_ARGS__)
-#define sr_info(...)	sr_log(SR_LOG_INFO, LOG_PREFIX ": " __VA_ARGS__)
-#define sr_warn(...)	sr_log(SR_LOG_WARN, LOG_PREFIX ": " __VA_ARGS__)
-#define sr_err(...)	sr_log(SR_LOG_ERR,  LOG_PREFIX ": " __VA_ARGS__)
+#define sr_spew(...)	sr_log_lazy(SR_LOG_SPEW, __VA_ARGS__)
+#define sr_dbg(...)	sr_log_lazy(SR_LOG_DBG,  __VA_ARGS__)
+#define sr_info(...)	sr_log_lazy(SR_LOG_INFO, __VA_ARGS__)
+#define sr_warn(...)	sr_log_lazy(SR_LOG_WARN, __VA_ARGS__)
+#define sr_err(...)	sr_log_lazy(SR_LOG_ERR,  __VA_ARGS__)
+
+/* Hex dumps of data, only built when the loglevel is enabled. */
+#define sr_spew_hexdump(text, data, len) (sr_log_enabled(SR_LOG_SPEW) ? \
+	sr_log_hexdump(SR_LOG_SPEW, LOG_PREFIX ": " text, data, len) : SR_OK)
+#define sr_dbg_hexdump(text, data, len) (sr_log_enabled(SR_LOG_DBG) ? \
+	sr_log_hexdump(SR_LOG_DBG, LOG_PREFIX ": " text, data, len) : SR_OK)
 
 /*--- device.c --------------------------------------------------------------*/
 
@@ -882,6 +908,8 @@ struct sr_session {
 	unsigned int stop_check_id;
 	/** Whether the session has been started. */
 	gboolean running;
+	/** Whether datafeed callbacks accept SR_DF_LOGIC_RLE packets. */
+	gboolean logic_rle;
 };
 
 SR_PRIV int sr_session_source_add_internal(struct sr_session *session,
@@ -914,6 +942,11 @@ SR_PRIV int sr_sessionfile_check(const char *filename);
 SR_PRIV struct sr_dev_inst *sr_session_prepare_sdi(const char *filename,
 		struct sr_session **session);
 
+/*--- input/input.c ---------------------------------------------------------*/
+
+SR_PRIV void *sr_input_packet_data(struct sr_input *in, const char *data,
+		gsize len);
+
 /*--- session_file.c --------------------------------------------------------*/
 
 #if !HAVE_ZIP_DISCARD
@@ -933,6 +966,34 @@ SR_PRIV int sr_analog_init(struct sr_datafeed_analog *analog,
                            struct sr_analog_spec *spec,
                            int digits);
 
+/*--- logic.c ---------------------------------------------------------------*/
+
+/** Size of the SR_DF_LOGIC packets an SR_DF_LOGIC_RLE packet expands into. */
+#define LOGIC_RLE_EXPAND_SIZE (4 * 1024 * 1024)
+
+/** Accumulates runs for an SR_DF_LOGIC_RLE packet. */
+struct sr_logic_rle_buffer {
+	uint16_t unitsize;
+	/** One sample value per run. */
+	GString *data;
+	/** Run lengths, as uint64_t. */
+	GArray *lengths;
+	/** Total number of samples in all runs. */
+	uint64_t num_samples;
+};
+
+SR_PRIV struct sr_logic_rle_buffer *sr_logic_rle_buffer_new(void);
+SR_PRIV void sr_logic_rle_buffer_free(struct sr_logic_rle_buffer *rb);
+SR_PRIV void sr_logic_rle_buffer_append(struct sr_logic_rle_buffer *rb,
+		const void *sample, uint16_t unitsize, uint64_t count);
+SR_PRIV void sr_logic_rle_buffer_truncate(struct sr_logic_rle_buffer *rb,
+		uint64_t num_samples);
+SR_PRIV int sr_logic_rle_buffer_send(const struct sr_dev_inst *sdi,
+		struct sr_logic_rle_buffer *rb);
+SR_PRIV int sr_logic_rle_expand_packets(const struct sr_datafeed_logic_rle *rle,
+		int (*cb)(const struct sr_datafeed_packet *packet, void *cb_data),
+		void *cb_data);
+
 /*--- std.c -----------------------------------------------------------------*/
 
 typedef int (*dev_close_callback)(struct sr_dev_inst *sdi);
@@ -959,6 +1020,12 @@ SR_PRIV GSList *std_dev_list(const struct sr_dev_driver *di);
 SR_PRIV int std_serial_dev_close(struct sr_dev_inst *sdi);
 SR_PRIV GSList *std_scan_complete(struct sr_dev_driver *di, GSList *devices);
 
+/* Upper bound for the worker threads of std_probe_parallel(). */
+#define STD_PROBE_THREADS_MAX 8
+typedef void *(*std_probe_callback)(void *item, void *cb_data);
+SR_PRIV GSList *std_probe_parallel(GSList *items, std_probe_callback probe,
+	void *cb_data);
+
 SR_PRIV int std_opts_config_list(uint32_t key, GVariant **data,
 	const struct sr_dev_inst *sdi, const struct sr_channel_group *cg,
 	const uint32_t scanopts[], size_t scansize, const uint32_t drvopts[],
@@ -1017,6 +1084,33 @@ SR_PRIV void *sr_resource_load(struct sr_context *ctx, int type,
 		const char *name, size_t *size, size_t max_size)
 		G_GNUC_MALLOC G_GNUC_WARN_UNUSED_RESULT;
 
+/*--- tcp.c -----------------------------------------------------------------*/
+
+struct sr_tcp_dev_inst {
+	char *host_addr;
+	char *tcp_port;
+	int sock_fd;
+	size_t rcvbuf_size;
+	/* Per-connection traffic counters, reset on connect. */
+	uint64_t bytes_received;
+	uint64_t bytes_sent;
+	int64_t connected_at;
+};
+
+SR_PRIV struct sr_tcp_dev_inst *sr_tcp_dev_inst_new(const char *host_addr,
+	const char *tcp_port, size_t rcvbuf_size);
+SR_PRIV void sr_tcp_dev_inst_free(struct sr_tcp_dev_inst *tcp);
+SR_PRIV int sr_tcp_connect(struct sr_tcp_dev_inst *tcp);
+SR_PRIV int sr_tcp_disconnect(struct sr_tcp_dev_inst *tcp);
+SR_PRIV int sr_tcp_write_bytes(struct sr_tcp_dev_inst *tcp,
+	const uint8_t *data, size_t len);
+SR_PRIV int sr_tcp_read_bytes(struct sr_tcp_dev_inst *tcp,
+	uint8_t *data, size_t len);
+SR_PRIV int sr_tcp_read_all(struct sr_tcp_dev_inst *tcp,
+	uint8_t *data, size_t len);
+SR_PRIV int sr_tcp_read_bulk(struct sr_tcp_dev_inst *tcp,
+	uint8_t *data, size_t len);
+
 /*--- strutil.c -------------------------------------------------------------*/
 
 SR_PRIV int sr_atol(const char *str, long *ret);
@@ -1029,12 +1123,56 @@ SR_PRIV int sr_atof_ascii(const char *str, float *ret);
 SR_PRIV GString *sr_hexdump_new(const uint8_t *data, const size_t len);
 SR_PRIV void sr_hexdump_free(GString *s);
 
+/*--- trigger.c -------------------------------------------------------------*/
+
+/** Bit for a match type in sr_trigger_hw_caps.matches. */
+#define SR_TRIGGER_MATCH_BIT(m) (UINT32_C(1) << (m))
+
+/** What a device's hardware trigger can evaluate on logic channels. */
+struct sr_trigger_hw_caps {
+	/** Number of consecutive stages, 0 for no hardware trigger. */
+	int num_stages;
+	/** Channels usable in matches, bit n for channel index n. */
+	uint64_t channels;
+	/** Supported match types, see SR_TRIGGER_MATCH_BIT(). */
+	uint32_t matches;
+	/** Edge matches (rising/falling/edge) per stage, -1 for no limit. */
+	int max_edges;
+	/**
+	 * Samples before the hardware trigger point which the device
+	 * delivers for a host check, -1 for no limit.
+	 */
+	int max_rewind;
+};
+
+/** Split of a trigger between device hardware and host. */
+struct sr_trigger_plan {
+	/** Trigger to program into the hardware, NULL for none. */
+	struct sr_trigger *hw;
+	/**
+	 * Trigger for the host to check on the captured samples, NULL when
+	 * the hardware trigger is exact. Not a copy, this is the trigger
+	 * which was planned.
+	 */
+	struct sr_trigger *soft;
+	/**
+	 * Number of samples before the hardware trigger point, i.e. the
+	 * sample where the last hardware stage matched, at which the host
+	 * check has to start.
+	 */
+	int rewind;
+};
+
+SR_PRIV int sr_trigger_plan_init(struct sr_trigger *trigger,
+		const struct sr_trigger_hw_caps *caps,
+		struct sr_trigger_plan *plan);
+SR_PRIV void sr_trigger_plan_clear(struct sr_trigger_plan *plan);
+
 /*--- soft-trigger.c --------------------------------------------------------*/
 
 struct soft_trigger_logic {
 	const struct sr_dev_inst *sdi;
 	const struct sr_trigger *trigger;
-	int count;
 	int unitsize;
 	int cur_stage;
 	uint8_t *prev_sample;
@@ -1042,6 +1180,10 @@ struct soft_trigger_logic {
 	uint8_t *pre_trigger_head;
 	int pre_trigger_size;
 	int pre_trigger_fill;
+	/* Per-stage match masks for the word-parallel check, or NULL. */
+	struct soft_trigger_masks *masks;
+	int num_stages;
+	gboolean have_prev;
 };
 
 SR_PRIV int logic_channel_unitsize(GSList *channels);
@@ -1094,6 +1236,51 @@ SR_PRIV int serial_source_remove(struct sr_session *session,
 		struct sr_serial_dev_inst *serial);
 SR_PRIV GSList *sr_serial_find_usb(uint16_t vendor_id, uint16_t product_id);
 SR_PRIV int serial_timeout(struct sr_serial_dev_inst *port, int num_bytes);
+
+enum serial_txn_state {
+	SERIAL_TXN_IDLE,
+	/** Waiting for the gap since the previous request to pass. */
+	SERIAL_TXN_QUEUED,
+	/** Request sent, collecting the reply. */
+	SERIAL_TXN_WAIT,
+};
+
+#define SERIAL_TXN_BUFSIZE 256
+
+/** Returns the total reply length, given the bytes received so far. */
+typedef size_t (*serial_txn_reply_len_callback)(const uint8_t *buf,
+		size_t len, void *cb_data);
+
+/** A non-blocking request/response transaction on a serial port. */
+struct serial_txn {
+	struct sr_serial_dev_inst *serial;
+	enum serial_txn_state state;
+	uint8_t request[SERIAL_TXN_BUFSIZE];
+	size_t request_len;
+	size_t request_sent;
+	uint8_t reply[SERIAL_TXN_BUFSIZE];
+	size_t reply_len;
+	size_t reply_size;
+	serial_txn_reply_len_callback reply_len_cb;
+	void *cb_data;
+	unsigned int timeout_ms;
+	unsigned int retries;
+	unsigned int gap_ms;
+	unsigned int attempt;
+	/** Earliest time [us] to send the next request. */
+	int64_t next_at;
+	/** Time [us] at which the current attempt times out. */
+	int64_t deadline;
+};
+
+SR_PRIV void serial_txn_init(struct serial_txn *txn,
+		struct sr_serial_dev_inst *serial, unsigned int timeout_ms,
+		unsigned int retries, unsigned int gap_ms);
+SR_PRIV int serial_txn_start(struct serial_txn *txn, const void *request,
+		size_t request_len, size_t reply_size,
+		serial_txn_reply_len_callback reply_len_cb, void *cb_data);
+SR_PRIV gboolean serial_txn_poll(struct serial_txn *txn, int *status);
+SR_PRIV int serial_txn_wait(struct serial_txn *txn);
 #endif
 
 /*--- hardware/ezusb.c ------------------------------------------------------*/
@@ -1118,6 +1305,41 @@ SR_PRIV int usb_source_remove(struct sr_session *session, struct sr_context *ctx
 SR_PRIV int usb_get_port_path(libusb_device *dev, char *path, int path_len);
 SR_PRIV gboolean usb_match_manuf_prod(libusb_device *dev,
 		const char *manufacturer, const char *product);
+
+/** Adaptive sizing of a queue of bulk IN transfers, see usb.c. */
+struct sr_usb_xfer_sched {
+	/** Data rate of the device, in bytes per ms. */
+	size_t bytes_per_ms;
+	/** Transfer sizes are a multiple of this. */
+	size_t unit;
+	/** Limits for the queue. */
+	size_t max_buffer_size;
+	unsigned int max_transfers;
+	unsigned int min_transfers;
+	size_t max_bytes;
+	/** Size of (re)submitted transfers, a multiple of 512 bytes. */
+	size_t buffer_size;
+	/** Number of transfers to keep in flight. */
+	unsigned int num_transfers;
+	/** Time of the last completion, in us. */
+	gint64 last_completion;
+	/** Slowly decaying worst case interval between completions, in us. */
+	gint64 max_gap;
+	/** Average time spent processing a transfer, in us. */
+	gint64 avg_processing;
+	/** Completions since the queue could last have shrunk. */
+	unsigned int idle_count;
+	/** Whether data loss is likely even with the queue at its limits. */
+	gboolean overflow_risk;
+};
+
+SR_PRIV void sr_usb_xfer_sched_init(struct sr_usb_xfer_sched *s,
+		size_t unit, size_t bytes_per_ms, unsigned int buffer_ms,
+		unsigned int queue_ms, size_t max_buffer_size,
+		unsigned int max_transfers, size_t max_bytes);
+SR_PRIV unsigned int sr_usb_xfer_sched_timeout(const struct sr_usb_xfer_sched *s);
+SR_PRIV gint64 sr_usb_xfer_sched_begin(struct sr_usb_xfer_sched *s);
+SR_PRIV void sr_usb_xfer_sched_end(struct sr_usb_xfer_sched *s, gint64 start);
 #endif
 
 
@@ -1138,9 +1360,15 @@ struct sr_modbus_dev_inst {
 	int (*read_begin)(void *priv, uint8_t *function_code);
 	int (*read_data)(void *priv, uint8_t *buf, int maxlen);
 	int (*read_end)(void *priv);
+	int (*request_async)(void *priv, const uint8_t *request,
+		int request_size, int reply_size, unsigned int timeout_ms);
+	gboolean (*reply_poll)(void *priv, uint8_t *reply, int reply_size,
+		int *status);
 	int (*close)(void *priv);
 	void (*free)(void *priv);
 	unsigned int read_timeout_ms;
+	/** A request sent by sr_modbus_request_async() awaits its reply. */
+	gboolean async_pending;
 	void *priv;
 };
 
@@ -1158,6 +1386,10 @@ SR_PRIV int sr_modbus_request(struct sr_modbus_dev_inst *modbus,
                               uint8_t *request, int request_size);
 SR_PRIV int sr_modbus_reply(struct sr_modbus_dev_inst *modbus,
                             uint8_t *reply, int reply_size);
+SR_PRIV int sr_modbus_request_async(struct sr_modbus_dev_inst *modbus,
+		const uint8_t *request, int request_size, int reply_size);
+SR_PRIV gboolean sr_modbus_reply_poll(struct sr_modbus_dev_inst *modbus,
+		uint8_t *reply, int reply_size, int *status);
 SR_PRIV int sr_modbus_request_reply(struct sr_modbus_dev_inst *modbus,
                                     uint8_t *request, int request_size,
                                     uint8_t *reply, int reply_size);
@@ -1166,11 +1398,35 @@ SR_PRIV int sr_modbus_read_coils(struct sr_modbus_dev_inst *modbus,
 SR_PRIV int sr_modbus_read_holding_registers(struct sr_modbus_dev_inst *modbus,
                                              int address, int nb_registers,
                                              uint16_t *registers);
+SR_PRIV int sr_modbus_read_holding_registers_async(
+		struct sr_modbus_dev_inst *modbus, int address, int nb_registers);
+SR_PRIV gboolean sr_modbus_read_holding_registers_poll(
+		struct sr_modbus_dev_inst *modbus, int nb_registers,
+		uint16_t *registers, int *status);
 SR_PRIV int sr_modbus_write_coil(struct sr_modbus_dev_inst *modbus,
                                  int address, int value);
 SR_PRIV int sr_modbus_write_multiple_registers(struct sr_modbus_dev_inst*modbus,
                                                int address, int nb_registers,
                                                uint16_t *registers);
+
+/** A range of holding registers a driver reads every cycle. */
+struct sr_modbus_reg_range {
+	uint16_t address;
+	uint16_t count;
+};
+
+struct sr_modbus_regcache;
+
+SR_PRIV struct sr_modbus_regcache *sr_modbus_regcache_new(
+		const struct sr_modbus_reg_range *ranges, size_t num_ranges,
+		unsigned int max_gap);
+SR_PRIV void sr_modbus_regcache_free(struct sr_modbus_regcache *cache);
+SR_PRIV gboolean sr_modbus_regcache_poll(struct sr_modbus_dev_inst *modbus,
+		struct sr_modbus_regcache *cache, int *status);
+SR_PRIV int sr_modbus_regcache_get(const struct sr_modbus_regcache *cache,
+		uint16_t address, uint16_t *value);
+SR_PRIV void sr_modbus_regcache_invalidate(struct sr_modbus_regcache *cache);
+
 SR_PRIV int sr_modbus_close(struct sr_modbus_dev_inst *modbus);
 SR_PRIV void sr_modbus_free(struct sr_modbus_dev_inst *modbus);
 
@@ -1527,4 +1783,17 @@ SR_PRIV void sr_sw_limits_update_samples_read(struct sr_sw_limits *limits,
 	uint64_t samples_read);
 SR_PRIV void sr_sw_limits_init(struct sr_sw_limits *limits);
 
+/*--- analog_batch.c --------------------------------------------------------*/
+
+struct sr_analog_batch;
+
+SR_PRIV struct sr_analog_batch *sr_analog_batch_new(
+	const struct sr_dev_inst *sdi, struct sr_channel *ch,
+	size_t capacity, uint64_t max_latency_ms);
+SR_PRIV void sr_analog_batch_free(struct sr_analog_batch *batch);
+SR_PRIV int sr_analog_batch_add(struct sr_analog_batch *batch,
+	const struct sr_datafeed_analog *analog, float value);
+SR_PRIV int sr_analog_batch_flush(struct sr_analog_batch *batch);
+SR_PRIV int sr_analog_batch_poll(struct sr_analog_batch *batch);
+
 #endif
@@ -20,6 +20,7 @@
 #include <config.h>
 #include <stdarg.h>
 #include <stdio.h>
+#include <string.h>
 #include <glib/gprintf.h>
 #include <libsigrok/libsigrok.h>
 #include "libsigrok-internal.h"
@@ -42,8 +43,11 @@
  * @{
  */
 
-/* Currently selected libsigrok loglevel. Default: SR_LOG_WARN. */
-static int cur_loglevel = SR_LOG_WARN; /* Show errors+warnings per default. */
+/*
+ * Currently selected libsigrok loglevel. Default: SR_LOG_WARN.
+ * Not static, the logging macros check it before evaluating arguments.
+ */
+SR_PRIV int sr_cur_loglevel = SR_LOG_WARN; /* Show errors+warnings per default. */
 
 /* Function prototype. */
 static int sr_logv(void *cb_data, int loglevel, const char *format,
@@ -63,6 +67,36 @@ static void *sr_log_cb_data = NULL;
 /** @endcond */
 static int64_t sr_log_start_time = 0;
 
+/** @cond PRIVATE */
+/* Messages up to this size are formatted without a heap allocation. */
+#define LOG_LINE_SIZE 512
+/* Room for the "sr: [mm:ss.uuuuuu] " prefix. */
+#define LOG_PREFIX_SIZE 40
+/* Messages in the asynchronous sink get truncated to this size. */
+#define LOG_ENTRY_SIZE 256
+/** @endcond */
+
+struct log_entry {
+	int loglevel;
+	int64_t time;
+	size_t len;
+	char text[LOG_ENTRY_SIZE];
+};
+
+/*
+ * State of the asynchronous sink, see sr_log_async_start(). The lock
+ * also guards the log callback and its data, which the log thread
+ * reads concurrently with sr_log_callback_set().
+ */
+static GRWLock log_async_lock;
+static gboolean log_async_active;
+static GThread *log_thread;
+static GAsyncQueue *log_free_queue;
+static GAsyncQueue *log_full_queue;
+static struct log_entry *log_entries;
+static struct log_entry log_stop_entry;
+static gint log_dropped;
+
 /**
  * Set the libsigrok loglevel.
  *
@@ -90,7 +124,7 @@ SR_API int sr_log_loglevel_set(int loglevel)
 	if (loglevel >= LOGLEVEL_TIMESTAMP && sr_log_start_time == 0)
 		sr_log_start_time = g_get_monotonic_time();
 
-	cur_loglevel = loglevel;
+	sr_cur_loglevel = loglevel;
 
 	sr_dbg("libsigrok loglevel set to %d.", loglevel);
 
@@ -106,7 +140,7 @@ SR_API int sr_log_loglevel_set(int loglevel)
  */
 SR_API int sr_log_loglevel_get(void)
 {
-	return cur_loglevel;
+	return sr_cur_loglevel;
 }
 
 /**
@@ -133,8 +167,10 @@ SR_API int sr_log_callback_set(sr_log_callback cb, void *cb_data)
 
 	/* Note: 'cb_data' is allowed to be NULL. */
 
+	g_rw_lock_writer_lock(&log_async_lock);
 	sr_log_cb = cb;
 	sr_log_cb_data = cb_data;
+	g_rw_lock_writer_unlock(&log_async_lock);
 
 	return SR_OK;
 }
@@ -154,8 +190,10 @@ SR_API int sr_log_callback_set_default(void)
 	 * Note: No log output in this function, as it should safely work
 	 * even if the currently set log callback is buggy/broken.
 	 */
+	g_rw_lock_writer_lock(&log_async_lock);
 	sr_log_cb = sr_logv;
 	sr_log_cb_data = NULL;
+	g_rw_lock_writer_unlock(&log_async_lock);
 
 	return SR_OK;
 }
@@ -174,59 +212,254 @@ SR_API int sr_log_callback_set_default(void)
  */
 SR_API int sr_log_callback_get(sr_log_callback *cb, void **cb_data)
 {
+	g_rw_lock_reader_lock(&log_async_lock);
 	if (cb)
 		*cb = sr_log_cb;
 	if (cb_data)
 		*cb_data = sr_log_cb_data;
+	g_rw_lock_reader_unlock(&log_async_lock);
 
 	return SR_OK;
 }
 
-static int sr_logv(void *cb_data, int loglevel, const char *format, va_list args)
+static size_t log_prefix(char *buf, int64_t time)
 {
 	uint64_t elapsed_us, minutes;
 	unsigned int rest_us, seconds, microseconds;
-	char *raw_output, *output;
-	int raw_len, raw_idx, idx, ret;
+
+	if (sr_cur_loglevel < LOGLEVEL_TIMESTAMP) {
+		memcpy(buf, "sr: ", 4);
+		return 4;
+	}
+
+	elapsed_us = time - sr_log_start_time;
+
+	minutes = elapsed_us / G_TIME_SPAN_MINUTE;
+	rest_us = elapsed_us % G_TIME_SPAN_MINUTE;
+	seconds = rest_us / G_TIME_SPAN_SECOND;
+	microseconds = rest_us % G_TIME_SPAN_SECOND;
+
+	return g_snprintf(buf, LOG_PREFIX_SIZE, "sr: [%.2" PRIu64 ":%.2u.%.6u] ",
+		minutes, seconds, microseconds);
+}
+
+/* Write one message to stderr with a single call, without newlines. */
+static void log_emit(int64_t time, const char *text, size_t len)
+{
+	char buf[LOG_LINE_SIZE + LOG_PREFIX_SIZE];
+	char *line;
+	size_t i, n;
+
+	line = buf;
+	if (len + LOG_PREFIX_SIZE + 1 > sizeof(buf))
+		line = g_malloc(len + LOG_PREFIX_SIZE + 1);
+
+	n = log_prefix(line, time);
+	for (i = 0; i < len; i++) {
+		if (text[i] != '\n')
+			line[n++] = text[i];
+	}
+	line[n++] = '\n';
+	fwrite(line, 1, n, stderr);
+
+	if (line != buf)
+		g_free(line);
+}
+
+static int sr_logv(void *cb_data, int loglevel, const char *format, va_list args)
+{
+	char buf[LOG_LINE_SIZE];
+	char *text;
+	va_list args_copy;
+	int len;
 
 	/* This specific log callback doesn't need the void pointer data. */
 	(void)cb_data;
 
 	(void)loglevel;
 
-	if (cur_loglevel >= LOGLEVEL_TIMESTAMP) {
-		elapsed_us = g_get_monotonic_time() - sr_log_start_time;
+	va_copy(args_copy, args);
+	len = g_vsnprintf(buf, sizeof(buf), format, args_copy);
+	va_end(args_copy);
+	if (len < 0)
+		return SR_ERR;
+
+	text = buf;
+	if ((size_t)len >= sizeof(buf) && g_vasprintf(&text, format, args) < 0)
+		return SR_ERR;
 
-		minutes = elapsed_us / G_TIME_SPAN_MINUTE;
-		rest_us = elapsed_us % G_TIME_SPAN_MINUTE;
-		seconds = rest_us / G_TIME_SPAN_SECOND;
-		microseconds = rest_us % G_TIME_SPAN_SECOND;
+	log_emit(g_get_monotonic_time(), text, len);
 
-		ret = g_fprintf(stderr, "sr: [%.2" PRIu64 ":%.2u.%.6u] ",
-				minutes, seconds, microseconds);
-	} else {
-		ret = fputs("sr: ", stderr);
-	}
+	if (text != buf)
+		g_free(text);
 
-	if (ret < 0 || (raw_len = g_vasprintf(&raw_output, format, args)) < 0)
-		return SR_ERR;
+	return SR_OK;
+}
+
+static int log_cb_call(sr_log_callback cb, void *cb_data, int loglevel,
+		const char *format, ...)
+{
+	int ret;
+	va_list args;
+
+	va_start(args, format);
+	ret = cb(cb_data, loglevel, format, args);
+	va_end(args);
 
-	output = g_malloc0(raw_len + 1);
+	return ret;
+}
+
+static void log_deliver(const struct log_entry *entry)
+{
+	sr_log_callback cb;
+	void *cb_data;
 
-	/* Copy the string without any unwanted newlines. */
-	raw_idx = idx = 0;
-	while (raw_idx < raw_len) {
-		if (raw_output[raw_idx] != '\n') {
-			output[idx] = raw_output[raw_idx];
-			idx++;
+	/*
+	 * Take the callback and its data as a pair, but don't hold the
+	 * lock during the call, the callback may log itself.
+	 */
+	g_rw_lock_reader_lock(&log_async_lock);
+	cb = sr_log_cb;
+	cb_data = sr_log_cb_data;
+	g_rw_lock_reader_unlock(&log_async_lock);
+
+	/* Keep the time of the event, not the time of the output. */
+	if (cb == sr_logv)
+		log_emit(entry->time, entry->text, entry->len);
+	else
+		log_cb_call(cb, cb_data, entry->loglevel, "%s", entry->text);
+}
+
+static gpointer log_thread_run(gpointer data)
+{
+	struct log_entry *entry;
+	struct log_entry notice;
+	int dropped;
+
+	(void)data;
+
+	while (1) {
+		entry = g_async_queue_pop(log_full_queue);
+		/* Also report a loss right before the sink stops. */
+		dropped = g_atomic_int_get(&log_dropped);
+		if (dropped) {
+			g_atomic_int_add(&log_dropped, -dropped);
+			notice.loglevel = SR_LOG_WARN;
+			notice.time = entry != &log_stop_entry ?
+				entry->time : g_get_monotonic_time();
+			notice.len = g_snprintf(notice.text, sizeof(notice.text),
+				"log: %d messages dropped, log buffer full.",
+				dropped);
+			log_deliver(&notice);
 		}
-		raw_idx++;
+		if (entry == &log_stop_entry)
+			break;
+		log_deliver(entry);
+		g_async_queue_push(log_free_queue, entry);
 	}
 
-	g_fprintf(stderr, "%s\n", output);
-	fflush(stderr);
-	g_free(raw_output);
-	g_free(output);
+	return NULL;
+}
+
+/* Format a message into a free entry of the asynchronous sink. */
+static int log_enqueue(int loglevel, const char *format, va_list args)
+{
+	struct log_entry *entry;
+	int len;
+
+	if (!(entry = g_async_queue_try_pop(log_free_queue))) {
+		/* Never block the caller, count the loss instead. */
+		g_atomic_int_inc(&log_dropped);
+		return SR_OK;
+	}
+
+	entry->loglevel = loglevel;
+	entry->time = g_get_monotonic_time();
+	len = g_vsnprintf(entry->text, sizeof(entry->text), format, args);
+	entry->len = MIN((size_t)MAX(len, 0), sizeof(entry->text) - 1);
+	g_async_queue_push(log_full_queue, entry);
+
+	return len < 0 ? SR_ERR : SR_OK;
+}
+
+/**
+ * Deliver log messages from a background thread.
+ *
+ * Messages are formatted into a ring of preallocated entries by the
+ * calling thread, and passed to the log callback by a dedicated thread.
+ * Logging then never waits for the terminal or the application, so
+ * enabling debug output disturbs the timing of acquisitions much less.
+ *
+ * Messages longer than 255 characters are truncated. When all entries
+ * are in use, new messages are dropped and their number is reported
+ * before the next message, or when the sink stops. Messages are still delivered in order, and
+ * with the time at which they were logged.
+ *
+ * @param num_entries The number of messages which can be pending.
+ *
+ * @retval SR_OK Success.
+ * @retval SR_ERR_ARG Invalid argument, or the asynchronous sink is
+ *                    already running.
+ * @retval SR_ERR The background thread could not be started.
+ *
+ * @since 0.6.0
+ */
+SR_API int sr_log_async_start(size_t num_entries)
+{
+	size_t i;
+
+	if (!num_entries || log_thread)
+		return SR_ERR_ARG;
+
+	log_entries = g_malloc_n(num_entries, sizeof(*log_entries));
+	log_free_queue = g_async_queue_new();
+	log_full_queue = g_async_queue_new();
+	for (i = 0; i < num_entries; i++)
+		g_async_queue_push(log_free_queue, &log_entries[i]);
+	log_dropped = 0;
+
+	log_thread = g_thread_try_new("sr-log", log_thread_run, NULL, NULL);
+	if (!log_thread) {
+		g_async_queue_unref(log_full_queue);
+		g_async_queue_unref(log_free_queue);
+		g_free(log_entries);
+		return SR_ERR;
+	}
+
+	g_rw_lock_writer_lock(&log_async_lock);
+	log_async_active = TRUE;
+	g_rw_lock_writer_unlock(&log_async_lock);
+
+	return SR_OK;
+}
+
+/**
+ * Stop delivering log messages from a background thread.
+ *
+ * Delivers all pending messages before returning. Subsequent messages
+ * are passed to the log callback directly again.
+ *
+ * @retval SR_OK Success, also if the asynchronous sink wasn't running.
+ *
+ * @since 0.6.0
+ */
+SR_API int sr_log_async_stop(void)
+{
+	if (!log_thread)
+		return SR_OK;
+
+	g_rw_lock_writer_lock(&log_async_lock);
+	log_async_active = FALSE;
+	g_rw_lock_writer_unlock(&log_async_lock);
+
+	g_async_queue_push(log_full_queue, &log_stop_entry);
+	g_thread_join(log_thread);
+	log_thread = NULL;
+
+	g_async_queue_unref(log_full_queue);
+	g_async_queue_unref(log_free_queue);
+	g_free(log_entries);
+	log_entries = NULL;
 
 	return SR_OK;
 }
@@ -236,16 +469,53 @@ SR_PRIV int sr_log(int loglevel, const char *format, ...)
 {
 	int ret;
 	va_list args;
+	sr_log_callback cb;
+	void *cb_data;
 
 	/* Only output messages of at least the selected loglevel(s). */
-	if (loglevel > cur_loglevel)
+	if (loglevel > sr_cur_loglevel)
 		return SR_OK;
 
 	va_start(args, format);
-	ret = sr_log_cb(sr_log_cb_data, loglevel, format, args);
+	g_rw_lock_reader_lock(&log_async_lock);
+	if (log_async_active) {
+		ret = log_enqueue(loglevel, format, args);
+		g_rw_lock_reader_unlock(&log_async_lock);
+	} else {
+		cb = sr_log_cb;
+		cb_data = sr_log_cb_data;
+		g_rw_lock_reader_unlock(&log_async_lock);
+		ret = cb(cb_data, loglevel, format, args);
+	}
 	va_end(args);
 
 	return ret;
 }
 
+/**
+ * Log a hex dump of some data, see sr_spew_hexdump() and sr_dbg_hexdump().
+ *
+ * @param loglevel The loglevel of the message.
+ * @param text The text which precedes the hex dump.
+ * @param data The data to dump.
+ * @param len The number of bytes to dump.
+ *
+ * @private
+ */
+SR_PRIV int sr_log_hexdump(int loglevel, const char *text,
+		const uint8_t *data, size_t len)
+{
+	GString *s;
+	int ret;
+
+	if (loglevel > sr_cur_loglevel)
+		return SR_OK;
+
+	s = sr_hexdump_new(data, len);
+	ret = sr_log(loglevel, "%s %s", text, s->str);
+	sr_hexdump_free(s);
+
+	return ret;
+}
+
 /** @} */
@@ -0,0 +1,426 @@
+/*
+ * This file is part of the libsigrok project.
+ *
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <config.h>
+#include <stdint.h>
+#include <string.h>
+#include <glib.h>
+#include <libsigrok/libsigrok.h>
+#include "libsigrok-internal.h"
+
+/** @cond PRIVATE */
+#define LOG_PREFIX "logic"
+/** @endcond */
+
+/**
+ * @file
+ *
+ * Handling and converting logic data.
+ */
+
+/**
+ * @defgroup grp_logic Logic data handling
+ *
+ * Handling and converting logic data.
+ *
+ * Besides plain SR_DF_LOGIC packets, the datafeed can carry run-length
+ * encoded logic data in SR_DF_LOGIC_RLE packets. Each run is a single
+ * sample value, repeated a number of times. Consumers which don't care
+ * for the encoding can expand it with sr_logic_rle_expand().
+ *
+ * @{
+ */
+
+/**
+ * Get the number of samples in a run-length encoded logic payload.
+ *
+ * @param rle The payload to use. Must not be NULL.
+ *
+ * @return The total number of samples in all runs.
+ *
+ * @since 0.6.0
+ */
+SR_API uint64_t sr_logic_rle_num_samples(const struct sr_datafeed_logic_rle *rle)
+{
+	uint64_t i, num_samples;
+
+	if (!rle)
+		return 0;
+
+	num_samples = 0;
+	for (i = 0; i < rle->num_runs; i++)
+		num_samples += rle->lengths[i];
+
+	return num_samples;
+}
+
+/**
+ * Expand run-length encoded logic data into plain samples.
+ *
+ * The payload can be expanded piecewise, into a buffer which is smaller
+ * than the whole payload: @a pos keeps track of where the previous call
+ * stopped. It must be zeroed before the first call.
+ *
+ * @param rle The payload to expand. Must not be NULL.
+ * @param pos The position within the payload. Must not be NULL.
+ * @param buf Buffer receiving the samples, with room for @a max_samples
+ *            samples of rle->unitsize bytes each. Must not be NULL.
+ * @param max_samples The maximum number of samples to write.
+ *
+ * @return The number of samples written into @a buf, 0 once all of
+ *         the payload was expanded.
+ *
+ * @since 0.6.0
+ */
+SR_API uint64_t sr_logic_rle_expand(const struct sr_datafeed_logic_rle *rle,
+		struct sr_logic_rle_pos *pos, void *buf, uint64_t max_samples)
+{
+	const uint8_t *value;
+	uint8_t *dst;
+	uint64_t count, written, i;
+	uint16_t unitsize;
+
+	if (!rle || !pos || !buf)
+		return 0;
+
+	unitsize = rle->unitsize;
+	dst = buf;
+	written = 0;
+	while (written < max_samples && pos->run < rle->num_runs) {
+		count = rle->lengths[pos->run] - pos->offset;
+		count = MIN(count, max_samples - written);
+		value = (const uint8_t *)rle->data + pos->run * unitsize;
+		if (unitsize == 1) {
+			memset(dst, value[0], count);
+		} else {
+			for (i = 0; i < count; i++)
+				memcpy(dst + i * unitsize, value, unitsize);
+		}
+		dst += count * unitsize;
+		written += count;
+		pos->offset += count;
+		if (pos->offset == rle->lengths[pos->run]) {
+			pos->run++;
+			pos->offset = 0;
+		}
+	}
+
+	return written;
+}
+
+/** @private */
+SR_PRIV struct sr_logic_rle_buffer *sr_logic_rle_buffer_new(void)
+{
+	struct sr_logic_rle_buffer *rb;
+
+	rb = g_malloc0(sizeof(*rb));
+	rb->data = g_string_new(NULL);
+	rb->lengths = g_array_new(FALSE, FALSE, sizeof(uint64_t));
+
+	return rb;
+}
+
+/** @private */
+SR_PRIV void sr_logic_rle_buffer_free(struct sr_logic_rle_buffer *rb)
+{
+	if (!rb)
+		return;
+
+	g_string_free(rb->data, TRUE);
+	g_array_free(rb->lengths, TRUE);
+	g_free(rb);
+}
+
+/**
+ * Append a sample, repeated @a count times, to a run-length buffer.
+ *
+ * The sample extends the last run if it has the same value.
+ *
+ * @private
+ */
+SR_PRIV void sr_logic_rle_buffer_append(struct sr_logic_rle_buffer *rb,
+		const void *sample, uint16_t unitsize, uint64_t count)
+{
+	const char *last;
+	uint64_t *last_length;
+
+	if (!count)
+		return;
+
+	if (!rb->lengths->len) {
+		rb->unitsize = unitsize;
+	} else if (unitsize != rb->unitsize) {
+		sr_err("Unit size changed from %d to %d, dropping samples.",
+			rb->unitsize, unitsize);
+		return;
+	}
+
+	if (rb->lengths->len) {
+		last = rb->data->str + rb->data->len - unitsize;
+		if (!memcmp(last, sample, unitsize)) {
+			last_length = &g_array_index(rb->lengths, uint64_t,
+				rb->lengths->len - 1);
+			*last_length += count;
+			rb->num_samples += count;
+			return;
+		}
+	}
+
+	g_string_append_len(rb->data, sample, unitsize);
+	g_array_append_val(rb->lengths, count);
+	rb->num_samples += count;
+}
+
+/**
+ * Drop samples from the end of a run-length buffer, so that it holds
+ * no more than @a num_samples samples.
+ *
+ * @private
+ */
+SR_PRIV void sr_logic_rle_buffer_truncate(struct sr_logic_rle_buffer *rb,
+		uint64_t num_samples)
+{
+	uint64_t *lengths, total;
+	guint i;
+
+	if (rb->num_samples <= num_samples)
+		return;
+
+	lengths = (uint64_t *)rb->lengths->data;
+	total = 0;
+	for (i = 0; i < rb->lengths->len; i++) {
+		if (total + lengths[i] >= num_samples)
+			break;
+		total += lengths[i];
+	}
+	if (total < num_samples)
+		lengths[i++] = num_samples - total;
+
+	g_array_set_size(rb->lengths, i);
+	g_string_truncate(rb->data, i * rb->unitsize);
+	rb->num_samples = num_samples;
+}
+
+/**
+ * Send the contents of a run-length buffer as SR_DF_LOGIC_RLE packet,
+ * and empty the buffer.
+ *
+ * @private
+ */
+SR_PRIV int sr_logic_rle_buffer_send(const struct sr_dev_inst *sdi,
+		struct sr_logic_rle_buffer *rb)
+{
+	struct sr_datafeed_packet packet;
+	struct sr_datafeed_logic_rle rle;
+	int ret;
+
+	if (!rb->lengths->len)
+		return SR_OK;
+
+	rle.num_runs = rb->lengths->len;
+	rle.unitsize = rb->unitsize;
+	rle.data = rb->data->str;
+	rle.lengths = (uint64_t *)rb->lengths->data;
+	packet.type = SR_DF_LOGIC_RLE;
+	packet.payload = &rle;
+	ret = sr_session_send(sdi, &packet);
+
+	g_string_truncate(rb->data, 0);
+	g_array_set_size(rb->lengths, 0);
+	rb->num_samples = 0;
+
+	return ret;
+}
+
+/**
+ * Call a function with a series of SR_DF_LOGIC packets, which together
+ * carry the expansion of a run-length encoded packet.
+ *
+ * This serves consumers which don't handle SR_DF_LOGIC_RLE themselves.
+ *
+ * @private
+ */
+SR_PRIV int sr_logic_rle_expand_packets(const struct sr_datafeed_logic_rle *rle,
+		int (*cb)(const struct sr_datafeed_packet *packet, void *cb_data),
+		void *cb_data)
+{
+	struct sr_datafeed_packet packet;
+	struct sr_datafeed_logic logic;
+	struct sr_logic_rle_pos pos;
+	uint64_t max_samples, num_samples;
+	void *buf;
+	int ret;
+
+	if (!rle->unitsize)
+		return SR_ERR_ARG;
+
+	max_samples = MIN(sr_logic_rle_num_samples(rle),
+		LOGIC_RLE_EXPAND_SIZE / rle->unitsize);
+	if (!max_samples)
+		return SR_OK;
+	if (!(buf = g_try_malloc(max_samples * rle->unitsize))) {
+		sr_err("Failed to allocate expansion buffer.");
+		return SR_ERR_MALLOC;
+	}
+
+	packet.type = SR_DF_LOGIC;
+	packet.payload = &logic;
+	logic.unitsize = rle->unitsize;
+	logic.data = buf;
+	memset(&pos, 0, sizeof(pos));
+	ret = SR_OK;
+	while (ret == SR_OK) {
+		num_samples = sr_logic_rle_expand(rle, &pos, buf, max_samples);
+		if (!num_samples)
+			break;
+		logic.length = num_samples * rle->unitsize;
+		ret = cb(&packet, cb_data);
+	}
+	g_free(buf);
+
+	return ret;
+}
+
+/*
+ * Transpose an 8x8 bit matrix, held in a 64-bit word with row r in
+ * byte r and column c in bit c of each byte.
+ */
+static inline uint64_t transpose8x8(uint64_t x)
+{
+	uint64_t t;
+
+	t = (x ^ (x >> 7)) & UINT64_C(0x00aa00aa00aa00aa);
+	x = x ^ t ^ (t << 7);
+	t = (x ^ (x >> 14)) & UINT64_C(0x0000cccc0000cccc);
+	x = x ^ t ^ (t << 14);
+	t = (x ^ (x >> 28)) & UINT64_C(0x00000000f0f0f0f0);
+	x = x ^ t ^ (t << 28);
+
+	return x;
+}
+
+/*
+ * Gather byte 'col' of up to eight planes into the rows of a bit matrix.
+ * Missing planes read as zero.
+ */
+static inline uint64_t gather_planes(const uint8_t *block, unsigned int first,
+		unsigned int num_planes, unsigned int plane_bytes, unsigned int col)
+{
+	uint64_t x;
+	unsigned int k, last;
+
+	x = 0;
+	last = MIN(first + 8, num_planes);
+	for (k = first; k < last; k++)
+		x |= (uint64_t)block[k * plane_bytes + col] << (8 * (k - first));
+
+	return x;
+}
+
+/**
+ * Transpose bit planes into 16-bit logic samples.
+ *
+ * Many devices send logic data as bit planes: a word per channel, whose
+ * bits are consecutive samples of that channel. This converts blocks of
+ * such planes into regular samples, using 8x8 bit matrix transposes
+ * instead of per-bit loops.
+ *
+ * @a src holds @a num_blocks blocks, each consisting of @a num_planes
+ * little-endian planes of @a plane_bytes bytes. Each block yields
+ * plane_bytes * 8 samples in @a dst.
+ *
+ * @param dst Buffer receiving num_blocks * plane_bytes * 8 samples.
+ *            Must not be NULL.
+ * @param src The bit planes. Must not be NULL.
+ * @param num_blocks The number of blocks in @a src.
+ * @param num_planes The number of planes per block, 1 to 16.
+ * @param plane_bytes The size of a plane in bytes, e.g. 2 for 16-bit planes.
+ * @param masks The channel bit(s) to set in a sample for each plane, or
+ *              NULL to map plane k to bit k.
+ * @param msb_first TRUE if the most significant bit of a plane holds
+ *                  the first sample, FALSE if the least significant does.
+ *
+ * @retval SR_OK Success.
+ * @retval SR_ERR_ARG Invalid argument.
+ *
+ * @since 0.6.0
+ */
+SR_API int sr_logic_transpose16(uint16_t *dst, const uint8_t *src,
+		size_t num_blocks, unsigned int num_planes,
+		unsigned int plane_bytes, const uint16_t *masks,
+		gboolean msb_first)
+{
+	uint16_t map_lo[256], map_hi[256];
+	uint16_t *out;
+	const uint8_t *block;
+	uint64_t lo, hi;
+	size_t b;
+	unsigned int i, k, bit, col, row, dense;
+	gboolean remap;
+
+	if (!dst || !src || !num_planes || num_planes > 16 || !plane_bytes)
+		return SR_ERR_ARG;
+
+	/* Only build lookup tables if planes don't map to bits 1:1. */
+	remap = FALSE;
+	if (masks) {
+		for (k = 0; k < num_planes; k++)
+			if (masks[k] != (1 << k))
+				remap = TRUE;
+	}
+	if (remap) {
+		map_lo[0] = map_hi[0] = 0;
+		for (k = 0; k < 8; k++) {
+			bit = 1 << k;
+			for (i = 0; i < bit; i++) {
+				map_lo[bit | i] = map_lo[i] |
+					(k < num_planes ? masks[k] : 0);
+				map_hi[bit | i] = map_hi[i] |
+					(k + 8 < num_planes ? masks[k + 8] : 0);
+			}
+		}
+	}
+
+	for (b = 0; b < num_blocks; b++) {
+		block = src + b * num_planes * plane_bytes;
+		for (col = 0; col < plane_bytes; col++) {
+			/* Row r of the result is sample r of this column. */
+			lo = transpose8x8(gather_planes(block, 0, num_planes,
+				plane_bytes, col));
+			hi = num_planes > 8 ? transpose8x8(gather_planes(block,
+				8, num_planes, plane_bytes, col)) : 0;
+			if (msb_first)
+				out = dst + (plane_bytes - 1 - col) * 8;
+			else
+				out = dst + col * 8;
+			for (row = 0; row < 8; row++) {
+				dense = ((lo >> (8 * row)) & 0xff) |
+					((hi >> (8 * row)) & 0xff) << 8;
+				if (remap)
+					dense = map_lo[dense & 0xff] | map_hi[dense >> 8];
+				out[msb_first ? 7 - row : row] = dense;
+			}
+		}
+		dst += plane_bytes * 8;
+	}
+
+	return SR_OK;
+}
+
+/** @} */
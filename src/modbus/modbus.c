@@ -19,6 +19,7 @@
 
 #include <config.h>
 #include <glib.h>
+#include <stdlib.h>
 #include <string.h>
 #include <libsigrok/libsigrok.h>
 #include "libsigrok-internal.h"
@@ -60,6 +61,33 @@ static struct sr_dev_inst *sr_modbus_scan_resource(const char *resource,
 	return NULL;
 }
 
+struct modbus_scan_job {
+	const char *serialcomm;
+	int modbusaddr;
+	struct sr_dev_inst *(*probe_device)(struct sr_modbus_dev_inst *modbus);
+};
+
+/* Probe one "resource:params" connection ID. */
+static void *modbus_scan_probe(void *item, void *cb_data)
+{
+	const char *conn_id;
+	struct modbus_scan_job *job;
+	struct sr_dev_inst *sdi;
+	gchar **res;
+
+	conn_id = item;
+	job = cb_data;
+	sdi = NULL;
+	res = g_strsplit(conn_id, ":", 2);
+	if (res[0] && (sdi = sr_modbus_scan_resource(res[0],
+			job->serialcomm ? job->serialcomm : res[1],
+			job->modbusaddr, job->probe_device)))
+		sdi->connection_id = g_strdup(conn_id);
+	g_strfreev(res);
+
+	return sdi;
+}
+
 /**
  * Scan for Modbus devices which match a probing function.
  *
@@ -76,10 +104,10 @@ SR_PRIV GSList *sr_modbus_scan(struct drv_context *drvc, GSList *options,
 {
 	GSList *resources, *l, *devices;
 	struct sr_dev_inst *sdi;
+	struct modbus_scan_job job;
 	const char *resource = NULL;
 	const char *serialcomm = NULL;
 	int modbusaddr = 1;
-	gchar **res;
 	unsigned int i;
 
 	for (l = options; l; l = l->next) {
@@ -97,24 +125,28 @@ SR_PRIV GSList *sr_modbus_scan(struct drv_context *drvc, GSList *options,
 		}
 	}
 
-	devices = NULL;
+	/*
+	 * Collect the candidates of all transports, then probe them. This
+	 * is sequential: none of the transports enumerate candidates yet,
+	 * and the probe functions haven't been checked for reentrancy.
+	 */
+	resources = NULL;
 	for (i = 0; i < modbus_devs_size; i++) {
 		if ((resource && strcmp(resource, modbus_devs[i]->prefix))
 		    || !modbus_devs[i]->scan)
 			continue;
-		resources = modbus_devs[i]->scan(modbusaddr);
-		for (l = resources; l; l = l->next) {
-			res = g_strsplit(l->data, ":", 2);
-			if (res[0] && (sdi = sr_modbus_scan_resource(res[0],
-					serialcomm ? serialcomm : res[1],
-					modbusaddr, probe_device))) {
-				devices = g_slist_append(devices, sdi);
-				sdi->connection_id = g_strdup(l->data);
-			}
-			g_strfreev(res);
-		}
-		g_slist_free_full(resources, g_free);
+		resources = g_slist_concat(resources,
+			modbus_devs[i]->scan(modbusaddr));
 	}
+	job.serialcomm = serialcomm;
+	job.modbusaddr = modbusaddr;
+	job.probe_device = probe_device;
+	devices = NULL;
+	for (l = resources; l; l = l->next) {
+		if ((sdi = modbus_scan_probe(l->data, &job)))
+			devices = g_slist_append(devices, sdi);
+	}
+	g_slist_free_full(resources, g_free);
 
 	if (!devices && resource) {
 		sdi = sr_modbus_scan_resource(resource, serialcomm, modbusaddr,
@@ -229,12 +261,84 @@ SR_PRIV int sr_modbus_source_remove(struct sr_session *session,
 SR_PRIV int sr_modbus_request(struct sr_modbus_dev_inst *modbus,
 		uint8_t *request, int request_size)
 {
+	int status;
+
 	if (!request || request_size < 1)
 		return SR_ERR_ARG;
 
+	/* Don't mix up our reply with the one of a pending async request. */
+	if (modbus->async_pending) {
+		sr_dbg("Waiting for the pending asynchronous reply.");
+		while (!sr_modbus_reply_poll(modbus, NULL, 0, &status))
+			g_usleep(1000);
+	}
+
 	return modbus->send(modbus->priv, request, request_size);
 }
 
+/**
+ * Send a Modbus command without waiting for its reply.
+ *
+ * The reply is collected by sr_modbus_reply_poll(), which never blocks.
+ * Retries and timeouts are handled by the transport, so that one thread
+ * can serve many devices.
+ *
+ * @param modbus Previously initialized Modbus device structure.
+ * @param request Buffer containing the Modbus command to send.
+ * @param request_size The size of the request buffer.
+ * @param reply_size The size of the expected reply.
+ *
+ * @return SR_OK upon success, SR_ERR_ARG upon invalid arguments,
+ *         SR_ERR_NA if the transport doesn't support asynchronous
+ *         requests, or SR_ERR on failure.
+ */
+SR_PRIV int sr_modbus_request_async(struct sr_modbus_dev_inst *modbus,
+		const uint8_t *request, int request_size, int reply_size)
+{
+	int ret;
+
+	if (!request || request_size < 1 || reply_size < 2
+			|| modbus->async_pending)
+		return SR_ERR_ARG;
+	if (!modbus->request_async)
+		return SR_ERR_NA;
+
+	ret = modbus->request_async(modbus->priv, request, request_size,
+		reply_size, modbus->read_timeout_ms);
+	if (ret == SR_OK)
+		modbus->async_pending = TRUE;
+
+	return ret;
+}
+
+/**
+ * Collect the reply of a request sent by sr_modbus_request_async(),
+ * without blocking.
+ *
+ * @param modbus Previously initialized Modbus device structure.
+ * @param reply Buffer to store the received Modbus reply, or NULL to
+ *              discard it.
+ * @param reply_size The size of the reply buffer.
+ * @param status The result once the reply is complete: SR_OK, or
+ *               SR_ERR_TIMEOUT, SR_ERR_DATA or SR_ERR on failure.
+ *
+ * @return TRUE when the request finished, FALSE while it is pending.
+ */
+SR_PRIV gboolean sr_modbus_reply_poll(struct sr_modbus_dev_inst *modbus,
+		uint8_t *reply, int reply_size, int *status)
+{
+	if (!modbus->async_pending) {
+		*status = SR_ERR_ARG;
+		return TRUE;
+	}
+
+	if (!modbus->reply_poll(modbus->priv, reply, reply_size, status))
+		return FALSE;
+	modbus->async_pending = FALSE;
+
+	return TRUE;
+}
+
 /**
  * Receive a Modbus reply.
  *
@@ -477,6 +581,69 @@ SR_PRIV int sr_modbus_read_holding_registers(struct sr_modbus_dev_inst *modbus,
 	return SR_OK;
 }
 
+/**
+ * Send a Modbus read holding registers command without waiting for the
+ * reply, see sr_modbus_read_holding_registers_poll().
+ *
+ * @param modbus Previously initialized Modbus device structure.
+ * @param address The Modbus address of the first register to read.
+ * @param nb_registers The number of registers to read.
+ *
+ * @return SR_OK upon success, SR_ERR_ARG upon invalid arguments,
+ *         SR_ERR_NA if unsupported by the transport, or SR_ERR on failure.
+ */
+SR_PRIV int sr_modbus_read_holding_registers_async(
+		struct sr_modbus_dev_inst *modbus, int address, int nb_registers)
+{
+	uint8_t request[5];
+
+	if (address < 0 || address > 0xFFFF
+	    || nb_registers < 1 || nb_registers > 125)
+		return SR_ERR_ARG;
+
+	W8(request + 0, MODBUS_READ_HOLDING_REGISTERS);
+	WB16(request + 1, address);
+	WB16(request + 3, nb_registers);
+
+	return sr_modbus_request_async(modbus, request, sizeof(request),
+		2 + (2 * nb_registers));
+}
+
+/**
+ * Collect the registers values requested by
+ * sr_modbus_read_holding_registers_async(), without blocking.
+ *
+ * @param modbus Previously initialized Modbus device structure.
+ * @param nb_registers The number of registers which were requested.
+ * @param registers Buffer to store all the received registers values.
+ * @param status The result once the reply is complete: SR_OK upon
+ *               success, SR_ERR_DATA upon invalid data, SR_ERR_TIMEOUT
+ *               or SR_ERR on failure.
+ *
+ * @return TRUE when the request finished, FALSE while it is pending.
+ */
+SR_PRIV gboolean sr_modbus_read_holding_registers_poll(
+		struct sr_modbus_dev_inst *modbus, int nb_registers,
+		uint16_t *registers, int *status)
+{
+	uint8_t reply[2 + (2 * nb_registers)];
+
+	if (!sr_modbus_reply_poll(modbus, reply, sizeof(reply), status))
+		return FALSE;
+	if (*status != SR_OK)
+		return TRUE;
+
+	if (sr_modbus_error_check(reply)
+			|| reply[0] != MODBUS_READ_HOLDING_REGISTERS
+			|| R8(reply + 1) != (uint8_t)(2 * nb_registers)) {
+		*status = SR_ERR_DATA;
+		return TRUE;
+	}
+	memcpy(registers, reply + 2, 2 * nb_registers);
+
+	return TRUE;
+}
+
 /**
  * Send a Modbus write coil command.
  *
@@ -551,6 +718,231 @@ SR_PRIV int sr_modbus_write_multiple_registers(struct sr_modbus_dev_inst*modbus,
 	return SR_OK;
 }
 
+/* Largest number of registers a single read holding registers request gets. */
+#define MODBUS_MAX_READ_REGISTERS 125
+
+struct modbus_reg_block {
+	uint16_t address;
+	uint16_t count;
+	size_t offset;
+};
+
+struct sr_modbus_regcache {
+	struct modbus_reg_block *blocks;
+	size_t num_blocks;
+	size_t num_registers;
+	/** Registers of the cycle in progress, as received (big endian). */
+	uint16_t *staging;
+	/** Registers of the last complete cycle, as received (big endian). */
+	uint16_t *snapshot;
+	gboolean valid;
+	gboolean busy;
+	size_t next_block;
+};
+
+static int reg_range_compare(const void *a, const void *b)
+{
+	const struct sr_modbus_reg_range *ra = a, *rb = b;
+
+	return (int)ra->address - (int)rb->address;
+}
+
+/**
+ * Create a cache for the holding registers a driver reads every cycle.
+ *
+ * The ranges are sorted and merged into as few read holding registers
+ * requests as possible. Ranges up to @p max_gap registers apart get
+ * merged as well, as reading a few unused registers is cheaper than
+ * another round trip on a slow bus.
+ *
+ * @param ranges The register ranges to read every cycle.
+ * @param num_ranges The number of ranges.
+ * @param max_gap The number of unused registers to read at most in
+ *                order to save a request.
+ *
+ * @return The new cache, or NULL upon invalid arguments.
+ */
+SR_PRIV struct sr_modbus_regcache *sr_modbus_regcache_new(
+		const struct sr_modbus_reg_range *ranges, size_t num_ranges,
+		unsigned int max_gap)
+{
+	struct sr_modbus_regcache *cache;
+	struct sr_modbus_reg_range *sorted;
+	struct modbus_reg_block *blk;
+	unsigned int start, end, r_end;
+	size_t i;
+
+	if (!ranges || !num_ranges)
+		return NULL;
+	for (i = 0; i < num_ranges; i++) {
+		if (!ranges[i].count || ranges[i].count > MODBUS_MAX_READ_REGISTERS
+				|| ranges[i].address + ranges[i].count > 0x10000)
+			return NULL;
+	}
+
+	sorted = g_memdup(ranges, num_ranges * sizeof(*ranges));
+	qsort(sorted, num_ranges, sizeof(*sorted), reg_range_compare);
+
+	cache = g_malloc0(sizeof(*cache));
+	cache->blocks = g_malloc0(num_ranges * sizeof(*cache->blocks));
+	blk = NULL;
+	for (i = 0; i < num_ranges; i++) {
+		r_end = sorted[i].address + sorted[i].count;
+		if (blk) {
+			start = blk->address;
+			end = MAX(start + blk->count, r_end);
+			if (sorted[i].address <= start + blk->count + max_gap
+					&& end - start <= MODBUS_MAX_READ_REGISTERS) {
+				blk->count = end - start;
+				continue;
+			}
+		}
+		blk = &cache->blocks[cache->num_blocks++];
+		blk->address = sorted[i].address;
+		blk->count = sorted[i].count;
+	}
+	g_free(sorted);
+
+	for (i = 0; i < cache->num_blocks; i++) {
+		cache->blocks[i].offset = cache->num_registers;
+		cache->num_registers += cache->blocks[i].count;
+	}
+	cache->staging = g_malloc0(cache->num_registers * sizeof(uint16_t));
+	cache->snapshot = g_malloc0(cache->num_registers * sizeof(uint16_t));
+	sr_dbg("Coalesced %zu register ranges into %zu requests.",
+		num_ranges, cache->num_blocks);
+
+	return cache;
+}
+
+/**
+ * Free a register cache.
+ *
+ * @param cache The cache to free, may be NULL.
+ */
+SR_PRIV void sr_modbus_regcache_free(struct sr_modbus_regcache *cache)
+{
+	if (!cache)
+		return;
+
+	g_free(cache->blocks);
+	g_free(cache->staging);
+	g_free(cache->snapshot);
+	g_free(cache);
+}
+
+static void regcache_commit(struct sr_modbus_regcache *cache)
+{
+	uint16_t *tmp;
+
+	/* Swap buffers, readers only ever see complete cycles. */
+	tmp = cache->snapshot;
+	cache->snapshot = cache->staging;
+	cache->staging = tmp;
+	cache->valid = TRUE;
+}
+
+/**
+ * Advance the read cycle of a cache without blocking.
+ *
+ * Starts a new cycle when none is in progress. The requests of a cycle
+ * are sent back to back, each one as soon as the previous reply is in.
+ *
+ * @param modbus Previously initialized Modbus device structure.
+ * @param cache The cache to refresh.
+ * @param status The result once the cycle finished: SR_OK when the
+ *               snapshot was updated, or the error of the failed request.
+ *
+ * @return TRUE when the cycle finished, FALSE while it is in progress.
+ */
+SR_PRIV gboolean sr_modbus_regcache_poll(struct sr_modbus_dev_inst *modbus,
+		struct sr_modbus_regcache *cache, int *status)
+{
+	struct modbus_reg_block *blk;
+
+	if (!cache->busy) {
+		cache->next_block = 0;
+		blk = &cache->blocks[0];
+		*status = sr_modbus_read_holding_registers_async(modbus,
+			blk->address, blk->count);
+		if (*status != SR_OK)
+			return TRUE;
+		cache->busy = TRUE;
+	}
+
+	while (1) {
+		blk = &cache->blocks[cache->next_block];
+		if (!modbus->async_pending) {
+			/* A blocking request consumed the reply, ask again. */
+			*status = sr_modbus_read_holding_registers_async(modbus,
+				blk->address, blk->count);
+			if (*status != SR_OK)
+				break;
+		}
+		if (!sr_modbus_read_holding_registers_poll(modbus, blk->count,
+				cache->staging + blk->offset, status))
+			return FALSE;
+		if (*status != SR_OK)
+			break;
+		if (++cache->next_block == cache->num_blocks) {
+			regcache_commit(cache);
+			break;
+		}
+		blk = &cache->blocks[cache->next_block];
+		*status = sr_modbus_read_holding_registers_async(modbus,
+			blk->address, blk->count);
+		if (*status != SR_OK)
+			break;
+	}
+	cache->busy = FALSE;
+
+	return TRUE;
+}
+
+/**
+ * Get a register value from the last complete cycle of a cache.
+ *
+ * @param cache The cache to read from.
+ * @param address The Modbus address of the register.
+ * @param value Where to store the register value.
+ *
+ * @return SR_OK upon success, SR_ERR_ARG if the register isn't cached,
+ *         or SR_ERR_NA if no cycle completed since the last invalidation.
+ */
+SR_PRIV int sr_modbus_regcache_get(const struct sr_modbus_regcache *cache,
+		uint16_t address, uint16_t *value)
+{
+	const struct modbus_reg_block *blk;
+	size_t i;
+
+	if (!cache)
+		return SR_ERR_ARG;
+
+	for (i = 0; i < cache->num_blocks; i++) {
+		blk = &cache->blocks[i];
+		if (address < blk->address || address >= blk->address + blk->count)
+			continue;
+		if (!cache->valid)
+			return SR_ERR_NA;
+		*value = RB16(cache->snapshot + blk->offset +
+			(address - blk->address));
+		return SR_OK;
+	}
+
+	return SR_ERR_ARG;
+}
+
+/**
+ * Invalidate the snapshot of a cache, e.g. after writing registers.
+ *
+ * @param cache The cache to invalidate, may be NULL.
+ */
+SR_PRIV void sr_modbus_regcache_invalidate(struct sr_modbus_regcache *cache)
+{
+	if (cache)
+		cache->valid = FALSE;
+}
+
 /**
  * Close Modbus device.
  *
@@ -28,10 +28,15 @@
 
 #define BUFFER_SIZE 1024
 
+/* How often an asynchronous request is resent when its reply is lost. */
+#define ASYNC_RETRIES 2
+
 struct modbus_serial_rtu {
 	struct sr_serial_dev_inst *serial;
 	uint8_t slave_addr;
 	uint16_t crc;
+	struct serial_txn txn;
+	int reply_size;
 };
 
 static int modbus_serial_rtu_dev_inst_new(void *priv, const char *resource,
@@ -58,6 +63,8 @@ static int modbus_serial_rtu_open(void *priv)
 	if (serial_flush(serial) != SR_OK)
 		return SR_ERR;
 
+	serial_txn_init(&modbus->txn, serial, 0, ASYNC_RETRIES, 0);
+
 	return SR_OK;
 }
 
@@ -177,6 +184,76 @@ static int modbus_serial_rtu_read_end(void *priv)
 	return SR_OK;
 }
 
+/* Slave address, PDU and CRC, the PDU of an exception has two bytes. */
+static size_t modbus_serial_rtu_reply_len(const uint8_t *buf, size_t len,
+		void *cb_data)
+{
+	struct modbus_serial_rtu *modbus = cb_data;
+
+	if (len < 2)
+		return 2;
+	if (buf[1] & 0x80)
+		return 1 + 2 + 2;
+
+	return 1 + modbus->reply_size + 2;
+}
+
+static int modbus_serial_rtu_request_async(void *priv,
+		const uint8_t *request, int request_size, int reply_size,
+		unsigned int timeout_ms)
+{
+	struct modbus_serial_rtu *modbus = priv;
+	uint8_t adu[SERIAL_TXN_BUFSIZE];
+	uint16_t crc;
+
+	if (1 + request_size + 2 > (int)sizeof(adu)
+			|| 1 + reply_size + 2 > SERIAL_TXN_BUFSIZE)
+		return SR_ERR_ARG;
+
+	adu[0] = modbus->slave_addr;
+	memcpy(adu + 1, request, request_size);
+	crc = modbus_serial_rtu_crc(0xFFFF, adu, 1 + request_size);
+	WL16(adu + 1 + request_size, crc);
+
+	modbus->reply_size = reply_size;
+	modbus->txn.timeout_ms = timeout_ms;
+
+	return serial_txn_start(&modbus->txn, adu, 1 + request_size + 2, 0,
+		modbus_serial_rtu_reply_len, modbus);
+}
+
+static gboolean modbus_serial_rtu_reply_poll(void *priv, uint8_t *reply,
+		int reply_size, int *status)
+{
+	struct modbus_serial_rtu *modbus = priv;
+	const uint8_t *adu;
+	size_t len;
+	uint16_t crc;
+
+	if (!serial_txn_poll(&modbus->txn, status))
+		return FALSE;
+	if (*status != SR_OK)
+		return TRUE;
+
+	adu = modbus->txn.reply;
+	len = modbus->txn.reply_len;
+	if (adu[0] != modbus->slave_addr) {
+		sr_err("Reply from unexpected slave address %d.", adu[0]);
+		*status = SR_ERR_DATA;
+		return TRUE;
+	}
+	crc = modbus_serial_rtu_crc(0xFFFF, adu, len - 2);
+	if (crc != RL16(adu + len - 2)) {
+		sr_err("CRC error (0x%04X vs 0x%04X).", RL16(adu + len - 2), crc);
+		*status = SR_ERR_DATA;
+		return TRUE;
+	}
+	if (reply)
+		memcpy(reply, adu + 1, MIN((int)len - 3, reply_size));
+
+	return TRUE;
+}
+
 static int modbus_serial_rtu_close(void *priv)
 {
 	struct modbus_serial_rtu *modbus = priv;
@@ -204,6 +281,8 @@ SR_PRIV const struct sr_modbus_dev_inst modbus_serial_rtu_dev = {
 	.read_begin    = modbus_serial_rtu_read_begin,
 	.read_data     = modbus_serial_rtu_read_data,
 	.read_end      = modbus_serial_rtu_read_end,
+	.request_async = modbus_serial_rtu_request_async,
+	.reply_poll    = modbus_serial_rtu_reply_poll,
 	.close         = modbus_serial_rtu_close,
 	.free          = modbus_serial_rtu_free,
 };
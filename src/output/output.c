@@ -323,18 +323,61 @@ SR_API const struct sr_output *sr_output_new(const struct sr_output_module *omod
 	return op;
 }
 
+struct expand_state {
+	const struct sr_output *o;
+	GString *out;
+};
+
+static int receive_expanded(const struct sr_datafeed_packet *packet,
+		void *cb_data)
+{
+	struct expand_state *state;
+	GString *out;
+	int ret;
+
+	state = cb_data;
+	out = NULL;
+	ret = state->o->module->receive(state->o, packet, &out);
+	if (!out)
+		return ret;
+	if (!state->out) {
+		state->out = out;
+	} else {
+		g_string_append_len(state->out, out->str, out->len);
+		g_string_free(out, TRUE);
+	}
+
+	return ret;
+}
+
 /**
  * Send a packet to the specified output instance.
  *
  * The instance's output is returned as a newly allocated GString,
  * which must be freed by the caller.
  *
+ * SR_DF_LOGIC_RLE packets are expanded for modules which don't
+ * handle them (see SR_OUTPUT_LOGIC_RLE).
+ *
  * @since 0.4.0
  */
 SR_API int sr_output_send(const struct sr_output *o,
 		const struct sr_datafeed_packet *packet, GString **out)
 {
-	return o->module->receive(o, packet, out);
+	struct expand_state state;
+	int ret;
+
+	if (packet->type != SR_DF_LOGIC_RLE
+			|| (o->module->flags & SR_OUTPUT_LOGIC_RLE))
+		return o->module->receive(o, packet, out);
+
+	state.o = o;
+	state.out = NULL;
+	ret = sr_logic_rle_expand_packets(packet->payload,
+		receive_expanded, &state);
+	*out = state.out;
+
+	return ret;
 }
 
 /**
@@ -29,6 +29,9 @@
 
 #define LOG_PREFIX "output/srzip"
 
+/* Maximum size of a logic chunk expanded from run-length encoded data. */
+#define RLE_CHUNK_SIZE (64 * 1024 * 1024)
+
 struct out_context {
 	gboolean zip_created;
 	uint64_t samplerate;
@@ -409,6 +412,44 @@ err_zip_discard:
 	return SR_ERR;
 }
 
+/*
+ * Expand run-length encoded data straight into archive chunks, which
+ * can be much larger than the packets the session would expand into.
+ */
+static int zip_append_rle(const struct sr_output *o,
+		const struct sr_datafeed_logic_rle *rle)
+{
+	struct sr_logic_rle_pos pos;
+	uint64_t max_samples, num_samples;
+	unsigned char *buf;
+	int ret;
+
+	if (!rle->unitsize)
+		return SR_ERR_ARG;
+
+	max_samples = MIN(sr_logic_rle_num_samples(rle),
+		RLE_CHUNK_SIZE / rle->unitsize);
+	if (!max_samples)
+		return SR_OK;
+	if (!(buf = g_try_malloc(max_samples * rle->unitsize))) {
+		sr_err("Failed to allocate chunk buffer.");
+		return SR_ERR_MALLOC;
+	}
+
+	memset(&pos, 0, sizeof(pos));
+	ret = SR_OK;
+	while (ret == SR_OK) {
+		num_samples = sr_logic_rle_expand(rle, &pos, buf, max_samples);
+		if (!num_samples)
+			break;
+		ret = zip_append(o, buf, rle->unitsize,
+			num_samples * rle->unitsize);
+	}
+	g_free(buf);
+
+	return ret;
+}
+
 static int receive(const struct sr_output *o, const struct sr_datafeed_packet *packet,
 		GString **out)
 {
@@ -446,6 +487,16 @@ static int receive(const struct sr_output *o, const struct sr_datafeed_packet *p
 		if (ret != SR_OK)
 			return ret;
 		break;
+	case SR_DF_LOGIC_RLE:
+		if (!outc->zip_created) {
+			if ((ret = zip_create(o)) != SR_OK)
+				return ret;
+			outc->zip_created = TRUE;
+		}
+		ret = zip_append_rle(o, packet->payload);
+		if (ret != SR_OK)
+			return ret;
+		break;
 	case SR_DF_ANALOG:
 		if (!outc->zip_created) {
 			if ((ret = zip_create(o)) != SR_OK)
@@ -489,7 +540,7 @@ SR_PRIV struct sr_output_module output_srzip = {
 	.name = "srzip",
 	.desc = "srzip session file format data",
 	.exts = (const char*[]){"sr", NULL},
-	.flags = SR_OUTPUT_INTERNAL_IO_HANDLING,
+	.flags = SR_OUTPUT_INTERNAL_IO_HANDLING | SR_OUTPUT_LOGIC_RLE,
 	.options = get_options,
 	.init = init,
 	.receive = receive,
@@ -152,18 +152,68 @@ static GString *gen_header(const struct sr_output *o)
 	return header;
 }
 
+/* Write the changes of a sample which repeats count times. */
+static void write_sample(struct context *ctx, GString *out,
+		const uint8_t *sample, uint16_t unitsize, uint64_t count)
+{
+	int p, curbit, prevbit, index;
+	gboolean timestamp_written;
+
+	timestamp_written = FALSE;
+
+	for (p = 0; p < ctx->num_enabled_channels; p++) {
+		/*
+		 * TODO Check whether the mapping from
+		 * data image positions to channel numbers
+		 * is required. Experiments suggest that
+		 * the data image "is dense", and packs
+		 * bits of enabled channels, and leaves no
+		 * room for positions of disabled channels.
+		 */
+		/* index = ctx->channel_index[p]; */
+		index = p;
+
+		curbit = ((unsigned)sample[index / 8]
+				>> (index % 8)) & 1;
+		prevbit = ((unsigned)ctx->prevsample[index / 8]
+				>> (index % 8)) & 1;
+
+		/* VCD only contains deltas/changes of signals. */
+		if (prevbit == curbit && ctx->samplecount > 0)
+			continue;
+
+		/* Output timestamp of subsequent signal changes. */
+		if (!timestamp_written)
+			g_string_append_printf(out, "#%.0f",
+				(double)ctx->samplecount /
+					ctx->samplerate * ctx->period);
+
+		/* Output which signal changed to which value. */
+		g_string_append_c(out, ' ');
+		g_string_append_c(out, '0' + curbit);
+		g_string_append_c(out, '!' + p);
+
+		timestamp_written = TRUE;
+	}
+
+	if (timestamp_written)
+		g_string_append_c(out, '\n');
+
+	ctx->samplecount += count;
+	memcpy(ctx->prevsample, sample, unitsize);
+}
+
 static int receive(const struct sr_output *o, const struct sr_datafeed_packet *packet,
 		GString **out)
 {
 	const struct sr_datafeed_meta *meta;
 	const struct sr_datafeed_logic *logic;
+	const struct sr_datafeed_logic_rle *rle;
 	const struct sr_config *src;
 	GSList *l;
 	struct context *ctx;
 	unsigned int i;
-	int p, curbit, prevbit, index;
-	uint8_t *sample;
-	gboolean timestamp_written;
+	uint64_t r;
 
 	*out = NULL;
 	if (!o || !o->priv)
@@ -195,50 +245,28 @@ static int receive(const struct sr_output *o, const struct sr_datafeed_packet *p
 			ctx->prevsample = g_malloc0(logic->unitsize);
 		}
 
-		for (i = 0; i <= logic->length - logic->unitsize; i += logic->unitsize) {
-			sample = logic->data + i;
-			timestamp_written = FALSE;
-
-			for (p = 0; p < ctx->num_enabled_channels; p++) {
-				/*
-				 * TODO Check whether the mapping from
-				 * data image positions to channel numbers
-				 * is required. Experiments suggest that
-				 * the data image "is dense", and packs
-				 * bits of enabled channels, and leaves no
-				 * room for positions of disabled channels.
-				 */
-				/* index = ctx->channel_index[p]; */
-				index = p;
-
-				curbit = ((unsigned)sample[index / 8]
-						>> (index % 8)) & 1;
-				prevbit = ((unsigned)ctx->prevsample[index / 8]
-						>> (index % 8)) & 1;
-
-				/* VCD only contains deltas/changes of signals. */
-				if (prevbit == curbit && ctx->samplecount > 0)
-					continue;
-
-				/* Output timestamp of subsequent signal changes. */
-				if (!timestamp_written)
-					g_string_append_printf(*out, "#%.0f",
-						(double)ctx->samplecount /
-							ctx->samplerate * ctx->period);
-
-				/* Output which signal changed to which value. */
-				g_string_append_c(*out, ' ');
-				g_string_append_c(*out, '0' + curbit);
-				g_string_append_c(*out, '!' + p);
-
-				timestamp_written = TRUE;
-			}
-
-			if (timestamp_written)
-				g_string_append_c(*out, '\n');
-
-			ctx->samplecount++;
-			memcpy(ctx->prevsample, sample, logic->unitsize);
+		for (i = 0; i <= logic->length - logic->unitsize; i += logic->unitsize)
+			write_sample(ctx, *out, logic->data + i, logic->unitsize, 1);
+		break;
+	case SR_DF_LOGIC_RLE:
+		rle = packet->payload;
+
+		if (!ctx->header_done) {
+			*out = gen_header(o);
+			ctx->header_done = TRUE;
+		} else {
+			*out = g_string_sized_new(512);
+		}
+
+		if (!ctx->prevsample)
+			ctx->prevsample = g_malloc0(rle->unitsize);
+
+		/* Only the start of each run can be a change. */
+		for (r = 0; r < rle->num_runs; r++) {
+			if (!rle->lengths[r])
+				continue;
+			write_sample(ctx, *out, (uint8_t *)rle->data + r * rle->unitsize,
+				rle->unitsize, rle->lengths[r]);
 		}
 		break;
 	case SR_DF_END:
@@ -272,7 +300,7 @@ struct sr_output_module output_vcd = {
 	.name = "VCD",
 	.desc = "Value Change Dump data",
 	.exts = (const char*[]){"vcd", NULL},
-	.flags = 0,
+	.flags = SR_OUTPUT_LOGIC_RLE,
 	.options = NULL,
 	.init = init,
 	.receive = receive,
@@ -310,14 +310,42 @@ static int scpi_get_data(struct sr_scpi_dev_inst *scpi,
 	return SR_OK;
 }
 
-SR_PRIV GSList *sr_scpi_scan(struct drv_context *drvc, GSList *options,
-		struct sr_dev_inst *(*probe_device)(struct sr_scpi_dev_inst *scpi))
+struct scpi_scan_job {
+	struct drv_context *drvc;
+	const char *serialcomm;
+	struct sr_dev_inst *(*probe_device)(struct sr_scpi_dev_inst *scpi);
+};
+
+/* Probe one "resource:params" connection ID, may run on a worker thread. */
+static void *scpi_scan_probe(void *item, void *cb_data)
+{
+	const char *conn_id;
+	struct scpi_scan_job *job;
+	struct sr_dev_inst *sdi;
+	gchar **res;
+
+	conn_id = item;
+	job = cb_data;
+	sdi = NULL;
+	res = g_strsplit(conn_id, ":", 2);
+	if (res[0] && (sdi = sr_scpi_scan_resource(job->drvc, res[0],
+	               job->serialcomm ? job->serialcomm : res[1],
+	               job->probe_device)))
+		sdi->connection_id = g_strdup(conn_id);
+	g_strfreev(res);
+
+	return sdi;
+}
+
+static GSList *scpi_scan(struct drv_context *drvc, GSList *options,
+		struct sr_dev_inst *(*probe_device)(struct sr_scpi_dev_inst *scpi),
+		gboolean concurrent)
 {
 	GSList *resources, *l, *devices;
 	struct sr_dev_inst *sdi;
+	struct scpi_scan_job job;
 	const char *resource = NULL;
 	const char *serialcomm = NULL;
-	gchar **res;
 	unsigned i;
 
 	for (l = options; l; l = l->next) {
@@ -332,23 +360,27 @@ SR_PRIV GSList *sr_scpi_scan(struct drv_context *drvc, GSList *options,
 		}
 	}
 
-	devices = NULL;
+	/* Collect the candidates of all transports, then probe them. */
+	resources = NULL;
 	for (i = 0; i < ARRAY_SIZE(scpi_devs); i++) {
 		if ((resource && strcmp(resource, scpi_devs[i]->prefix))
 		    || !scpi_devs[i]->scan)
 			continue;
-		resources = scpi_devs[i]->scan(drvc);
+		resources = g_slist_concat(resources, scpi_devs[i]->scan(drvc));
+	}
+	job.drvc = drvc;
+	job.serialcomm = serialcomm;
+	job.probe_device = probe_device;
+	if (concurrent) {
+		devices = std_probe_parallel(resources, scpi_scan_probe, &job);
+	} else {
+		devices = NULL;
 		for (l = resources; l; l = l->next) {
-			res = g_strsplit(l->data, ":", 2);
-			if (res[0] && (sdi = sr_scpi_scan_resource(drvc, res[0],
-			               serialcomm ? serialcomm : res[1], probe_device))) {
+			if ((sdi = scpi_scan_probe(l->data, &job)))
 				devices = g_slist_append(devices, sdi);
-				sdi->connection_id = g_strdup(l->data);
-			}
-			g_strfreev(res);
 		}
-		g_slist_free_full(resources, g_free);
 	}
+	g_slist_free_full(resources, g_free);
 
 	if (!devices && resource) {
 		sdi = sr_scpi_scan_resource(drvc, resource, serialcomm, probe_device);
@@ -363,6 +395,26 @@ SR_PRIV GSList *sr_scpi_scan(struct drv_context *drvc, GSList *options,
 	return devices;
 }
 
+SR_PRIV GSList *sr_scpi_scan(struct drv_context *drvc, GSList *options,
+		struct sr_dev_inst *(*probe_device)(struct sr_scpi_dev_inst *scpi))
+{
+	return scpi_scan(drvc, options, probe_device, FALSE);
+}
+
+/**
+ * Scan for SCPI devices, probing the candidate resources concurrently.
+ *
+ * Like sr_scpi_scan(), but runs @p probe_device on worker threads, see
+ * std_probe_parallel(). Only use this for drivers whose probe function
+ * has been checked to be reentrant.
+ */
+SR_PRIV GSList *sr_scpi_scan_concurrent(struct drv_context *drvc,
+		GSList *options,
+		struct sr_dev_inst *(*probe_device)(struct sr_scpi_dev_inst *scpi))
+{
+	return scpi_scan(drvc, options, probe_device, TRUE);
+}
+
 SR_PRIV struct sr_scpi_dev_inst *scpi_dev_inst_new(struct drv_context *drvc,
 		const char *resource, const char *serialcomm)
 {
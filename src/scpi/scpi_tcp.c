@@ -18,21 +18,8 @@
  */
 
 #include <config.h>
-#ifdef _WIN32
-#define _WIN32_WINNT 0x0501
-#include <winsock2.h>
-#include <ws2tcpip.h>
-#endif
 #include <glib.h>
 #include <string.h>
-#include <unistd.h>
-#ifndef _WIN32
-#include <sys/socket.h>
-#include <netinet/in.h>
-#include <arpa/inet.h>
-#include <netdb.h>
-#endif
-#include <errno.h>
 #include <libsigrok/libsigrok.h>
 #include "libsigrok-internal.h"
 #include "scpi.h"
@@ -41,10 +28,11 @@
 
 #define LENGTH_BYTES 4
 
+/* Large enough for waveform blocks of networked scopes at LAN speed. */
+#define RCVBUF_SIZE (1024 * 1024)
+
 struct scpi_tcp {
-	char *address;
-	char *port;
-	int socket;
+	struct sr_tcp_dev_inst *tcp_dev;
 	char length_buf[LENGTH_BYTES];
 	int length_bytes_read;
 	int response_length;
@@ -65,9 +53,9 @@ static int scpi_tcp_dev_inst_new(void *priv, struct drv_context *drvc,
 		return SR_ERR;
 	}
 
-	tcp->address = g_strdup(params[1]);
-	tcp->port = g_strdup(params[2]);
-	tcp->socket = -1;
+	tcp->tcp_dev = sr_tcp_dev_inst_new(params[1], params[2], RCVBUF_SIZE);
+	if (!tcp->tcp_dev)
+		return SR_ERR;
 
 	return SR_OK;
 }
@@ -75,44 +63,8 @@ static int scpi_tcp_dev_inst_new(void *priv, struct drv_context *drvc,
 static int scpi_tcp_open(struct sr_scpi_dev_inst *scpi)
 {
 	struct scpi_tcp *tcp = scpi->priv;
-	struct addrinfo hints;
-	struct addrinfo *results, *res;
-	int err;
-
-	memset(&hints, 0, sizeof(hints));
-	hints.ai_family = AF_UNSPEC;
-	hints.ai_socktype = SOCK_STREAM;
-	hints.ai_protocol = IPPROTO_TCP;
-
-	err = getaddrinfo(tcp->address, tcp->port, &hints, &results);
 
-	if (err) {
-		sr_err("Address lookup failed: %s:%s: %s", tcp->address, tcp->port,
-			gai_strerror(err));
-		return SR_ERR;
-	}
-
-	for (res = results; res; res = res->ai_next) {
-		if ((tcp->socket = socket(res->ai_family, res->ai_socktype,
-						res->ai_protocol)) < 0)
-			continue;
-		if (connect(tcp->socket, res->ai_addr, res->ai_addrlen) != 0) {
-			close(tcp->socket);
-			tcp->socket = -1;
-			continue;
-		}
-		break;
-	}
-
-	freeaddrinfo(results);
-
-	if (tcp->socket < 0) {
-		sr_err("Failed to connect to %s:%s: %s", tcp->address, tcp->port,
-				g_strerror(errno));
-		return SR_ERR;
-	}
-
-	return SR_OK;
+	return sr_tcp_connect(tcp->tcp_dev);
 }
 
 static int scpi_tcp_source_add(struct sr_session *session, void *priv,
@@ -120,34 +72,26 @@ static int scpi_tcp_source_add(struct sr_session *session, void *priv,
 {
 	struct scpi_tcp *tcp = priv;
 
-	return sr_session_source_add(session, tcp->socket, events, timeout,
-			cb, cb_data);
+	return sr_session_source_add(session, tcp->tcp_dev->sock_fd, events,
+			timeout, cb, cb_data);
 }
 
 static int scpi_tcp_source_remove(struct sr_session *session, void *priv)
 {
 	struct scpi_tcp *tcp = priv;
 
-	return sr_session_source_remove(session, tcp->socket);
+	return sr_session_source_remove(session, tcp->tcp_dev->sock_fd);
 }
 
 static int scpi_tcp_send(void *priv, const char *command)
 {
 	struct scpi_tcp *tcp = priv;
-	int len, out;
-
-	len = strlen(command);
-	out = send(tcp->socket, command, len, 0);
+	int ret;
 
-	if (out < 0) {
-		sr_err("Send error: %s", g_strerror(errno));
+	ret = sr_tcp_write_bytes(tcp->tcp_dev, (const uint8_t *)command,
+		strlen(command));
+	if (ret < 0)
 		return SR_ERR;
-	}
-
-	if (out < len) {
-		sr_dbg("Only sent %d/%d bytes of SCPI command: '%s'.", out,
-		       len, command);
-	}
 
 	sr_spew("Successfully sent SCPI command: '%s'.", command);
 
@@ -169,12 +113,9 @@ static int scpi_tcp_raw_read_data(void *priv, char *buf, int maxlen)
 	struct scpi_tcp *tcp = priv;
 	int len;
 
-	len = recv(tcp->socket, buf, maxlen, 0);
-
-	if (len < 0) {
-		sr_err("Receive error: %s", g_strerror(errno));
+	len = sr_tcp_read_bytes(tcp->tcp_dev, (uint8_t *)buf, maxlen);
+	if (len < 0)
 		return SR_ERR;
-	}
 
 	tcp->length_bytes_read = LENGTH_BYTES;
 	tcp->response_length = len < maxlen ? len : maxlen + 1;
@@ -186,16 +127,8 @@ static int scpi_tcp_raw_read_data(void *priv, char *buf, int maxlen)
 static int scpi_tcp_raw_write_data(void *priv, char *buf, int len)
 {
 	struct scpi_tcp *tcp = priv;
-	int sentlen;
-
-	sentlen = send(tcp->socket, buf, len, 0);
-
-	if (sentlen < 0) {
-		sr_err("Send error: %s.", g_strerror(errno));
-		return SR_ERR;
-	}
 
-	return sentlen;
+	return sr_tcp_write_bytes(tcp->tcp_dev, (const uint8_t *)buf, len);
 }
 
 static int scpi_tcp_rigol_read_data(void *priv, char *buf, int maxlen)
@@ -204,12 +137,11 @@ static int scpi_tcp_rigol_read_data(void *priv, char *buf, int maxlen)
 	int len;
 
 	if (tcp->length_bytes_read < LENGTH_BYTES) {
-		len = recv(tcp->socket, tcp->length_buf + tcp->length_bytes_read,
-				LENGTH_BYTES - tcp->length_bytes_read, 0);
-		if (len < 0) {
-			sr_err("Receive error: %s", g_strerror(errno));
+		len = sr_tcp_read_all(tcp->tcp_dev,
+			(uint8_t *)tcp->length_buf + tcp->length_bytes_read,
+			LENGTH_BYTES - tcp->length_bytes_read);
+		if (len < 0)
 			return SR_ERR;
-		}
 
 		tcp->length_bytes_read += len;
 
@@ -222,12 +154,14 @@ static int scpi_tcp_rigol_read_data(void *priv, char *buf, int maxlen)
 	if (tcp->response_bytes_read >= tcp->response_length)
 		return SR_ERR;
 
-	len = recv(tcp->socket, buf, maxlen, 0);
-
-	if (len < 0) {
-		sr_err("Receive error: %s", g_strerror(errno));
+	/*
+	 * The response length is known, receive the caller's chunk in one
+	 * go, and don't consume data beyond the end of this response.
+	 */
+	maxlen = MIN(maxlen, tcp->response_length - tcp->response_bytes_read);
+	len = sr_tcp_read_all(tcp->tcp_dev, (uint8_t *)buf, maxlen);
+	if (len < 0)
 		return SR_ERR;
-	}
 
 	tcp->response_bytes_read += len;
 
@@ -246,18 +180,14 @@ static int scpi_tcp_close(struct sr_scpi_dev_inst *scpi)
 {
 	struct scpi_tcp *tcp = scpi->priv;
 
-	if (close(tcp->socket) < 0)
-		return SR_ERR;
-
-	return SR_OK;
+	return sr_tcp_disconnect(tcp->tcp_dev);
 }
 
 static void scpi_tcp_free(void *priv)
 {
 	struct scpi_tcp *tcp = priv;
 
-	g_free(tcp->address);
-	g_free(tcp->port);
+	sr_tcp_dev_inst_free(tcp->tcp_dev);
 }
 
 SR_PRIV const struct sr_scpi_dev_inst scpi_tcp_raw_dev = {
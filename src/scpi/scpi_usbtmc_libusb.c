@@ -28,6 +28,22 @@
 #define MAX_TRANSFER_LENGTH 2048
 #define TRANSFER_TIMEOUT 1000
 
+/*
+ * Bulk IN data is received by several large asynchronous transfers,
+ * one of which is being consumed by the SCPI layer while the others
+ * are in flight.
+ */
+#define NUM_IN_TRANSFERS 4
+#define IN_TRANSFER_SIZE (1024 * 1024)
+/* Room for rounding up to the packet size, and alignment bytes. */
+#define IN_BUFFER_SIZE (IN_TRANSFER_SIZE + 1024)
+
+struct usbtmc_in_transfer {
+	struct libusb_transfer *xfer;
+	uint8_t *buffer;
+	int completed;
+};
+
 struct scpi_usbtmc_libusb {
 	struct sr_context *ctx;
 	struct sr_usb_dev_inst *usb;
@@ -41,9 +57,16 @@ struct scpi_usbtmc_libusb {
 	uint8_t usb488_dev_cap;
 	uint8_t bTag;
 	uint8_t bulkin_attributes;
+	uint16_t bulk_in_max_packet;
 	uint8_t buffer[MAX_TRANSFER_LENGTH];
+	struct usbtmc_in_transfer in_transfers[NUM_IN_TRANSFERS];
+	int in_head;
+	int in_pending;
+	int in_flight_length;
+	uint8_t *response;
 	int response_length;
 	int response_bytes_read;
+	/* Message bytes not yet received. */
 	int remaining_length;
 };
 
@@ -336,6 +359,7 @@ static int scpi_usbtmc_libusb_open(struct sr_scpi_dev_inst *scpi)
 				if (ep->bmAttributes == LIBUSB_TRANSFER_TYPE_BULK &&
 				    ep->bEndpointAddress & (LIBUSB_ENDPOINT_DIR_MASK)) {
 					uscpi->bulk_in_ep = ep->bEndpointAddress;
+					uscpi->bulk_in_max_packet = ep->wMaxPacketSize & 0x7ff;
 					sr_dbg("Bulk IN EP %d", uscpi->bulk_in_ep & 0x7f);
 				}
 				if (ep->bmAttributes == LIBUSB_TRANSFER_TYPE_INTERRUPT &&
@@ -505,23 +529,207 @@ static int scpi_usbtmc_bulkout(struct scpi_usbtmc_libusb *uscpi,
 	return transferred - USBTMC_BULK_HEADER_SIZE;
 }
 
-static int scpi_usbtmc_bulkin_start(struct scpi_usbtmc_libusb *uscpi,
-                                    uint8_t msg_id, void *data, int32_t size,
-                                    uint8_t *transfer_attributes)
+static void LIBUSB_CALL usbtmc_in_transfer_cb(struct libusb_transfer *xfer)
+{
+	struct usbtmc_in_transfer *t = xfer->user_data;
+
+	t->completed = 1;
+}
+
+static int usbtmc_in_transfers_alloc(struct scpi_usbtmc_libusb *uscpi)
+{
+	struct usbtmc_in_transfer *t;
+	int i;
+
+	for (i = 0; i < NUM_IN_TRANSFERS; i++) {
+		t = &uscpi->in_transfers[i];
+		if (!t->xfer && !(t->xfer = libusb_alloc_transfer(0)))
+			return SR_ERR_MALLOC;
+		if (!t->buffer && !(t->buffer = g_try_malloc(IN_BUFFER_SIZE)))
+			return SR_ERR_MALLOC;
+	}
+
+	return SR_OK;
+}
+
+/*
+ * Free the transfers and their buffers. Transfers which could not be
+ * reaped are still owned by libusb and get leaked instead.
+ */
+static void usbtmc_in_transfers_free(struct scpi_usbtmc_libusb *uscpi)
+{
+	struct usbtmc_in_transfer *t;
+	int i;
+
+	for (i = 0; i < NUM_IN_TRANSFERS; i++) {
+		t = &uscpi->in_transfers[i];
+		if ((i - uscpi->in_head + NUM_IN_TRANSFERS) % NUM_IN_TRANSFERS <
+		    uscpi->in_pending) {
+			sr_warn("USBTMC bulk in transfer still busy, leaking it.");
+			t->xfer = NULL;
+			t->buffer = NULL;
+			continue;
+		}
+		libusb_free_transfer(t->xfer);
+		t->xfer = NULL;
+		g_free(t->buffer);
+		t->buffer = NULL;
+	}
+	uscpi->response = NULL;
+}
+
+static int usbtmc_in_transfer_wait(struct scpi_usbtmc_libusb *uscpi,
+                                   struct usbtmc_in_transfer *t)
+{
+	struct timeval tv;
+	int ret;
+
+	/* The transfer's own timeout terminates this loop. */
+	while (!t->completed) {
+		tv.tv_sec = TRANSFER_TIMEOUT / 1000;
+		tv.tv_usec = 0;
+		ret = libusb_handle_events_timeout_completed(
+			uscpi->ctx->libusb_ctx, &tv, &t->completed);
+		if (ret < 0) {
+			sr_err("USBTMC event handling error: %s.",
+			       libusb_error_name(ret));
+			return SR_ERR;
+		}
+	}
+
+	return SR_OK;
+}
+
+/*
+ * Cancel the transfers in flight, the response being read is kept.
+ * A transfer is only released once it has completed. If waiting for
+ * one fails, it and the ones after it stay pending, so that their slots
+ * and buffers don't get reused while libusb still owns them.
+ */
+static int usbtmc_in_transfers_cancel(struct scpi_usbtmc_libusb *uscpi)
+{
+	struct usbtmc_in_transfer *t;
+	int i;
+
+	for (i = 0; i < uscpi->in_pending; i++) {
+		t = &uscpi->in_transfers[(uscpi->in_head + i) % NUM_IN_TRANSFERS];
+		libusb_cancel_transfer(t->xfer);
+	}
+	while (uscpi->in_pending > 0) {
+		t = &uscpi->in_transfers[uscpi->in_head];
+		if (usbtmc_in_transfer_wait(uscpi, t) != SR_OK)
+			return SR_ERR;
+		uscpi->in_head = (uscpi->in_head + 1) % NUM_IN_TRANSFERS;
+		uscpi->in_pending--;
+		uscpi->in_flight_length -= t->xfer->length;
+	}
+	uscpi->in_flight_length = 0;
+
+	return SR_OK;
+}
+
+static int usbtmc_in_transfer_submit(struct scpi_usbtmc_libusb *uscpi,
+                                     int length)
 {
 	struct sr_usb_dev_inst *usb = uscpi->usb;
-	int ret, transferred, message_size;
+	struct usbtmc_in_transfer *t;
+	int ret;
 
-	ret = libusb_bulk_transfer(usb->devhdl, uscpi->bulk_in_ep, data, size,
-	                           &transferred, TRANSFER_TIMEOUT);
-	if (ret < 0) {
-		sr_err("USBTMC bulk in transfer error: %s.",
+	if (uscpi->in_pending >= NUM_IN_TRANSFERS) {
+		sr_err("USBTMC bulk in transfers still busy.");
+		return SR_ERR;
+	}
+
+	t = &uscpi->in_transfers[(uscpi->in_head + uscpi->in_pending) %
+		NUM_IN_TRANSFERS];
+	/* Allow for 1MB/s at least, USB full-speed devices are slow. */
+	libusb_fill_bulk_transfer(t->xfer, usb->devhdl, uscpi->bulk_in_ep,
+	                          t->buffer, length, usbtmc_in_transfer_cb, t,
+	                          TRANSFER_TIMEOUT + length / 1000);
+	t->completed = 0;
+	if ((ret = libusb_submit_transfer(t->xfer)) < 0) {
+		sr_err("USBTMC bulk in submit error: %s.",
 		       libusb_error_name(ret));
 		return SR_ERR;
 	}
+	uscpi->in_pending++;
+	uscpi->in_flight_length += length;
+
+	return SR_OK;
+}
+
+/*
+ * Keep transfers in flight for the not yet requested part of the
+ * message. One slot stays reserved for the response being read.
+ */
+static int usbtmc_in_transfers_fill(struct scpi_usbtmc_libusb *uscpi)
+{
+	int packet, length;
+
+	packet = uscpi->bulk_in_max_packet ? uscpi->bulk_in_max_packet : 512;
+	while (uscpi->in_pending < NUM_IN_TRANSFERS - 1 &&
+	       uscpi->remaining_length > uscpi->in_flight_length) {
+		length = uscpi->remaining_length - uscpi->in_flight_length;
+		/* The last transfer also takes the alignment bytes. */
+		if (length <= IN_TRANSFER_SIZE)
+			length += 3;
+		else
+			length = IN_TRANSFER_SIZE;
+		length = (length + packet - 1) / packet * packet;
+		if (usbtmc_in_transfer_submit(uscpi, length) != SR_OK)
+			return SR_ERR;
+	}
+
+	return SR_OK;
+}
+
+/* Wait for the oldest transfer in flight, and make it the response. */
+static int usbtmc_in_transfer_next(struct scpi_usbtmc_libusb *uscpi,
+                                   int *transferred)
+{
+	struct usbtmc_in_transfer *t;
+	int status;
+
+	if (!uscpi->in_pending)
+		return SR_ERR;
+
+	t = &uscpi->in_transfers[uscpi->in_head];
+	if (usbtmc_in_transfer_wait(uscpi, t) != SR_OK) {
+		usbtmc_in_transfers_cancel(uscpi);
+		return SR_ERR;
+	}
+	uscpi->in_head = (uscpi->in_head + 1) % NUM_IN_TRANSFERS;
+	uscpi->in_pending--;
+	uscpi->in_flight_length -= t->xfer->length;
+
+	status = t->xfer->status;
+	if (status != LIBUSB_TRANSFER_COMPLETED) {
+		sr_err("USBTMC bulk in transfer error: %s.",
+		       libusb_error_name(status == LIBUSB_TRANSFER_TIMED_OUT ?
+		       LIBUSB_ERROR_TIMEOUT : LIBUSB_ERROR_IO));
+		usbtmc_in_transfers_cancel(uscpi);
+		return SR_ERR;
+	}
 
-	if (usbtmc_bulk_in_header_read(data, msg_id, uscpi->bTag, &message_size,
-	                               transfer_attributes) != SR_OK) {
+	uscpi->response = t->buffer;
+	*transferred = t->xfer->actual_length;
+
+	return SR_OK;
+}
+
+static int scpi_usbtmc_bulkin_start(struct scpi_usbtmc_libusb *uscpi,
+                                    uint8_t msg_id,
+                                    uint8_t *transfer_attributes)
+{
+	int transferred, message_size;
+
+	if (usbtmc_in_transfer_submit(uscpi, IN_TRANSFER_SIZE) != SR_OK)
+		return SR_ERR;
+	if (usbtmc_in_transfer_next(uscpi, &transferred) != SR_OK)
+		return SR_ERR;
+
+	if (usbtmc_bulk_in_header_read(uscpi->response, msg_id, uscpi->bTag,
+	                               &message_size, transfer_attributes) != SR_OK) {
 		sr_err("USBTMC invalid bulk in header.");
 		return SR_ERR;
 	}
@@ -531,27 +739,41 @@ static int scpi_usbtmc_bulkin_start(struct scpi_usbtmc_libusb *uscpi,
 	uscpi->response_bytes_read = USBTMC_BULK_HEADER_SIZE;
 	uscpi->remaining_length = message_size - uscpi->response_length;
 
+	/* Have the rest of a large message streamed in meanwhile. */
+	if (usbtmc_in_transfers_fill(uscpi) != SR_OK) {
+		usbtmc_in_transfers_cancel(uscpi);
+		return SR_ERR;
+	}
+
 	return transferred - USBTMC_BULK_HEADER_SIZE;
 }
 
-static int scpi_usbtmc_bulkin_continue(struct scpi_usbtmc_libusb *uscpi,
-                                       void *data, int size)
+static int scpi_usbtmc_bulkin_continue(struct scpi_usbtmc_libusb *uscpi)
 {
-	struct sr_usb_dev_inst *usb = uscpi->usb;
-	int ret, transferred;
+	int transferred;
 
-	ret = libusb_bulk_transfer(usb->devhdl, uscpi->bulk_in_ep, data, size,
-	                           &transferred, TRANSFER_TIMEOUT);
-	if (ret < 0) {
-		sr_err("USBTMC bulk in transfer error: %s.",
-		       libusb_error_name(ret));
+	if (usbtmc_in_transfers_fill(uscpi) != SR_OK) {
+		usbtmc_in_transfers_cancel(uscpi);
 		return SR_ERR;
 	}
+	if (usbtmc_in_transfer_next(uscpi, &transferred) != SR_OK)
+		return SR_ERR;
 
 	uscpi->response_length = MIN(transferred, uscpi->remaining_length);
 	uscpi->response_bytes_read = 0;
 	uscpi->remaining_length -= uscpi->response_length;
 
+	/*
+	 * Top up the transfers in flight. Transfers which were submitted
+	 * for more data than the device eventually sent are not needed.
+	 */
+	if (uscpi->remaining_length <= 0)
+		usbtmc_in_transfers_cancel(uscpi);
+	else if (usbtmc_in_transfers_fill(uscpi) != SR_OK) {
+		usbtmc_in_transfers_cancel(uscpi);
+		return SR_ERR;
+	}
+
 	return transferred;
 }
 
@@ -572,13 +794,21 @@ static int scpi_usbtmc_libusb_read_begin(void *priv)
 {
 	struct scpi_usbtmc_libusb *uscpi = priv;
 
+	if (usbtmc_in_transfers_cancel(uscpi) != SR_OK)
+		return SR_ERR;
 	uscpi->remaining_length = 0;
+	uscpi->response_length = 0;
+	uscpi->response_bytes_read = 0;
+
+	if (usbtmc_in_transfers_alloc(uscpi) != SR_OK) {
+		sr_err("USBTMC bulk in transfers allocation failed.");
+		return SR_ERR_MALLOC;
+	}
 
 	if (scpi_usbtmc_bulkout(uscpi, REQUEST_DEV_DEP_MSG_IN,
 	    NULL, INT32_MAX, 0) < 0)
 		return SR_ERR;
 	if (scpi_usbtmc_bulkin_start(uscpi, DEV_DEP_MSG_IN,
-	                             uscpi->buffer, sizeof(uscpi->buffer),
 	                             &uscpi->bulkin_attributes) < 0)
 		return SR_ERR;
 
@@ -592,8 +822,7 @@ static int scpi_usbtmc_libusb_read_data(void *priv, char *buf, int maxlen)
 
 	if (uscpi->response_bytes_read >= uscpi->response_length) {
 		if (uscpi->remaining_length > 0) {
-			if (scpi_usbtmc_bulkin_continue(uscpi, uscpi->buffer,
-			                                sizeof(uscpi->buffer)) <= 0)
+			if (scpi_usbtmc_bulkin_continue(uscpi) <= 0)
 				return SR_ERR;
 		} else {
 			if (uscpi->bulkin_attributes & EOM)
@@ -605,7 +834,7 @@ static int scpi_usbtmc_libusb_read_data(void *priv, char *buf, int maxlen)
 
 	read_length = MIN(uscpi->response_length - uscpi->response_bytes_read, maxlen);
 
-	memcpy(buf, uscpi->buffer + uscpi->response_bytes_read, read_length);
+	memcpy(buf, uscpi->response + uscpi->response_bytes_read, read_length);
 
 	uscpi->response_bytes_read += read_length;
 
@@ -629,6 +858,9 @@ static int scpi_usbtmc_libusb_close(struct sr_scpi_dev_inst *scpi)
 	if (!usb->devhdl)
 		return SR_ERR;
 
+	usbtmc_in_transfers_cancel(uscpi);
+	usbtmc_in_transfers_free(uscpi);
+
 	scpi_usbtmc_local(uscpi);
 
 	if ((ret = libusb_release_interface(usb->devhdl, uscpi->interface)) < 0)
@@ -715,11 +715,8 @@ SR_PRIV int serial_stream_detect(struct sr_serial_dev_inst *serial,
 		time /= 1000;
 
 		if ((ibuf - i) >= packet_size) {
-			GString *text;
 			/* We have at least a packet's worth of data. */
-			text = sr_hexdump_new(&buf[i], packet_size);
-			sr_spew("Trying packet: %s", text->str);
-			sr_hexdump_free(text);
+			sr_spew_hexdump("Trying packet:", &buf[i], packet_size);
 			if (is_valid(&buf[i])) {
 				sr_spew("Found valid %zu-byte packet after "
 					"%" PRIu64 "ms.", (ibuf - i), time);
@@ -748,6 +745,190 @@ SR_PRIV int serial_stream_detect(struct sr_serial_dev_inst *serial,
 	return SR_ERR;
 }
 
+/**
+ * Initialize a non-blocking request/response transaction.
+ *
+ * A transaction sends a request and collects its reply without ever
+ * blocking, so that one thread can serve many instruments. It keeps its
+ * own deadline and retry count, and enforces a minimum gap between two
+ * requests for devices which need time to process a command.
+ *
+ * @param txn The transaction to initialize.
+ * @param serial Previously initialized serial port structure.
+ * @param[in] timeout_ms Time to wait for a complete reply.
+ * @param[in] retries How often to resend a request which timed out.
+ * @param[in] gap_ms Minimum time between sending two requests.
+ *
+ * @private
+ */
+SR_PRIV void serial_txn_init(struct serial_txn *txn,
+		struct sr_serial_dev_inst *serial, unsigned int timeout_ms,
+		unsigned int retries, unsigned int gap_ms)
+{
+	memset(txn, 0, sizeof(*txn));
+	txn->serial = serial;
+	txn->state = SERIAL_TXN_IDLE;
+	txn->timeout_ms = timeout_ms;
+	txn->retries = retries;
+	txn->gap_ms = gap_ms;
+}
+
+/**
+ * Queue a request. It is sent by serial_txn_poll() once the gap since
+ * the previous request has passed.
+ *
+ * @param txn Previously initialized, idle transaction.
+ * @param[in] request The bytes to send.
+ * @param[in] request_len Number of bytes to send.
+ * @param[in] reply_size Length of the reply, 0 if there is none.
+ * @param reply_len_cb Optional callback which determines the reply length
+ *                     from the bytes received so far, overrides reply_size.
+ * @param cb_data Opaque pointer passed to reply_len_cb.
+ *
+ * @retval SR_OK Success.
+ * @retval SR_ERR_ARG Invalid argument, or a transaction is still pending.
+ *
+ * @private
+ */
+SR_PRIV int serial_txn_start(struct serial_txn *txn, const void *request,
+		size_t request_len, size_t reply_size,
+		serial_txn_reply_len_callback reply_len_cb, void *cb_data)
+{
+	if (!txn || txn->state != SERIAL_TXN_IDLE
+			|| request_len > sizeof(txn->request)
+			|| reply_size > sizeof(txn->reply))
+		return SR_ERR_ARG;
+
+	memcpy(txn->request, request, request_len);
+	txn->request_len = request_len;
+	txn->request_sent = 0;
+	txn->reply_len = 0;
+	txn->reply_size = reply_size;
+	txn->reply_len_cb = reply_len_cb;
+	txn->cb_data = cb_data;
+	txn->attempt = 0;
+	txn->state = SERIAL_TXN_QUEUED;
+
+	return SR_OK;
+}
+
+static size_t serial_txn_reply_len(const struct serial_txn *txn)
+{
+	size_t len;
+
+	len = txn->reply_size;
+	if (txn->reply_len_cb)
+		len = txn->reply_len_cb(txn->reply, txn->reply_len, txn->cb_data);
+
+	return MIN(len, sizeof(txn->reply));
+}
+
+/**
+ * Advance a transaction as far as possible without blocking.
+ *
+ * Call this from the receive callback on data and on timeouts alike.
+ * Upon completion the reply is in txn->reply, txn->reply_len bytes long.
+ *
+ * @param txn The transaction to advance.
+ * @param[out] status The result once the transaction finished: SR_OK,
+ *                    SR_ERR_TIMEOUT when all retries timed out, or
+ *                    another error code from the serial port.
+ *
+ * @return TRUE if the transaction finished, FALSE if it is still pending.
+ *
+ * @private
+ */
+SR_PRIV gboolean serial_txn_poll(struct serial_txn *txn, int *status)
+{
+	int64_t now;
+	size_t need;
+	int ret;
+
+	now = g_get_monotonic_time();
+
+	if (txn->state == SERIAL_TXN_IDLE) {
+		*status = SR_ERR_ARG;
+		return TRUE;
+	}
+
+	if (txn->state == SERIAL_TXN_QUEUED) {
+		if (now < txn->next_at)
+			return FALSE;
+		ret = serial_write_nonblocking(txn->serial,
+			txn->request + txn->request_sent,
+			txn->request_len - txn->request_sent);
+		if (ret < 0)
+			goto done;
+		txn->request_sent += ret;
+		if (txn->request_sent < txn->request_len)
+			return FALSE;
+		txn->next_at = now + txn->gap_ms * 1000;
+		txn->deadline = now + txn->timeout_ms * 1000;
+		txn->state = SERIAL_TXN_WAIT;
+	}
+
+	need = serial_txn_reply_len(txn);
+	while (txn->reply_len < need) {
+		ret = serial_read_nonblocking(txn->serial,
+			txn->reply + txn->reply_len, need - txn->reply_len);
+		if (ret < 0)
+			goto done;
+		if (ret == 0)
+			break;
+		txn->reply_len += ret;
+		need = serial_txn_reply_len(txn);
+	}
+	if (txn->reply_len >= need) {
+		ret = SR_OK;
+		goto done;
+	}
+
+	if (now < txn->deadline)
+		return FALSE;
+
+	if (txn->attempt < txn->retries) {
+		txn->attempt++;
+		sr_dbg("No reply from %s after %ums, retry %u/%u.",
+			txn->serial->port, txn->timeout_ms, txn->attempt,
+			txn->retries);
+		serial_flush(txn->serial);
+		txn->request_sent = 0;
+		txn->reply_len = 0;
+		txn->state = SERIAL_TXN_QUEUED;
+		return FALSE;
+	}
+	sr_dbg("No reply from %s, giving up.", txn->serial->port);
+	ret = SR_ERR_TIMEOUT;
+
+done:
+	txn->state = SERIAL_TXN_IDLE;
+	*status = ret;
+
+	return TRUE;
+}
+
+/**
+ * Run a transaction to completion, blocking the caller.
+ *
+ * For use outside of the session's receive callbacks only, e.g. from
+ * config_get() and config_set().
+ *
+ * @param txn The transaction to finish.
+ *
+ * @return The status of the finished transaction, see serial_txn_poll().
+ *
+ * @private
+ */
+SR_PRIV int serial_txn_wait(struct serial_txn *txn)
+{
+	int status;
+
+	while (!serial_txn_poll(txn, &status))
+		g_usleep(1000);
+
+	return status;
+}
+
 /**
  * Extract the serial device and options from the options linked list.
  *
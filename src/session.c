@@ -504,6 +504,36 @@ SR_API int sr_session_datafeed_callback_add(struct sr_session *session,
 	return SR_OK;
 }
 
+/**
+ * Set whether the datafeed callbacks of a session accept run-length
+ * encoded logic data.
+ *
+ * When enabled, SR_DF_LOGIC_RLE packets are passed to the datafeed
+ * callbacks as-is. Otherwise (the default) they are expanded into
+ * SR_DF_LOGIC packets first, so that existing callbacks keep working.
+ *
+ * SR_DF_LOGIC_RLE packets are always expanded if the session has
+ * transform modules.
+ *
+ * @param session The session to use. Must not be NULL.
+ * @param enable TRUE to pass SR_DF_LOGIC_RLE packets to the callbacks.
+ *
+ * @retval SR_OK Success.
+ * @retval SR_ERR_ARG Invalid session passed.
+ *
+ * @since 0.6.0
+ */
+SR_API int sr_session_logic_rle_set(struct sr_session *session,
+		gboolean enable)
+{
+	if (!session)
+		return SR_ERR_ARG;
+
+	session->logic_rle = enable;
+
+	return SR_OK;
+}
+
 /**
  * Get the trigger assigned to this session.
  *
@@ -1033,6 +1063,7 @@ SR_API int sr_session_stopped_callback_set(struct sr_session *session,
 static void datafeed_dump(const struct sr_datafeed_packet *packet)
 {
 	const struct sr_datafeed_logic *logic;
+	const struct sr_datafeed_logic_rle *rle;
 	const struct sr_datafeed_analog *analog;
 
 	/* Please use the same order as in libsigrok.h. */
@@ -1065,12 +1096,23 @@ static void datafeed_dump(const struct sr_datafeed_packet *packet)
 		sr_dbg("bus: Received SR_DF_ANALOG packet (%d samples).",
 		       analog->num_samples);
 		break;
+	case SR_DF_LOGIC_RLE:
+		rle = packet->payload;
+		sr_dbg("bus: Received SR_DF_LOGIC_RLE packet (%" PRIu64 " runs, "
+		       "unitsize = %d).", rle->num_runs, rle->unitsize);
+		break;
 	default:
 		sr_dbg("bus: Received unknown packet type: %d.", packet->type);
 		break;
 	}
 }
 
+static int send_expanded(const struct sr_datafeed_packet *packet,
+		void *cb_data)
+{
+	return sr_session_send(cb_data, packet);
+}
+
 /**
  * Send a packet to whatever is listening on the datafeed bus.
  *
@@ -1108,6 +1150,13 @@ SR_PRIV int sr_session_send(const struct sr_dev_inst *sdi,
 		return SR_ERR_BUG;
 	}
 
+	if (packet->type == SR_DF_LOGIC_RLE && (!sdi->session->logic_rle
+			|| sdi->session->transforms)) {
+		/* The listeners can't handle run-length encoded data. */
+		return sr_logic_rle_expand_packets(packet->payload,
+			send_expanded, (void *)sdi);
+	}
+
 	/*
 	 * Pass the packet to the first transform module. If that returns
 	 * another packet (instead of NULL), pass that packet to the next
@@ -1457,6 +1506,8 @@ SR_API int sr_packet_copy(const struct sr_datafeed_packet *packet,
 	struct sr_datafeed_meta *meta_copy;
 	const struct sr_datafeed_logic *logic;
 	struct sr_datafeed_logic *logic_copy;
+	const struct sr_datafeed_logic_rle *rle;
+	struct sr_datafeed_logic_rle *rle_copy;
 	const struct sr_datafeed_analog *analog;
 	struct sr_datafeed_analog *analog_copy;
 	uint8_t *payload;
@@ -1467,6 +1518,8 @@ SR_API int sr_packet_copy(const struct sr_datafeed_packet *packet,
 	switch (packet->type) {
 	case SR_DF_TRIGGER:
 	case SR_DF_END:
+	case SR_DF_FRAME_BEGIN:
+	case SR_DF_FRAME_END:
 		/* No payload. */
 		break;
 	case SR_DF_HEADER:
@@ -1487,12 +1540,13 @@ SR_API int sr_packet_copy(const struct sr_datafeed_packet *packet,
 			return SR_ERR;
 		logic_copy->length = logic->length;
 		logic_copy->unitsize = logic->unitsize;
-		logic_copy->data = g_malloc(logic->length * logic->unitsize);
+		/* The logic length is in bytes, not samples. */
+		logic_copy->data = g_malloc(logic->length);
 		if (!logic_copy->data) {
 			g_free(logic_copy);
 			return SR_ERR;
 		}
-		memcpy(logic_copy->data, logic->data, logic->length * logic->unitsize);
+		memcpy(logic_copy->data, logic->data, logic->length);
 		(*copy)->payload = logic_copy;
 		break;
 	case SR_DF_ANALOG:
@@ -1513,6 +1567,17 @@ SR_API int sr_packet_copy(const struct sr_datafeed_packet *packet,
 				sizeof(struct sr_analog_spec));
 		(*copy)->payload = analog_copy;
 		break;
+	case SR_DF_LOGIC_RLE:
+		rle = packet->payload;
+		rle_copy = g_malloc(sizeof(*rle_copy));
+		rle_copy->num_runs = rle->num_runs;
+		rle_copy->unitsize = rle->unitsize;
+		rle_copy->data = g_memdup(rle->data,
+				rle->num_runs * rle->unitsize);
+		rle_copy->lengths = g_memdup(rle->lengths,
+				rle->num_runs * sizeof(uint64_t));
+		(*copy)->payload = rle_copy;
+		break;
 	default:
 		sr_err("Unknown packet type %d", packet->type);
 		return SR_ERR;
@@ -1525,6 +1590,7 @@ SR_API void sr_packet_free(struct sr_datafeed_packet *packet)
 {
 	const struct sr_datafeed_meta *meta;
 	const struct sr_datafeed_logic *logic;
+	const struct sr_datafeed_logic_rle *rle;
 	const struct sr_datafeed_analog *analog;
 	struct sr_config *src;
 	GSList *l;
@@ -1532,6 +1598,8 @@ SR_API void sr_packet_free(struct sr_datafeed_packet *packet)
 	switch (packet->type) {
 	case SR_DF_TRIGGER:
 	case SR_DF_END:
+	case SR_DF_FRAME_BEGIN:
+	case SR_DF_FRAME_END:
 		/* No payload. */
 		break;
 	case SR_DF_HEADER:
@@ -1562,6 +1630,12 @@ SR_API void sr_packet_free(struct sr_datafeed_packet *packet)
 		g_free(analog->spec);
 		g_free((void *)packet->payload);
 		break;
+	case SR_DF_LOGIC_RLE:
+		rle = packet->payload;
+		g_free(rle->data);
+		g_free(rle->lengths);
+		g_free((void *)packet->payload);
+		break;
 	default:
 		sr_err("Unknown packet type %d", packet->type);
 	}
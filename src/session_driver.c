@@ -34,21 +34,69 @@
 #define CHUNKSIZE (4 * 1024 * 1024)
 /** @endcond */
 
+/* Timer period of the realtime mode, also the reader thread's poll period. */
+#define REPLAY_PACE_MS 10
+/* Number of buffers the max-speed reader thread fills ahead. */
+#define REPLAY_NUM_BUFS 4
+/* Return to the main loop after this long in max-speed mode. */
+#define REPLAY_SLICE_MS 100
+
 SR_PRIV struct sr_dev_driver session_driver_info;
 
+enum replay_mode {
+	REPLAY_FREEWHEEL,
+	REPLAY_REALTIME,
+	REPLAY_MAX_SPEED,
+};
+
+static const char *replay_modes[] = {
+	[REPLAY_FREEWHEEL] = "freewheel",
+	[REPLAY_REALTIME] = "realtime",
+	[REPLAY_MAX_SPEED] = "max-speed",
+};
+
+/* One (possibly chunked) capture file in the session archive. */
+struct capture_stream {
+	/* Always the unchunked base name. */
+	char *name;
+	struct zip_file *file;
+	/* 0: nothing opened yet, -1: unchunked file, else current chunk. */
+	int cur_chunk;
+	gboolean done;
+};
+
+/* The samples of all streams for one range of sample indices. */
+struct replay_buf {
+	uint8_t *logic;
+	size_t logic_len;
+	float *analog;
+	size_t *analog_len;
+	gboolean last;
+};
+
 struct session_vdev {
 	char *sessionfile;
 	char *capturefile;
 	struct zip *archive;
-	struct zip_file *capfile;
-	int bytes_read;
 	uint64_t samplerate;
 	int unitsize;
 	int num_logic_channels;
 	int num_analog_channels;
-	int cur_analog_channel;
 	GArray *analog_channels;
-	int cur_chunk;
+	enum replay_mode mode;
+	enum replay_mode run_mode;
+	struct capture_stream logic_stream;
+	struct capture_stream *analog_streams;
+	uint64_t round_samples;
+	struct replay_buf *bufs;
+	int num_bufs;
+	GThread *reader;
+	GAsyncQueue *free_queue;
+	GAsyncQueue *full_queue;
+	gint stop;
+	gint64 start_time;
+	uint64_t samples_sent;
+	uint64_t bytes_sent;
 	gboolean finished;
 };
 
@@ -59,9 +107,102 @@ static const uint32_t devopts[] = {
 	SR_CONF_NUM_ANALOG_CHANNELS | SR_CONF_SET,
 	SR_CONF_SAMPLERATE | SR_CONF_GET | SR_CONF_SET,
 	SR_CONF_SESSIONFILE | SR_CONF_SET,
+	SR_CONF_SESSION_REPLAY | SR_CONF_GET | SR_CONF_SET | SR_CONF_LIST,
 };
 
-static gboolean stream_session_data(struct sr_dev_inst *sdi)
+/* Open the next file of a capture stream, FALSE past the last one. */
+static gboolean stream_open_next(struct zip *archive, struct capture_stream *s)
+{
+	struct zip_stat zs;
+	char name[128];
+
+	if (s->cur_chunk == 0 && zip_stat(archive, s->name, 0, &zs) != -1) {
+		/* No chunks, just a single capture file. */
+		g_strlcpy(name, s->name, sizeof(name));
+		s->cur_chunk = -1;
+	} else if (s->cur_chunk >= 0) {
+		snprintf(name, sizeof(name), "%s-%d", s->name, ++s->cur_chunk);
+		if (zip_stat(archive, name, 0, &zs) == -1) {
+			if (s->cur_chunk == 1)
+				sr_err("No capture file '%s' in session file.",
+					s->name);
+			return FALSE;
+		}
+	} else {
+		return FALSE;
+	}
+
+	if (!(s->file = zip_fopen(archive, name, 0))) {
+		sr_err("Failed to open capture file '%s'.", name);
+		return FALSE;
+	}
+	sr_dbg("Opened %s.", name);
+
+	return TRUE;
+}
+
+/* Fill up to len bytes from a capture stream, across chunk boundaries. */
+static size_t stream_read(struct zip *archive, struct capture_stream *s,
+		void *buf, size_t len)
+{
+	zip_int64_t ret;
+	size_t count;
+
+	count = 0;
+	while (!s->done && count < len) {
+		if (!s->file && !stream_open_next(archive, s)) {
+			s->done = TRUE;
+			break;
+		}
+		ret = zip_fread(s->file, (uint8_t *)buf + count, len - count);
+		if (ret > 0) {
+			count += ret;
+			continue;
+		}
+		if (ret < 0)
+			sr_err("Failed to read from capture file '%s'.", s->name);
+		/* Done with this capture file. */
+		zip_fclose(s->file);
+		s->file = NULL;
+	}
+
+	return count;
+}
+
+static void stream_close(struct capture_stream *s)
+{
+	if (s->file)
+		zip_fclose(s->file);
+	s->file = NULL;
+}
+
+/*
+ * Read the next range of sample indices from all capture streams, so
+ * that logic and analog data get sent interleaved.
+ */
+static void read_round(struct session_vdev *vdev, struct replay_buf *b)
+{
+	unsigned int i;
+
+	b->last = TRUE;
+	b->logic_len = 0;
+	if (vdev->logic_stream.name) {
+		b->logic_len = stream_read(vdev->archive, &vdev->logic_stream,
+			b->logic, vdev->round_samples * vdev->unitsize);
+		if (b->logic_len)
+			b->last = FALSE;
+	}
+	for (i = 0; i < vdev->analog_channels->len; i++) {
+		b->analog_len[i] = stream_read(vdev->archive,
+			&vdev->analog_streams[i],
+			b->analog + i * vdev->round_samples,
+			vdev->round_samples * sizeof(float)) / sizeof(float);
+		if (b->analog_len[i])
+			b->last = FALSE;
+	}
+}
+
+static void send_round(const struct sr_dev_inst *sdi, struct replay_buf *b)
 {
 	struct session_vdev *vdev;
 	struct sr_datafeed_packet packet;
@@ -70,140 +211,257 @@ static gboolean stream_session_data(struct sr_dev_inst *sdi)
 	struct sr_analog_encoding encoding;
 	struct sr_analog_meaning meaning;
 	struct sr_analog_spec spec;
-	struct zip_stat zs;
-	int ret, got_data;
-	char capturefile[128];
-	void *buf;
+	uint64_t samples;
+	unsigned int i;
 
-	got_data = FALSE;
 	vdev = sdi->priv;
+	samples = 0;
+
+	if (b->logic_len) {
+		if (b->logic_len % vdev->unitsize != 0)
+			sr_warn("Read size %zu not a multiple of the"
+				" unit size %d.", b->logic_len, vdev->unitsize);
+		packet.type = SR_DF_LOGIC;
+		packet.payload = &logic;
+		logic.length = b->logic_len;
+		logic.unitsize = vdev->unitsize;
+		logic.data = b->logic;
+		sr_session_send(sdi, &packet);
+		samples = b->logic_len / vdev->unitsize;
+		vdev->bytes_sent += b->logic_len;
+	}
 
-	if (!vdev->capfile) {
-		/* No capture file opened yet, or finished with the last
-		 * chunked one. */
-		if (vdev->capturefile && (vdev->cur_chunk == 0)) {
-			/* capturefile is always the unchunked base name. */
-			if (zip_stat(vdev->archive, vdev->capturefile, 0, &zs) != -1) {
-				/* No chunks, just a single capture file. */
-				vdev->cur_chunk = 0;
-				if (!(vdev->capfile = zip_fopen(vdev->archive,
-						vdev->capturefile, 0)))
-					return FALSE;
-				sr_dbg("Opened %s.", vdev->capturefile);
-			} else {
-				/* Try as first chunk filename. */
-				snprintf(capturefile, sizeof(capturefile) - 1, "%s-1", vdev->capturefile);
-				if (zip_stat(vdev->archive, capturefile, 0, &zs) != -1) {
-					vdev->cur_chunk = 1;
-					if (!(vdev->capfile = zip_fopen(vdev->archive,
-							capturefile, 0)))
-						return FALSE;
-					sr_dbg("Opened %s.", capturefile);
-				} else {
-					sr_err("No capture file '%s' in " "session file '%s'.",
-							vdev->capturefile, vdev->sessionfile);
-					return FALSE;
-				}
-			}
-		} else {
-			/* Capture data is chunked, advance to the next chunk. */
-			vdev->cur_chunk++;
-			snprintf(capturefile, sizeof(capturefile) - 1, "%s-%d", vdev->capturefile,
-					vdev->cur_chunk);
-			if (zip_stat(vdev->archive, capturefile, 0, &zs) != -1) {
-				if (!(vdev->capfile = zip_fopen(vdev->archive,
-						capturefile, 0)))
-					return FALSE;
-				sr_dbg("Opened %s.", capturefile);
-			} else if (vdev->cur_analog_channel < vdev->num_analog_channels) {
-				vdev->capturefile = g_strdup_printf("analog-1-%d",
-						vdev->num_logic_channels + vdev->cur_analog_channel + 1);
-				vdev->cur_analog_channel++;
-				vdev->cur_chunk = 0;
-				return TRUE;
-			} else {
-				/* We got all the chunks, finish up. */
-				g_free(vdev->capturefile);
-
-				/* If the file has logic channels, the initial value for
-				 * capturefile is set by stream_session_data() - however only
-				 * once. In order to not mess this mechanism up, we simulate
-				 * this here if needed. For purely analog files, capturefile
-				 * is not set.
-				 */
-				if (vdev->num_logic_channels)
-					vdev->capturefile = g_strdup("logic-1");
-				else
-					vdev->capturefile = NULL;
-				return FALSE;
-			}
-		}
+	for (i = 0; i < vdev->analog_channels->len; i++) {
+		if (!b->analog_len[i])
+			continue;
+		packet.type = SR_DF_ANALOG;
+		packet.payload = &analog;
+		/* TODO: Use proper 'digits' value for this device (and its modes). */
+		sr_analog_init(&analog, &encoding, &meaning, &spec, 2);
+		analog.meaning->channels = g_slist_prepend(NULL,
+				g_array_index(vdev->analog_channels,
+					struct sr_channel *, i));
+		analog.num_samples = b->analog_len[i];
+		analog.meaning->mq = SR_MQ_VOLTAGE;
+		analog.meaning->unit = SR_UNIT_VOLT;
+		analog.meaning->mqflags = SR_MQFLAG_DC;
+		analog.data = b->analog + i * vdev->round_samples;
+		sr_session_send(sdi, &packet);
+		g_slist_free(analog.meaning->channels);
+		samples = MAX(samples, b->analog_len[i]);
+		vdev->bytes_sent += b->analog_len[i] * sizeof(float);
+	}
+
+	vdev->samples_sent += samples;
+}
+
+/* Synchronously read and send one round, FALSE when all data was sent. */
+static gboolean replay_round(const struct sr_dev_inst *sdi)
+{
+	struct session_vdev *vdev;
+
+	vdev = sdi->priv;
+	read_round(vdev, &vdev->bufs[0]);
+	if (vdev->bufs[0].last)
+		return FALSE;
+	send_round(sdi, &vdev->bufs[0]);
+
+	return TRUE;
+}
+
+/* Send as many samples as the original samplerate allows by now. */
+static gboolean replay_paced(const struct sr_dev_inst *sdi)
+{
+	struct session_vdev *vdev;
+	uint64_t elapsed, due;
+
+	vdev = sdi->priv;
+	elapsed = g_get_monotonic_time() - vdev->start_time;
+	due = elapsed / G_USEC_PER_SEC * vdev->samplerate +
+		elapsed % G_USEC_PER_SEC * vdev->samplerate / G_USEC_PER_SEC;
+	while (vdev->samples_sent < due) {
+		if (!replay_round(sdi))
+			return FALSE;
+	}
+
+	return TRUE;
+}
+
+static gpointer replay_reader_thread(gpointer data)
+{
+	struct session_vdev *vdev;
+	struct replay_buf *b;
+
+	vdev = data;
+	while (!g_atomic_int_get(&vdev->stop)) {
+		b = g_async_queue_timeout_pop(vdev->free_queue,
+			REPLAY_PACE_MS * 1000);
+		if (!b)
+			continue;
+		read_round(vdev, b);
+		g_async_queue_push(vdev->full_queue, b);
+		if (b->last)
+			break;
 	}
 
-	buf = g_malloc(CHUNKSIZE);
+	return NULL;
+}
+
+/* Send what the reader thread has read ahead, for one time slice. */
+static gboolean replay_queued(const struct sr_dev_inst *sdi)
+{
+	struct session_vdev *vdev;
+	struct replay_buf *b;
+	gint64 deadline;
+
+	vdev = sdi->priv;
+	deadline = g_get_monotonic_time() + REPLAY_SLICE_MS * 1000;
+	do {
+		b = g_async_queue_timeout_pop(vdev->full_queue,
+			REPLAY_PACE_MS * 1000);
+		if (!b)
+			return TRUE;
+		if (b->last)
+			return FALSE;
+		send_round(sdi, b);
+		g_async_queue_push(vdev->free_queue, b);
+	} while (g_get_monotonic_time() < deadline);
+
+	return TRUE;
+}
+
+static int replay_start(struct session_vdev *vdev)
+{
+	size_t sample_size;
+	unsigned int i;
+	int n;
+
+	vdev->run_mode = vdev->mode;
+	if (vdev->run_mode == REPLAY_REALTIME && !vdev->samplerate) {
+		sr_warn("Unknown samplerate, cannot replay in realtime.");
+		vdev->run_mode = REPLAY_FREEWHEEL;
+	}
 
 	/* unitsize is not defined for purely analog session files. */
-	if (vdev->unitsize)
-		ret = zip_fread(vdev->capfile, buf,
-				CHUNKSIZE / vdev->unitsize * vdev->unitsize);
-	else
-		ret = zip_fread(vdev->capfile, buf, CHUNKSIZE);
-
-	if (ret > 0) {
-		if (vdev->cur_analog_channel != 0) {
-			got_data = TRUE;
-			packet.type = SR_DF_ANALOG;
-			packet.payload = &analog;
-			/* TODO: Use proper 'digits' value for this device (and its modes). */
-			sr_analog_init(&analog, &encoding, &meaning, &spec, 2);
-			analog.meaning->channels = g_slist_prepend(NULL,
-					g_array_index(vdev->analog_channels,
-						struct sr_channel *, vdev->cur_analog_channel - 1));
-			analog.num_samples = ret / sizeof(float);
-			analog.meaning->mq = SR_MQ_VOLTAGE;
-			analog.meaning->unit = SR_UNIT_VOLT;
-			analog.meaning->mqflags = SR_MQFLAG_DC;
-			analog.data = (float *) buf;
-		} else if (vdev->unitsize) {
-			got_data = TRUE;
-			if (ret % vdev->unitsize != 0)
-				sr_warn("Read size %d not a multiple of the"
-					" unit size %d.", ret, vdev->unitsize);
-			packet.type = SR_DF_LOGIC;
-			packet.payload = &logic;
-			logic.length = ret;
-			logic.unitsize = vdev->unitsize;
-			logic.data = buf;
-		} else {
-			/*
-			 * Neither analog data, nor logic which has
-			 * unitsize, must be an unexpected API use.
-			 */
-			sr_warn("Neither analog nor logic data. Ignoring.");
-		}
-		if (got_data) {
-			vdev->bytes_read += ret;
-			sr_session_send(sdi, &packet);
-		}
-	} else {
-		/* done with this capture file */
-		zip_fclose(vdev->capfile);
-		vdev->capfile = NULL;
-		if (vdev->cur_chunk != 0) {
-			/* There might be more chunks, so don't fall through
-			 * to the SR_DF_END here. */
-			got_data = TRUE;
+	sample_size = 0;
+	if (vdev->capturefile && vdev->unitsize) {
+		vdev->logic_stream.name = g_strdup(vdev->capturefile);
+		sample_size += vdev->unitsize;
+	}
+	vdev->analog_streams = g_malloc0(vdev->analog_channels->len *
+		sizeof(*vdev->analog_streams));
+	for (i = 0; i < vdev->analog_channels->len; i++) {
+		vdev->analog_streams[i].name = g_strdup_printf("analog-1-%d",
+			vdev->num_logic_channels + i + 1);
+		sample_size += sizeof(float);
+	}
+	if (!sample_size) {
+		sr_err("Neither analog nor logic data in session file.");
+		return SR_ERR;
+	}
+
+	vdev->round_samples = MAX(CHUNKSIZE / sample_size, 1);
+	if (vdev->run_mode == REPLAY_REALTIME)
+		vdev->round_samples = CLAMP(vdev->samplerate *
+			REPLAY_PACE_MS / 1000, 1, vdev->round_samples);
+
+	vdev->num_bufs = vdev->run_mode == REPLAY_MAX_SPEED ? REPLAY_NUM_BUFS : 1;
+	vdev->bufs = g_malloc0(vdev->num_bufs * sizeof(*vdev->bufs));
+	for (n = 0; n < vdev->num_bufs; n++) {
+		if (vdev->logic_stream.name)
+			vdev->bufs[n].logic = g_malloc(vdev->round_samples *
+				vdev->unitsize);
+		vdev->bufs[n].analog = g_malloc(vdev->analog_channels->len *
+			vdev->round_samples * sizeof(float));
+		vdev->bufs[n].analog_len = g_malloc0(vdev->analog_channels->len *
+			sizeof(size_t));
+	}
+
+	vdev->samples_sent = 0;
+	vdev->bytes_sent = 0;
+	vdev->start_time = g_get_monotonic_time();
+
+	if (vdev->run_mode != REPLAY_MAX_SPEED)
+		return SR_OK;
+
+	vdev->free_queue = g_async_queue_new();
+	vdev->full_queue = g_async_queue_new();
+	for (n = 0; n < vdev->num_bufs; n++)
+		g_async_queue_push(vdev->free_queue, &vdev->bufs[n]);
+	g_atomic_int_set(&vdev->stop, 0);
+	vdev->reader = g_thread_try_new("session-reader",
+		replay_reader_thread, vdev, NULL);
+	if (!vdev->reader) {
+		sr_warn("Cannot start reader thread, replaying freewheeling.");
+		vdev->run_mode = REPLAY_FREEWHEEL;
+	}
+
+	return SR_OK;
+}
+
+static void replay_stop(struct session_vdev *vdev)
+{
+	unsigned int i;
+	double secs;
+	int n;
+
+	if (vdev->reader) {
+		g_atomic_int_set(&vdev->stop, 1);
+		g_thread_join(vdev->reader);
+		vdev->reader = NULL;
+	}
+	if (vdev->free_queue) {
+		g_async_queue_unref(vdev->free_queue);
+		vdev->free_queue = NULL;
+	}
+	if (vdev->full_queue) {
+		g_async_queue_unref(vdev->full_queue);
+		vdev->full_queue = NULL;
+	}
+
+	secs = (g_get_monotonic_time() - vdev->start_time) / (double)G_USEC_PER_SEC;
+	if (vdev->bufs && secs > 0)
+		sr_info("Replayed %" PRIu64 " samples (%" PRIu64 " bytes) "
+			"in %.3f s: %.0f samples/s (%.1f%% of samplerate), "
+			"%.1f MB/s.", vdev->samples_sent, vdev->bytes_sent,
+			secs, vdev->samples_sent / secs,
+			vdev->samplerate ? 100.0 * vdev->samples_sent /
+			secs / vdev->samplerate : 0.0,
+			vdev->bytes_sent / secs / 1e6);
+
+	stream_close(&vdev->logic_stream);
+	g_free(vdev->logic_stream.name);
+	memset(&vdev->logic_stream, 0, sizeof(vdev->logic_stream));
+	if (vdev->analog_streams) {
+		for (i = 0; i < vdev->analog_channels->len; i++) {
+			stream_close(&vdev->analog_streams[i]);
+			g_free(vdev->analog_streams[i].name);
 		}
+		g_free(vdev->analog_streams);
+		vdev->analog_streams = NULL;
 	}
-	g_free(buf);
+	for (n = 0; n < vdev->num_bufs; n++) {
+		g_free(vdev->bufs[n].logic);
+		g_free(vdev->bufs[n].analog);
+		g_free(vdev->bufs[n].analog_len);
+	}
+	g_free(vdev->bufs);
+	vdev->bufs = NULL;
+	vdev->num_bufs = 0;
+	g_array_free(vdev->analog_channels, TRUE);
+	vdev->analog_channels = NULL;
 
-	return got_data;
+	if (vdev->archive) {
+		zip_discard(vdev->archive);
+		vdev->archive = NULL;
+	}
 }
 
 static int receive_data(int fd, int revents, void *cb_data)
 {
 	struct sr_dev_inst *sdi;
 	struct session_vdev *vdev;
+	gboolean more;
 
 	(void)fd;
 	(void)revents;
@@ -211,20 +469,20 @@ static int receive_data(int fd, int revents, void *cb_data)
 	sdi = cb_data;
 	vdev = sdi->priv;
 
-	if (!vdev->finished && !stream_session_data(sdi))
-		vdev->finished = TRUE;
+	if (!vdev->finished) {
+		if (vdev->run_mode == REPLAY_REALTIME)
+			more = replay_paced(sdi);
+		else if (vdev->run_mode == REPLAY_MAX_SPEED)
+			more = replay_queued(sdi);
+		else
+			more = replay_round(sdi);
+		if (!more)
+			vdev->finished = TRUE;
+	}
 	if (!vdev->finished)
 		return G_SOURCE_CONTINUE;
 
-	if (vdev->capfile) {
-		zip_fclose(vdev->capfile);
-		vdev->capfile = NULL;
-	}
-	if (vdev->archive) {
-		zip_discard(vdev->archive);
-		vdev->archive = NULL;
-	}
-
+	replay_stop(vdev);
 	std_session_send_df_end(sdi);
 
 	return G_SOURCE_REMOVE;
@@ -278,6 +536,9 @@ static int config_get(uint32_t key, GVariant **data,
 	case SR_CONF_CAPTURE_UNITSIZE:
 		*data = g_variant_new_uint64(vdev->unitsize);
 		break;
+	case SR_CONF_SESSION_REPLAY:
+		*data = g_variant_new_string(replay_modes[vdev->mode]);
+		break;
 	default:
 		return SR_ERR_NA;
 	}
@@ -289,6 +550,7 @@ static int config_set(uint32_t key, GVariant *data,
 	const struct sr_dev_inst *sdi, const struct sr_channel_group *cg)
 {
 	struct session_vdev *vdev;
+	int idx;
 
 	(void)cg;
 
@@ -318,6 +580,11 @@ static int config_set(uint32_t key, GVariant *data,
 	case SR_CONF_NUM_ANALOG_CHANNELS:
 		vdev->num_analog_channels = g_variant_get_int32(data);
 		break;
+	case SR_CONF_SESSION_REPLAY:
+		if ((idx = std_str_idx(data, ARRAY_AND_SIZE(replay_modes))) < 0)
+			return SR_ERR_ARG;
+		vdev->mode = idx;
+		break;
 	default:
 		return SR_ERR_NA;
 	}
@@ -328,7 +595,18 @@ static int config_set(uint32_t key, GVariant *data,
 static int config_list(uint32_t key, GVariant **data,
 	const struct sr_dev_inst *sdi, const struct sr_channel_group *cg)
 {
-	return STD_CONFIG_LIST(key, data, sdi, cg, NO_OPTS, NO_OPTS, devopts);
+	switch (key) {
+	case SR_CONF_SCAN_OPTIONS:
+	case SR_CONF_DEVICE_OPTIONS:
+		return STD_CONFIG_LIST(key, data, sdi, cg, NO_OPTS, NO_OPTS, devopts);
+	case SR_CONF_SESSION_REPLAY:
+		*data = g_variant_new_strv(ARRAY_AND_SIZE(replay_modes));
+		break;
+	default:
+		return SR_ERR_NA;
+	}
+
+	return SR_OK;
 }
 
 static int dev_acquisition_start(const struct sr_dev_inst *sdi)
@@ -339,8 +617,6 @@ static int dev_acquisition_start(const struct sr_dev_inst *sdi)
 	struct sr_channel *ch;
 
 	vdev = sdi->priv;
-	vdev->bytes_read = 0;
-	vdev->cur_analog_channel = 0;
 	vdev->analog_channels = g_array_sized_new(FALSE, FALSE,
 			sizeof(struct sr_channel *), vdev->num_analog_channels);
 	for (l = sdi->channels; l; l = l->next) {
@@ -348,7 +624,6 @@ static int dev_acquisition_start(const struct sr_dev_inst *sdi)
 		if (ch->type == SR_CHANNEL_ANALOG)
 			g_array_append_val(vdev->analog_channels, ch);
 	}
-	vdev->cur_chunk = 0;
 	vdev->finished = FALSE;
 
 	sr_info("Opening archive %s file %s", vdev->sessionfile,
@@ -357,13 +632,26 @@ static int dev_acquisition_start(const struct sr_dev_inst *sdi)
 	if (!(vdev->archive = zip_open(vdev->sessionfile, 0, &ret))) {
 		sr_err("Failed to open session file '%s': "
 		       "zip error %d.", vdev->sessionfile, ret);
+		g_array_free(vdev->analog_channels, TRUE);
+		vdev->analog_channels = NULL;
 		return SR_ERR;
 	}
 
+	if (replay_start(vdev) != SR_OK) {
+		replay_stop(vdev);
+		return SR_ERR;
+	}
+	sr_info("Replaying %s.", replay_modes[vdev->run_mode]);
+
 	std_session_send_df_header(sdi);
 
-	/* freewheeling source */
-	sr_session_source_add(sdi->session, -1, 0, 0, receive_data, (void *)sdi);
+	if (vdev->run_mode == REPLAY_REALTIME)
+		sr_session_source_add(sdi->session, -1, 0, REPLAY_PACE_MS,
+			receive_data, (void *)sdi);
+	else
+		/* freewheeling source */
+		sr_session_source_add(sdi->session, -1, 0, 0,
+			receive_data, (void *)sdi);
 
 	return SR_OK;
 }
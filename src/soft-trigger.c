@@ -26,6 +26,18 @@
 #define LOG_PREFIX "soft-trigger"
 /* @endcond */
 
+/*
+ * The matches of one trigger stage as bit masks over a whole sample,
+ * so that all channels get checked with a few integer operations.
+ */
+struct soft_trigger_masks {
+	uint64_t level_mask;
+	uint64_t level_value;
+	uint64_t rising;
+	uint64_t falling;
+	uint64_t edge;
+};
+
 SR_PRIV int logic_channel_unitsize(GSList *channels)
 {
 	int number = 0;
@@ -41,6 +53,66 @@ SR_PRIV int logic_channel_unitsize(GSList *channels)
 	return (number + 7) / 8;
 }
 
+/*
+ * Translate the trigger stages into masks. Only possible for samples of
+ * one to 64 channels, and when every stage has matches; other triggers
+ * use the per-match check.
+ */
+static void masks_init(struct soft_trigger_logic *stl)
+{
+	struct soft_trigger_masks *m;
+	struct sr_trigger_stage *stage;
+	struct sr_trigger_match *match;
+	GSList *l, *l_stage;
+	uint64_t bit, value;
+	int i;
+
+	stl->num_stages = g_slist_length(stl->trigger->stages);
+	if (stl->unitsize < 1 || stl->unitsize > 8 || !stl->num_stages)
+		return;
+
+	stl->masks = g_malloc0_n(stl->num_stages, sizeof(*stl->masks));
+	for (l_stage = stl->trigger->stages, i = 0; l_stage;
+			l_stage = l_stage->next, i++) {
+		stage = l_stage->data;
+		if (!stage->matches)
+			goto fallback;
+		m = &stl->masks[i];
+		for (l = stage->matches; l; l = l->next) {
+			match = l->data;
+			/* Ignore disabled channels with a trigger. */
+			if (!match->channel->enabled)
+				continue;
+			if (match->channel->type != SR_CHANNEL_LOGIC ||
+					match->channel->index >= stl->unitsize * 8)
+				goto fallback;
+			bit = UINT64_C(1) << match->channel->index;
+			if (match->match == SR_TRIGGER_ZERO ||
+					match->match == SR_TRIGGER_ONE) {
+				value = match->match == SR_TRIGGER_ONE ? bit : 0;
+				/* Contradicting levels for one channel. */
+				if ((m->level_mask & bit) &&
+						(m->level_value & bit) != value)
+					goto fallback;
+				m->level_mask |= bit;
+				m->level_value |= value;
+			} else if (match->match == SR_TRIGGER_RISING) {
+				m->rising |= bit;
+			} else if (match->match == SR_TRIGGER_FALLING) {
+				m->falling |= bit;
+			} else if (match->match == SR_TRIGGER_EDGE) {
+				m->edge |= bit;
+			}
+		}
+	}
+
+	return;
+
+fallback:
+	g_free(stl->masks);
+	stl->masks = NULL;
+}
+
 SR_PRIV struct soft_trigger_logic *soft_trigger_logic_new(
 		const struct sr_dev_inst *sdi, struct sr_trigger *trigger,
 		int pre_trigger_samples)
@@ -70,11 +142,14 @@ SR_PRIV struct soft_trigger_logic *soft_trigger_logic_new(
 		return NULL;
 	}
 
+	masks_init(stl);
+
 	return stl;
 }
 
 SR_PRIV void soft_trigger_logic_free(struct soft_trigger_logic *stl)
 {
+	g_free(stl->masks);
 	g_free(stl->pre_trigger_buffer);
 	g_free(stl->prev_sample);
 	g_free(stl);
@@ -139,12 +214,11 @@ static void pre_trigger_send(struct soft_trigger_logic *stl,
 }
 
 static gboolean logic_check_match(struct soft_trigger_logic *stl,
-		uint8_t *sample, struct sr_trigger_match *match)
+		uint8_t *sample, uint8_t *prev, struct sr_trigger_match *match)
 {
 	int bit, prev_bit;
 	gboolean result;
 
-	stl->count++;
 	result = FALSE;
 	bit = *(sample + match->channel->index / 8)
 			& (1 << (match->channel->index % 8));
@@ -154,10 +228,10 @@ static gboolean logic_check_match(struct soft_trigger_logic *stl,
 		result = bit != 0;
 	else {
 		/* Edge matches. */
-		if (stl->count == 1)
+		if (!stl->have_prev)
 			/* First sample, don't have enough for an edge match yet. */
 			return FALSE;
-		prev_bit = *(stl->prev_sample + match->channel->index / 8)
+		prev_bit = *(prev + match->channel->index / 8)
 				& (1 << (match->channel->index % 8));
 		if (match->match == SR_TRIGGER_RISING)
 			result = prev_bit == 0 && bit != 0;
@@ -170,6 +244,119 @@ static gboolean logic_check_match(struct soft_trigger_logic *stl,
 	return result;
 }
 
+static uint64_t load_sample(const uint8_t *p, int unitsize)
+{
+	uint64_t sample;
+
+	switch (unitsize) {
+	case 1:
+		return R8(p);
+	case 2:
+		return RL16(p);
+	case 4:
+		return RL32(p);
+	case 8:
+		return RL64(p);
+	}
+
+	sample = 0;
+	while (unitsize--)
+		sample = (sample << 8) | p[unitsize];
+
+	return sample;
+}
+
+static gboolean masks_match(const struct soft_trigger_masks *m,
+		uint64_t sample, uint64_t prev, gboolean have_prev)
+{
+	uint64_t changed;
+
+	if ((sample & m->level_mask) != m->level_value)
+		return FALSE;
+	if (!(m->rising | m->falling | m->edge))
+		return TRUE;
+	/* First sample, don't have enough for an edge match yet. */
+	if (!have_prev)
+		return FALSE;
+
+	changed = sample ^ prev;
+
+	return (changed & sample & m->rising) == m->rising &&
+		(changed & prev & m->falling) == m->falling &&
+		(changed & m->edge) == m->edge;
+}
+
+static void fire(struct soft_trigger_logic *stl, uint8_t *buf, int offset,
+		int *pre_trigger_samples)
+{
+	struct sr_datafeed_packet packet;
+
+	/* Matched on last stage, send pre-trigger data. */
+	pre_trigger_append(stl, buf, offset);
+	pre_trigger_send(stl, pre_trigger_samples);
+
+	packet.type = SR_DF_TRIGGER;
+	packet.payload = NULL;
+	sr_session_send(stl->sdi, &packet);
+}
+
+/*
+ * Word-parallel variant of soft_trigger_logic_check(). Every sample is
+ * checked against all matches of the current stage at once. With a
+ * single stage, runs of unchanged samples are skipped eight bytes at a
+ * time: a sample equal to its predecessor can't have an edge, and can't
+ * match levels its predecessor didn't match.
+ */
+static int masks_check(struct soft_trigger_logic *stl, uint8_t *buf,
+		int len, int *pre_trigger_samples)
+{
+	const int unitsize = stl->unitsize;
+	const gboolean skip_runs = stl->num_stages == 1 && 8 % unitsize == 0;
+	uint64_t sample, prev;
+	int i;
+
+	prev = load_sample(stl->prev_sample, unitsize);
+	for (i = 0; i + unitsize <= len; i += unitsize) {
+		if (skip_runs && i >= unitsize) {
+			while (i + 8 <= len && !memcmp(buf + i, buf + i - unitsize, 8))
+				i += 8;
+			if (i + unitsize > len)
+				break;
+		}
+		sample = load_sample(buf + i, unitsize);
+		if (!masks_match(&stl->masks[stl->cur_stage], sample, prev,
+				stl->have_prev)) {
+			if (stl->cur_stage > 0) {
+				/*
+				 * Restart at the sample after the one which
+				 * matched the first stage, as the per-match
+				 * check does.
+				 */
+				i -= stl->cur_stage * unitsize;
+				if (i < 0)
+					i = -unitsize; /* Went back past this buffer. */
+				stl->cur_stage = 0;
+				prev = load_sample(i >= 0 ? buf + i :
+					stl->prev_sample, unitsize);
+				continue;
+			}
+		} else if (++stl->cur_stage == stl->num_stages) {
+			stl->cur_stage = 0;
+			memcpy(stl->prev_sample, buf + i, unitsize);
+			fire(stl, buf, i, pre_trigger_samples);
+			return i / unitsize;
+		}
+		prev = sample;
+		stl->have_prev = TRUE;
+	}
+
+	if (len >= unitsize)
+		memcpy(stl->prev_sample, buf + len - unitsize, unitsize);
+	pre_trigger_append(stl, buf, len);
+
+	return -1;
+}
+
 /* Returns the offset (in samples) within buf of where the trigger
  * occurred, or -1 if not triggered. */
 SR_PRIV int soft_trigger_logic_check(struct soft_trigger_logic *stl,
@@ -179,30 +366,39 @@ SR_PRIV int soft_trigger_logic_check(struct soft_trigger_logic *stl,
 	struct sr_trigger_stage *stage;
 	struct sr_trigger_match *match;
 	GSList *l, *l_stage;
+	uint8_t *prev;
 	int offset;
 	int i;
 	gboolean match_found;
 
+	if (stl->masks)
+		return masks_check(stl, buf, len, pre_trigger_samples);
+
 	offset = -1;
-	for (i = 0; i < len; i += stl->unitsize) {
+	for (i = 0; i + stl->unitsize <= len; i += stl->unitsize) {
 		l_stage = g_slist_nth(stl->trigger->stages, stl->cur_stage);
 		stage = l_stage->data;
 		if (!stage->matches)
 			/* No matches supplied, client error. */
 			return SR_ERR_ARG;
 
+		/*
+		 * The previous sample is taken from the buffer, so that it
+		 * is still right after going back to an earlier sample.
+		 */
+		prev = i > 0 ? buf + i - stl->unitsize : stl->prev_sample;
 		match_found = TRUE;
 		for (l = stage->matches; l; l = l->next) {
 			match = l->data;
 			if (!match->channel->enabled)
 				/* Ignore disabled channels with a trigger. */
 				continue;
-			if (!logic_check_match(stl, buf + i, match)) {
+			if (!logic_check_match(stl, buf + i, prev, match)) {
 				match_found = FALSE;
 				break;
 			}
 		}
-		memcpy(stl->prev_sample, buf + i, stl->unitsize);
+		stl->have_prev = TRUE;
 		if (match_found) {
 			/* Matched on the current stage. */
 			if (l_stage->next) {
@@ -215,6 +411,7 @@ SR_PRIV int soft_trigger_logic_check(struct soft_trigger_logic *stl,
 
 				/* Fire trigger. */
 				offset = i / stl->unitsize;
+				memcpy(stl->prev_sample, buf + i, stl->unitsize);
 
 				packet.type = SR_DF_TRIGGER;
 				packet.payload = NULL;
@@ -232,15 +429,19 @@ SR_PRIV int soft_trigger_logic_check(struct soft_trigger_logic *stl,
 			 * takes care of.
 			 */
 			i -= stl->cur_stage * stl->unitsize;
-			if (i < -1)
-				i = -1; /* Oops, went back past this buffer. */
+			if (i < -stl->unitsize)
+				i = -stl->unitsize; /* Oops, went back past this buffer. */
 			/* Reset trigger stage. */
 			stl->cur_stage = 0;
 		}
 	}
 
-	if (offset == -1)
+	if (offset == -1) {
+		if (len >= stl->unitsize)
+			memcpy(stl->prev_sample, buf + len - stl->unitsize,
+				stl->unitsize);
 		pre_trigger_append(stl, buf, len);
+	}
 
 	return offset;
 }
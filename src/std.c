@@ -575,6 +575,93 @@ SR_PRIV GSList *std_scan_complete(struct sr_dev_driver *di, GSList *devices)
 	return devices;
 }
 
+struct std_probe_task {
+	void *item;
+	void *result;
+};
+
+struct std_probe_pool {
+	std_probe_callback probe;
+	void *cb_data;
+};
+
+static void std_probe_task_run(gpointer data, gpointer user_data)
+{
+	struct std_probe_task *task;
+	struct std_probe_pool *pool;
+
+	task = data;
+	pool = user_data;
+	task->result = pool->probe(task->item, pool->cb_data);
+}
+
+/**
+ * Probe a list of resources concurrently.
+ *
+ * The @p probe callback runs for every item of @p items on a bounded
+ * pool of worker threads, so that the total time is determined by the
+ * slowest resource rather than by the sum of them. Per-probe timeouts
+ * are those of the transport which the callback uses.
+ *
+ * The callback must be reentrant: it must not touch state which is
+ * shared between the probes, apart from read-only data, and everything
+ * it calls (transport open and close, the driver's probe function) must
+ * be safe to run from several threads at once. Log messages of the
+ * probes are emitted from the worker threads. Callers only use this on
+ * behalf of drivers which opted in after their probe was checked, see
+ * sr_scpi_scan_concurrent().
+ *
+ * @param[in] items The resources to probe, passed to @p probe.
+ * @param[in] probe Callback returning a result for an item, or NULL.
+ * @param[in] cb_data Opaque pointer passed to @p probe.
+ *
+ * @return The list of non-NULL results, in the order of @p items.
+ */
+SR_PRIV GSList *std_probe_parallel(GSList *items, std_probe_callback probe,
+		void *cb_data)
+{
+	struct std_probe_task *tasks;
+	struct std_probe_pool ctx;
+	GThreadPool *pool;
+	GSList *l, *results;
+	size_t count, i;
+	gint64 start;
+
+	count = g_slist_length(items);
+	if (!count)
+		return NULL;
+
+	tasks = g_malloc0(count * sizeof(*tasks));
+	for (l = items, i = 0; l; l = l->next, i++)
+		tasks[i].item = l->data;
+	ctx.probe = probe;
+	ctx.cb_data = cb_data;
+
+	start = g_get_monotonic_time();
+	pool = NULL;
+	if (count > 1)
+		pool = g_thread_pool_new(std_probe_task_run, &ctx,
+			MIN(count, STD_PROBE_THREADS_MAX), FALSE, NULL);
+	for (i = 0; i < count; i++) {
+		/* Fall back to probing in the caller's thread. */
+		if (!pool || !g_thread_pool_push(pool, &tasks[i], NULL))
+			std_probe_task_run(&tasks[i], &ctx);
+	}
+	if (pool)
+		g_thread_pool_free(pool, FALSE, TRUE);
+	sr_dbg("Probed %zu resources in %" PRIi64 "ms.", count,
+		(g_get_monotonic_time() - start) / 1000);
+
+	results = NULL;
+	for (i = 0; i < count; i++) {
+		if (tasks[i].result)
+			results = g_slist_append(results, tasks[i].result);
+	}
+	g_free(tasks);
+
+	return results;
+}
+
 SR_PRIV int std_opts_config_list(uint32_t key, GVariant **data,
 	const struct sr_dev_inst *sdi, const struct sr_channel_group *cg,
 	const uint32_t scanopts[], size_t scansize, const uint32_t drvopts[],
@@ -0,0 +1,372 @@
+/*
+ * This file is part of the libsigrok project.
+ *
+ * Moved here from scpi_tcp.c and beaglelogic_tcp.c, their copyright
+ * notices are listed below:
+ *
+ * Copyright (C) 2013 Martin Ling <martin-sigrok@earth.li>
+ * Copyright (C) 2013 poljar (Damir Jelić) <poljarinho@gmail.com>
+ * Copyright (C) 2017 Kumar Abhishek <abhishek@theembeddedkitchen.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file
+ * TCP connections shared by network transports
+ * @internal
+ */
+
+#include <config.h>
+#ifdef _WIN32
+#define _WIN32_WINNT 0x0501
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#endif
+#include <glib.h>
+#include <string.h>
+#include <unistd.h>
+#ifndef _WIN32
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <netdb.h>
+#endif
+#include <errno.h>
+#include <libsigrok/libsigrok.h>
+#include "libsigrok-internal.h"
+
+#define LOG_PREFIX "tcp"
+
+/**
+ * Allocate a TCP connection instance.
+ *
+ * @param host_addr The host name or address to connect to.
+ * @param tcp_port The port number or service name to connect to.
+ * @param rcvbuf_size The socket receive buffer size to request, 0 to keep
+ *                    the system default. Bulk transfers benefit from a
+ *                    buffer which covers the bandwidth-delay product.
+ *
+ * @return The new instance, NULL on invalid arguments.
+ */
+SR_PRIV struct sr_tcp_dev_inst *sr_tcp_dev_inst_new(const char *host_addr,
+	const char *tcp_port, size_t rcvbuf_size)
+{
+	struct sr_tcp_dev_inst *tcp;
+
+	if (!host_addr || !*host_addr || !tcp_port || !*tcp_port)
+		return NULL;
+
+	tcp = g_malloc0(sizeof(*tcp));
+	tcp->host_addr = g_strdup(host_addr);
+	tcp->tcp_port = g_strdup(tcp_port);
+	tcp->sock_fd = -1;
+	tcp->rcvbuf_size = rcvbuf_size;
+
+	return tcp;
+}
+
+/**
+ * Free a TCP connection instance, closing the connection if needed.
+ *
+ * @param tcp The instance to free, may be NULL.
+ */
+SR_PRIV void sr_tcp_dev_inst_free(struct sr_tcp_dev_inst *tcp)
+{
+	if (!tcp)
+		return;
+
+	sr_tcp_disconnect(tcp);
+	g_free(tcp->host_addr);
+	g_free(tcp->tcp_port);
+	g_free(tcp);
+}
+
+static void set_socket_options(struct sr_tcp_dev_inst *tcp)
+{
+	int opt;
+	socklen_t optlen;
+
+	/*
+	 * Commands and queries are small, don't let Nagle's algorithm
+	 * hold them back until the previous segment was acknowledged.
+	 */
+	opt = 1;
+	if (setsockopt(tcp->sock_fd, IPPROTO_TCP, TCP_NODELAY,
+			(const void *)&opt, sizeof(opt)) < 0)
+		sr_dbg("Cannot set TCP_NODELAY: %s.", g_strerror(errno));
+
+	/*
+	 * The receive buffer size limits the advertised window, so it has
+	 * to be set before connecting. The OS may cap the size (Linux:
+	 * net.core.rmem_max), log the effective value.
+	 */
+	if (!tcp->rcvbuf_size)
+		return;
+	opt = MIN(tcp->rcvbuf_size, G_MAXINT);
+	if (setsockopt(tcp->sock_fd, SOL_SOCKET, SO_RCVBUF,
+			(const void *)&opt, sizeof(opt)) < 0) {
+		sr_dbg("Cannot set SO_RCVBUF: %s.", g_strerror(errno));
+		return;
+	}
+	optlen = sizeof(opt);
+	if (getsockopt(tcp->sock_fd, SOL_SOCKET, SO_RCVBUF,
+			(void *)&opt, &optlen) == 0)
+		sr_dbg("Receive buffer size %d (requested %zu).",
+			opt, tcp->rcvbuf_size);
+}
+
+/**
+ * Connect to the instance's host and port.
+ *
+ * @param tcp The instance to connect.
+ *
+ * @retval SR_OK Success.
+ * @retval SR_ERR_ARG Invalid argument.
+ * @retval SR_ERR Address lookup or connection failed.
+ */
+SR_PRIV int sr_tcp_connect(struct sr_tcp_dev_inst *tcp)
+{
+	struct addrinfo hints;
+	struct addrinfo *results, *res;
+	int err;
+
+	if (!tcp)
+		return SR_ERR_ARG;
+
+	memset(&hints, 0, sizeof(hints));
+	hints.ai_family = AF_UNSPEC;
+	hints.ai_socktype = SOCK_STREAM;
+	hints.ai_protocol = IPPROTO_TCP;
+
+	err = getaddrinfo(tcp->host_addr, tcp->tcp_port, &hints, &results);
+	if (err) {
+		sr_err("Address lookup failed: %s:%s: %s", tcp->host_addr,
+			tcp->tcp_port, gai_strerror(err));
+		return SR_ERR;
+	}
+
+	for (res = results; res; res = res->ai_next) {
+		if ((tcp->sock_fd = socket(res->ai_family, res->ai_socktype,
+						res->ai_protocol)) < 0)
+			continue;
+		set_socket_options(tcp);
+		if (connect(tcp->sock_fd, res->ai_addr, res->ai_addrlen) != 0) {
+			close(tcp->sock_fd);
+			tcp->sock_fd = -1;
+			continue;
+		}
+		break;
+	}
+
+	freeaddrinfo(results);
+
+	if (tcp->sock_fd < 0) {
+		sr_err("Failed to connect to %s:%s: %s", tcp->host_addr,
+			tcp->tcp_port, g_strerror(errno));
+		return SR_ERR;
+	}
+
+	tcp->bytes_received = 0;
+	tcp->bytes_sent = 0;
+	tcp->connected_at = g_get_monotonic_time();
+
+	return SR_OK;
+}
+
+/**
+ * Close the connection of an instance.
+ *
+ * Logs the amount of data transferred over the connection, and the
+ * average throughput.
+ *
+ * @param tcp The instance to disconnect.
+ *
+ * @retval SR_OK Success, also if the instance wasn't connected.
+ * @retval SR_ERR Closing the socket failed.
+ */
+SR_PRIV int sr_tcp_disconnect(struct sr_tcp_dev_inst *tcp)
+{
+	int64_t elapsed;
+	int ret;
+
+	if (!tcp || tcp->sock_fd < 0)
+		return SR_OK;
+
+	elapsed = g_get_monotonic_time() - tcp->connected_at;
+	sr_dbg("%s:%s: received %" PRIu64 " bytes, sent %" PRIu64
+		" bytes in %.3f s, %.1f kB/s in.", tcp->host_addr,
+		tcp->tcp_port, tcp->bytes_received, tcp->bytes_sent,
+		elapsed / 1e6, elapsed ? tcp->bytes_received * 1e3 / elapsed : 0);
+
+	ret = close(tcp->sock_fd);
+	tcp->sock_fd = -1;
+
+	return ret < 0 ? SR_ERR : SR_OK;
+}
+
+/**
+ * Send data over a connection.
+ *
+ * Retries until all data was sent, or an error occurred.
+ *
+ * @param tcp The instance to send with.
+ * @param data The data to send.
+ * @param len The number of bytes to send.
+ *
+ * @return The number of bytes sent, or SR_ERR upon failure.
+ */
+SR_PRIV int sr_tcp_write_bytes(struct sr_tcp_dev_inst *tcp,
+	const uint8_t *data, size_t len)
+{
+	size_t written;
+	int ret;
+
+	if (!tcp || tcp->sock_fd < 0 || len > G_MAXINT)
+		return SR_ERR_ARG;
+
+	written = 0;
+	while (written < len) {
+		ret = send(tcp->sock_fd, (const void *)(data + written),
+			len - written, 0);
+		if (ret < 0 && errno == EINTR)
+			continue;
+		if (ret < 0) {
+			sr_err("Send error: %s", g_strerror(errno));
+			return SR_ERR;
+		}
+		written += ret;
+		tcp->bytes_sent += ret;
+	}
+
+	return written;
+}
+
+/**
+ * Receive the data which is available on a connection.
+ *
+ * Blocks until at least one byte is available, and returns what a single
+ * read yields. Use this when the length of the response is not known.
+ *
+ * @param tcp The instance to receive with.
+ * @param data The buffer to receive into.
+ * @param len The size of the buffer.
+ *
+ * @return The number of bytes received, 0 when the peer closed the
+ *         connection, or SR_ERR upon failure.
+ */
+SR_PRIV int sr_tcp_read_bytes(struct sr_tcp_dev_inst *tcp,
+	uint8_t *data, size_t len)
+{
+	int ret;
+
+	if (!tcp || tcp->sock_fd < 0 || len > G_MAXINT)
+		return SR_ERR_ARG;
+
+	do {
+		ret = recv(tcp->sock_fd, (void *)data, len, 0);
+	} while (ret < 0 && errno == EINTR);
+	if (ret < 0) {
+		sr_err("Receive error: %s", g_strerror(errno));
+		return SR_ERR;
+	}
+	tcp->bytes_received += ret;
+
+	return ret;
+}
+
+/**
+ * Receive an exact amount of data from a connection.
+ *
+ * Waits for the complete amount in the kernel (MSG_WAITALL) rather than
+ * returning every segment separately. Use this when the length of the
+ * response is known, e.g. from a length header.
+ *
+ * @param tcp The instance to receive with.
+ * @param data The buffer to receive into.
+ * @param len The number of bytes to receive.
+ *
+ * @return The number of bytes received, which is less than @p len only
+ *         when the peer closed the connection, or SR_ERR upon failure.
+ */
+SR_PRIV int sr_tcp_read_all(struct sr_tcp_dev_inst *tcp,
+	uint8_t *data, size_t len)
+{
+	size_t got;
+	int ret;
+
+	if (!tcp || tcp->sock_fd < 0 || len > G_MAXINT)
+		return SR_ERR_ARG;
+
+	got = 0;
+	while (got < len) {
+		ret = recv(tcp->sock_fd, (void *)(data + got), len - got,
+			MSG_WAITALL);
+		if (ret < 0 && errno == EINTR)
+			continue;
+		if (ret < 0) {
+			sr_err("Receive error: %s", g_strerror(errno));
+			return SR_ERR;
+		}
+		if (ret == 0)
+			break;
+		got += ret;
+		tcp->bytes_received += ret;
+	}
+
+	return got;
+}
+
+/**
+ * Receive as much data as is available on a connection, up to a limit.
+ *
+ * Blocks for the first read like sr_tcp_read_bytes(), then keeps reading
+ * without blocking until the buffer is full or no more data is queued.
+ * This lets stream receivers handle large chunks per poll event instead
+ * of single segments.
+ *
+ * @param tcp The instance to receive with.
+ * @param data The buffer to receive into.
+ * @param len The size of the buffer.
+ *
+ * @return The number of bytes received, 0 when the peer closed the
+ *         connection, or SR_ERR upon failure.
+ */
+SR_PRIV int sr_tcp_read_bulk(struct sr_tcp_dev_inst *tcp,
+	uint8_t *data, size_t len)
+{
+	size_t got;
+	int ret;
+
+	ret = sr_tcp_read_bytes(tcp, data, len);
+	if (ret <= 0)
+		return ret;
+	got = ret;
+
+#ifdef MSG_DONTWAIT
+	while (got < len) {
+		ret = recv(tcp->sock_fd, (void *)(data + got), len - got,
+			MSG_DONTWAIT);
+		if (ret < 0 && errno == EINTR)
+			continue;
+		if (ret <= 0)
+			break;
+		got += ret;
+		tcp->bytes_received += ret;
+	}
+#endif
+
+	return got;
+}
@@ -18,6 +18,7 @@
  */
 
 #include <config.h>
+#include <string.h>
 #include <libsigrok/libsigrok.h>
 #include "libsigrok-internal.h"
 
@@ -178,4 +179,175 @@ SR_API int sr_trigger_match_add(struct sr_trigger_stage *stage,
 	return SR_OK;
 }
 
+static gboolean hw_match_supported(const struct sr_trigger_hw_caps *caps,
+		const struct sr_trigger_match *match, int *edges)
+{
+	int idx;
+	gboolean is_edge;
+
+	idx = match->channel->index;
+	if (match->channel->type != SR_CHANNEL_LOGIC || idx < 0 || idx >= 64)
+		return FALSE;
+	if (!(caps->channels & (UINT64_C(1) << idx)))
+		return FALSE;
+	if ((unsigned int)match->match >= 32 ||
+			!(caps->matches & SR_TRIGGER_MATCH_BIT(match->match)))
+		return FALSE;
+
+	is_edge = match->match == SR_TRIGGER_RISING ||
+		match->match == SR_TRIGGER_FALLING ||
+		match->match == SR_TRIGGER_EDGE;
+	if (is_edge && caps->max_edges >= 0 && *edges >= caps->max_edges)
+		return FALSE;
+	if (is_edge)
+		(*edges)++;
+
+	return TRUE;
+}
+
+/*
+ * Count the matches of a stage which the hardware supports, and add them
+ * to the hardware trigger if one is given.
+ */
+static int relax_stage(const struct sr_trigger_hw_caps *caps,
+		const struct sr_trigger_stage *stage, struct sr_trigger *hw,
+		gboolean *exact)
+{
+	struct sr_trigger_stage *hw_stage;
+	struct sr_trigger_match *match;
+	const GSList *l;
+	int edges, count;
+
+	hw_stage = NULL;
+	edges = 0;
+	count = 0;
+	for (l = stage->matches; l; l = l->next) {
+		match = l->data;
+		if (!match->channel->enabled)
+			continue;
+		if (!hw_match_supported(caps, match, &edges)) {
+			*exact = FALSE;
+			continue;
+		}
+		count++;
+		if (!hw)
+			continue;
+		if (!hw_stage)
+			hw_stage = sr_trigger_stage_add(hw);
+		sr_trigger_match_add(hw_stage, match->channel, match->match,
+			match->value);
+	}
+
+	return count;
+}
+
+static gboolean has_edge_match(const struct sr_trigger *trigger)
+{
+	const struct sr_trigger_stage *stage;
+	const struct sr_trigger_match *match;
+	const GSList *l, *m;
+
+	for (l = trigger->stages; l; l = l->next) {
+		stage = l->data;
+		for (m = stage->matches; m; m = m->next) {
+			match = m->data;
+			if (match->channel->enabled &&
+					(match->match == SR_TRIGGER_RISING ||
+					match->match == SR_TRIGGER_FALLING ||
+					match->match == SR_TRIGGER_EDGE))
+				return TRUE;
+		}
+	}
+
+	return FALSE;
+}
+
+/**
+ * Split a trigger into a hardware part and a residual host check.
+ *
+ * The hardware gets as many leading stages as it supports, each reduced
+ * to the matches it can evaluate. Dropping matches only makes a stage
+ * fire more often, so the hardware trigger point can be early but never
+ * late. When anything was dropped, the host checks the complete trigger
+ * on the captured data, starting @c rewind samples before the hardware
+ * trigger point: soft trigger stages match on consecutive samples, and
+ * edge matches need the sample before. Stages are taken off the hardware
+ * while the device can't deliver that many samples. If not even the
+ * first stage can be offloaded, the host checks everything.
+ *
+ * Matches on disabled channels are ignored, as in the soft trigger.
+ *
+ * @param trigger The trigger to plan, may be NULL.
+ * @param caps The capabilities of the device's hardware trigger.
+ * @param plan The plan to fill in. Release with sr_trigger_plan_clear().
+ *
+ * @retval SR_OK Success.
+ * @retval SR_ERR_ARG Invalid argument.
+ *
+ * @private
+ */
+SR_PRIV int sr_trigger_plan_init(struct sr_trigger *trigger,
+		const struct sr_trigger_hw_caps *caps,
+		struct sr_trigger_plan *plan)
+{
+	const GSList *l;
+	int num_stages, extra, i;
+	gboolean exact;
+
+	if (!caps || !plan)
+		return SR_ERR_ARG;
+
+	memset(plan, 0, sizeof(*plan));
+	if (!trigger || !trigger->stages)
+		return SR_OK;
+
+	exact = TRUE;
+	num_stages = 0;
+	for (l = trigger->stages; l && num_stages < caps->num_stages; l = l->next) {
+		/* A stage which fires on any sample ends the offload. */
+		if (!relax_stage(caps, l->data, NULL, &exact))
+			break;
+		num_stages++;
+	}
+	if (l)
+		exact = FALSE;
+
+	if (!exact) {
+		extra = has_edge_match(trigger) ? 1 : 0;
+		while (num_stages > 0 && caps->max_rewind >= 0 &&
+				num_stages - 1 + extra > caps->max_rewind)
+			num_stages--;
+		plan->soft = trigger;
+		plan->rewind = num_stages ? num_stages - 1 + extra : 0;
+	}
+
+	if (num_stages) {
+		plan->hw = sr_trigger_new(trigger->name);
+		for (l = trigger->stages, i = 0; i < num_stages; l = l->next, i++)
+			relax_stage(caps, l->data, plan->hw, &exact);
+	}
+
+	sr_dbg("%d of %u trigger stages in hardware, %s.", num_stages,
+		g_slist_length(trigger->stages),
+		plan->soft ? "host check needed" : "exact");
+
+	return SR_OK;
+}
+
+/**
+ * Release the hardware trigger of a plan, and reset the plan.
+ *
+ * @param plan The plan to clear, may be NULL.
+ *
+ * @private
+ */
+SR_PRIV void sr_trigger_plan_clear(struct sr_trigger_plan *plan)
+{
+	if (!plan)
+		return;
+
+	sr_trigger_free(plan->hw);
+	memset(plan, 0, sizeof(*plan));
+}
+
 /** @} */
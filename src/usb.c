@@ -551,3 +551,191 @@ SR_PRIV gboolean usb_match_manuf_prod(libusb_device *dev,
 
 	return ret;
 }
+
+/*
+ * Adaptive bulk transfer scheduling.
+ *
+ * Streaming drivers keep a number of bulk IN transfers in flight. Data
+ * is lost if the device's FIFO overflows before the host resubmits a
+ * transfer, i.e. if the host stalls for longer than the queued transfers
+ * can absorb. The scheduler watches the intervals between transfer
+ * completions and the time spent in the completion callback, and grows
+ * the queue (more transfers first, then larger ones) when stalls come
+ * close to what it can absorb. It slowly shrinks the queue again when
+ * the host keeps up easily.
+ */
+
+/* Weight of new measurements in the running averages, 1/2^n. */
+#define SCHED_AVG_SHIFT		3
+/* Decay of the worst case interval, per completion, 1/2^n. */
+#define SCHED_GAP_DECAY_SHIFT	6
+/* Completions between decisions to shrink the queue. */
+#define SCHED_SHRINK_INTERVAL	256
+
+static size_t sched_round_size(const struct sr_usb_xfer_sched *s, size_t size)
+{
+	return MAX((size + s->unit - 1) / s->unit, 1) * s->unit;
+}
+
+/* The time the data of n transfers of the current size take to arrive. */
+static gint64 sched_queue_us(const struct sr_usb_xfer_sched *s,
+		unsigned int n)
+{
+	return (gint64)n * s->buffer_size * 1000 / s->bytes_per_ms;
+}
+
+/**
+ * Initialize a transfer scheduler.
+ *
+ * @param s The scheduler to initialize.
+ * @param unit Transfer sizes are a multiple of this, which should be a
+ *             multiple of the bulk packet size.
+ * @param bytes_per_ms The data rate of the device, in bytes per ms.
+ * @param buffer_ms Initial amount of data per transfer, in ms.
+ * @param queue_ms Initial amount of data for all transfers, in ms.
+ * @param max_buffer_size Upper limit for the size of a transfer.
+ * @param max_transfers Upper limit for the number of transfers.
+ * @param max_bytes Upper limit for all transfer buffers together.
+ *
+ * @private
+ */
+SR_PRIV void sr_usb_xfer_sched_init(struct sr_usb_xfer_sched *s,
+		size_t unit, size_t bytes_per_ms, unsigned int buffer_ms,
+		unsigned int queue_ms, size_t max_buffer_size,
+		unsigned int max_transfers, size_t max_bytes)
+{
+	memset(s, 0, sizeof(*s));
+	s->unit = MAX(unit, 1);
+	s->bytes_per_ms = MAX(bytes_per_ms, 1);
+	s->max_buffer_size = sched_round_size(s, max_buffer_size);
+	s->max_transfers = MAX(max_transfers, 1);
+	s->max_bytes = max_bytes;
+
+	s->buffer_size = sched_round_size(s, buffer_ms * s->bytes_per_ms);
+	s->buffer_size = MIN(s->buffer_size, s->max_buffer_size);
+	s->num_transfers = (queue_ms * s->bytes_per_ms + s->buffer_size - 1) /
+		s->buffer_size;
+	s->num_transfers = MIN(s->num_transfers, s->max_transfers);
+	s->num_transfers = MIN(s->num_transfers, s->max_bytes / s->buffer_size);
+	s->num_transfers = MAX(s->num_transfers, 1);
+	s->min_transfers = MAX(s->num_transfers / 4, 1);
+}
+
+/**
+ * Get the timeout for a transfer, in ms.
+ *
+ * This covers the time the whole queue takes to fill, plus headroom.
+ *
+ * @private
+ */
+SR_PRIV unsigned int sr_usb_xfer_sched_timeout(const struct sr_usb_xfer_sched *s)
+{
+	gint64 timeout;
+
+	timeout = sched_queue_us(s, s->num_transfers) / 1000;
+
+	/* Leave a headroom of 25% percent. */
+	return timeout + timeout / 4 + 1;
+}
+
+/**
+ * Note the completion of a transfer. To be called first thing in the
+ * transfer callback.
+ *
+ * @return The timestamp to pass to sr_usb_xfer_sched_end().
+ *
+ * @private
+ */
+SR_PRIV gint64 sr_usb_xfer_sched_begin(struct sr_usb_xfer_sched *s)
+{
+	gint64 now, gap;
+
+	now = g_get_monotonic_time();
+	if (s->last_completion) {
+		gap = now - s->last_completion;
+		s->max_gap -= s->max_gap >> SCHED_GAP_DECAY_SHIFT;
+		s->max_gap = MAX(s->max_gap, gap);
+	}
+	s->last_completion = now;
+
+	return now;
+}
+
+static gboolean sched_grow(struct sr_usb_xfer_sched *s)
+{
+	size_t size;
+
+	/* More transfers shorten the stalls a single resubmit can cause. */
+	if (s->num_transfers < s->max_transfers &&
+			(s->num_transfers + 1) * s->buffer_size <= s->max_bytes) {
+		s->num_transfers++;
+		return TRUE;
+	}
+
+	/* Otherwise make every transfer cover more time. */
+	size = sched_round_size(s, s->buffer_size + s->buffer_size / 4);
+	size = MIN(size, s->max_buffer_size);
+	if (size > s->buffer_size && s->num_transfers * size <= s->max_bytes) {
+		s->buffer_size = size;
+		return TRUE;
+	}
+
+	return FALSE;
+}
+
+/**
+ * Note the end of transfer processing, and adapt the queue. To be called
+ * before the transfer is resubmitted.
+ *
+ * Afterwards, buffer_size and num_transfers hold the size for the
+ * transfer about to be resubmitted, and the number of transfers which
+ * should be in flight.
+ *
+ * @param s The scheduler.
+ * @param start The timestamp sr_usb_xfer_sched_begin() returned.
+ *
+ * @private
+ */
+SR_PRIV void sr_usb_xfer_sched_end(struct sr_usb_xfer_sched *s, gint64 start)
+{
+	gint64 processing, queue_us, buffer_us;
+	gboolean risk, grown;
+
+	processing = g_get_monotonic_time() - start;
+	s->avg_processing += (processing - s->avg_processing) >> SCHED_AVG_SHIFT;
+
+	queue_us = sched_queue_us(s, s->num_transfers);
+	buffer_us = sched_queue_us(s, 1);
+
+	/*
+	 * Grow if the worst recent stall takes up half the queue, or if
+	 * processing a transfer takes most of the time it covers (larger
+	 * transfers amortize per-transfer overhead).
+	 */
+	risk = FALSE;
+	if (s->max_gap > queue_us / 2 || s->avg_processing > buffer_us * 3 / 4) {
+		grown = sched_grow(s);
+		if (grown)
+			sr_spew("Transfer queue grown to %u x %zu bytes.",
+				s->num_transfers, s->buffer_size);
+		/* Out of budget and still close to the edge. */
+		risk = !grown && (s->max_gap > queue_us * 3 / 4 ||
+			s->avg_processing > buffer_us);
+	} else if (s->max_gap < queue_us / 8 &&
+			s->num_transfers > s->min_transfers &&
+			++s->idle_count >= SCHED_SHRINK_INTERVAL) {
+		s->idle_count = 0;
+		s->num_transfers--;
+		sr_spew("Transfer queue shrunk to %u x %zu bytes.",
+			s->num_transfers, s->buffer_size);
+	}
+
+	if (risk && !s->overflow_risk)
+		sr_warn("Host can't keep up with the device (stalls of %"
+			G_GINT64_FORMAT " us, %" G_GINT64_FORMAT " us per "
+			"transfer), data loss is likely.", s->max_gap,
+			s->avg_processing);
+	else if (!risk && s->overflow_risk)
+		sr_info("Host keeps up with the device again.");
+	s->overflow_risk = risk;
+}
@@ -85,6 +85,53 @@ START_TEST(test_analog_to_float)
 }
 END_TEST
 
+/* Integer encoded samples as sent by the oscilloscope drivers. */
+START_TEST(test_analog_to_float_int)
+{
+	int ret;
+	unsigned int i;
+	float fout[4];
+	struct sr_channel ch;
+	struct sr_datafeed_analog analog;
+	struct sr_analog_encoding encoding;
+	struct sr_analog_meaning meaning;
+	struct sr_analog_spec spec;
+	const uint8_t u8[] = { 0, 100, 128, 255 };
+	const int8_t s8[] = { -128, -25, 0, 127 };
+	const float u8_exp[] = { -5.12, -1.12, 0, 5.08 };
+	const float s8_exp[] = { -5.62, -1.5, -0.5, 4.58 };
+
+	sr_analog_init_(&analog, &encoding, &meaning, &spec, 3);
+	meaning.channels = g_slist_append(NULL, &ch);
+	analog.num_samples = ARRAY_SIZE(u8);
+	encoding.unitsize = 1;
+	encoding.is_float = FALSE;
+
+	/* (raw - 128) * 0.04 */
+	encoding.is_signed = FALSE;
+	sr_rational_set(&encoding.scale, 4, 100);
+	sr_rational_set(&encoding.offset, -512, 100);
+	analog.data = (void *)u8;
+	ret = sr_analog_to_float(&analog, fout);
+	fail_unless(ret == SR_OK, "sr_analog_to_float() failed: %d.", ret);
+	for (i = 0; i < ARRAY_SIZE(u8); i++)
+		fail_unless(fabs(fout[i] - u8_exp[i]) <= 0.001,
+			"[%u] %f != %f", i, fout[i], u8_exp[i]);
+
+	/* raw * 0.04 - 0.5 */
+	encoding.is_signed = TRUE;
+	sr_rational_set(&encoding.offset, -1, 2);
+	analog.data = (void *)s8;
+	ret = sr_analog_to_float(&analog, fout);
+	fail_unless(ret == SR_OK, "sr_analog_to_float() failed: %d.", ret);
+	for (i = 0; i < ARRAY_SIZE(s8); i++)
+		fail_unless(fabs(fout[i] - s8_exp[i]) <= 0.001,
+			"[%u] %f != %f", i, fout[i], s8_exp[i]);
+
+	g_slist_free(meaning.channels);
+}
+END_TEST
+
 START_TEST(test_analog_to_float_null)
 {
 	int ret;
@@ -262,6 +309,40 @@ START_TEST(test_set_rational_null)
 }
 END_TEST
 
+START_TEST(test_rational_from_double)
+{
+	const struct {
+		double value;
+		struct sr_rational r;
+	} v[] = {
+		{ 0, { 0, 1 } },
+		{ 1, { 1, 1 } },
+		{ 0.5, { 1, 2 } },
+		{ -0.004, { -4, 1000 } },
+		{ 1234.5, { 2469, 2 } },
+		{ 0.1 / 25.6, { 390625, 100000000 } },
+		{ 1e9, { 1000000000, 1 } },
+		{ -2.5e-6, { -25, 10000000 } },
+	};
+	struct sr_rational r;
+	unsigned int i;
+	int ret;
+
+	for (i = 0; i < ARRAY_SIZE(v); i++) {
+		ret = sr_rational_from_double(&r, v[i].value);
+		fail_unless(ret == SR_OK, "[%u] failed: %d.", i, ret);
+		fail_unless(sr_rational_eq(&r, &v[i].r) == 1,
+			"[%u] %g: %ld/%lu != %ld/%lu.",
+			i, v[i].value, r.p, r.q, v[i].r.p, v[i].r.q);
+	}
+
+	fail_unless(sr_rational_from_double(&r, NAN) == SR_ERR_ARG);
+	fail_unless(sr_rational_from_double(&r, INFINITY) == SR_ERR_ARG);
+	fail_unless(sr_rational_from_double(&r, 1e19) == SR_ERR_ARG);
+	fail_unless(sr_rational_from_double(NULL, 1) == SR_ERR_ARG);
+}
+END_TEST
+
 START_TEST(test_cmp_rational)
 {
 	const struct sr_rational r[] = { { 1, 1 },
@@ -385,6 +466,7 @@ Suite *suite_analog(void)
 
 	tc = tcase_create("analog_to_float");
 	tcase_add_test(tc, test_analog_to_float);
+	tcase_add_test(tc, test_analog_to_float_int);
 	tcase_add_test(tc, test_analog_to_float_null);
 	tcase_add_test(tc, test_analog_si_prefix);
 	tcase_add_test(tc, test_analog_si_prefix_null);
@@ -392,6 +474,7 @@ Suite *suite_analog(void)
 	tcase_add_test(tc, test_analog_unit_to_string_null);
 	tcase_add_test(tc, test_set_rational);
 	tcase_add_test(tc, test_set_rational_null);
+	tcase_add_test(tc, test_rational_from_double);
 	tcase_add_test(tc, test_cmp_rational);
 	tcase_add_test(tc, test_mult_rational);
 	tcase_add_test(tc, test_div_rational);
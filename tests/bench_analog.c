@@ -0,0 +1,173 @@
+/*
+ * This file is part of the libsigrok project.
+ *
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Benchmark oscilloscope frames sent as native 8bit samples with a
+ * scale/offset encoding against the former float conversion in the
+ * driver. Each frame gets converted (old) or wrapped (new), copied the
+ * way the session copies packets for deferred consumers, and optionally
+ * converted to float by a consumer. Build with "make tests/bench_analog".
+ */
+
+#include <config.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <glib.h>
+#include <libsigrok/libsigrok.h>
+
+#define FRAME_SAMPLES (1024 * 1024)
+#define FRAMES 64
+
+/* Typical rigol-ds V3+ values: 1V/div, 25 ADC steps per division. */
+#define VDIV (1.0 / 25)
+#define VREF 127
+#define ORIGIN 0.0
+
+struct frame {
+	struct sr_datafeed_packet packet;
+	struct sr_datafeed_analog analog;
+	struct sr_analog_encoding encoding;
+	struct sr_analog_meaning meaning;
+	struct sr_analog_spec spec;
+};
+
+static void frame_init(struct frame *f, struct sr_channel *ch)
+{
+	memset(f, 0, sizeof(*f));
+	f->analog.encoding = &f->encoding;
+	f->analog.meaning = &f->meaning;
+	f->analog.spec = &f->spec;
+	f->encoding.unitsize = sizeof(float);
+	f->encoding.is_signed = TRUE;
+	f->encoding.is_float = TRUE;
+#ifdef WORDS_BIGENDIAN
+	f->encoding.is_bigendian = TRUE;
+#endif
+	sr_rational_set(&f->encoding.scale, 1, 1);
+	sr_rational_set(&f->encoding.offset, 0, 1);
+	f->meaning.channels = g_slist_append(NULL, ch);
+	f->meaning.mq = SR_MQ_VOLTAGE;
+	f->meaning.unit = SR_UNIT_VOLT;
+	f->analog.num_samples = FRAME_SAMPLES;
+	f->packet.type = SR_DF_ANALOG;
+	f->packet.payload = &f->analog;
+}
+
+/* Send one frame, consume it, return the first converted value. */
+static float run_frame(struct frame *f, const uint8_t *raw, float *data,
+		float *consumer, gboolean native, gboolean convert)
+{
+	struct sr_datafeed_packet *copy;
+	struct sr_datafeed_analog *analog;
+	unsigned int i;
+	float ret;
+
+	if (native) {
+		f->analog.data = (void *)raw;
+	} else {
+		/* The former rigol_ds_receive() conversion loop. */
+		for (i = 0; i < FRAME_SAMPLES; i++)
+			data[i] = ((int)raw[i] - VREF - ORIGIN) * VDIV;
+		f->analog.data = data;
+	}
+
+	sr_packet_copy(&f->packet, &copy);
+	analog = (struct sr_datafeed_analog *)copy->payload;
+	ret = 0;
+	if (convert) {
+		sr_analog_to_float(analog, consumer);
+		ret = consumer[0];
+	}
+	sr_packet_free(copy);
+
+	return ret;
+}
+
+static double bench(struct frame *f, const uint8_t *raw, float *data,
+		float *consumer, gboolean native, gboolean convert)
+{
+	gint64 start;
+	int i;
+
+	start = g_get_monotonic_time();
+	for (i = 0; i < FRAMES; i++)
+		run_frame(f, raw, data, consumer, native, convert);
+
+	return FRAMES * 1e6 / (g_get_monotonic_time() - start);
+}
+
+int main(void)
+{
+	struct sr_channel ch;
+	struct frame old_f, new_f;
+	uint8_t *raw;
+	float *data, *out_old, *out_new;
+	unsigned int i;
+	int ret;
+
+	raw = g_malloc(FRAME_SAMPLES);
+	data = g_malloc(FRAME_SAMPLES * sizeof(float));
+	out_old = g_malloc(FRAME_SAMPLES * sizeof(float));
+	out_new = g_malloc(FRAME_SAMPLES * sizeof(float));
+	for (i = 0; i < FRAME_SAMPLES; i++)
+		raw[i] = g_random_int();
+
+	frame_init(&old_f, &ch);
+	frame_init(&new_f, &ch);
+	new_f.encoding.unitsize = 1;
+	new_f.encoding.is_signed = FALSE;
+	new_f.encoding.is_float = FALSE;
+	new_f.encoding.is_bigendian = FALSE;
+	sr_rational_from_double(&new_f.encoding.scale, VDIV);
+	sr_rational_from_double(&new_f.encoding.offset, -(VREF + ORIGIN) * VDIV);
+
+	/* Both paths must yield the same values for a float consumer. */
+	run_frame(&old_f, raw, data, out_old, FALSE, TRUE);
+	run_frame(&new_f, raw, data, out_new, TRUE, TRUE);
+	ret = 0;
+	for (i = 0; i < FRAME_SAMPLES; i++) {
+		if (fabsf(out_old[i] - out_new[i]) > 1e-4) {
+			printf("mismatch at %u: %f != %f\n", i,
+				out_old[i], out_new[i]);
+			ret = 1;
+			break;
+		}
+	}
+
+	printf("%u samples/frame, packet size: float %zu bytes, native %zu bytes\n",
+		FRAME_SAMPLES, FRAME_SAMPLES * sizeof(float),
+		(size_t)FRAME_SAMPLES);
+	printf("raw consumer:   float %8.1f frames/s, native %8.1f frames/s\n",
+		bench(&old_f, raw, data, out_old, FALSE, FALSE),
+		bench(&new_f, raw, data, out_new, TRUE, FALSE));
+	printf("float consumer: float %8.1f frames/s, native %8.1f frames/s\n",
+		bench(&old_f, raw, data, out_old, FALSE, TRUE),
+		bench(&new_f, raw, data, out_new, TRUE, TRUE));
+
+	g_slist_free(old_f.meaning.channels);
+	g_slist_free(new_f.meaning.channels);
+	g_free(out_new);
+	g_free(out_old);
+	g_free(data);
+	g_free(raw);
+
+	return ret;
+}
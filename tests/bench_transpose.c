@@ -0,0 +1,202 @@
+/*
+ * This file is part of the libsigrok project.
+ *
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Benchmark sr_logic_transpose16() against the per-driver conversion
+ * loops it replaced. Build with "make tests/bench_transpose".
+ */
+
+#include <config.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <glib.h>
+#include <libsigrok/libsigrok.h>
+
+#define BUF_SIZE (16 * 1024 * 1024)
+#define ROUNDS 8
+
+/* The former dreamsourcelab-dslogic deinterleave_buffer(). */
+static void old_dslogic(const uint8_t *src, size_t length,
+		uint16_t *dst_ptr, size_t channel_count, uint16_t channel_mask)
+{
+	const uint64_t *src_ptr, *word_ptr;
+	unsigned int channel;
+	uint16_t sample, m;
+	int bit;
+
+	for (src_ptr = (const uint64_t *)src;
+			src_ptr < (const uint64_t *)(src + length);
+			src_ptr += channel_count) {
+		for (bit = 0; bit != 64; bit++) {
+			word_ptr = src_ptr;
+			sample = 0;
+			for (channel = 0; channel != 16; channel++) {
+				m = channel_mask >> channel;
+				if (!m)
+					break;
+				if ((m & 1) && ((*word_ptr++ >> bit) & UINT64_C(1)))
+					sample |= 1 << channel;
+			}
+			*dst_ptr++ = sample;
+		}
+	}
+}
+
+/* The former saleae-logic16 convert_sample_data(), without carry-over. */
+static void old_logic16(const uint8_t *src, size_t srccnt, uint16_t *dest,
+		int num_channels, const uint16_t *channel_masks)
+{
+	uint16_t channel_data[16];
+	uint16_t sample;
+	int i, cur_channel;
+
+	memset(channel_data, 0, sizeof(channel_data));
+	cur_channel = 0;
+	srccnt /= 2;
+	while (srccnt--) {
+		sample = src[0] | (src[1] << 8);
+		src += 2;
+		for (i = 15; i >= 0; --i, sample >>= 1)
+			if (sample & 1)
+				channel_data[i] |= channel_masks[cur_channel];
+		if (++cur_channel == num_channels) {
+			cur_channel = 0;
+			memcpy(dest, channel_data, sizeof(channel_data));
+			memset(channel_data, 0, sizeof(channel_data));
+			dest += 16;
+		}
+	}
+}
+
+/* The former saleae-logic-pro conversion loop, without carry-over. */
+static void old_logic_pro(const uint32_t *src, size_t srccnt, uint16_t *dst,
+		unsigned int num_channels, const uint16_t *channel_masks)
+{
+	unsigned int sample_index, batch_index;
+	uint32_t samples;
+
+	batch_index = 0;
+	while (srccnt--) {
+		samples = *src++;
+		if (batch_index == 0)
+			memset(dst, 0, 32 * sizeof(uint16_t));
+		for (sample_index = 0; sample_index <= 31; sample_index++)
+			if ((samples >> (31 - sample_index)) & 1)
+				dst[sample_index] |= channel_masks[batch_index];
+		if (++batch_index == num_channels) {
+			batch_index = 0;
+			dst += 32;
+		}
+	}
+}
+
+static double mbytes_per_sec(gint64 usecs)
+{
+	return (double)BUF_SIZE * ROUNDS / usecs;
+}
+
+static void report(const char *name, unsigned int num_channels,
+		gint64 old_usecs, gint64 new_usecs, gboolean match)
+{
+	printf("%-10s %2u ch: old %8.1f MB/s, new %8.1f MB/s, x%5.2f%s\n",
+		name, num_channels, mbytes_per_sec(old_usecs),
+		mbytes_per_sec(new_usecs), (double)old_usecs / new_usecs,
+		match ? "" : "  MISMATCH");
+}
+
+int main(void)
+{
+	static const unsigned int channel_counts[] = { 1, 3, 8, 9, 16 };
+	uint8_t *src;
+	uint16_t *dst_old, *dst_new, masks[16];
+	size_t length, dst_size, i;
+	unsigned int c, k, num_channels;
+	uint16_t channel_mask;
+	gint64 start, old_usecs, new_usecs;
+	gboolean match;
+	int r, ret;
+
+	src = g_malloc(BUF_SIZE);
+	/* Worst case: one channel, 16 samples per source byte. */
+	dst_size = BUF_SIZE * 16;
+	dst_old = g_malloc(dst_size);
+	dst_new = g_malloc(dst_size);
+	for (i = 0; i < BUF_SIZE; i++)
+		src[i] = g_random_int();
+
+	ret = 0;
+	for (c = 0; c < G_N_ELEMENTS(channel_counts); c++) {
+		num_channels = channel_counts[c];
+		channel_mask = 0;
+		for (k = 0; k < num_channels; k++) {
+			masks[k] = 1 << k;
+			channel_mask |= masks[k];
+		}
+
+		length = BUF_SIZE - BUF_SIZE % (num_channels * 8);
+		start = g_get_monotonic_time();
+		for (r = 0; r < ROUNDS; r++)
+			old_dslogic(src, length, dst_old, num_channels, channel_mask);
+		old_usecs = g_get_monotonic_time() - start;
+		start = g_get_monotonic_time();
+		for (r = 0; r < ROUNDS; r++)
+			sr_logic_transpose16(dst_new, src, length / (num_channels * 8),
+				num_channels, 8, masks, FALSE);
+		new_usecs = g_get_monotonic_time() - start;
+		match = !memcmp(dst_old, dst_new, length / num_channels * 16);
+		report("dslogic", num_channels, old_usecs, new_usecs, match);
+		ret |= !match;
+
+		length = BUF_SIZE - BUF_SIZE % (num_channels * 2);
+		start = g_get_monotonic_time();
+		for (r = 0; r < ROUNDS; r++)
+			old_logic16(src, length, dst_old, num_channels, masks);
+		old_usecs = g_get_monotonic_time() - start;
+		start = g_get_monotonic_time();
+		for (r = 0; r < ROUNDS; r++)
+			sr_logic_transpose16(dst_new, src, length / (num_channels * 2),
+				num_channels, 2, masks, TRUE);
+		new_usecs = g_get_monotonic_time() - start;
+		match = !memcmp(dst_old, dst_new, length / num_channels * 16);
+		report("logic16", num_channels, old_usecs, new_usecs, match);
+		ret |= !match;
+
+		length = BUF_SIZE - BUF_SIZE % (num_channels * 4);
+		start = g_get_monotonic_time();
+		for (r = 0; r < ROUNDS; r++)
+			old_logic_pro((const uint32_t *)src, length / 4, dst_old,
+				num_channels, masks);
+		old_usecs = g_get_monotonic_time() - start;
+		start = g_get_monotonic_time();
+		for (r = 0; r < ROUNDS; r++)
+			sr_logic_transpose16(dst_new, src, length / (num_channels * 4),
+				num_channels, 4, masks, TRUE);
+		new_usecs = g_get_monotonic_time() - start;
+		match = !memcmp(dst_old, dst_new, length / num_channels * 16);
+		report("logic-pro", num_channels, old_usecs, new_usecs, match);
+		ret |= !match;
+	}
+
+	g_free(dst_new);
+	g_free(dst_old);
+	g_free(src);
+
+	return ret;
+}
@@ -19,6 +19,8 @@
 
 #include <config.h>
 #include <check.h>
+#include <string.h>
+#include <unistd.h>
 #include <glib/gstdio.h>
 #include <libsigrok/libsigrok.h>
 #include "lib.h"
@@ -29,6 +31,7 @@ enum {
 	CHECK_ALL_LOW,
 	CHECK_ALL_HIGH,
 	CHECK_HELLO_WORLD,
+	CHECK_HELLO_WORLD_INVERTED,
 };
 
 static uint64_t df_packet_counter = 0, sample_counter = 0;
@@ -76,6 +79,20 @@ static void check_hello_world(const struct sr_datafeed_logic *logic)
 	}
 }
 
+static void check_hello_world_inverted(const struct sr_datafeed_logic *logic)
+{
+	uint64_t i;
+	uint8_t *data, b;
+	const char *h = "Hello world";
+
+	for (i = 0; i < logic->length; i++) {
+		data = logic->data;
+		b = ~data[sample_counter + i];
+		if (b != h[sample_counter + i])
+			fail("Logic data was not inverted 'Hello world'.");
+	}
+}
+
 static void datafeed_in(const struct sr_dev_inst *sdi,
 	const struct sr_datafeed_packet *packet, void *cb_data)
 {
@@ -158,6 +175,8 @@ static void datafeed_in(const struct sr_dev_inst *sdi,
 			check_all_high(logic);
 		else if (check_to_perform == CHECK_HELLO_WORLD)
 			check_hello_world(logic);
+		else if (check_to_perform == CHECK_HELLO_WORLD_INVERTED)
+			check_hello_world_inverted(logic);
 
 		sample_counter += logic->length / logic->unitsize;
 
@@ -308,6 +327,85 @@ START_TEST(test_input_binary_hello_world)
 }
 END_TEST
 
+static void check_mapped(gboolean invert)
+{
+	const struct sr_input_module *imod;
+	const struct sr_input *in;
+	const struct sr_transform *t;
+	struct sr_session *session;
+	struct sr_dev_inst *sdi;
+	gboolean done;
+	gchar *filename, *contents;
+	int fd, ret;
+
+	df_packet_counter = sample_counter = 0;
+	have_seen_df_end = FALSE;
+	logic_channellist = NULL;
+	check_to_perform = invert ? CHECK_HELLO_WORLD_INVERTED : CHECK_HELLO_WORLD;
+	expected_samples = 11;
+	expected_samplerate = NULL;
+
+	fd = g_file_open_tmp("sr-test-XXXXXX", &filename, NULL);
+	fail_unless(fd >= 0, "Failed to create temporary file.");
+	fail_unless(write(fd, "Hello world", 11) == 11);
+	close(fd);
+
+	imod = sr_input_find("binary");
+	fail_unless(imod != NULL, "Failed to find input module.");
+	in = sr_input_new(imod, NULL);
+	fail_unless(in != NULL, "Failed to create input instance.");
+
+	ret = sr_input_map_file(in, filename);
+	fail_unless(ret == SR_OK, "sr_input_map_file() error: %d", ret);
+
+	sr_session_new(srtest_ctx, &session);
+	sr_session_datafeed_callback_add(session, datafeed_in, NULL);
+
+	sdi = NULL;
+	t = NULL;
+	do {
+		ret = sr_input_send_mapped(in, &done);
+		fail_unless(ret == SR_OK, "sr_input_send_mapped() error: %d", ret);
+		if (!sdi && (sdi = sr_input_dev_inst_get(in))) {
+			sr_session_dev_add(session, sdi);
+			/* The invert transform modifies packet data in place. */
+			if (invert) {
+				t = sr_transform_new(sr_transform_find("invert"),
+					NULL, sdi);
+				fail_unless(t != NULL, "Failed to create transform.");
+			}
+		}
+	} while (!done);
+	fail_unless(sdi != NULL, "Input device instance never got ready.");
+
+	ret = sr_input_end(in);
+	fail_unless(ret == SR_OK, "sr_input_end() error: %d", ret);
+	fail_unless(have_seen_df_end, "No SR_DF_END packet was sent.");
+
+	sr_input_free(in);
+	sr_session_destroy(session);
+	sr_transform_free(t);
+
+	/* The file itself must not have been modified. */
+	fail_unless(g_file_get_contents(filename, &contents, NULL, NULL));
+	fail_unless(!strcmp(contents, "Hello world"), "File was modified.");
+	g_free(contents);
+	g_unlink(filename);
+	g_free(filename);
+}
+
+START_TEST(test_input_binary_mapped)
+{
+	check_mapped(FALSE);
+}
+END_TEST
+
+START_TEST(test_input_binary_mapped_invert)
+{
+	check_mapped(TRUE);
+}
+END_TEST
+
 Suite *suite_input_binary(void)
 {
 	Suite *s;
@@ -321,6 +419,8 @@ Suite *suite_input_binary(void)
 	tcase_add_test(tc, test_input_binary_all_high);
 	tcase_add_loop_test(tc, test_input_binary_all_high_loop, 1, 10);
 	tcase_add_test(tc, test_input_binary_hello_world);
+	tcase_add_test(tc, test_input_binary_mapped);
+	tcase_add_test(tc, test_input_binary_mapped_invert);
 	suite_add_tcase(s, tc);
 
 	return s;
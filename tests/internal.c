@@ -0,0 +1,139 @@
+/*
+ * This file is part of the libsigrok project.
+ *
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Tests of internal (SR_PRIV) code, which tests/main can't reach through
+ * the shared library. The code under test is built into this program,
+ * and the few library functions it calls are replaced below.
+ */
+
+#include <config.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <check.h>
+#include <libsigrok/libsigrok.h>
+#include "libsigrok-internal.h"
+#include "internal.h"
+
+GString *srtest_sent_logic;
+int srtest_sent_triggers;
+
+SR_PRIV int sr_session_send(const struct sr_dev_inst *sdi,
+		const struct sr_datafeed_packet *packet)
+{
+	const struct sr_datafeed_logic *logic;
+
+	(void)sdi;
+
+	if (packet->type == SR_DF_LOGIC) {
+		logic = packet->payload;
+		g_string_append_len(srtest_sent_logic, logic->data,
+			logic->length);
+	} else if (packet->type == SR_DF_TRIGGER) {
+		srtest_sent_triggers++;
+	}
+
+	return SR_OK;
+}
+
+void srtest_sent_reset(void)
+{
+	g_string_truncate(srtest_sent_logic, 0);
+	srtest_sent_triggers = 0;
+}
+
+/* Add an enabled channel of the given type, with the next free index. */
+struct sr_channel *srtest_channel_add(struct sr_dev_inst *sdi, int type,
+		const char *name)
+{
+	struct sr_channel *ch;
+
+	ch = g_malloc0(sizeof(struct sr_channel));
+	ch->sdi = sdi;
+	ch->index = g_slist_length(sdi->channels);
+	ch->type = type;
+	ch->enabled = TRUE;
+	ch->name = g_strdup(name);
+	sdi->channels = g_slist_append(sdi->channels, ch);
+
+	return ch;
+}
+
+/* Create a device instance with logic channels D0 to D<n-1>. */
+struct sr_dev_inst *srtest_dev_new(int num_logic_channels)
+{
+	struct sr_dev_inst *sdi;
+	char name[16];
+	int i;
+
+	sdi = g_malloc0(sizeof(struct sr_dev_inst));
+	for (i = 0; i < num_logic_channels; i++) {
+		snprintf(name, sizeof(name), "D%d", i);
+		srtest_channel_add(sdi, SR_CHANNEL_LOGIC, name);
+	}
+
+	return sdi;
+}
+
+static void channel_free(void *data)
+{
+	struct sr_channel *ch;
+
+	ch = data;
+	g_free(ch->name);
+	g_free(ch);
+}
+
+void srtest_dev_free(struct sr_dev_inst *sdi)
+{
+	g_slist_free_full(sdi->channels, channel_free);
+	g_free(sdi);
+}
+
+/* Add a match on the channel with the given index to a trigger stage. */
+void srtest_match_add(struct sr_trigger_stage *stage,
+		const struct sr_dev_inst *sdi, int index, int match)
+{
+	fail_unless(sr_trigger_match_add(stage,
+		g_slist_nth_data(sdi->channels, index), match, 0) == SR_OK);
+}
+
+int main(void)
+{
+	int ret;
+	Suite *s;
+	SRunner *srunner;
+
+	srtest_sent_logic = g_string_new(NULL);
+
+	s = suite_create("internalsuite");
+	srunner = srunner_create(s);
+
+	srunner_add_suite(srunner, suite_log());
+	srunner_add_suite(srunner, suite_soft_trigger());
+	srunner_add_suite(srunner, suite_trigger_plan());
+
+	srunner_run_all(srunner, CK_VERBOSE);
+	ret = srunner_ntests_failed(srunner);
+	srunner_free(srunner);
+
+	g_string_free(srtest_sent_logic, TRUE);
+
+	return (ret == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,44 @@
+/*
+ * This file is part of the libsigrok project.
+ *
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef LIBSIGROK_TESTS_INTERNAL_H
+#define LIBSIGROK_TESTS_INTERNAL_H
+
+#include <glib.h>
+#include <libsigrok/libsigrok.h>
+
+/* Logic data of the packets passed to sr_session_send(). */
+extern GString *srtest_sent_logic;
+/* Number of SR_DF_TRIGGER packets passed to sr_session_send(). */
+extern int srtest_sent_triggers;
+
+void srtest_sent_reset(void);
+
+struct sr_channel *srtest_channel_add(struct sr_dev_inst *sdi, int type,
+		const char *name);
+struct sr_dev_inst *srtest_dev_new(int num_logic_channels);
+void srtest_dev_free(struct sr_dev_inst *sdi);
+void srtest_match_add(struct sr_trigger_stage *stage,
+		const struct sr_dev_inst *sdi, int index, int match);
+
+Suite *suite_log(void);
+Suite *suite_soft_trigger(void);
+Suite *suite_trigger_plan(void);
+
+#endif
@@ -0,0 +1,209 @@
+/*
+ * This file is part of the libsigrok project.
+ *
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <config.h>
+#include <stdarg.h>
+#include <string.h>
+#include <check.h>
+#include <libsigrok/libsigrok.h>
+#include "libsigrok-internal.h"
+#include "internal.h"
+
+#define LOG_PREFIX "test"
+
+/* Messages received by record_log(), one per line. */
+static GString *log_text;
+
+/* When set, record_log() blocks on the next message until released. */
+static gboolean log_block;
+static GAsyncQueue *log_entered;
+static GMutex log_release;
+
+static int record_log(void *cb_data, int loglevel, const char *format,
+		va_list args)
+{
+	GString *text;
+
+	(void)loglevel;
+
+	text = cb_data;
+	g_string_append_vprintf(text, format, args);
+	g_string_append_c(text, '\n');
+
+	if (log_block) {
+		log_block = FALSE;
+		g_async_queue_push(log_entered, text);
+		g_mutex_lock(&log_release);
+		g_mutex_unlock(&log_release);
+	}
+
+	return SR_OK;
+}
+
+/* Log the messages "msg <first>" to "msg <last>". */
+static void log_msgs(int first, int last)
+{
+	int i;
+
+	for (i = first; i <= last; i++)
+		sr_info("msg %d", i);
+}
+
+/*
+ * Keep the log thread busy with a message until log_release gets
+ * unlocked. Meanwhile, the other entries can be filled.
+ */
+static void log_hold_thread(void)
+{
+	log_block = TRUE;
+	g_mutex_lock(&log_release);
+	sr_info("held");
+	g_async_queue_pop(log_entered);
+}
+
+static void setup(void)
+{
+	log_text = g_string_new(NULL);
+	log_entered = g_async_queue_new();
+	sr_log_loglevel_set(SR_LOG_INFO);
+	sr_log_callback_set(record_log, log_text);
+}
+
+static void teardown(void)
+{
+	sr_log_async_stop();
+	sr_log_callback_set_default();
+	sr_log_loglevel_set(SR_LOG_WARN);
+	g_async_queue_unref(log_entered);
+	g_string_free(log_text, TRUE);
+}
+
+/* Pending messages are delivered in order when the sink stops. */
+START_TEST(test_log_async_order)
+{
+	fail_unless(sr_log_async_start(4) == SR_OK);
+	fail_unless(sr_log_async_start(4) == SR_ERR_ARG);
+	log_msgs(0, 2);
+	fail_unless(sr_log_async_stop() == SR_OK);
+	fail_unless(!strcmp(log_text->str,
+		"test: msg 0\ntest: msg 1\ntest: msg 2\n"));
+
+	/* Without the sink, messages are delivered right away. */
+	g_string_truncate(log_text, 0);
+	log_msgs(3, 3);
+	fail_unless(!strcmp(log_text->str, "test: msg 3\n"));
+	fail_unless(sr_log_async_stop() == SR_OK);
+}
+END_TEST
+
+/* Messages which find all entries in use are counted before the next. */
+START_TEST(test_log_async_full)
+{
+	fail_unless(sr_log_async_start(2) == SR_OK);
+	log_hold_thread();
+	/* The second entry takes msg 0, the rest gets dropped. */
+	log_msgs(0, 2);
+	g_mutex_unlock(&log_release);
+	fail_unless(sr_log_async_stop() == SR_OK);
+	fail_unless(!strcmp(log_text->str, "test: held\n"
+		"log: 2 messages dropped, log buffer full.\n"
+		"test: msg 0\n"));
+}
+END_TEST
+
+/* A loss without further messages is reported when the sink stops. */
+START_TEST(test_log_async_full_stop)
+{
+	fail_unless(sr_log_async_start(1) == SR_OK);
+	log_hold_thread();
+	log_msgs(0, 2);
+	g_mutex_unlock(&log_release);
+	fail_unless(sr_log_async_stop() == SR_OK);
+	fail_unless(!strcmp(log_text->str, "test: held\n"
+		"log: 3 messages dropped, log buffer full.\n"));
+}
+END_TEST
+
+/* The log thread uses the callback data which was set with the callback. */
+START_TEST(test_log_async_callback_set)
+{
+	GString *other;
+
+	other = g_string_new(NULL);
+	fail_unless(sr_log_async_start(4) == SR_OK);
+	log_hold_thread();
+	sr_log_callback_set(record_log, other);
+	log_msgs(0, 0);
+	g_mutex_unlock(&log_release);
+	fail_unless(sr_log_async_stop() == SR_OK);
+	fail_unless(!strcmp(log_text->str, "test: held\n"));
+	fail_unless(!strcmp(other->str, "test: msg 0\n"));
+	g_string_free(other, TRUE);
+}
+END_TEST
+
+/* The arguments of disabled messages are not evaluated. */
+START_TEST(test_log_disabled_args)
+{
+	int n;
+	uint8_t data[2];
+
+	n = 0;
+	data[0] = 0x12;
+	data[1] = 0x34;
+	sr_dbg("%d", n++);
+	sr_spew("%d", n++);
+	sr_dbg_hexdump("data:", data, n++);
+	fail_unless(n == 0);
+	fail_unless(log_text->len == 0);
+
+	sr_info("%d", n++);
+	fail_unless(n == 1);
+	fail_unless(!strcmp(log_text->str, "test: 0\n"));
+
+	sr_log_loglevel_set(SR_LOG_DBG);
+	g_string_truncate(log_text, 0);
+	sr_dbg_hexdump("data:", data, ++n);
+	fail_unless(n == 2);
+	fail_unless(!strcmp(log_text->str, "test: data: 12 34\n"));
+}
+END_TEST
+
+Suite *suite_log(void)
+{
+	Suite *s;
+	TCase *tc;
+
+	s = suite_create("log");
+
+	tc = tcase_create("async");
+	tcase_add_checked_fixture(tc, setup, teardown);
+	tcase_add_test(tc, test_log_async_order);
+	tcase_add_test(tc, test_log_async_full);
+	tcase_add_test(tc, test_log_async_full_stop);
+	tcase_add_test(tc, test_log_async_callback_set);
+	suite_add_tcase(s, tc);
+
+	tc = tcase_create("lazy");
+	tcase_add_checked_fixture(tc, setup, teardown);
+	tcase_add_test(tc, test_log_disabled_args);
+	suite_add_tcase(s, tc);
+
+	return s;
+}
@@ -0,0 +1,201 @@
+/*
+ * This file is part of the libsigrok project.
+ *
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <config.h>
+#include <stdlib.h>
+#include <string.h>
+#include <check.h>
+#include <libsigrok/libsigrok.h>
+#include "lib.h"
+
+static uint16_t rle_values[] = { 0x1234, 0x0000, 0xffff };
+static uint64_t rle_lengths[] = { 3, 1, 4 };
+static const uint16_t rle_expanded[] = {
+	0x1234, 0x1234, 0x1234, 0x0000, 0xffff, 0xffff, 0xffff, 0xffff,
+};
+
+static void init_rle(struct sr_datafeed_logic_rle *rle)
+{
+	rle->num_runs = ARRAY_SIZE(rle_lengths);
+	rle->unitsize = sizeof(rle_values[0]);
+	rle->data = rle_values;
+	rle->lengths = rle_lengths;
+}
+
+/* Check whether sr_logic_rle_num_samples() works. */
+START_TEST(test_logic_rle_num_samples)
+{
+	struct sr_datafeed_logic_rle rle;
+
+	init_rle(&rle);
+	fail_unless(sr_logic_rle_num_samples(&rle) == ARRAY_SIZE(rle_expanded));
+	fail_unless(sr_logic_rle_num_samples(NULL) == 0);
+}
+END_TEST
+
+/* Check whether sr_logic_rle_expand() works in one go. */
+START_TEST(test_logic_rle_expand)
+{
+	struct sr_datafeed_logic_rle rle;
+	struct sr_logic_rle_pos pos;
+	uint16_t buf[ARRAY_SIZE(rle_expanded) + 2];
+	uint64_t n;
+
+	init_rle(&rle);
+	memset(&pos, 0, sizeof(pos));
+	n = sr_logic_rle_expand(&rle, &pos, buf, ARRAY_SIZE(buf));
+	fail_unless(n == ARRAY_SIZE(rle_expanded), "Got %" PRIu64 " samples.", n);
+	fail_unless(!memcmp(buf, rle_expanded, sizeof(rle_expanded)));
+	fail_unless(sr_logic_rle_expand(&rle, &pos, buf, ARRAY_SIZE(buf)) == 0);
+}
+END_TEST
+
+/* Check whether sr_logic_rle_expand() resumes across run boundaries. */
+START_TEST(test_logic_rle_expand_piecewise)
+{
+	struct sr_datafeed_logic_rle rle;
+	struct sr_logic_rle_pos pos;
+	uint16_t buf[ARRAY_SIZE(rle_expanded)];
+	uint64_t n, total;
+
+	init_rle(&rle);
+	memset(&pos, 0, sizeof(pos));
+	total = 0;
+	while ((n = sr_logic_rle_expand(&rle, &pos, buf + total, 2)) > 0) {
+		fail_unless(n <= 2);
+		total += n;
+		fail_unless(total <= ARRAY_SIZE(buf));
+	}
+	fail_unless(total == ARRAY_SIZE(rle_expanded));
+	fail_unless(!memcmp(buf, rle_expanded, sizeof(rle_expanded)));
+}
+END_TEST
+
+/* Check whether sr_logic_rle_expand() fails gracefully on bad args. */
+START_TEST(test_logic_rle_expand_null)
+{
+	struct sr_datafeed_logic_rle rle;
+	struct sr_logic_rle_pos pos;
+	uint16_t buf[4];
+
+	init_rle(&rle);
+	memset(&pos, 0, sizeof(pos));
+	fail_unless(sr_logic_rle_expand(NULL, &pos, buf, 4) == 0);
+	fail_unless(sr_logic_rle_expand(&rle, NULL, buf, 4) == 0);
+	fail_unless(sr_logic_rle_expand(&rle, &pos, NULL, 4) == 0);
+}
+END_TEST
+
+/* Naive transpose, one bit at a time. */
+static void transpose_ref(uint16_t *dst, const uint8_t *src, size_t num_blocks,
+		unsigned int num_planes, unsigned int plane_bytes,
+		const uint16_t *masks, gboolean msb_first)
+{
+	size_t b;
+	unsigned int s, k, bit;
+	uint16_t sample;
+
+	for (b = 0; b < num_blocks; b++) {
+		for (s = 0; s < plane_bytes * 8; s++) {
+			bit = msb_first ? plane_bytes * 8 - 1 - s : s;
+			sample = 0;
+			for (k = 0; k < num_planes; k++) {
+				if ((src[k * plane_bytes + bit / 8] >> (bit % 8)) & 1)
+					sample |= masks ? masks[k] : (1 << k);
+			}
+			*dst++ = sample;
+		}
+		src += num_planes * plane_bytes;
+	}
+}
+
+/* Check sr_logic_transpose16() against the naive version. */
+START_TEST(test_logic_transpose16)
+{
+	static const unsigned int plane_sizes[] = { 1, 2, 4, 8 };
+	uint8_t src[3 * 16 * 8];
+	uint16_t masks[16], expected[3 * 64], result[3 * 64];
+	unsigned int i, k, p, num_planes, plane_bytes;
+	int msb_first, use_masks;
+
+	srand(1);
+	for (i = 0; i < sizeof(src); i++)
+		src[i] = rand();
+	/* Planes for scattered channels, in reverse order. */
+	for (k = 0; k < 16; k++)
+		masks[k] = 1 << ((15 - k) ^ 3);
+
+	for (num_planes = 1; num_planes <= 16; num_planes++) {
+		for (p = 0; p < ARRAY_SIZE(plane_sizes); p++) {
+			plane_bytes = plane_sizes[p];
+			for (i = 0; i < 4; i++) {
+				msb_first = i & 1;
+				use_masks = i & 2;
+				transpose_ref(expected, src, 3, num_planes,
+					plane_bytes, use_masks ? masks : NULL,
+					msb_first);
+				fail_unless(sr_logic_transpose16(result, src, 3,
+					num_planes, plane_bytes,
+					use_masks ? masks : NULL, msb_first) == SR_OK);
+				fail_unless(!memcmp(result, expected,
+					3 * plane_bytes * 8 * sizeof(uint16_t)),
+					"Mismatch for %u planes of %u bytes (%d).",
+					num_planes, plane_bytes, i);
+			}
+		}
+	}
+}
+END_TEST
+
+/* Check whether sr_logic_transpose16() rejects invalid arguments. */
+START_TEST(test_logic_transpose16_args)
+{
+	uint8_t src[2 * 17];
+	uint16_t dst[16];
+
+	memset(src, 0, sizeof(src));
+	fail_unless(sr_logic_transpose16(NULL, src, 1, 1, 2, NULL, FALSE) == SR_ERR_ARG);
+	fail_unless(sr_logic_transpose16(dst, NULL, 1, 1, 2, NULL, FALSE) == SR_ERR_ARG);
+	fail_unless(sr_logic_transpose16(dst, src, 1, 0, 2, NULL, FALSE) == SR_ERR_ARG);
+	fail_unless(sr_logic_transpose16(dst, src, 1, 17, 2, NULL, FALSE) == SR_ERR_ARG);
+	fail_unless(sr_logic_transpose16(dst, src, 1, 1, 0, NULL, FALSE) == SR_ERR_ARG);
+}
+END_TEST
+
+Suite *suite_logic(void)
+{
+	Suite *s;
+	TCase *tc;
+
+	s = suite_create("logic");
+
+	tc = tcase_create("logic_rle");
+	tcase_add_test(tc, test_logic_rle_num_samples);
+	tcase_add_test(tc, test_logic_rle_expand);
+	tcase_add_test(tc, test_logic_rle_expand_piecewise);
+	tcase_add_test(tc, test_logic_rle_expand_null);
+	suite_add_tcase(s, tc);
+
+	tc = tcase_create("logic_transpose");
+	tcase_add_test(tc, test_logic_transpose16);
+	tcase_add_test(tc, test_logic_transpose16_args);
+	suite_add_tcase(s, tc);
+
+	return s;
+}
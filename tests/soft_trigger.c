@@ -0,0 +1,366 @@
+/*
+ * This file is part of the libsigrok project.
+ *
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <config.h>
+#include <stdio.h>
+#include <string.h>
+#include <check.h>
+#include <libsigrok/libsigrok.h>
+#include "libsigrok-internal.h"
+#include "internal.h"
+
+#define NUM_SAMPLES 4096
+#define PRE_TRIGGER_SAMPLES 16
+
+static const int unitsizes[] = { 1, 2, 3, 5 };
+static const int chunk_samples[] = { 1, 3, 7, 64, 1000, NUM_SAMPLES };
+
+struct soft_trigger_result {
+	int trigger;
+	int pre_trigger_samples;
+	int triggers;
+	GString *sent;
+};
+
+/*
+ * Random samples made of runs of 1 to 1000 equal samples, so that both
+ * short patterns and long constant stretches occur. Only a few bits
+ * change from one run to the next.
+ */
+static uint8_t *data_new(int unitsize, uint32_t seed)
+{
+	uint8_t *data, *p;
+	uint32_t x;
+	int i, run;
+
+	data = g_malloc0(NUM_SAMPLES * unitsize);
+	x = seed;
+	run = 0;
+	for (i = 0, p = data; i < NUM_SAMPLES; i++, p += unitsize) {
+		if (i > 0)
+			memcpy(p, p - unitsize, unitsize);
+		if (run-- > 0)
+			continue;
+		/* xorshift32 */
+		x ^= x << 13;
+		x ^= x >> 17;
+		x ^= x << 5;
+		p[x % unitsize] ^= 1 << ((x >> 8) % 8);
+		p[0] ^= (x >> 16) & 0x0f;
+		run = (x >> 20) % 4 ? (x >> 20) % 8 : (x >> 22) % 1000;
+	}
+
+	return data;
+}
+
+/* Feed the samples to a soft trigger in chunks, like a driver does. */
+static void run(struct sr_dev_inst *sdi, struct sr_trigger *trigger,
+		const uint8_t *data, int chunk, gboolean use_masks,
+		struct soft_trigger_result *res)
+{
+	struct soft_trigger_logic *stl;
+	uint8_t *buf;
+	int unitsize, pos, num, ret;
+
+	stl = soft_trigger_logic_new(sdi, trigger, PRE_TRIGGER_SAMPLES);
+	fail_unless(stl != NULL);
+	fail_unless(stl->masks != NULL);
+	if (!use_masks) {
+		g_free(stl->masks);
+		stl->masks = NULL;
+	}
+	unitsize = stl->unitsize;
+
+	srtest_sent_reset();
+	res->trigger = -1;
+	res->pre_trigger_samples = -1;
+	for (pos = 0; pos < NUM_SAMPLES; pos += num) {
+		num = MIN(chunk, NUM_SAMPLES - pos);
+		/* A copy, so that reads past the chunk get caught. */
+		buf = g_malloc(num * unitsize);
+		memcpy(buf, data + pos * unitsize, num * unitsize);
+		ret = soft_trigger_logic_check(stl, buf, num * unitsize,
+			&res->pre_trigger_samples);
+		g_free(buf);
+		if (ret >= 0) {
+			res->trigger = pos + ret;
+			break;
+		}
+	}
+	res->triggers = srtest_sent_triggers;
+	res->sent = g_string_new_len(srtest_sent_logic->str,
+		srtest_sent_logic->len);
+
+	soft_trigger_logic_free(stl);
+}
+
+/*
+ * Run the samples through the mask path and the per-match path, in
+ * chunks of all sizes. Returns the sample at which the trigger fired,
+ * or -1.
+ */
+static int compare(struct sr_dev_inst *sdi, struct sr_trigger *trigger,
+		const uint8_t *data)
+{
+	struct soft_trigger_result masks, matches;
+	unsigned int i;
+	int trigger_pos;
+
+	trigger_pos = -2;
+	for (i = 0; i < ARRAY_SIZE(chunk_samples); i++) {
+		run(sdi, trigger, data, chunk_samples[i], TRUE, &masks);
+		run(sdi, trigger, data, chunk_samples[i], FALSE, &matches);
+		fail_unless(masks.trigger == matches.trigger,
+			"Trigger at %d with masks, at %d per match (chunk %d).",
+			masks.trigger, matches.trigger, chunk_samples[i]);
+		fail_unless(masks.triggers == matches.triggers);
+		fail_unless(masks.triggers == (masks.trigger >= 0));
+		if (masks.trigger >= 0)
+			fail_unless(masks.pre_trigger_samples ==
+				matches.pre_trigger_samples);
+		fail_unless(g_string_equal(masks.sent, matches.sent));
+		/* The chunk size must not make a difference either. */
+		if (trigger_pos != -2)
+			fail_unless(masks.trigger == trigger_pos);
+		trigger_pos = masks.trigger;
+		g_string_free(masks.sent, TRUE);
+		g_string_free(matches.sent, TRUE);
+	}
+
+	return trigger_pos;
+}
+
+/* Single stage level trigger, on the first and the last channel. */
+START_TEST(test_soft_trigger_level)
+{
+	struct sr_dev_inst *sdi;
+	struct sr_trigger *t;
+	struct sr_trigger_stage *s;
+	uint8_t *data;
+	unsigned int i;
+	uint32_t seed;
+	int n;
+
+	for (i = 0; i < ARRAY_SIZE(unitsizes); i++) {
+		n = unitsizes[i] * 8;
+		sdi = srtest_dev_new(n);
+		t = sr_trigger_new(NULL);
+		s = sr_trigger_stage_add(t);
+		srtest_match_add(s, sdi, 0, SR_TRIGGER_ONE);
+		srtest_match_add(s, sdi, n - 1, SR_TRIGGER_ZERO);
+		for (seed = 1; seed <= 8; seed++) {
+			data = data_new(unitsizes[i], seed);
+			compare(sdi, t, data);
+			g_free(data);
+		}
+		sr_trigger_free(t);
+		srtest_dev_free(sdi);
+	}
+}
+END_TEST
+
+/* Single stage edge triggers, combined with a level. */
+START_TEST(test_soft_trigger_edge)
+{
+	struct sr_dev_inst *sdi;
+	struct sr_trigger *t;
+	struct sr_trigger_stage *s;
+	uint8_t *data;
+	unsigned int i;
+	uint32_t seed;
+	int m, n;
+
+	for (i = 0; i < ARRAY_SIZE(unitsizes); i++) {
+		n = unitsizes[i] * 8;
+		sdi = srtest_dev_new(n);
+		for (m = SR_TRIGGER_RISING; m <= SR_TRIGGER_EDGE; m++) {
+			t = sr_trigger_new(NULL);
+			s = sr_trigger_stage_add(t);
+			srtest_match_add(s, sdi, 2, m);
+			srtest_match_add(s, sdi, n - 3, SR_TRIGGER_ONE);
+			for (seed = 1; seed <= 8; seed++) {
+				data = data_new(unitsizes[i], seed);
+				compare(sdi, t, data);
+				g_free(data);
+			}
+			sr_trigger_free(t);
+		}
+		srtest_dev_free(sdi);
+	}
+}
+END_TEST
+
+/* Multi-stage triggers mixing levels and edges. */
+START_TEST(test_soft_trigger_multi_stage)
+{
+	struct sr_dev_inst *sdi;
+	struct sr_trigger *t;
+	struct sr_trigger_stage *s;
+	uint8_t *data;
+	unsigned int i;
+	uint32_t seed;
+	int n;
+
+	for (i = 0; i < ARRAY_SIZE(unitsizes); i++) {
+		n = unitsizes[i] * 8;
+		sdi = srtest_dev_new(n);
+		t = sr_trigger_new(NULL);
+		s = sr_trigger_stage_add(t);
+		srtest_match_add(s, sdi, 0, SR_TRIGGER_EDGE);
+		s = sr_trigger_stage_add(t);
+		srtest_match_add(s, sdi, 1, SR_TRIGGER_ONE);
+		s = sr_trigger_stage_add(t);
+		srtest_match_add(s, sdi, 2, SR_TRIGGER_ZERO);
+		srtest_match_add(s, sdi, n - 1, SR_TRIGGER_ONE);
+		for (seed = 1; seed <= 32; seed++) {
+			data = data_new(unitsizes[i], seed);
+			compare(sdi, t, data);
+			g_free(data);
+		}
+		sr_trigger_free(t);
+		srtest_dev_free(sdi);
+	}
+}
+END_TEST
+
+/*
+ * A partial match at the end of one buffer which fails in the next.
+ * The check has to go back to the sample after the first stage match,
+ * with the right previous sample for the edge match.
+ */
+START_TEST(test_soft_trigger_partial_match)
+{
+	static const uint8_t samples[] = { 0x00, 0x01, 0x00, 0x02 };
+	struct sr_dev_inst *sdi;
+	struct sr_trigger *t;
+	struct sr_trigger_stage *s;
+	struct soft_trigger_result res;
+	uint8_t *data;
+	int use_masks;
+
+	sdi = srtest_dev_new(8);
+	t = sr_trigger_new(NULL);
+	s = sr_trigger_stage_add(t);
+	srtest_match_add(s, sdi, 0, SR_TRIGGER_EDGE);
+	s = sr_trigger_stage_add(t);
+	srtest_match_add(s, sdi, 1, SR_TRIGGER_ONE);
+
+	/*
+	 * Sample 1 matches stage 1, sample 2 fails stage 2 but matches
+	 * stage 1 again (falling edge), sample 3 matches stage 2.
+	 */
+	data = g_malloc0(NUM_SAMPLES);
+	memcpy(data + 100, samples, sizeof(samples));
+	memset(data + 104, 0x02, NUM_SAMPLES - 104);
+	fail_unless(compare(sdi, t, data) == 103);
+
+	/* The same, split right after the first stage match. */
+	for (use_masks = 0; use_masks <= 1; use_masks++) {
+		run(sdi, t, data, 102, use_masks, &res);
+		fail_unless(res.trigger == 103);
+		fail_unless(res.pre_trigger_samples == PRE_TRIGGER_SAMPLES);
+		g_string_free(res.sent, TRUE);
+	}
+
+	g_free(data);
+	sr_trigger_free(t);
+	srtest_dev_free(sdi);
+}
+END_TEST
+
+/* A trigger right after a long constant run, at any alignment. */
+START_TEST(test_soft_trigger_long_run)
+{
+	struct sr_dev_inst *sdi;
+	struct sr_trigger *t;
+	struct sr_trigger_stage *s;
+	uint8_t *data;
+	unsigned int i;
+	int n, pos;
+
+	for (i = 0; i < ARRAY_SIZE(unitsizes); i++) {
+		n = unitsizes[i] * 8;
+		sdi = srtest_dev_new(n);
+		t = sr_trigger_new(NULL);
+		s = sr_trigger_stage_add(t);
+		srtest_match_add(s, sdi, n - 1, SR_TRIGGER_RISING);
+		for (pos = 2000; pos < 2017; pos++) {
+			data = g_malloc0(NUM_SAMPLES * unitsizes[i]);
+			memset(data + pos * unitsizes[i], 0xff,
+				(NUM_SAMPLES - pos) * unitsizes[i]);
+			fail_unless(compare(sdi, t, data) == pos);
+			g_free(data);
+		}
+		/* No trigger at all in constant data. */
+		data = g_malloc0(NUM_SAMPLES * unitsizes[i]);
+		memset(data, 0xff, NUM_SAMPLES * unitsizes[i]);
+		fail_unless(compare(sdi, t, data) == -1);
+		g_free(data);
+		sr_trigger_free(t);
+		srtest_dev_free(sdi);
+	}
+}
+END_TEST
+
+/*
+ * Without logic channels there's nothing for the masks to check, even
+ * if all matches are on disabled channels and would be ignored.
+ */
+START_TEST(test_soft_trigger_no_logic_channels)
+{
+	struct sr_dev_inst *sdi;
+	struct sr_channel *ch;
+	struct sr_trigger *t;
+	struct sr_trigger_stage *s;
+	struct soft_trigger_logic *stl;
+
+	sdi = srtest_dev_new(0);
+	ch = srtest_channel_add(sdi, SR_CHANNEL_ANALOG, "A0");
+	ch->enabled = FALSE;
+	t = sr_trigger_new(NULL);
+	s = sr_trigger_stage_add(t);
+	srtest_match_add(s, sdi, 0, SR_TRIGGER_RISING);
+	stl = soft_trigger_logic_new(sdi, t, 0);
+	fail_unless(stl != NULL);
+	fail_unless(stl->masks == NULL);
+	soft_trigger_logic_free(stl);
+	sr_trigger_free(t);
+	srtest_dev_free(sdi);
+}
+END_TEST
+
+Suite *suite_soft_trigger(void)
+{
+	Suite *s;
+	TCase *tc;
+
+	s = suite_create("soft-trigger");
+
+	tc = tcase_create("masks");
+	tcase_set_timeout(tc, 0);
+	tcase_add_test(tc, test_soft_trigger_level);
+	tcase_add_test(tc, test_soft_trigger_edge);
+	tcase_add_test(tc, test_soft_trigger_multi_stage);
+	tcase_add_test(tc, test_soft_trigger_partial_match);
+	tcase_add_test(tc, test_soft_trigger_long_run);
+	tcase_add_test(tc, test_soft_trigger_no_logic_channels);
+	suite_add_tcase(s, tc);
+
+	return s;
+}
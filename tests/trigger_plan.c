@@ -0,0 +1,304 @@
+/*
+ * This file is part of the libsigrok project.
+ *
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <config.h>
+#include <check.h>
+#include <libsigrok/libsigrok.h>
+#include "libsigrok-internal.h"
+#include "internal.h"
+
+#define NUM_CHANNELS 8
+
+#define LEVEL_MATCHES \
+	(SR_TRIGGER_MATCH_BIT(SR_TRIGGER_ZERO) | \
+	SR_TRIGGER_MATCH_BIT(SR_TRIGGER_ONE))
+#define EDGE_MATCHES \
+	(SR_TRIGGER_MATCH_BIT(SR_TRIGGER_RISING) | \
+	SR_TRIGGER_MATCH_BIT(SR_TRIGGER_FALLING) | \
+	SR_TRIGGER_MATCH_BIT(SR_TRIGGER_EDGE))
+
+static struct sr_dev_inst *sdi;
+
+static void setup(void)
+{
+	sdi = srtest_dev_new(NUM_CHANNELS);
+}
+
+static void teardown(void)
+{
+	srtest_dev_free(sdi);
+}
+
+/* Capabilities of a hardware trigger supporting everything. */
+static void caps_init(struct sr_trigger_hw_caps *caps, int num_stages)
+{
+	caps->num_stages = num_stages;
+	caps->channels = (UINT64_C(1) << NUM_CHANNELS) - 1;
+	caps->matches = LEVEL_MATCHES | EDGE_MATCHES;
+	caps->max_edges = -1;
+	caps->max_rewind = -1;
+}
+
+static int num_matches(const struct sr_trigger *trigger, int stage)
+{
+	const struct sr_trigger_stage *s;
+
+	s = g_slist_nth_data(trigger->stages, stage);
+	fail_unless(s != NULL);
+
+	return g_slist_length(s->matches);
+}
+
+/* Check whether a plan leaves nothing to do for a missing trigger. */
+START_TEST(test_trigger_plan_null)
+{
+	struct sr_trigger_hw_caps caps;
+	struct sr_trigger_plan plan;
+	struct sr_trigger *t;
+
+	caps_init(&caps, 4);
+	fail_unless(sr_trigger_plan_init(NULL, &caps, &plan) == SR_OK);
+	fail_unless(plan.hw == NULL && plan.soft == NULL && plan.rewind == 0);
+
+	t = sr_trigger_new(NULL);
+	fail_unless(sr_trigger_plan_init(t, &caps, &plan) == SR_OK);
+	fail_unless(plan.hw == NULL && plan.soft == NULL && plan.rewind == 0);
+
+	fail_unless(sr_trigger_plan_init(t, NULL, &plan) == SR_ERR_ARG);
+	fail_unless(sr_trigger_plan_init(t, &caps, NULL) == SR_ERR_ARG);
+	sr_trigger_free(t);
+}
+END_TEST
+
+/* A single stage which the hardware supports completely. */
+START_TEST(test_trigger_plan_exact)
+{
+	struct sr_trigger_hw_caps caps;
+	struct sr_trigger_plan plan;
+	struct sr_trigger *t;
+	struct sr_trigger_stage *s;
+
+	caps_init(&caps, 1);
+	t = sr_trigger_new(NULL);
+	s = sr_trigger_stage_add(t);
+	srtest_match_add(s, sdi, 0, SR_TRIGGER_ONE);
+	srtest_match_add(s, sdi, 1, SR_TRIGGER_RISING);
+
+	fail_unless(sr_trigger_plan_init(t, &caps, &plan) == SR_OK);
+	fail_unless(plan.hw != NULL);
+	fail_unless(g_slist_length(plan.hw->stages) == 1);
+	fail_unless(num_matches(plan.hw, 0) == 2);
+	fail_unless(plan.soft == NULL);
+	fail_unless(plan.rewind == 0);
+
+	sr_trigger_plan_clear(&plan);
+	fail_unless(plan.hw == NULL);
+	sr_trigger_free(t);
+}
+END_TEST
+
+/*
+ * An EDGE match the hardware can't do. The host check needs the sample
+ * before the hardware trigger point, which the device can't deliver
+ * with max_rewind 0, so everything is left to the host.
+ */
+START_TEST(test_trigger_plan_unsupported_edge)
+{
+	struct sr_trigger_hw_caps caps;
+	struct sr_trigger_plan plan;
+	struct sr_trigger *t;
+	struct sr_trigger_stage *s;
+
+	caps_init(&caps, 2);
+	caps.matches &= ~SR_TRIGGER_MATCH_BIT(SR_TRIGGER_EDGE);
+	caps.max_rewind = 0;
+	t = sr_trigger_new(NULL);
+	s = sr_trigger_stage_add(t);
+	srtest_match_add(s, sdi, 0, SR_TRIGGER_ONE);
+	srtest_match_add(s, sdi, 1, SR_TRIGGER_EDGE);
+
+	fail_unless(sr_trigger_plan_init(t, &caps, &plan) == SR_OK);
+	fail_unless(plan.hw == NULL);
+	fail_unless(plan.soft == t);
+	fail_unless(plan.rewind == 0);
+	sr_trigger_plan_clear(&plan);
+
+	/* With one sample to spare, the level goes to the hardware. */
+	caps.max_rewind = 1;
+	fail_unless(sr_trigger_plan_init(t, &caps, &plan) == SR_OK);
+	fail_unless(plan.hw != NULL);
+	fail_unless(g_slist_length(plan.hw->stages) == 1);
+	fail_unless(num_matches(plan.hw, 0) == 1);
+	fail_unless(plan.soft == t);
+	fail_unless(plan.rewind == 1);
+	sr_trigger_plan_clear(&plan);
+
+	sr_trigger_free(t);
+}
+END_TEST
+
+/* More stages than the hardware has, the rest is checked on the host. */
+START_TEST(test_trigger_plan_truncated)
+{
+	struct sr_trigger_hw_caps caps;
+	struct sr_trigger_plan plan;
+	struct sr_trigger *t;
+	struct sr_trigger_stage *s;
+	int i;
+
+	caps_init(&caps, 2);
+	t = sr_trigger_new(NULL);
+	for (i = 0; i < 4; i++) {
+		s = sr_trigger_stage_add(t);
+		srtest_match_add(s, sdi, i, SR_TRIGGER_ONE);
+	}
+
+	/* Levels only: start at the sample where the first stage matched. */
+	fail_unless(sr_trigger_plan_init(t, &caps, &plan) == SR_OK);
+	fail_unless(plan.hw != NULL);
+	fail_unless(g_slist_length(plan.hw->stages) == 2);
+	fail_unless(plan.soft == t);
+	fail_unless(plan.rewind == 1);
+	sr_trigger_plan_clear(&plan);
+
+	/* An edge in a host-only stage needs one more sample. */
+	srtest_match_add(s, sdi, 7, SR_TRIGGER_FALLING);
+	fail_unless(sr_trigger_plan_init(t, &caps, &plan) == SR_OK);
+	fail_unless(g_slist_length(plan.hw->stages) == 2);
+	fail_unless(plan.soft == t);
+	fail_unless(plan.rewind == 2);
+	sr_trigger_plan_clear(&plan);
+
+	/* Limited rewind takes stages off the hardware. */
+	caps.max_rewind = 1;
+	fail_unless(sr_trigger_plan_init(t, &caps, &plan) == SR_OK);
+	fail_unless(g_slist_length(plan.hw->stages) == 1);
+	fail_unless(plan.soft == t);
+	fail_unless(plan.rewind == 1);
+	sr_trigger_plan_clear(&plan);
+
+	sr_trigger_free(t);
+}
+END_TEST
+
+/*
+ * A stage with matches only on disabled or unsupported channels fires
+ * on any sample in hardware, which ends the offload.
+ */
+START_TEST(test_trigger_plan_no_hw_matches)
+{
+	struct sr_trigger_hw_caps caps;
+	struct sr_trigger_plan plan;
+	struct sr_trigger *t;
+	struct sr_trigger_stage *s;
+	struct sr_channel *ch;
+
+	caps_init(&caps, 4);
+	caps.channels = 0x0f;
+	ch = g_slist_nth_data(sdi->channels, 1);
+	ch->enabled = FALSE;
+	t = sr_trigger_new(NULL);
+	s = sr_trigger_stage_add(t);
+	srtest_match_add(s, sdi, 0, SR_TRIGGER_ONE);
+	s = sr_trigger_stage_add(t);
+	srtest_match_add(s, sdi, 1, SR_TRIGGER_ONE);
+	srtest_match_add(s, sdi, 5, SR_TRIGGER_ZERO);
+	s = sr_trigger_stage_add(t);
+	srtest_match_add(s, sdi, 2, SR_TRIGGER_ONE);
+
+	fail_unless(sr_trigger_plan_init(t, &caps, &plan) == SR_OK);
+	fail_unless(plan.hw != NULL);
+	fail_unless(g_slist_length(plan.hw->stages) == 1);
+	fail_unless(plan.soft == t);
+	fail_unless(plan.rewind == 0);
+	sr_trigger_plan_clear(&plan);
+	sr_trigger_free(t);
+
+	/* Only a disabled channel in the first stage: host only. */
+	t = sr_trigger_new(NULL);
+	s = sr_trigger_stage_add(t);
+	srtest_match_add(s, sdi, 1, SR_TRIGGER_ONE);
+	fail_unless(sr_trigger_plan_init(t, &caps, &plan) == SR_OK);
+	fail_unless(plan.hw == NULL);
+	fail_unless(plan.soft == t);
+	fail_unless(plan.rewind == 0);
+	sr_trigger_plan_clear(&plan);
+	sr_trigger_free(t);
+}
+END_TEST
+
+/* Edge matches beyond max_edges are left to the host. */
+START_TEST(test_trigger_plan_max_edges)
+{
+	struct sr_trigger_hw_caps caps;
+	struct sr_trigger_plan plan;
+	struct sr_trigger *t;
+	struct sr_trigger_stage *s;
+
+	caps_init(&caps, 1);
+	t = sr_trigger_new(NULL);
+	s = sr_trigger_stage_add(t);
+	srtest_match_add(s, sdi, 0, SR_TRIGGER_RISING);
+	srtest_match_add(s, sdi, 1, SR_TRIGGER_FALLING);
+	srtest_match_add(s, sdi, 2, SR_TRIGGER_ONE);
+
+	caps.max_edges = 1;
+	fail_unless(sr_trigger_plan_init(t, &caps, &plan) == SR_OK);
+	fail_unless(num_matches(plan.hw, 0) == 2);
+	fail_unless(plan.soft == t);
+	fail_unless(plan.rewind == 1);
+	sr_trigger_plan_clear(&plan);
+
+	caps.max_edges = 0;
+	fail_unless(sr_trigger_plan_init(t, &caps, &plan) == SR_OK);
+	fail_unless(num_matches(plan.hw, 0) == 1);
+	fail_unless(plan.soft == t);
+	fail_unless(plan.rewind == 1);
+	sr_trigger_plan_clear(&plan);
+
+	caps.max_edges = 2;
+	fail_unless(sr_trigger_plan_init(t, &caps, &plan) == SR_OK);
+	fail_unless(num_matches(plan.hw, 0) == 3);
+	fail_unless(plan.soft == NULL);
+	fail_unless(plan.rewind == 0);
+	sr_trigger_plan_clear(&plan);
+
+	sr_trigger_free(t);
+}
+END_TEST
+
+Suite *suite_trigger_plan(void)
+{
+	Suite *s;
+	TCase *tc;
+
+	s = suite_create("trigger-plan");
+
+	tc = tcase_create("plan");
+	tcase_add_checked_fixture(tc, setup, teardown);
+	tcase_add_test(tc, test_trigger_plan_null);
+	tcase_add_test(tc, test_trigger_plan_exact);
+	tcase_add_test(tc, test_trigger_plan_unsupported_edge);
+	tcase_add_test(tc, test_trigger_plan_truncated);
+	tcase_add_test(tc, test_trigger_plan_no_hw_matches);
+	tcase_add_test(tc, test_trigger_plan_max_edges);
+	suite_add_tcase(s, tc);
+
+	return s;
+}